@@ -28,7 +28,7 @@ namespace ap {
 /**
  * @brief This class is used to test the Ceps class (private methods)
  */
-//class CepsTest;
+class TestCeps;
 
 /**
  * @brief This class allows the extraction of features from raw audio data.
@@ -85,6 +85,16 @@ class Ceps: public Spectrogram
      */
     void operator()(const blitz::Array<double,1>& input, blitz::Array<double,2>& output);
 
+    /**
+     * @brief Computes the Cepstral features of several utterances, which
+     * are distributed between n_threads threads (0 means all hardware
+     * threads). Each thread works on its own copy of this extractor. The
+     * output arrays are (re-)allocated with the expected shapes.
+     */
+    void operator()(const std::vector<blitz::Array<double,1> >& inputs,
+      std::vector<blitz::Array<double,2> >& outputs,
+      const size_t n_threads) const;
+
     /**
      * @brief Returns the sampling frequency/frequency rate
      */
@@ -205,8 +215,10 @@ class Ceps: public Spectrogram
     bool m_with_delta_delta;
 
     blitz::Array<double,2> m_dct_kernel;
+    mutable blitz::Array<double,2> m_cache_ceps_block;
+    mutable blitz::Array<double,1> m_cache_energies;
 
-//    friend class TestCeps;
+    friend class TestCeps;
 };
 }}
 
@@ -227,6 +227,30 @@ class Spectrogram: public Energy
      */
     void triangularFilterBank(blitz::Array<double,1>& data) const;
 
+    /**
+     * @brief Computes the magnitude (or energy) spectrum of the n frames of
+     * the input starting at the frame of index begin, and stores them in the
+     * first n rows of m_cache_spectrum. A real-input FFT is used. If
+     * log_energies is not null, the log-energy of each frame (before
+     * pre-emphasis) is stored there.
+     * @warning n should not be larger than the number of rows of
+     *   m_cache_spectrum, and no other check is performed.
+     */
+    void spectrumBlock(const blitz::Array<double,1>& input, const int begin,
+      const int n, double* log_energies=0) const;
+    /**
+     * @brief Applies the (log) triangular filter bank to the first n rows
+     * of m_cache_spectrum as a single matrix product, and stores the result
+     * in the first n rows of m_cache_filters_block.
+     */
+    void filterBankBlock(const int n) const;
+    /**
+     * @brief Tells whether the whole filter bank lies in the first half of
+     * the spectrum, which is required by filterBankBlock()
+     */
+    bool filterBankInBand() const
+    { return m_p_index(0) >= 0 && m_p_index((int)m_n_filters+1) <= (int)m_win_size/2; }
+
 
     virtual void initWinLength();
     virtual void initWinSize();
@@ -252,6 +276,7 @@ class Spectrogram: public Energy
      */
     void initCachePIndex();
     void initCacheFilters();
+    void initCacheFilterBankMatrix();
 
     size_t m_n_filters;
     double m_f_min;
@@ -272,8 +297,19 @@ class Spectrogram: public Energy
     mutable blitz::Array<std::complex<double>,1> m_cache_frame_c1;
     mutable blitz::Array<std::complex<double>,1> m_cache_frame_c2;
     mutable blitz::Array<double,1> m_cache_filters;
+
+    blitz::Array<double,2> m_filter_bank_matrix; ///< n_filters x (win_size/2+1)
+    mutable blitz::Array<double,1> m_rfft_wsave; ///< real FFT workspace
+    mutable blitz::Array<double,2> m_cache_spectrum;
+    mutable blitz::Array<double,2> m_cache_filters_block;
 };
 
+/**
+ * @brief The number of frames processed at once by the batch (matrix)
+ * implementation of the Spectrogram and Ceps extractors
+ */
+const int spectrogram_block_size = 256;
+
 }
 }
 
@@ -0,0 +1,134 @@
+/**
+ * @file bob/core/benchmark.h
+ * @date Sun Oct 18 19:05:12 2026 +0200
+ *
+ * @brief A minimalistic harness for the micro-benchmarks of bob: each case
+ * is run a number of times after some warm-up runs, and the minimum,
+ * median, mean and maximum durations are reported as text, CSV or JSON.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_CORE_BENCHMARK_H
+#define BOB_CORE_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+namespace bob { namespace core {
+  /**
+   * @ingroup CORE
+   * @{
+   */
+
+  /**
+   * @brief The timings of a benchmark case, in microseconds
+   */
+  struct BenchmarkResult {
+    std::string name; ///< name of the benchmark case
+    std::string size; ///< description of the problem size
+    size_t repetitions; ///< number of timed runs
+    double min; ///< fastest run
+    double median; ///< median run
+    double mean; ///< average run
+    double max; ///< slowest run
+  };
+
+  /**
+   * @brief A suite of benchmark cases. The code to time is run in a loop
+   * controlled by the suite, as follows:
+   *
+   * @code
+   * bob::core::BenchmarkSuite suite("math", argc, argv);
+   * while (suite.iterate("prod", "256x256")) bob::math::prod_(A, B, C);
+   * suite.report();
+   * @endcode
+   *
+   * The following command line options are understood:
+   *   --repetitions=N  number of timed runs of each case (default: 10)
+   *   --warmup=N       number of untimed runs before (default: 1)
+   *   --format=F       output format: text (default), csv or json
+   *   --filter=S       only run the cases whose name contains S
+   * The other arguments are available through getArguments() (e.g. the
+   * path to a model file).
+   */
+  class BenchmarkSuite {
+
+    public:
+
+      /**
+       * @brief Constructor
+       * @param name The name of the suite (usually, the package name)
+       * @param argc The number of command line arguments
+       * @param argv The command line arguments (argv[0] is skipped)
+       */
+      BenchmarkSuite(const std::string& name, int argc=0, char** argv=0);
+
+      /**
+       * @brief Controls the loop around the code to benchmark: returns true
+       * as long as the code should be run again, and records the timings of
+       * the case when it returns false. Returns false immediately if the
+       * case is filtered out.
+       * @param name The name of the case
+       * @param size A description of the problem size
+       */
+      bool iterate(const std::string& name, const std::string& size);
+
+      /**
+       * @brief Writes the results of all the cases that were run
+       */
+      void report(std::ostream& os) const;
+      void report() const;
+
+      /**
+       * @brief Tells whether the case of the given name should be run
+       */
+      bool enabled(const std::string& name) const;
+
+      /**
+       * @brief Returns the results of all the cases that were run
+       */
+      const std::vector<BenchmarkResult>& getResults() const
+      { return m_results; }
+
+      /**
+       * @brief Returns the command line arguments which are not options of
+       * the suite
+       */
+      const std::vector<std::string>& getArguments() const
+      { return m_arguments; }
+
+      size_t getRepetitions() const { return m_repetitions; }
+      size_t getWarmup() const { return m_warmup; }
+
+    private:
+
+      void parse(int argc, char** argv);
+      void record();
+
+      std::string m_name;
+      size_t m_repetitions;
+      size_t m_warmup;
+      std::string m_format;
+      std::string m_filter;
+      std::vector<std::string> m_arguments;
+
+      // state of the running case
+      bool m_running;
+      std::string m_case_name;
+      std::string m_case_size;
+      size_t m_iteration;
+      boost::posix_time::ptime m_start;
+      std::vector<double> m_timings;
+
+      std::vector<BenchmarkResult> m_results;
+  };
+
+  /**
+   * @}
+   */
+}}
+
+#endif /* BOB_CORE_BENCHMARK_H */
@@ -0,0 +1,226 @@
+/**
+ * @file bob/core/parallel.h
+ * @date Sun Oct 18 10:12:31 2026 +0200
+ *
+ * @brief Minimalistic helpers to split a loop over a number of objects
+ * between several boost threads. Contrary to the visioner threading
+ * utilities, exceptions raised inside the worker threads are transported
+ * back to the calling thread and re-thrown there.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_CORE_PARALLEL_H
+#define BOB_CORE_PARALLEL_H
+
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+#include <boost/thread.hpp>
+#include <boost/exception_ptr.hpp>
+
+namespace bob { namespace core {
+  /**
+   * @ingroup CORE
+   * @{
+   */
+
+  /**
+   * @brief Returns the number of threads to use for a given request. A value
+   * of 0 means "as many as there are hardware threads". The result is always
+   * at least 1.
+   */
+  size_t thread_count(const size_t n_threads);
+
+  /**
+   * @brief Splits the range [0, size) into n_threads contiguous, balanced
+   * blocks. The i-th block is [begins[i], ends[i]). Some blocks might be
+   * empty if size < n_threads.
+   */
+  void thread_split(const size_t size, std::vector<size_t>& begins,
+    std::vector<size_t>& ends, const size_t n_threads);
+
+  namespace detail {
+
+    /**
+     * @brief Runs one block of a parallel loop, storing any exception
+     * thrown in the process.
+     */
+    template <typename TOp> class ParallelTask {
+
+      public:
+
+        ParallelTask(TOp& op, const size_t index, const size_t begin,
+            const size_t end, boost::exception_ptr& error):
+          m_op(op), m_index(index), m_begin(begin), m_end(end),
+          m_error(error) {}
+
+        void operator()() {
+          try {
+            m_op(m_index, m_begin, m_end);
+          }
+          catch (...) {
+            m_error = boost::current_exception();
+          }
+        }
+
+      private:
+
+        TOp& m_op;
+        size_t m_index;
+        size_t m_begin;
+        size_t m_end;
+        boost::exception_ptr& m_error;
+    };
+
+    /**
+     * @brief Hands out the indices [0, size) one at a time to several
+     * threads.
+     */
+    class WorkQueue {
+
+      public:
+
+        WorkQueue(const size_t size): m_next(0), m_size(size) {}
+
+        /**
+         * @brief Takes the next index, returns false once the queue is
+         * empty
+         */
+        bool pop(size_t& index);
+
+        /**
+         * @brief Empties the queue, such that no more index is handed out
+         */
+        void stop();
+
+      private:
+
+        boost::mutex m_mutex;
+        size_t m_next;
+        size_t m_size;
+    };
+
+    /**
+     * @brief Runs the items taken from a work queue in one thread, storing
+     * any exception thrown in the process (which stops the queue).
+     */
+    template <typename TOp> class QueueTask {
+
+      public:
+
+        QueueTask(TOp& op, const size_t index, WorkQueue& queue,
+            boost::exception_ptr& error):
+          m_op(op), m_index(index), m_queue(queue), m_error(error) {}
+
+        void operator()() {
+          try {
+            size_t i;
+            while (m_queue.pop(i)) m_op(m_index, i);
+          }
+          catch (...) {
+            m_error = boost::current_exception();
+            m_queue.stop();
+          }
+        }
+
+      private:
+
+        TOp& m_op;
+        size_t m_index;
+        WorkQueue& m_queue;
+        boost::exception_ptr& m_error;
+    };
+
+  }
+
+  /**
+   * @brief Splits a loop of the given size in contiguous blocks and calls
+   * op(thread_index, begin, end) for each of them on a separate thread. The
+   * first block is processed by the calling thread. The same op object is
+   * shared by all threads: its call operator must be thread-safe. Per-thread
+   * state (scratch memory, partial accumulators) should be indexed using
+   * thread_index, which is always lower than thread_count(n_threads).
+   *
+   * If any of the blocks throws, the exception is re-thrown in the calling
+   * thread after all threads have joined.
+   *
+   * @param op The operation to call on each block
+   * @param size The number of objects to process
+   * @param n_threads The number of threads to use (0 means all hardware
+   * threads). With 1 thread, op(0, 0, size) is called directly.
+   */
+  template <typename TOp>
+  void parallel_for(TOp& op, const size_t size, const size_t n_threads) {
+    const size_t n = thread_count(n_threads);
+    if (n <= 1 || size <= 1) {
+      op(0, 0, size);
+      return;
+    }
+
+    std::vector<size_t> begins, ends;
+    thread_split(size, begins, ends, n);
+    std::vector<boost::exception_ptr> errors(n);
+
+    boost::thread_group group;
+    for (size_t i=1; i<n; ++i) {
+      group.create_thread(detail::ParallelTask<TOp>(op, i, begins[i], ends[i],
+            errors[i]));
+    }
+    detail::ParallelTask<TOp>(op, 0, begins[0], ends[0], errors[0])();
+    group.join_all();
+
+    for (size_t i=0; i<n; ++i) {
+      if (errors[i]) boost::rethrow_exception(errors[i]);
+    }
+  }
+
+  /**
+   * @brief Calls op(thread_index, i) for each i in [0, size), the items
+   * being handed out one at a time to the threads as they become idle. This
+   * balances the load when the cost of the items varies a lot (e.g.
+   * utterances or files of different lengths), where the contiguous blocks
+   * of parallel_for() would leave some threads waiting for the others. The
+   * calling thread is one of the workers. As for parallel_for(), the call
+   * operator of op must be thread-safe and per-thread state should be
+   * indexed using thread_index, which is always lower than
+   * min(thread_count(n_threads), size).
+   *
+   * If an item throws, no further item is started and the exception is
+   * re-thrown in the calling thread after all threads have joined.
+   *
+   * @param op The operation to call on each item
+   * @param size The number of items to process
+   * @param n_threads The number of threads to use (0 means all hardware
+   * threads). With 1 thread, the items are processed in order by the
+   * calling thread.
+   */
+  template <typename TOp>
+  void parallel_queue(TOp& op, const size_t size, const size_t n_threads) {
+    const size_t n = std::min(thread_count(n_threads), size);
+    if (n <= 1) {
+      for (size_t i=0; i<size; ++i) op(0, i);
+      return;
+    }
+
+    detail::WorkQueue queue(size);
+    std::vector<boost::exception_ptr> errors(n);
+
+    boost::thread_group group;
+    for (size_t i=1; i<n; ++i) {
+      group.create_thread(detail::QueueTask<TOp>(op, i, queue, errors[i]));
+    }
+    detail::QueueTask<TOp>(op, 0, queue, errors[0])();
+    group.join_all();
+
+    for (size_t i=0; i<n; ++i) {
+      if (errors[i]) boost::rethrow_exception(errors[i]);
+    }
+  }
+
+  /**
+   * @}
+   */
+}}
+
+#endif /* BOB_CORE_PARALLEL_H */
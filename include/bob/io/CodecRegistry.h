@@ -45,6 +45,13 @@ namespace bob { namespace io {
       static bool ignoreDoubleRegistration() { return instance()->s_ignore; }
       static void ignoreDoubleRegistration(bool v) { instance()->s_ignore = v; }
 
+      /**
+       * Sets and gets the number of threads the codecs may use to decode a
+       * file (0, the default, uses all the hardware threads)
+       */
+      static size_t nThreads() { return instance()->s_n_threads; }
+      static void nThreads(size_t n) { instance()->s_n_threads = n; }
+
     public: //object access
 
       void registerExtension(const std::string& extension,
@@ -61,7 +68,7 @@ namespace bob { namespace io {
 
     private:
 
-      CodecRegistry(): s_extension2codec(), s_ignore(false) {}
+      CodecRegistry(): s_extension2codec(), s_ignore(false), s_n_threads(0) {}
 
       // Not implemented
       CodecRegistry( const CodecRegistry&);
@@ -69,6 +76,7 @@ namespace bob { namespace io {
       std::map<std::string, file_factory_t> s_extension2codec;
       std::map<std::string, std::string> s_extension2description;
       bool s_ignore; ///< shall I ignore double-registrations?
+      size_t s_n_threads; ///< threads used to decode a file
     
   };
 
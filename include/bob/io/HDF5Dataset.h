@@ -247,6 +247,29 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
           return readArray<T,N>(0);
         }
 
+      /**
+       * Reads a block of consecutive arrays from the file in a single
+       * operation. The given array has one more dimension than the arrays
+       * stored in the dataset: its first extent sets the number of arrays to
+       * read, starting at the given index, and the remaining extents should
+       * match the shape of the stored arrays.
+       *
+       * If the shapes are not consistent, raises a type error. If the block
+       * goes past the last array of the dataset, raises an index error.
+       *
+       * @param index The index of the first array to read
+       * @param value The output array data will be stored inside this
+       * variable. This variable has to be a zero-based C-style contiguous
+       * storage array. If that is not the case, we will raise an exception.
+       */
+      template <typename T, int N>
+        void readArrayBlock(size_t index, blitz::Array<T,N>& value) {
+          bob::core::array::assertCZeroBaseContiguous(value);
+          bob::io::HDF5Type dest_type(value);
+          read_block_buffer(index, dest_type,
+              reinterpret_cast<void*>(value.data()));
+        }
+
       /**
        * DATA WRITING FUNCTIONALITY
        */
@@ -384,6 +407,14 @@ namespace bob { namespace io { namespace detail { namespace hdf5 {
        */
       void read_buffer (size_t index, const bob::io::HDF5Type& dest, void* buffer);
 
+      /**
+       * Reads a block of consecutive arrays, starting at the given index,
+       * into the given (user) buffer. The first extent of the destination
+       * type is the number of arrays to read.
+       */
+      void read_block_buffer (size_t index, const bob::io::HDF5Type& dest,
+          void* buffer);
+
       /**
        * Writes the contents of a given buffer into the file. The area that the
        * data will occupy should have been selected beforehand.
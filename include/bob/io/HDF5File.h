@@ -236,6 +236,18 @@ namespace bob { namespace io {
           return readArray<T,N>(path, 0);
       }
 
+      /**
+       * Reads a block of consecutive arrays, starting at the given position,
+       * into an array with one more dimension than the stored ones (the
+       * first extent being the number of arrays to read). Raises an
+       * exception if the type is incompatible or if the block goes past the
+       * end of the dataset. Relative paths are accepted.
+       */
+      template <typename T, int N> void readArrayBlock(const std::string& path,
+          size_t pos, blitz::Array<T,N>& value) {
+        (*m_cwd)[path]->readArrayBlock(pos, value);
+      }
+
       /**
        * Modifies the value of a scalar inside the file. Relative paths are
        * accepted.
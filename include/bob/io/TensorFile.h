@@ -13,6 +13,7 @@
 
 #include <boost/format.hpp>
 #include <stdexcept>
+#include <vector>
 
 #include <bob/core/blitz_array.h>
 #include <bob/io/TensorFileHeader.h>
@@ -93,6 +94,37 @@ namespace bob { namespace io {
        */
       void read (size_t index, bob::core::array::interface& data);
 
+      /**
+       * Reads count consecutive arrays, starting at the given position, with
+       * a single read from the file. The arrays are stacked along the first
+       * dimension of data, which has one more dimension than the arrays of
+       * the file. The bob::core::array::interface size will be reset if
+       * required.
+       */
+      void readBlock(size_t index, size_t count,
+          bob::core::array::interface& data);
+
+      /**
+       * Writes all the arrays stacked along the first dimension of data with
+       * a single write to the file: data[k] becomes the next array of the
+       * file, for each k. The same type/shape rules as for write() apply to
+       * the arrays data[k].
+       */
+      void writeBlock(const bob::core::array::interface& data);
+
+      /**
+       * Sets the number of arrays that are read at once by the sequential
+       * and indexed read() variants. The next arrays are then served from
+       * memory until a read is made outside of the buffered range. A value
+       * of 0 or 1 (default) disables the read-ahead.
+       */
+      void setReadAhead(size_t n_arrays);
+
+      /**
+       * Gets the number of arrays that are read at once
+       */
+      inline size_t getReadAhead() const { return m_read_ahead; }
+
       /**
        * Peeks the file and returns the currently set typeinfo
        */
@@ -163,6 +195,17 @@ namespace bob { namespace io {
        */
       void initHeader(const bob::core::array::typeinfo& info);
 
+      /**
+       * Fills the read-ahead buffer, starting at the current array
+       */
+      void fillReadAhead();
+
+      /**
+       * Puts the stream back at the current array, if it was moved by the
+       * read-ahead, before writing
+       */
+      void prepareWrite();
+
     public:
 
       /********************************************************************
@@ -202,6 +245,29 @@ namespace bob { namespace io {
         return bob::core::array::cast<T,D>(buf);
       }
 
+      /**
+       * Loads count consecutive arrays, stacked along the first dimension of
+       * the returned blitz++ array (which has one more dimension than the
+       * arrays of the file).
+       */
+      template <typename T, int D> inline blitz::Array<T,D> readBlock(size_t
+          index, size_t count) {
+        bob::core::array::typeinfo info;
+        peek(info);
+        if (info.nd + 1 != D) {
+          boost::format m("TensorFile::readBlock(): cannot read arrays with %d dimensions into a block with %d dimensions");
+          m % info.nd % D;
+          throw std::runtime_error(m.str());
+        }
+        for (size_t k=info.nd; k>0; --k) info.shape[k] = info.shape[k-1];
+        info.shape[0] = count;
+        ++info.nd;
+        info.update_strides();
+        bob::core::array::blitz_array buf(info);
+        readBlock(index, count, buf);
+        return bob::core::array::cast<T,D>(buf);
+      }
+
     private: //representation
 
       bool m_header_init;
@@ -211,6 +277,11 @@ namespace bob { namespace io {
       detail::TensorFileHeader m_header;
       openmode m_openmode;
       boost::shared_ptr<void> m_buffer;
+      std::vector<char> m_block; ///< column-major arrays of readBlock() and writeBlock()
+      size_t m_read_ahead; ///< number of arrays read at once
+      std::vector<char> m_ahead; ///< column-major arrays read ahead
+      size_t m_ahead_first; ///< index of the first array read ahead
+      size_t m_ahead_count; ///< number of arrays read ahead
   };
 
   inline _TensorFileFlag operator&(_TensorFileFlag a, _TensorFileFlag b) {
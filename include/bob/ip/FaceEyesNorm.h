@@ -9,9 +9,12 @@
 #ifndef BOB_IP_FACE_EYES_NORM_H
 #define BOB_IP_FACE_EYES_NORM_H
 
+#include <vector>
+#include <algorithm>
 #include <boost/shared_ptr.hpp>
 #include "bob/core/assert.h"
 #include "bob/core/check.h"
+#include "bob/core/parallel.h"
 #include "bob/ip/GeomNorm.h"
 #include "bob/ip/rotate.h"
 
@@ -106,6 +109,22 @@ namespace bob {
           blitz::Array<bool,2>& dst_mask, const double e1_y, const double e1_x,
           const double e2_y, const double e2_x) const;
 
+        /**
+          * @brief Process a batch of 2D face images, in parallel. The eye
+          * center coordinates of the i-th image are given by the i-th row
+          * (e1_y, e1_x, e2_y, e2_x) of eyes. The output images are resized
+          * to the cropping area if required. As each thread uses its own
+          * copy of this object, getLastAngle(), getLastScale() and
+          * getGeomNorm() are not updated by this variant.
+          *
+          * @param n_threads The number of threads to use (0 means all
+          * hardware threads)
+          */
+        template <typename T> void operator()(
+          const std::vector<blitz::Array<T,2> >& src,
+          std::vector<blitz::Array<double,2> >& dst,
+          const blitz::Array<double,2>& eyes, const size_t n_threads=1) const;
+
         /**
          * @brief Getter function for the bob::ip::GeomNorm object that is doing the job.
          *
@@ -178,6 +197,70 @@ namespace bob {
         e2_x);
     }
 
+    namespace detail {
+
+      /**
+       * Worker of the batch face normalization: the images are handed out
+       * one at a time by bob::core::parallel_queue(), and each thread uses
+       * its own copy of the normalizer (the angle and scale of the
+       * geometric normalization are set on each call).
+       */
+      template <typename T> class FaceEyesNormOp {
+
+        public:
+
+          FaceEyesNormOp(std::vector<boost::shared_ptr<FaceEyesNorm> >& norms,
+              const std::vector<blitz::Array<T,2> >& src,
+              std::vector<blitz::Array<double,2> >& dst,
+              const blitz::Array<double,2>& eyes):
+            m_norms(norms), m_src(src), m_dst(dst), m_eyes(eyes) {}
+
+          void operator()(size_t thread, size_t i) {
+            (*m_norms[thread])(m_src[i], m_dst[i], m_eyes(i,0), m_eyes(i,1),
+              m_eyes(i,2), m_eyes(i,3));
+          }
+
+        private:
+
+          std::vector<boost::shared_ptr<FaceEyesNorm> >& m_norms;
+          const std::vector<blitz::Array<T,2> >& m_src;
+          std::vector<blitz::Array<double,2> >& m_dst;
+          const blitz::Array<double,2>& m_eyes;
+      };
+
+    }
+
+    template <typename T>
+    inline void bob::ip::FaceEyesNorm::operator()(
+      const std::vector<blitz::Array<T,2> >& src,
+      std::vector<blitz::Array<double,2> >& dst,
+      const blitz::Array<double,2>& eyes, const size_t n_threads) const
+    {
+      // Check input
+      bob::core::array::assertSameDimensionLength(eyes.extent(0), src.size());
+      bob::core::array::assertSameDimensionLength(eyes.extent(1), 4);
+      for (size_t i=0; i<src.size(); ++i)
+        bob::core::array::assertZeroBase(src[i]);
+
+      // Allocate output
+      dst.resize(src.size());
+      for (size_t i=0; i<dst.size(); ++i) {
+        if (dst[i].extent(0) != m_out_shape(0) ||
+            dst[i].extent(1) != m_out_shape(1))
+          dst[i].resize(m_out_shape);
+      }
+      if (src.empty()) return;
+
+      // Process, using one copy of this object per thread
+      const size_t n = std::min(bob::core::thread_count(n_threads), src.size());
+      std::vector<boost::shared_ptr<FaceEyesNorm> > norms;
+      for (size_t t=0; t<n; ++t)
+        norms.push_back(boost::shared_ptr<FaceEyesNorm>(new FaceEyesNorm(*this)));
+
+      detail::FaceEyesNormOp<T> op(norms, src, dst, eyes);
+      bob::core::parallel_queue(op, src.size(), n);
+    }
+
     template <typename T, bool mask>
     inline void bob::ip::FaceEyesNorm::processNoCheck(const blitz::Array<T,2>& src,
       const blitz::Array<bool,2>& src_mask, blitz::Array<double,2>& dst,
@@ -220,6 +220,51 @@ namespace bob {
       int h = source.shape()[0]-1;
       int w = source.shape()[1]-1;
 
+      // If the four neighbours of all the target pixels lie inside the source
+      // image, the bounds checks can be skipped. The source positions being
+      // an affine function of the target positions, it is enough to check
+      // the four corners of the target image (with a small margin for the
+      // rounding errors of the incremental computation below).
+      if (!mask && m_crop_height > 0 && m_crop_width > 0) {
+        const double margin = 1e-6;
+        const double last_x = m_crop_width - 1., last_y = m_crop_height - 1.;
+        const double corners_x[4] = {origin_x, origin_x + last_x * dx,
+          origin_x - last_y * dy, origin_x + last_x * dx - last_y * dy};
+        const double corners_y[4] = {origin_y, origin_y + last_x * dy,
+          origin_y + last_y * dx, origin_y + last_x * dy + last_y * dx};
+        bool inside = true;
+        for (int k = 0; k < 4; ++k)
+          inside = inside && corners_x[k] >= margin && corners_x[k] <= w - margin
+            && corners_y[k] >= margin && corners_y[k] <= h - margin;
+
+        if (inside) {
+          const T* s = source.data();
+          const int s_y = source.stride(0), s_x = source.stride(1);
+          for (int y = 0; y < (int)m_crop_height; ++y){
+            double source_x = origin_x, source_y = origin_y;
+            for (int x = 0; x < (int)m_crop_width; ++x){
+              // positive positions: truncation is the same as std::floor
+              ox = static_cast<int>(source_x);
+              oy = static_cast<int>(source_y);
+              mx = source_x - ox;
+              my = source_y - oy;
+              const T* p = s + oy * s_y + ox * s_x;
+              double res = 0.;
+              res += (1.-mx) * (1.-my) * p[0];
+              res += mx * (1.-my) * p[s_x];
+              res += (1.-mx) * my * p[s_y];
+              res += mx * my * p[s_y + s_x];
+              target(y,x) = res;
+              source_x += dx;
+              source_y += dy;
+            }
+            origin_x -= dy;
+            origin_y += dx;
+          }
+          return;
+        }
+      }
+
       // Ok, so let's do it.
       for (int y = 0; y < (int)m_crop_height; ++y){
         // set the source image point to first point in row
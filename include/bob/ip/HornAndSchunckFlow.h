@@ -35,6 +35,16 @@ namespace bob { namespace ip { namespace optflow {
    *
    * Note that you will get the WRONG results if you use the Laplacian kernel
    * directly...
+   *
+   * The input is mirrored (edge pixels repeated) around the borders, so
+   * that the output has the same shape as the input, and output(y,x) is the
+   * average around input(y,x).
+   *
+   * @warning Behaviour change: previous versions returned the average around
+   * input(y+1,x+1) at output(y,x) (a "valid" convolution of the unmirrored
+   * input written to an output of the same shape), with a kernel truncated
+   * on the last two rows and columns. The outputs, and therefore the flows
+   * estimated by the Horn & Schunck operators, differ from those versions.
    */
   void laplacian_avg_hs_opencv(const blitz::Array<double,2>& input,
       blitz::Array<double,2>& output);
@@ -53,6 +63,16 @@ namespace bob { namespace ip { namespace optflow {
    * [1/12 1/6 1/12]
    * [1/6   0  1/6 ]
    * [1/12 1/6 1/12]
+   *
+   * The input is mirrored (edge pixels repeated) around the borders, so
+   * that the output has the same shape as the input, and output(y,x) is the
+   * average around input(y,x).
+   *
+   * @warning Behaviour change: previous versions returned the average around
+   * input(y+1,x+1) at output(y,x) (a "valid" convolution of the unmirrored
+   * input written to an output of the same shape), with a kernel truncated
+   * on the last two rows and columns. The outputs, and therefore the flows
+   * estimated by the Horn & Schunck operators, differ from those versions.
    */
   void laplacian_avg_hs(const blitz::Array<double,2>& input,
       blitz::Array<double,2>& output);
@@ -164,12 +184,53 @@ namespace bob { namespace ip { namespace optflow {
           const blitz::Array<double,2>& v, blitz::Array<double,2>& error) const;
 
       /**
-       * Call this to evaluate the flow
+       * Call this to evaluate the flow. Returns the number of iterations
+       * run at the finest level, which is lower than the requested one if
+       * the iterations converged before.
        */
-      void operator() (double alpha, size_t iterations, const
+      size_t operator() (double alpha, size_t iterations, const
           blitz::Array<double,2>& i1, const blitz::Array<double,2>& i2,
           blitz::Array<double,2>& u0, blitz::Array<double,2>& v0) const;
 
+      /**
+       * Sets the number of threads used by the iterations (0 means all
+       * hardware threads). The image rows are split between the threads.
+       */
+      void setNThreads(size_t n_threads) { m_n_threads = n_threads; }
+
+      /**
+       * Returns the number of threads used by the iterations
+       */
+      size_t getNThreads() const { return m_n_threads; }
+
+      /**
+       * Sets the convergence threshold: the iterations stop as soon as no
+       * velocity changes by more than this value. 0 (the default) disables
+       * the early exit, so that exactly the requested number of iterations
+       * are run.
+       */
+      void setTolerance(double tolerance) { m_tolerance = tolerance; }
+
+      /**
+       * Returns the convergence threshold
+       */
+      double getTolerance() const { return m_tolerance; }
+
+      /**
+       * Sets the number of levels of the multiresolution pyramid. With more
+       * than one level, the flow is first estimated on images downsampled by
+       * 2 at each level, from the coarsest to the finest, and each estimate
+       * is upsampled to initialize the iterations of the next level. The
+       * coarsest level is never smaller than 8 pixels in both directions.
+       * With 1 level (the default), only the images themselves are used.
+       */
+      void setNLevels(size_t n_levels);
+
+      /**
+       * Returns the number of levels of the multiresolution pyramid
+       */
+      size_t getNLevels() const { return m_n_levels; }
+
     private: //representation
 
       bob::ip::HornAndSchunckGradient m_gradient; ///< Gradient operator
@@ -178,7 +239,12 @@ namespace bob { namespace ip { namespace optflow {
       mutable blitz::Array<double,2> m_et; ///< Et buffer
       mutable blitz::Array<double,2> m_u; ///< U (x velocity) buffer
       mutable blitz::Array<double,2> m_v; ///< V (y velocity) buffer
-      mutable blitz::Array<double, 2> m_cterm; ///< common term buffer
+      mutable blitz::Array<double,2> m_u2; ///< U buffer of the next iteration
+      mutable blitz::Array<double,2> m_v2; ///< V buffer of the next iteration
+      mutable blitz::Array<double, 2> m_cterm; ///< common denominator buffer
+      size_t m_n_threads; ///< number of threads for the iterations
+      double m_tolerance; ///< convergence threshold (0 to disable)
+      size_t m_n_levels; ///< number of levels of the pyramid
 
   };
 
@@ -239,13 +305,54 @@ namespace bob { namespace ip { namespace optflow {
           blitz::Array<double,2>& error) const;
 
       /**
-       * Call this to evaluate the flow
+       * Call this to evaluate the flow. Returns the number of iterations
+       * run at the finest level, which is lower than the requested one if
+       * the iterations converged before.
        */
-      void operator() (double alpha, size_t iterations, const
+      size_t operator() (double alpha, size_t iterations, const
           blitz::Array<double,2>& i1, const blitz::Array<double,2>& i2,
           const blitz::Array<double,2>& i3,
           blitz::Array<double,2>& u0, blitz::Array<double,2>& v0) const;
 
+      /**
+       * Sets the number of threads used by the iterations (0 means all
+       * hardware threads). The image rows are split between the threads.
+       */
+      void setNThreads(size_t n_threads) { m_n_threads = n_threads; }
+
+      /**
+       * Returns the number of threads used by the iterations
+       */
+      size_t getNThreads() const { return m_n_threads; }
+
+      /**
+       * Sets the convergence threshold: the iterations stop as soon as no
+       * velocity changes by more than this value. 0 (the default) disables
+       * the early exit, so that exactly the requested number of iterations
+       * are run.
+       */
+      void setTolerance(double tolerance) { m_tolerance = tolerance; }
+
+      /**
+       * Returns the convergence threshold
+       */
+      double getTolerance() const { return m_tolerance; }
+
+      /**
+       * Sets the number of levels of the multiresolution pyramid. With more
+       * than one level, the flow is first estimated on images downsampled by
+       * 2 at each level, from the coarsest to the finest, and each estimate
+       * is upsampled to initialize the iterations of the next level. The
+       * coarsest level is never smaller than 8 pixels in both directions.
+       * With 1 level (the default), only the images themselves are used.
+       */
+      void setNLevels(size_t n_levels);
+
+      /**
+       * Returns the number of levels of the multiresolution pyramid
+       */
+      size_t getNLevels() const { return m_n_levels; }
+
     private: //representation
 
       bob::ip::SobelGradient m_gradient; ///< Gradient operator
@@ -254,7 +361,12 @@ namespace bob { namespace ip { namespace optflow {
       mutable blitz::Array<double,2> m_et; ///< Et buffer
       mutable blitz::Array<double,2> m_u; ///< U (x velocity) buffer
       mutable blitz::Array<double,2> m_v; ///< V (y velocity) buffer
-      mutable blitz::Array<double, 2> m_cterm; ///< common term buffer
+      mutable blitz::Array<double,2> m_u2; ///< U buffer of the next iteration
+      mutable blitz::Array<double,2> m_v2; ///< V buffer of the next iteration
+      mutable blitz::Array<double, 2> m_cterm; ///< common denominator buffer
+      size_t m_n_threads; ///< number of threads for the iterations
+      double m_tolerance; ///< convergence threshold (0 to disable)
+      size_t m_n_levels; ///< number of levels of the pyramid
 
   };
 
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <limits>
 #include "bob/ip/LBP.h"
+#include "bob/core/assert.h"
 
 namespace bob { namespace ip {
 
@@ -28,17 +29,17 @@ namespace bob { namespace ip {
    * The LBPTop class is designed to calculate the LBP-Top
    * coefficients given a set of images.
    *
-   * The workflow is as follows:
-   * TODO: UPDATE as this is not true
+   * The whole sequence can be processed at once, as a 3D array, or frame by
+   * frame, as follows:
    * 1. You initialize the class, defining the radius and number of points
    * in each of the three directions: XY, XT, YT for the LBP calculations
    * 2. For each image you have in the frame sequence, you push into the
    * class
-   * 3. An internal FIFO queue (length = radius in T direction) keeps track
-   * of the current image and their order. As a new image is pushed in, the
-   * oldest on the queue is pushed out.
-   * 4. After pushing an image, you read the current LBP-Top coefficients
-   * and may save it somewhere.
+   * 3. An internal FIFO queue (length = 2R+1, R being the largest radius)
+   * keeps track of the last images and their order. As a new image is
+   * pushed in, the oldest on the queue is pushed out.
+   * 4. Once the queue is full, push() returns the LBP-Top coefficients of
+   * the image at its center, and you may save them somewhere.
    */
   class LBPTop {
 
@@ -106,6 +107,49 @@ namespace bob { namespace ip {
           blitz::Array<uint16_t,3>& xt,
           blitz::Array<uint16_t,3>& yt) const;
 
+      /**
+       * Processes a video sequence one <b>grayscale</b> frame at a time.
+       * Only the last 2R+1 frames are kept in memory (R being the largest of
+       * the radii), so that arbitrarily long sequences can be processed. As
+       * soon as enough frames have been pushed, each call computes the LBP
+       * planes of the frame pushed R calls before, which are the same as the
+       * ones of this frame in the output of the 3D operator, and returns
+       * true. It returns false (leaving the outputs untouched) while the
+       * buffer is filling up.
+       *
+       * @param frame The next frame of the sequence. All the frames of a
+       * sequence should have the same shape: call reset() before processing
+       * another sequence.
+       * @param xy The result of the LBP operator in the XY plane, for the
+       * center frame of the buffer (shape: height-2R x width-2R)
+       * @param xt The result of the LBP operator in the XT plane (same shape)
+       * @param yt The result of the LBP operator in the YT plane (same shape)
+       */
+      bool push(const blitz::Array<uint8_t,2>& frame,
+          blitz::Array<uint16_t,2>& xy,
+          blitz::Array<uint16_t,2>& xt,
+          blitz::Array<uint16_t,2>& yt);
+
+      bool push(const blitz::Array<uint16_t,2>& frame,
+          blitz::Array<uint16_t,2>& xy,
+          blitz::Array<uint16_t,2>& xt,
+          blitz::Array<uint16_t,2>& yt);
+
+      bool push(const blitz::Array<double,2>& frame,
+          blitz::Array<uint16_t,2>& xy,
+          blitz::Array<uint16_t,2>& xt,
+          blitz::Array<uint16_t,2>& yt);
+
+      /**
+       * Forgets the frames pushed so far, to start a new sequence
+       */
+      void reset();
+
+      /**
+       * Returns the number of frames pushed since the last reset()
+       */
+      size_t getNFrames() const { return m_n_frames; }
+
       /**
        * Accessors
        */
@@ -143,9 +187,43 @@ namespace bob { namespace ip {
             blitz::Array<uint16_t,3>& xt,
             blitz::Array<uint16_t,3>& yt) const;
 
+      /**
+       * Computes the three LBP planes of the frame i of a 3D array, which
+       * should have at least R frames before and after it.
+       */
+      template <typename T>
+        void processFrame(const blitz::Array<T,3>& src, const int i,
+            const int max_radius,
+            blitz::Array<uint16_t,2>& xy,
+            blitz::Array<uint16_t,2>& xt,
+            blitz::Array<uint16_t,2>& yt) const;
+
+      /**
+       * Returns the largest of the X, Y and T radii
+       */
+      int getMaxRadius() const;
+
+      /**
+       * Stores a frame in the ring buffer and processes the center frame
+       * once the buffer is full.
+       */
+      template <typename T>
+        bool pushFrame(const blitz::Array<T,2>& frame,
+            blitz::Array<uint16_t,2>& xy,
+            blitz::Array<uint16_t,2>& xt,
+            blitz::Array<uint16_t,2>& yt);
+
       bob::ip::LBP m_lbp_xy; ///< LBP for the XY calculation
       bob::ip::LBP m_lbp_xt; ///< LBP for the XT calculation
       bob::ip::LBP m_lbp_yt; ///< LBP for the YT calculation
+
+      /**
+       * Ring buffer of the last L=2R+1 frames of the sequence being pushed.
+       * Each frame is stored twice, at the slots n%L and n%L+L, so that the
+       * last L frames are always the contiguous slots [(n+1)%L, (n+1)%L+L).
+       */
+      blitz::Array<double,3> m_frames;
+      size_t m_n_frames; ///< number of frames pushed since the last reset
   };
 
   /**
@@ -244,27 +322,89 @@ namespace bob { namespace ip {
       }
 
 
-      //for each element in time domain (the simplest way to see what is happening)
+      //for each element in time domain
       for(int i=max_radius;i<(Tlength-max_radius);i++){
-        for (int j=max_radius; j < (height-max_radius); j++) {
-          for (int k=max_radius; k < (width-max_radius); k++) {
-            /*Getting the "micro-plane" for XY calculus*/
-            const blitz::Array<T,2> kxy =
-               src( i, blitz::Range(j-max_radius,j+max_radius), blitz::Range(k-max_radius,k+max_radius));
-            xy(i-max_radius,j-max_radius,k-max_radius) = m_lbp_xy(kxy, max_radius, max_radius);
-
-            /*Getting the "micro-plane" for XT calculus*/
-            const blitz::Array<T,2> kxt =
-               src(blitz::Range(i-max_radius,i+max_radius),j,blitz::Range(k-max_radius,k+max_radius));
-            xt(i-max_radius,j-max_radius,k-max_radius) = m_lbp_xt(kxt, max_radius, max_radius);
-
-            /*Getting the "micro-plane" for YT calculus*/
-            const blitz::Array<T,2> kyt =
-               src(blitz::Range(i-max_radius,i+max_radius),blitz::Range(j-max_radius,j+max_radius),k);
-            yt(i-max_radius,j-max_radius,k-max_radius) = m_lbp_yt(kyt, max_radius, max_radius);
-          }
+        blitz::Array<uint16_t,2> xy_i = xy(i-max_radius, blitz::Range::all(), blitz::Range::all());
+        blitz::Array<uint16_t,2> xt_i = xt(i-max_radius, blitz::Range::all(), blitz::Range::all());
+        blitz::Array<uint16_t,2> yt_i = yt(i-max_radius, blitz::Range::all(), blitz::Range::all());
+        processFrame(src, i, max_radius, xy_i, xt_i, yt_i);
+      }
+    }
+
+  template <typename T>
+    void bob::ip::LBPTop::processFrame(const blitz::Array<T,3>& src,
+                                       const int i, const int max_radius,
+                                       blitz::Array<uint16_t,2>& xy,
+                                       blitz::Array<uint16_t,2>& xt,
+                                       blitz::Array<uint16_t,2>& yt) const
+    {
+      int height = src.extent(1);
+      int width = src.extent(2);
+
+      for (int j=max_radius; j < (height-max_radius); j++) {
+        for (int k=max_radius; k < (width-max_radius); k++) {
+          /*Getting the "micro-plane" for XY calculus*/
+          const blitz::Array<T,2> kxy =
+             src( i, blitz::Range(j-max_radius,j+max_radius), blitz::Range(k-max_radius,k+max_radius));
+          xy(j-max_radius,k-max_radius) = m_lbp_xy(kxy, max_radius, max_radius);
+
+          /*Getting the "micro-plane" for XT calculus*/
+          const blitz::Array<T,2> kxt =
+             src(blitz::Range(i-max_radius,i+max_radius),j,blitz::Range(k-max_radius,k+max_radius));
+          xt(j-max_radius,k-max_radius) = m_lbp_xt(kxt, max_radius, max_radius);
+
+          /*Getting the "micro-plane" for YT calculus*/
+          const blitz::Array<T,2> kyt =
+             src(blitz::Range(i-max_radius,i+max_radius),blitz::Range(j-max_radius,j+max_radius),k);
+          yt(j-max_radius,k-max_radius) = m_lbp_yt(kyt, max_radius, max_radius);
+        }
+      }
+    }
+
+  template <typename T>
+    bool bob::ip::LBPTop::pushFrame(const blitz::Array<T,2>& frame,
+                                    blitz::Array<uint16_t,2>& xy,
+                                    blitz::Array<uint16_t,2>& xt,
+                                    blitz::Array<uint16_t,2>& yt)
+    {
+      const int max_radius = getMaxRadius();
+      const int L = 2*max_radius + 1;
+      const int height = frame.extent(0);
+      const int width = frame.extent(1);
+
+      if (m_n_frames == 0) {
+        // checks the frame size once per sequence
+        if (height <= 2*max_radius || width <= 2*max_radius) {
+          boost::format m("the frames (%dx%d) should be larger than %dx%d");
+          m % height % width % (2*max_radius) % (2*max_radius);
+          throw std::runtime_error(m.str());
         }
+        m_frames.resize(2*L, height, width);
       }
+      else if (height != m_frames.extent(1) || width != m_frames.extent(2)) {
+        boost::format m("the frame shape (%dx%d) differs from the one of the previous frames of the sequence (%dx%d): call reset() to start a new sequence");
+        m % height % width % m_frames.extent(1) % m_frames.extent(2);
+        throw std::runtime_error(m.str());
+      }
+
+      const blitz::TinyVector<int,2> shape(height-2*max_radius, width-2*max_radius);
+      bob::core::array::assertSameShape(xy, shape);
+      bob::core::array::assertSameShape(xt, shape);
+      bob::core::array::assertSameShape(yt, shape);
+
+      const int slot = m_n_frames % L;
+      blitz::Range all = blitz::Range::all();
+      m_frames(slot, all, all) = frame;
+      m_frames(slot+L, all, all) = m_frames(slot, all, all);
+      ++m_n_frames;
+      if (m_n_frames < (size_t)L) return false;
+
+      // the last L frames, from the oldest to the newest
+      const int first = m_n_frames % L;
+      const blitz::Array<double,3> window =
+        m_frames(blitz::Range(first, first+L-1), all, all);
+      processFrame(window, max_radius, max_radius, xy, xt, yt);
+      return true;
     }
 } }
 
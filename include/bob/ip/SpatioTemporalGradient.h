@@ -106,6 +106,27 @@ namespace bob { namespace ip {
         const blitz::Array<double,2>& i2, blitz::Array<double,2>& Ex,
         blitz::Array<double,2>& Ey, blitz::Array<double,2>& Et) const;
 
+      /**
+       * Processes a video sequence one frame at a time. The spatial
+       * filtering of each frame is done once and kept until the frame
+       * leaves the 2-frame window, so that the temporal combination is all
+       * that remains to be done for each new frame. Returns false while the
+       * window is filling up (i.e. for the first frame) and true once Ex, Ey
+       * and Et hold the gradients for the last 2 frames pushed, which are
+       * the same as the ones of the operator() for this pair of frames.
+       *
+       * All the frames of a sequence should have the shape of the operator.
+       * Changing the shape or the kernels restarts the sequence.
+       */
+      bool push(const blitz::Array<double,2>& frame,
+        blitz::Array<double,2>& Ex, blitz::Array<double,2>& Ey,
+        blitz::Array<double,2>& Et);
+
+      /**
+       * Forgets the frames pushed so far, to start a new sequence
+       */
+      void reset();
+
     private: //representation
 
       blitz::Array<double,1> m_diff_kernel;
@@ -113,6 +134,13 @@ namespace bob { namespace ip {
       mutable blitz::Array<double,2> m_buffer1;
       mutable blitz::Array<double,2> m_buffer2;
 
+      // spatially filtered terms of the last frames pushed, indexed by the
+      // frame number modulo the window size
+      blitz::Array<double,3> m_frame_ex;
+      blitz::Array<double,3> m_frame_ey;
+      blitz::Array<double,3> m_frame_et;
+      size_t m_n_frames; ///< number of frames pushed since the last reset
+
   };
 
   /**
@@ -239,6 +267,26 @@ namespace bob { namespace ip {
           blitz::Array<double,2>& Ex, blitz::Array<double,2>& Ey,
           blitz::Array<double,2>& Et) const;
 
+      /**
+       * Processes a video sequence one frame at a time. The spatial
+       * filtering of each frame is done once and kept until the frame
+       * leaves the 3-frame window. Returns false while the window is
+       * filling up (i.e. for the first 2 frames) and true once Ex, Ey and Et
+       * hold the gradients for the last 3 frames pushed, which are the same
+       * as the ones of the operator() for these frames.
+       *
+       * All the frames of a sequence should have the shape of the operator.
+       * Changing the shape or the kernels restarts the sequence.
+       */
+      bool push(const blitz::Array<double,2>& frame,
+          blitz::Array<double,2>& Ex, blitz::Array<double,2>& Ey,
+          blitz::Array<double,2>& Et);
+
+      /**
+       * Forgets the frames pushed so far, to start a new sequence
+       */
+      void reset();
+
     private: //representation
 
       blitz::Array<double,1> m_diff_kernel;
@@ -247,6 +295,13 @@ namespace bob { namespace ip {
       mutable blitz::Array<double,2> m_buffer2;
       mutable blitz::Array<double,2> m_buffer3;
 
+      // spatially filtered terms of the last frames pushed, indexed by the
+      // frame number modulo the window size
+      blitz::Array<double,3> m_frame_ex;
+      blitz::Array<double,3> m_frame_ey;
+      blitz::Array<double,3> m_frame_et;
+      size_t m_n_frames; ///< number of frames pushed since the last reset
+
   };
 
   /**
@@ -65,6 +65,12 @@ namespace bob { namespace machine {
       //! performs some checks before calling the forward_ method
       void forward (const blitz::Array<double,1>& input, double& output) const;
 
+      //! computes the BIC probability scores of the given input difference vectors (one per row)
+      void forward_(const blitz::Array<double,2>& input, blitz::Array<double,1>& output) const;
+
+      //! performs some checks before calling the batch forward_ method
+      void forward (const blitz::Array<double,2>& input, blitz::Array<double,1>& output) const;
+
       //! sets the IEC vectors of the given class
       void setIEC(bool clazz, const blitz::Array<double,1>& mean, const blitz::Array<double,1>& variances, bool copy_data = false);
 
@@ -225,6 +225,39 @@ class GMMMachine: public Machine<blitz::Array<double,1>, double>
      */
     double logLikelihood_(const blitz::Array<double, 1> &x) const;
 
+    /**
+     * Output the log likelihood of each sample (row) of X, i.e.
+     * log(p(x_n|GMM)), using the batch kernel of the Gaussians
+     * @param[in]  X      The samples (one per row)
+     * @param[out] output The log likelihood of each sample
+     * Dimensions of the parameters are checked
+     */
+    void logLikelihood(const blitz::Array<double,2> &X,
+      blitz::Array<double,1> &output) const;
+
+    /**
+     * Output the log likelihood of each sample (row) of X, i.e.
+     * log(p(x_n|GMM)), using the batch kernel of the Gaussians
+     * @param[in]  X      The samples (one per row)
+     * @param[out] output The log likelihood of each sample
+     * @warning Dimensions of the parameters are not checked
+     */
+    void logLikelihood_(const blitz::Array<double,2> &X,
+      blitz::Array<double,1> &output) const;
+
+    /**
+     * Output the log likelihood of each sample (row) of X, i.e.
+     * log(p(x_n|GMM)), using the batch kernel of the Gaussians
+     * @param[in]  X      The samples (one per row)
+     * @param[out] log_weighted_gaussian_likelihoods For each sample n and
+     *   Gaussian i: log(weight_i*p(x_n|Gaussian_i))
+     * @param[out] output The log likelihood of each sample
+     * @warning Dimensions of the parameters are not checked
+     */
+    void logLikelihood_(const blitz::Array<double,2> &X,
+      blitz::Array<double,2> &log_weighted_gaussian_likelihoods,
+      blitz::Array<double,1> &output) const;
+
     /**
      * Output the log likelihood of the sample, x
      * (overrides Machine::forward)
@@ -271,6 +304,24 @@ class GMMMachine: public Machine<blitz::Array<double,1>, double>
      */
     void accStatistics_(const blitz::Array<double,1> &x, GMMStats &stats) const;
 
+    /**
+     * Accumulate the GMM statistics for this sample, using the given buffers
+     * instead of the internal cache of the machine. As the machine is not
+     * modified, several threads can call this method concurrently on the
+     * same (shared) machine, as long as each of them provides its own
+     * sample, statistics and buffers.
+     *
+     * @param[in]  x     The current sample
+     * @param[out] stats The accumulated statistics
+     * @param log_weighted_gaussian_likelihoods Buffer of size n_gaussians
+     * @param P Buffer of size n_gaussians
+     * @param Px Buffer of size n_gaussians x n_inputs
+     * @warning Dimensions of the parameters are not checked
+     */
+    void accStatistics_(const blitz::Array<double,1>& x, GMMStats &stats,
+      blitz::Array<double,1>& log_weighted_gaussian_likelihoods,
+      blitz::Array<double,1>& P, blitz::Array<double,2>& Px) const;
+
     /**
      * Get a pointer to a particular Gaussian component
      * @param[in] i The index of the Gaussian component
@@ -356,10 +407,27 @@ class GMMMachine: public Machine<blitz::Array<double,1>, double>
      * @param[in]  x     The current sample
      * @param[out] stats The accumulated statistics
      * @param[in]  log_likelihood  The current log_likelihood
+     * @param[in]  log_weighted_gaussian_likelihoods  The weighted log
+     *   likelihoods of each Gaussian for this sample
+     * @param      P   Buffer for the responsibilities
+     * @param      Px  Buffer for the first order statistics of this sample
      * @warning Dimensions of the parameters are not checked
      */
     void accStatisticsInternal(const blitz::Array<double,1> &x,
-      GMMStats &stats, const double log_likelihood) const;
+      GMMStats &stats, const double log_likelihood,
+      const blitz::Array<double,1>& log_weighted_gaussian_likelihoods,
+      blitz::Array<double,1>& P, blitz::Array<double,2>& Px) const;
+
+    /**
+     * Computes log(weight_i*p(x_n|Gaussian_i)) for the samples
+     * [begin, begin+n) of X, using the batch kernel of the Gaussians.
+     * Xt is a buffer of size n_inputs x n, and the result is stored in l,
+     * Gaussian by Gaussian (l[i*n+k] for the k-th sample).
+     * @warning Dimensions of the parameters are not checked
+     */
+    void logWeightedLikelihoodsBlock(const blitz::Array<double,2>& X,
+      const int begin, const int n, std::vector<double>& Xt,
+      std::vector<double>& l) const;
 
 
     /// Some cache arrays to avoid re-allocation when computing log-likelihoods
@@ -0,0 +1,141 @@
+/**
+ * @file bob/machine/GMMStatsExtractor.h
+ * @date Sun Oct 18 13:02:45 2026 +0200
+ *
+ * @brief Computes the GMM statistics of many utterances at once, sharing a
+ * single (read-only) world model between several threads.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_MACHINE_GMMSTATSEXTRACTOR_H
+#define BOB_MACHINE_GMMSTATSEXTRACTOR_H
+
+#include <string>
+#include <vector>
+#include <blitz/array.h>
+#include <boost/shared_ptr.hpp>
+#include <bob/io/HDF5File.h>
+#include <bob/machine/GMMMachine.h>
+#include <bob/machine/GMMStats.h>
+
+namespace bob { namespace machine {
+/**
+ * @ingroup MACHINE
+ * @{
+ */
+
+/**
+ * @brief Extracts one GMMStats per utterance (set of feature vectors) with
+ * respect to a world model (UBM).
+ *
+ * The utterances are distributed to a pool of worker threads, which all
+ * share the same GMMMachine. The utterances are processed by batches: at
+ * most batch_size feature arrays and statistics are held in memory at any
+ * time, and the statistics of each batch are written (in the input order)
+ * before the next batch is started. Feature files are read with
+ * bob::io::load(), one file at a time, as the HDF5 library is not
+ * thread-safe. The progress is reported after each batch on
+ * bob::core::info.
+ */
+class GMMStatsExtractor
+{
+  public:
+    /**
+     * @brief Constructor
+     * @param ubm The world model
+     * @param n_threads The number of worker threads (0 means all hardware
+     *   threads)
+     * @param batch_size The maximum number of utterances processed at once
+     */
+    GMMStatsExtractor(const boost::shared_ptr<const bob::machine::GMMMachine> ubm,
+      const size_t n_threads=0, const size_t batch_size=256);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~GMMStatsExtractor();
+
+    /**
+     * @brief Returns the world model
+     */
+    const boost::shared_ptr<const bob::machine::GMMMachine> getUbm() const
+    { return m_ubm; }
+    /**
+     * @brief Sets the world model
+     */
+    void setUbm(const boost::shared_ptr<const bob::machine::GMMMachine> ubm);
+
+    /**
+     * @brief Returns the number of worker threads
+     */
+    size_t getNThreads() const
+    { return m_n_threads; }
+    /**
+     * @brief Sets the number of worker threads (0 means all hardware
+     *   threads)
+     */
+    void setNThreads(const size_t n_threads)
+    { m_n_threads = n_threads; }
+
+    /**
+     * @brief Returns the maximum number of utterances processed at once
+     */
+    size_t getBatchSize() const
+    { return m_batch_size; }
+    /**
+     * @brief Sets the maximum number of utterances processed at once
+     */
+    void setBatchSize(const size_t batch_size);
+
+    /**
+     * @brief Computes the statistics of a list of utterances held in memory
+     * @param features The feature vectors of each utterance (one per row)
+     * @param stats The statistics of each utterance, in the same order
+     */
+    void extract(const std::vector<blitz::Array<double,2> >& features,
+      std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats) const;
+
+    /**
+     * @brief Computes the statistics of a list of feature files, and saves
+     * them in the given HDF5 file. The statistics of the i-th file are
+     * stored in the group "statsI" (e.g. "stats0", "stats1", ...), relative
+     * to the current working directory of the output file.
+     * @param feature_files The files containing the feature vectors of each
+     *   utterance (one per row)
+     * @param output The HDF5 file where to write the statistics
+     */
+    void extract(const std::vector<std::string>& feature_files,
+      bob::io::HDF5File& output) const;
+
+    /**
+     * @brief Computes the statistics of a list of feature files, and saves
+     * each of them in its own HDF5 file (as GMMStats::save() does).
+     * @param feature_files The files containing the feature vectors of each
+     *   utterance (one per row)
+     * @param output_files The HDF5 files where to write the statistics
+     */
+    void extract(const std::vector<std::string>& feature_files,
+      const std::vector<std::string>& output_files) const;
+
+  private:
+    /**
+     * @brief Computes the statistics of the items [begin, end) of the given
+     * source, either from memory or from files.
+     */
+    void extractBatch(const std::vector<blitz::Array<double,2> >* features,
+      const std::vector<std::string>* feature_files, const size_t begin,
+      const size_t end,
+      std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats) const;
+
+    boost::shared_ptr<const bob::machine::GMMMachine> m_ubm;
+    size_t m_n_threads;
+    size_t m_batch_size;
+};
+
+/**
+ * @}
+ */
+}}
+
+#endif // BOB_MACHINE_GMMSTATSEXTRACTOR_H
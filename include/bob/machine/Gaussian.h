@@ -21,6 +21,34 @@ namespace bob { namespace machine {
  * @{
  */
 
+namespace detail {
+
+  /**
+   * @brief Number of samples evaluated at once by the batch log-likelihood
+   * kernels. A block of 128 samples of 60 dimensions fits in the L1 cache.
+   */
+  const int gaussian_block_size = 128;
+
+  /**
+   * @brief Copies the rows [begin, begin+n) of X into the dimension-major
+   * buffer Xt (of size X.extent(1) x n), i.e. Xt[d*n+k] = X(begin+k,d).
+   */
+  void transposeBlock(const blitz::Array<double,2>& X, const int begin,
+    const int n, double* Xt);
+
+  /**
+   * @brief Evaluates a diagonal Gaussian on a block of n samples stored in
+   * dimension-major order (see transposeBlock()):
+   *   out[k] = constant - 0.5 * sum_d (Xt[d*n+k] - mean[d])^2 * inv_variance[d]
+   * The innermost loop runs over independent samples with unit stride, and
+   * hence vectorises without requiring any reassociation of the sums.
+   */
+  void diagonalGaussianKernel(const double* Xt, const int n, const int D,
+    const double* mean, const double* inv_variance, const double constant,
+    double* out);
+
+}
+
 /**
  * @brief This class implements a multivariate diagonal Gaussian distribution.
  */
@@ -175,6 +203,36 @@ class Gaussian: public Machine<blitz::Array<double,1>, double>
      */
     double logLikelihood_(const blitz::Array<double,1>& x) const;
 
+    /**
+     * Output the log likelihood of each sample (row) of X
+     * @param X The data samples (one feature vector per row)
+     * @param output The log likelihood of each sample
+     */
+    void logLikelihood(const blitz::Array<double,2>& X,
+      blitz::Array<double,1>& output) const;
+
+    /**
+     * Output the log likelihood of each sample (row) of X
+     * @param X The data samples (one feature vector per row)
+     * @param output The log likelihood of each sample
+     * @warning The inputs are NOT checked
+     */
+    void logLikelihood_(const blitz::Array<double,2>& X,
+      blitz::Array<double,1>& output) const;
+
+    /**
+     * Output offset + the log likelihood of n samples stored in a
+     * dimension-major block, as filled by detail::transposeBlock()
+     * @param Xt The block of samples (n_inputs x n)
+     * @param n The number of samples in the block
+     * @param offset A constant added to each log likelihood (e.g. the log of
+     *   the weight of the Gaussian in a mixture)
+     * @param output The n (offset) log likelihoods
+     * @warning The inputs are NOT checked
+     */
+    void logLikelihoodBlock_(const double* Xt, const int n,
+      const double offset, double* output) const;
+
     /**
      * Computes the log likelihood of the sample, x
      * @param x The data sample (feature vector)
@@ -246,6 +304,12 @@ class Gaussian: public Machine<blitz::Array<double,1>, double>
      */
     blitz::Array<double,1> m_variance_thresholds;
 
+    /**
+     * The inverse of the variance (1/m_variance), which is used by the
+     * batch log likelihood kernel (updated with m_g_norm)
+     */
+    blitz::Array<double,1> m_cache_inv_variance;
+
     /**
      * A constant that depends only on the feature dimensionality
      * m_n_log2pi = n_inputs * log(2*pi) (used to compute m_gnorm)
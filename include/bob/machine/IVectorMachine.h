@@ -10,6 +10,7 @@
 #define BOB_MACHINE_IVECTOR_H
 
 #include <blitz/array.h>
+#include <vector>
 #include "Machine.h"
 #include "GMMMachine.h"
 #include "GMMStats.h"
@@ -217,6 +218,37 @@ class IVectorMachine: public bob::machine::Machine<bob::machine::GMMStats, blitz
      */
     void computeTtSigmaInvFnorm(const bob::machine::GMMStats& input, blitz::Array<double,1>& output) const;
 
+    /**
+     * @brief Computes the posterior distribution of the latent variable
+     * \f$w\f$ for a batch of utterances.
+     *
+     * The matrices \f$(Id + \sum_{c=1}^{C} N_{i,j,c} T^{T} \Sigma_{c}^{-1} T)\f$
+     * of all the utterances are obtained at once, as the product of the
+     * zeroth order statistics with the packed
+     * \f$T_{c}^{T} \Sigma_{c}^{-1} T_{c}\f$ matrices, and are then
+     * solved per utterance using a Cholesky decomposition. The utterances
+     * are distributed between n_threads threads.
+     *
+     * @param input GMM statistics (only the ones in [begin, end) are used)
+     * @param begin Index of the first utterance
+     * @param end Index following the last utterance (U = end - begin)
+     * @param N Zeroth order statistics \f$N_{c}\f$ (size U x C)
+     * @param Fnorm Centered first order statistics
+     *   \f$F_{c} - N_{c} ubmmean_{c}\f$ (size U x CD)
+     * @param Ew Posterior mean \f$E\{w\}\f$ (size U x rt)
+     * @param Eww If not null, posterior second order moment
+     *   \f$E\{w.w^{T}\}\f$, each row being a flattened rt x rt matrix
+     *   (size U x rt*rt)
+     * @param n_threads Number of threads to use (0 means all hardware
+     *   threads)
+     * @warning No check is performed, and all the output arrays should be
+     *   C-contiguous
+     */
+    void computePosteriors_(const std::vector<bob::machine::GMMStats>& input,
+      const size_t begin, const size_t end, blitz::Array<double,2>& N,
+      blitz::Array<double,2>& Fnorm, blitz::Array<double,2>& Ew,
+      blitz::Array<double,2>* Eww, const size_t n_threads=1) const;
+
     /**
      * @brief Extracts an ivector from the input GMM statistics
      *
@@ -234,6 +266,29 @@ class IVectorMachine: public bob::machine::Machine<bob::machine::GMMStats, blitz
      */
     void forward_(const bob::machine::GMMStats& input, blitz::Array<double,1>& output) const;
 
+    /**
+     * @brief Extracts the ivectors of a list of GMM statistics
+     *
+     * @param input GMM statistics to be used by the machine
+     * @param output I-vectors computed by the machine (one per row)
+     * @param n_threads Number of threads to use (0 means all hardware
+     *   threads)
+     */
+    void forward(const std::vector<bob::machine::GMMStats>& input,
+      blitz::Array<double,2>& output, const size_t n_threads=1) const;
+
+    /**
+     * @brief Extracts the ivectors of a list of GMM statistics
+     *
+     * @param input GMM statistics to be used by the machine
+     * @param output I-vectors computed by the machine (one per row)
+     * @param n_threads Number of threads to use (0 means all hardware
+     *   threads)
+     * @warning Inputs are NOT checked
+     */
+    void forward_(const std::vector<bob::machine::GMMStats>& input,
+      blitz::Array<double,2>& output, const size_t n_threads=1) const;
+
   protected:
     /**
      * @brief Apply the variance flooring thresholds.
@@ -266,12 +321,13 @@ class IVectorMachine: public bob::machine::Machine<bob::machine::GMMStats, blitz
     blitz::Array<double,1> m_sigma; ///< The diagonal covariance matrix \f$\Sigma\f$
     double m_variance_threshold; ///< The variance flooring threshold
 
-    blitz::Array<double,3> m_cache_Tct_sigmacInv;
-    blitz::Array<double,3> m_cache_Tct_sigmacInv_Tc;
+    ///< \f$\Sigma^{-1} T\f$ (CD x rt)
+    blitz::Array<double,2> m_cache_sigmaInvT;
+    ///< \f$T_{c}^{T} \Sigma_{c}^{-1} T_{c}\f$, one flattened rt x rt
+    ///< matrix per Gaussian component (C x rt*rt)
+    blitz::Array<double,2> m_cache_Tct_sigmacInv_Tc;
 
-    mutable blitz::Array<double,1> m_tmp_d;
     mutable blitz::Array<double,1> m_tmp_t1;
-    mutable blitz::Array<double,1> m_tmp_t2;
     mutable blitz::Array<double,2> m_tmp_tt;
 };
 
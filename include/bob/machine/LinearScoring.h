@@ -31,6 +31,8 @@ namespace bob { namespace machine {
  * @param test_channelOffset  list of channel offset if any (for JFA/ISA for instance)
  * @param frame_length_normalisation   perform a normalisation by the number of feature vectors
  * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+ * @param n_threads   number of threads used to build the statistics matrix and to compute the product (0 means all hardware threads)
+ * @param chunk_size  number of test statistics processed at once (0 means all of them), which bounds the memory used for the centred statistics
  * @warning the output scores matrix should have the correct size (number of models x number of test_stats)
  */
 void linearScoring(const std::vector<blitz::Array<double,1> >& models,
@@ -38,12 +40,14 @@ void linearScoring(const std::vector<blitz::Array<double,1> >& models,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const std::vector<blitz::Array<double, 1> >& test_channelOffset,
                    const bool frame_length_normalisation,
-                   blitz::Array<double,2>& scores);
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads=1, const size_t chunk_size=256);
 void linearScoring(const std::vector<blitz::Array<double,1> >& models,
                    const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const bool frame_length_normalisation,
-                   blitz::Array<double,2>& scores);
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads=1, const size_t chunk_size=256);
 
 /**
  * Compute a matrix of scores using linear scoring.
@@ -55,13 +59,16 @@ void linearScoring(const std::vector<blitz::Array<double,1> >& models,
  * @param test_stats  list of accumulate statistics for each test trial
  * @param frame_length_normalisation   perform a normalisation by the number of feature vectors
  * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+ * @param n_threads   number of threads used to build the statistics matrix and to compute the product (0 means all hardware threads)
+ * @param chunk_size  number of test statistics processed at once (0 means all of them), which bounds the memory used for the centred statistics
  * @warning the output scores matrix should have the correct size (number of models x number of test_stats)
  */
 void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
                    const bob::machine::GMMMachine& ubm,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const bool frame_length_normalisation,
-                   blitz::Array<double,2>& scores);
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads=1, const size_t chunk_size=256);
 /**
  * Compute a matrix of scores using linear scoring.
  *
@@ -73,6 +80,8 @@ void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMa
  * @param test_channelOffset  list of channel offset if any (for JFA/ISA for instance)
  * @param frame_length_normalisation   perform a normalisation by the number of feature vectors
  * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+ * @param n_threads   number of threads used to build the statistics matrix and to compute the product (0 means all hardware threads)
+ * @param chunk_size  number of test statistics processed at once (0 means all of them), which bounds the memory used for the centred statistics
  * @warning the output scores matrix should have the correct size (number of models x number of test_stats)
  */
 void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
@@ -80,7 +89,8 @@ void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMa
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const std::vector<blitz::Array<double, 1> >& test_channelOffset,
                    const bool frame_length_normalisation,
-                   blitz::Array<double,2>& scores);
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads=1, const size_t chunk_size=256);
 
 /**
  * Compute a score using linear scoring.
@@ -0,0 +1,56 @@
+/**
+ * @file bob/math/gemm.h
+ * @date Sun Oct 18 10:48:02 2026 +0200
+ *
+ * @brief This file defines a general matrix multiplication for 2D blitz
+ * arrays of doubles, backed by the BLAS dgemm function.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_MATH_GEMM_H
+#define BOB_MATH_GEMM_H
+
+#include <blitz/array.h>
+
+namespace bob { namespace math {
+/**
+ * @ingroup MATH
+ * @{
+ */
+
+/**
+ * @brief Function which computes C = alpha*op(A)*op(B) + beta*C, where
+ *   op(X) is either X or its transpose, using the dgemm BLAS function.
+ *   Contrary to prod(), which relies on a blitz++ reduction, this relies on
+ *   the (blocked and, depending on the BLAS implementation, multi-threaded)
+ *   BLAS kernel and is recommended for large matrices.
+ *   Non C-contiguous inputs and outputs are handled through temporary
+ *   copies. The rows of C may additionally be split between several
+ *   threads, each of them calling dgemm on its own block (this should not
+ *   be combined with a multi-threaded BLAS implementation).
+ * @param A The A matrix (size MxN, or NxM if transA is set)
+ * @param B The B matrix (size NxP, or PxN if transB is set)
+ * @param C The C matrix (size MxP)
+ * @param transA Whether to use the transpose of A
+ * @param transB Whether to use the transpose of B
+ * @param alpha The scaling factor of the product
+ * @param beta The scaling factor of the previous content of C
+ * @param n_threads The number of threads to use (0 means all hardware
+ *   threads)
+ */
+void gemm(const blitz::Array<double,2>& A, const blitz::Array<double,2>& B,
+  blitz::Array<double,2>& C, const bool transA=false,
+  const bool transB=false, const double alpha=1., const double beta=0.,
+  const size_t n_threads=1);
+void gemm_(const blitz::Array<double,2>& A, const blitz::Array<double,2>& B,
+  blitz::Array<double,2>& C, const bool transA=false,
+  const bool transB=false, const double alpha=1., const double beta=0.,
+  const size_t n_threads=1);
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_MATH_GEMM_H */
@@ -14,6 +14,8 @@
 
 #include <blitz/array.h>
 #include <bob/core/assert.h>
+#include <bob/core/parallel.h>
+#include <algorithm>
 #include <vector>
 
 namespace bob { namespace math {
@@ -22,6 +24,177 @@ namespace bob { namespace math {
  * @{
  */
 
+    namespace detail {
+
+      /**
+       * @brief Number of samples (rows) processed at once by the scatter
+       * kernels.
+       */
+      const int scatter_block_size = 128;
+
+      /**
+       * @brief Symmetric rank-k update S += X'*X of the lower triangle of the
+       * (C-contiguous) DxD matrix S, where X is a C-contiguous block of k
+       * samples of D features. The float and double versions rely on the
+       * BLAS ssyrk/dsyrk functions. The upper triangle of S is not
+       * accessed.
+       */
+      void syrk(const int D, const int k, const double* X, double* S);
+      void syrk(const int D, const int k, const float* X, float* S);
+
+      /**
+       * @brief Generic version of the symmetric rank-k update, for types
+       * that are not supported by BLAS.
+       */
+      template <typename T>
+      void syrk(const int D, const int k, const T* X, T* S) {
+        for (int z=0; z<k; ++z) {
+          const T* x = X + z*D;
+          for (int i=0; i<D; ++i)
+            for (int j=0; j<=i; ++j)
+              S[i*D+j] += x[i] * x[j];
+        }
+      }
+
+      /**
+       * @brief Sums the samples of A, block of samples by block of samples.
+       * Each thread accumulates the sums of its blocks in its own vector, as
+       * the reference counting of blitz++ arrays is not thread-safe.
+       */
+      template <typename T>
+      class SumOp {
+
+        public:
+
+          SumOp(const blitz::Array<T,2>& A, std::vector<std::vector<T> >& sums):
+            m_A(A), m_sums(sums) {}
+
+          void operator()(size_t t, size_t begin, size_t end) const {
+            const int N = m_A.extent(0);
+            const int D = m_A.extent(1);
+            std::vector<T>& sum = m_sums[t];
+            sum.assign(D, T(0));
+            std::vector<T> block_sum(D);
+            for (size_t b=begin; b<end; ++b) {
+              const int z0 = b*scatter_block_size;
+              const int z1 = std::min(z0 + scatter_block_size, N);
+              std::fill(block_sum.begin(), block_sum.end(), T(0));
+              for (int z=z0; z<z1; ++z)
+                for (int d=0; d<D; ++d)
+                  block_sum[d] += m_A(z,d);
+              for (int d=0; d<D; ++d) sum[d] += block_sum[d];
+            }
+          }
+
+        private:
+
+          const blitz::Array<T,2>& m_A;
+          std::vector<std::vector<T> >& m_sums;
+      };
+
+      /**
+       * @brief Accumulates the lower triangle of the scatter matrix of the
+       * samples of A around M, as well as the sums of the centered samples.
+       * The centered samples of each block are copied into a contiguous
+       * buffer, which is then used for a symmetric rank-k update of the
+       * partial scatter matrix of the thread.
+       */
+      template <typename T>
+      class ScatterOp {
+
+        public:
+
+          ScatterOp(const blitz::Array<T,2>& A, const std::vector<T>& M,
+              std::vector<std::vector<T> >& S,
+              std::vector<std::vector<T> >& sums):
+            m_A(A), m_M(M), m_S(S), m_sums(sums) {}
+
+          void operator()(size_t t, size_t begin, size_t end) const {
+            const int N = m_A.extent(0);
+            const int D = m_A.extent(1);
+            std::vector<T>& S = m_S[t];
+            std::vector<T>& sum = m_sums[t];
+            S.assign(D*D, T(0));
+            sum.assign(D, T(0));
+            std::vector<T> X(scatter_block_size*D);
+            for (size_t b=begin; b<end; ++b) {
+              const int z0 = b*scatter_block_size;
+              const int k = std::min(scatter_block_size, N - z0);
+              for (int z=0; z<k; ++z)
+                for (int d=0; d<D; ++d) {
+                  const T x = m_A(z0+z,d) - m_M[d];
+                  X[z*D+d] = x;
+                  sum[d] += x;
+                }
+              syrk(D, k, &X[0], &S[0]);
+            }
+          }
+
+        private:
+
+          const blitz::Array<T,2>& m_A;
+          const std::vector<T>& m_M;
+          std::vector<std::vector<T> >& m_S;
+          std::vector<std::vector<T> >& m_sums;
+      };
+
+      /**
+       * @brief Computes the sample mean M and the scatter matrix of the
+       * samples of A, which is either stored in S or added to S. The mean is
+       * computed with the corrected two-pass algorithm: the sums of the
+       * samples are computed by blocks, and the sums of the samples centered
+       * around this first estimate are used to correct both the mean and
+       * the scatter matrix. Only the lower triangle of the scatter is
+       * computed, the upper triangle being set by symmetry. The blocks of
+       * samples are split between n_threads threads (0 means all hardware
+       * threads), each of them using its own partial scatter matrix.
+       */
+      template <typename T>
+      void scatterBlocked(const blitz::Array<T,2>& A, blitz::Array<T,2>& S,
+        blitz::Array<T,1>& M, const bool accumulate, const size_t n_threads)
+      {
+        const int N = A.extent(0);
+        const int D = A.extent(1);
+        if (!accumulate) S = 0;
+        if (N == 0) {
+          M = 0;
+          return;
+        }
+
+        const size_t n_blocks = (N + scatter_block_size - 1) / scatter_block_size;
+        const size_t n = std::min(bob::core::thread_count(n_threads), n_blocks);
+
+        // 1. Blocked sums of the samples
+        std::vector<std::vector<T> > sums(n);
+        SumOp<T> sum_op(A, sums);
+        bob::core::parallel_for(sum_op, n_blocks, n);
+        std::vector<T> mean(D, T(0));
+        for (size_t t=0; t<n; ++t)
+          for (int d=0; d<D; ++d) mean[d] += sums[t][d];
+        for (int d=0; d<D; ++d) mean[d] /= N;
+
+        // 2. Scatter around this mean, by symmetric rank-k updates
+        std::vector<std::vector<T> > parts(n);
+        ScatterOp<T> scatter_op(A, mean, parts, sums);
+        bob::core::parallel_for(scatter_op, n_blocks, n);
+
+        // 3. Correction of the mean and of the scatter, using the sums of
+        // the centered samples c: S = sum (x-m)(x-m)' - c*c'/N
+        std::vector<T> c(D, T(0));
+        for (size_t t=0; t<n; ++t)
+          for (int d=0; d<D; ++d) c[d] += sums[t][d];
+        for (int d=0; d<D; ++d) M(d) = mean[d] + c[d] / N;
+        for (int i=0; i<D; ++i)
+          for (int j=0; j<=i; ++j) {
+            T v = - c[i] * c[j] / N;
+            for (size_t t=0; t<n; ++t) v += parts[t][i*D+j];
+            S(i,j) += v;
+            if (j < i) S(j,i) += v;
+          }
+      }
+
+    }
+
     /**
      * @brief Computes the scatter matrix of a 2D array considering data is
      * organized row-wise (each sample is a row, each feature is a column).
@@ -32,22 +205,15 @@ namespace bob { namespace math {
      * focused only on speed.
      *
      * This version of the method also returns the sample mean of the array.
+     *
+     * The samples are processed by blocks, as symmetric rank-k updates of
+     * the scatter matrix, and the blocks may be split between n_threads
+     * threads (0 means all hardware threads).
      */
     template<typename T>
     void scatter_(const blitz::Array<T,2>& A, blitz::Array<T,2>& S, 
-        blitz::Array<T,1>& M) {
-      blitz::firstIndex i;
-      blitz::secondIndex j;
-      blitz::Range a = blitz::Range::all();
-
-      M = blitz::mean(A(j,i),j);
-      S = 0;
-
-      blitz::Array<T,1> buffer(A.extent(1));
-      for (int z=0; z<A.extent(0); ++z) {
-        buffer = A(z,a) - M;
-        S += buffer(i) * buffer(j); //outer product
-      }
+        blitz::Array<T,1>& M, const size_t n_threads=1) {
+      detail::scatterBlocked<T>(A, S, M, false, n_threads);
     }
 
     /**
@@ -63,14 +229,14 @@ namespace bob { namespace math {
      */
     template<typename T>
     void scatter(const blitz::Array<T,2>& A, blitz::Array<T,2>& S, 
-        blitz::Array<T,1>& M) {
+        blitz::Array<T,1>& M, const size_t n_threads=1) {
 
       // Check output
       bob::core::array::assertSameDimensionLength(A.extent(1), M.extent(0));
       bob::core::array::assertSameDimensionLength(A.extent(1), S.extent(0));
       bob::core::array::assertSameDimensionLength(A.extent(1), S.extent(1));
 
-      scatter_<T>(A, S, M);
+      scatter_<T>(A, S, M, n_threads);
     }
 
     /**
@@ -83,9 +249,10 @@ namespace bob { namespace math {
      * focused only on speed.
      */
     template<typename T>
-    void scatter_(const blitz::Array<T,2>& A, blitz::Array<T,2>& S) {
-      blitz::Array<T,1> M;
-      scatter_<T>(A, S, M);
+    void scatter_(const blitz::Array<T,2>& A, blitz::Array<T,2>& S,
+        const size_t n_threads=1) {
+      blitz::Array<T,1> M(A.extent(1));
+      scatter_<T>(A, S, M, n_threads);
     }
 
     /**
@@ -98,48 +265,22 @@ namespace bob { namespace math {
      * the input and output matrices conform, use the scatter_() variant.
      */
     template<typename T>
-    void scatter(const blitz::Array<T,2>& A, blitz::Array<T,2>& S) {
-      blitz::Array<T,1> M;
-      scatter<T>(A, S, M);
+    void scatter(const blitz::Array<T,2>& A, blitz::Array<T,2>& S,
+        const size_t n_threads=1) {
+      blitz::Array<T,1> M(A.extent(1));
+      scatter<T>(A, S, M, n_threads);
     }
 
 
-    namespace detail {
-      /** 
-       * @brief Evaluates, in a single loop, the overall (or grand) mean 'm',
-       * the individual class means 'm_k' and computes the total number of 
-       * elements in each class 'N'. 
-       */ 
-      template <typename T>
-      void evalMeans(const std::vector<blitz::Array<T,2> >& data, 
-        blitz::Array<T,1>& m, blitz::Array<T,2>& m_k, 
-        blitz::Array<T,1>& N) 
-      { 
-        blitz::Range a = blitz::Range::all(); 
-        for (size_t k=0; k<data.size(); ++k) { //class loop 
-          N(k) = data[k].extent(0); 
-          for (int example=0; example<data[k].extent(0); ++example) { 
-            blitz::Array<T,1> buffer(data[k](example,a)); 
-            m_k(a,k) += buffer; 
-            m += buffer; 
-          }
-          
-          m_k(a,k) /= N(k); 
-        }
-        
-        m /= sum(N); 
-      }   
-
-    }
-
     /**
      * @brief Calculates the within and between class scatter matrices Sw and 
      * Sb. Returns those matrices and the overall means vector (m).
      *
      * Strategy implemented:
-     * 1. Evaluate the overall mean (m), class means (m_k) and the total class
-     *    counts (N).
-     * 2. Evaluate Sw and Sb using normal loops.
+     * 1. Evaluate the class means (m_k) and the within class scatter Sw,
+     *    class by class, using the blocked (and possibly multi-threaded)
+     *    scatter kernel.
+     * 2. Evaluate the overall mean (m) and Sb from the class means.
      *
      * Note that Sw and Sb, in this implementation, will be normalized by N-1
      * (number of samples) and K (number of classes). This procedure makes
@@ -161,39 +302,37 @@ namespace bob { namespace math {
     template <typename T>
     void scatters_(const std::vector<blitz::Array<T,2> >& data,
       blitz::Array<T,2>& Sw, blitz::Array<T,2>& Sb,
-      blitz::Array<T,1>& m)
+      blitz::Array<T,1>& m, const size_t n_threads=1)
     {
       // checks for data shape should have been done before...
       const int n_features = data[0].extent(1);
 
-      m = 0; //overall mean
-      blitz::Array<T,2> m_k(n_features, data.size());
-      m_k = 0; //class means
-      blitz::Array<T,1> N(data.size());
-      N = 0; //class counts
-
-      // Compute the means
-      detail::evalMeans(data, m, m_k, N); 
+      blitz::Array<T,2> m_k(n_features, data.size()); //class means
+      blitz::Array<T,1> N(data.size()); //class counts
 
       blitz::firstIndex i;
       blitz::secondIndex j;
       blitz::Range a = blitz::Range::all();
 
-      // between class scatter Sb
-      Sb = 0;
+      // within class scatter Sw and class means, class by class
+      Sw = 0;
       blitz::Array<T,1> buffer(n_features); //tmp buffer for speed-up
       for (size_t k=0; k<data.size(); ++k) { //class loop
-        buffer = m - m_k(a,k);
-        Sb += N(k) * buffer(i) * buffer(j); //Bishop's Eq. 4.46
+        N(k) = data[k].extent(0);
+        detail::scatterBlocked<T>(data[k], Sw, buffer, true, n_threads);
+        m_k(a,k) = buffer;
       }
 
-      // within class scatter Sw
-      Sw = 0;
+      // overall mean
+      m = 0;
+      for (size_t k=0; k<data.size(); ++k) m += N(k) * m_k(a,k);
+      m /= blitz::sum(N);
+
+      // between class scatter Sb
+      Sb = 0;
       for (size_t k=0; k<data.size(); ++k) { //class loop
-        for (int example=0; example<data[k].extent(0); ++example) {
-          buffer = data[k](example,a) - m_k(a,k);
-          Sw += buffer(i) * buffer(j); //outer product
-        }
+        buffer = m - m_k(a,k);
+        Sb += N(k) * buffer(i) * buffer(j); //Bishop's Eq. 4.46
       }
     }
 
@@ -202,9 +341,10 @@ namespace bob { namespace math {
      * Sb. Returns those matrices and the overall means vector (m).
      *
      * Strategy implemented:
-     * 1. Evaluate the overall mean (m), class means (m_k) and the total class
-     *    counts (N).
-     * 2. Evaluate Sw and Sb using normal loops.
+     * 1. Evaluate the class means (m_k) and the within class scatter Sw,
+     *    class by class, using the blocked (and possibly multi-threaded)
+     *    scatter kernel.
+     * 2. Evaluate the overall mean (m) and Sb from the class means.
      *
      * Note that Sw and Sb, in this implementation, will be normalized by N-1
      * (number of samples) and K (number of classes). This procedure makes
@@ -222,7 +362,7 @@ namespace bob { namespace math {
     template <typename T>
     void scatters(const std::vector<blitz::Array<T,2> >& data,
       blitz::Array<T,2>& Sw, blitz::Array<T,2>& Sb,
-      blitz::Array<T,1>& m)
+      blitz::Array<T,1>& m, const size_t n_threads=1)
     {
       // Check output
       for (size_t i=0; i<data.size(); ++i)
@@ -232,7 +372,7 @@ namespace bob { namespace math {
       bob::core::array::assertSameDimensionLength(m.extent(0), Sb.extent(0));
       bob::core::array::assertSameDimensionLength(m.extent(0), Sb.extent(1));
 
-      scatters_<T>(data, Sw, Sb, m);
+      scatters_<T>(data, Sw, Sb, m, n_threads);
     }
 
     /**
@@ -240,9 +380,10 @@ namespace bob { namespace math {
      * Sb. Returns those matrices.
      *
      * Strategy implemented:
-     * 1. Evaluate the overall mean (m), class means (m_k) and the total class
-     *    counts (N).
-     * 2. Evaluate Sw and Sb using normal loops.
+     * 1. Evaluate the class means (m_k) and the within class scatter Sw,
+     *    class by class, using the blocked (and possibly multi-threaded)
+     *    scatter kernel.
+     * 2. Evaluate the overall mean (m) and Sb from the class means.
      *
      * Note that Sw and Sb, in this implementation, will be normalized by N-1
      * (number of samples) and K (number of classes). This procedure makes
@@ -259,10 +400,10 @@ namespace bob { namespace math {
      */
     template<typename T>
     void scatters_(const std::vector<blitz::Array<T,2> >& data,
-      blitz::Array<T,2>& Sw, blitz::Array<T,2>& Sb)
+      blitz::Array<T,2>& Sw, blitz::Array<T,2>& Sb, const size_t n_threads=1)
     {
       blitz::Array<T,1> M(data[0].extent(1));
-      scatters_<T>(data, Sw, Sb, M);
+      scatters_<T>(data, Sw, Sb, M, n_threads);
     }
 
     /**
@@ -270,9 +411,10 @@ namespace bob { namespace math {
      * Sb. Returns those matrices.
      *
      * Strategy implemented:
-     * 1. Evaluate the overall mean (m), class means (m_k) and the total class
-     *    counts (N).
-     * 2. Evaluate Sw and Sb using normal loops.
+     * 1. Evaluate the class means (m_k) and the within class scatter Sw,
+     *    class by class, using the blocked (and possibly multi-threaded)
+     *    scatter kernel.
+     * 2. Evaluate the overall mean (m) and Sb from the class means.
      *
      * Note that Sw and Sb, in this implementation, will be normalized by N-1
      * (number of samples) and K (number of classes). This procedure makes
@@ -293,12 +435,78 @@ namespace bob { namespace math {
      */
     template<typename T>
     void scatters(const std::vector<blitz::Array<T,2> >& data,
-      blitz::Array<T,2>& Sw, blitz::Array<T,2>& Sb)
+      blitz::Array<T,2>& Sw, blitz::Array<T,2>& Sb, const size_t n_threads=1)
     {
       blitz::Array<T,1> M(data[0].extent(1));
-      scatters<T>(data, Sw, Sb, M);
+      scatters<T>(data, Sw, Sb, M, n_threads);
     }
 
+    /**
+     * @brief Accumulates the sample mean and the scatter matrix of a set of
+     * samples which is given block by block (e.g. read from a file), such
+     * that the whole set never needs to be held in memory.
+     *
+     * The mean and scatter of each block are computed with scatter_(), and
+     * merged with those of the previous blocks using the pairwise update of
+     * Chan et al.:
+     *   n = n_a + n_b,  d = m_b - m_a,
+     *   m = m_a + d * n_b / n,
+     *   S = S_a + S_b + d * d' * n_a * n_b / n
+     * which, contrary to the accumulation of the raw first and second order
+     * moments, does not suffer from catastrophic cancellation.
+     */
+    class ScatterAccumulator {
+
+      public:
+
+        /**
+         * @brief Constructor
+         * @param n_features The dimensionality of the samples
+         * @param n_threads The number of threads used to compute the scatter
+         *   of each block (0 means all hardware threads)
+         */
+        ScatterAccumulator(const size_t n_features, const size_t n_threads=1);
+
+        /**
+         * @brief Accumulates a block of samples (one per row)
+         */
+        void accumulate(const blitz::Array<double,2>& block);
+
+        /**
+         * @brief Resets the accumulator, as if no sample was seen
+         */
+        void reset();
+
+        /**
+         * @brief Returns the number of accumulated samples
+         */
+        size_t getNSamples() const { return m_n_samples; }
+
+        /**
+         * @brief Returns the dimensionality of the samples
+         */
+        size_t getNFeatures() const { return m_mean.extent(0); }
+
+        /**
+         * @brief Returns the mean of the accumulated samples
+         */
+        const blitz::Array<double,1>& getMean() const { return m_mean; }
+
+        /**
+         * @brief Returns the scatter matrix of the accumulated samples
+         */
+        const blitz::Array<double,2>& getScatter() const { return m_scatter; }
+
+      private:
+
+        size_t m_n_samples;
+        size_t m_n_threads;
+        blitz::Array<double,1> m_mean;
+        blitz::Array<double,2> m_scatter;
+        blitz::Array<double,1> m_block_mean;
+        blitz::Array<double,2> m_block_scatter;
+    };
+
 /**
  * @}
  */
@@ -16,7 +16,9 @@
 #define BOB_TRAINER_FISHERLDATRAINER_H
 
 #include <vector>
+#include <boost/shared_ptr.hpp>
 #include <bob/machine/LinearMachine.h>
+#include <bob/trainer/SampleReader.h>
 
 namespace bob { namespace trainer {
 
@@ -105,6 +107,18 @@ namespace bob { namespace trainer {
        */
       void setStripToRank (bool v) { m_strip_to_rank = v; }
 
+      /**
+       * @brief Gets the number of threads used to compute the scatter
+       * matrices
+       */
+      size_t getNThreads () const { return m_n_threads; }
+
+      /**
+       * @brief Sets the number of threads used to compute the scatter
+       * matrices (0 means all hardware threads)
+       */
+      void setNThreads (const size_t n_threads) { m_n_threads = n_threads; }
+
       /**
        * @brief Trains the LinearMachine to perform Fisher/LDA discrimination.
        * The resulting machine will have the eigen-vectors of the
@@ -146,9 +160,35 @@ namespace bob { namespace trainer {
        */
       size_t output_size(const std::vector<blitz::Array<double,2> >& X) const;
 
+      /**
+       * @brief Trains the LinearMachine to perform Fisher/LDA discrimination,
+       * reading the samples of each class block by block from the given
+       * readers (one per class), such that the training set does not need to
+       * fit in memory. Returns the eigen values as the in-memory version.
+       */
+      void train(bob::machine::LinearMachine& machine,
+          blitz::Array<double,1>& eigen_values,
+          std::vector<boost::shared_ptr<bob::trainer::SampleReader> >& X) const;
+
+      /**
+       * @brief Trains the LinearMachine to perform Fisher/LDA discrimination,
+       * reading the samples of each class block by block from the given
+       * readers (one per class).
+       */
+      void train(bob::machine::LinearMachine& machine,
+          std::vector<boost::shared_ptr<bob::trainer::SampleReader> >& X) const;
+
+      /**
+       * @brief Returns the expected size of the output given the readers of
+       * each class (see the in-memory version).
+       */
+      size_t output_size(
+          const std::vector<boost::shared_ptr<bob::trainer::SampleReader> >& X) const;
+
     private:
       bool m_use_pinv; ///< use the 'pinv' method for LDA
       bool m_strip_to_rank; ///< return rank or full matrix
+      size_t m_n_threads; ///< number of threads used for the scatters
   };
 
   /**
@@ -110,6 +110,31 @@ class IVectorTrainer: public bob::trainer::EMTrainer<bob::machine::IVectorMachin
     bool is_similar_to(const IVectorTrainer& b, const double r_epsilon=1e-5,
       const double a_epsilon=1e-8) const;
 
+    /**
+     * @brief Returns the number of threads used by the eStep()
+     */
+    size_t getNThreads() const
+    { return m_n_threads; }
+    /**
+     * @brief Sets the number of threads used by the eStep() (0 means all
+     *   hardware threads)
+     */
+    void setNThreads(const size_t n_threads)
+    { m_n_threads = n_threads; }
+
+    /**
+     * @brief Returns the number of utterances processed at once by the
+     *   eStep()
+     */
+    size_t getBatchSize() const
+    { return m_batch_size; }
+    /**
+     * @brief Sets the number of utterances processed at once by the
+     *   eStep(). Larger batches make a better use of the matrix products,
+     *   at the cost of (batch_size x rt x rt) doubles of working memory.
+     */
+    void setBatchSize(const size_t batch_size);
+
     /**
      * @brief Getters for the accumulators
      */
@@ -142,6 +167,8 @@ class IVectorTrainer: public bob::trainer::EMTrainer<bob::machine::IVectorMachin
   protected:
     // Attributes
     bool m_update_sigma;
+    size_t m_n_threads;
+    size_t m_batch_size;
 
     // Acccumulators
     blitz::Array<double,3> m_acc_Nij_wij2;
@@ -150,14 +177,13 @@ class IVectorTrainer: public bob::trainer::EMTrainer<bob::machine::IVectorMachin
     blitz::Array<double,2> m_acc_Snormij;
 
     // Working arrays
-    mutable blitz::Array<double,1> m_tmp_wij;
-    mutable blitz::Array<double,2> m_tmp_wij2;
     mutable blitz::Array<double,1> m_tmp_d1;
-    mutable blitz::Array<double,1> m_tmp_t1;
     mutable blitz::Array<double,2> m_tmp_dd1;
-    mutable blitz::Array<double,2> m_tmp_dt1;
-    mutable blitz::Array<double,2> m_tmp_tt1;
-    mutable blitz::Array<double,2> m_tmp_tt2;
+    // Batch working arrays of the eStep() (one row per utterance)
+    mutable blitz::Array<double,2> m_tmp_N; ///< N_c (batch_size x C)
+    mutable blitz::Array<double,2> m_tmp_Fnorm; ///< F_c - N_c.m_c (batch_size x CD)
+    mutable blitz::Array<double,2> m_tmp_Ew; ///< E{w} (batch_size x rt)
+    mutable blitz::Array<double,2> m_tmp_Eww; ///< E{w.w^T} (batch_size x rt*rt)
 };
 
 /**
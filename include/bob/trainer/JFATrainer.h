@@ -80,9 +80,28 @@ class FABaseTrainer
     void resetXYZ();
 
 
+    /**
+     * @brief Sets the number of threads used to process the clients and
+     * sessions (0 means all hardware threads)
+     */
+    void setNThreads(const size_t n_threads)
+    { m_n_threads = n_threads; }
+    /**
+     * @brief Gets the number of threads used to process the clients and
+     * sessions
+     */
+    size_t getNThreads() const
+    { return m_n_threads; }
+
+
     /**** Y and V functions ****/
     /**
-     * @brief Computes Vt * diag(sigma)^-1
+     * @brief Computes diag(sigma)^-1 * V, the transpose of
+     * Vt * diag(sigma)^-1
+     */
+    void computeSigmaInvV(const bob::machine::FABase& m);
+    /**
+     * @deprecated Same as computeSigmaInvV()
      */
     void computeVtSigmaInv(const bob::machine::FABase& m);
     /**
@@ -90,25 +109,25 @@ class FABaseTrainer
      */
     void computeVProd(const bob::machine::FABase& m);
     /**
-     * @brief Computes (I+Vt*diag(sigma)^-1*Ni*V)^-1 which occurs in the y 
-     * estimation for the given person
+     * @deprecated Computes (I+Vt*diag(sigma)^-1*Ni*V)^-1 which occurs in the
+     * y estimation for the given person. updateY() processes all the people
+     * at once.
      */
     void computeIdPlusVProd_i(const size_t id);
     /**
-     * @brief Computes sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - U*x_{i,h}) 
+     * @deprecated Computes sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - U*x_{i,h})
      * which occurs in the y estimation of the given person
      */
     void computeFn_y_i(const bob::machine::FABase& m,
       const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats,
       const size_t id);
     /**
-     * @brief Updates y_i (of the current person) and the accumulators to
-     * compute V with the cache values m_cache_IdPlusVprod_i, m_VtSigmaInv and
-     * m_cache_Fn_y_i
+     * @deprecated Updates y_i (of the current person) with the cache values
+     * m_cache_IdPlusVProd_i, m_cache_SigmaInvV and m_cache_Fn_y_i
      */
     void updateY_i(const size_t id);
     /**
-     * @brief Updates y and the accumulators to compute V 
+     * @brief Updates y
      */
     void updateY(const bob::machine::FABase& m,
       const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats);
@@ -126,7 +145,12 @@ class FABaseTrainer
 
     /**** X and U functions ****/
     /**
-     * @brief Computes Ut * diag(sigma)^-1
+     * @brief Computes diag(sigma)^-1 * U, the transpose of
+     * Ut * diag(sigma)^-1
+     */
+    void computeSigmaInvU(const bob::machine::FABase& m);
+    /**
+     * @deprecated Same as computeSigmaInvU()
      */
     void computeUtSigmaInv(const bob::machine::FABase& m);
     /**
@@ -134,20 +158,19 @@ class FABaseTrainer
      */
     void computeUProd(const bob::machine::FABase& m);
     /**
-     * @brief Computes (I+Ut*diag(sigma)^-1*Ni*U)^-1 which occurs in the x 
-     * estimation
+     * @deprecated Computes (I+Ut*diag(sigma)^-1*Ni*U)^-1 which occurs in the
+     * x estimation. updateX() processes all the sessions at once.
      */
     void computeIdPlusUProd_ih(const boost::shared_ptr<bob::machine::GMMStats>& stats);
     /**
-     * @brief Computes sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - U*x_{i,h})
-     * which occurs in the y estimation of the given person
+     * @deprecated Computes N_{i,h}*(o_{i,h} - m - D*z_{i} - V*y_{i}) which
+     * occurs in the x estimation of the given person/session
      */
-    void computeFn_x_ih(const bob::machine::FABase& m, 
+    void computeFn_x_ih(const bob::machine::FABase& m,
       const boost::shared_ptr<bob::machine::GMMStats>& stats, const size_t id);
     /**
-     * @brief Updates x_ih (of the current person/session) and the 
-     * accumulators to compute U with the cache values m_cache_IdPlusVprod_i, 
-     * m_VtSigmaInv and m_cache_Fn_y_i
+     * @deprecated Updates x_ih (of the current person/session) with the cache
+     * values m_cache_IdPlusUProd_ih, m_cache_SigmaInvU and m_cache_Fn_x_ih
      */
     void updateX_ih(const size_t id, const size_t h);
     /**
@@ -177,24 +200,25 @@ class FABaseTrainer
      */
     void computeDProd(const bob::machine::FABase& m);
     /**
-     * @brief Computes (I+diag(d)t*diag(sigma)^-1*Ni*diag(d))^-1 which occurs
-     * in the z estimation for the given person
+     * @deprecated Computes (I+diag(d)t*diag(sigma)^-1*Ni*diag(d))^-1 which
+     * occurs in the z estimation for the given person. updateZ() processes
+     * all the people at once.
      */
     void computeIdPlusDProd_i(const size_t id);
     /**
-     * @brief Computes sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i} - U*x_{i,h})
-     * which occurs in the y estimation of the given person
+     * @deprecated Computes sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i} - U*x_{i,h})
+     * which occurs in the z estimation of the given person
      */
     void computeFn_z_i(const bob::machine::FABase& m,
-      const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats, const size_t id);
+      const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats,
+      const size_t id);
     /**
-     * @brief Updates z_i (of the current person) and the accumulators to 
-     * compute D with the cache values m_cache_IdPlusDProd_i, m_VtSigmaInv
-     * and m_cache_Fn_z_i
+     * @deprecated Updates z_i (of the current person) with the cache values
+     * m_cache_IdPlusDProd_i, m_cache_DtSigmaInv and m_cache_Fn_z_i
      */
     void updateZ_i(const size_t id);
     /**
-     * @brief Updates z and the accumulators to compute D
+     * @brief Updates z
      */
     void updateZ(const bob::machine::FABase& m,
       const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats);
@@ -297,11 +321,28 @@ class FABaseTrainer
 
 
   private:
+    /**
+     * @brief Estimates the latent variables y (one item per client) or x
+     * (one item per session) by batches of items, or computes the
+     * accumulators for V or U from their current values.
+     *
+     * The normalised first order statistics of the items are computed by
+     * the worker threads, each of them using its own working arrays. The
+     * matrices (I + sum_c N_c Xt_c.diag(sigma)^-1.X_c) of a batch and the
+     * projections Xt.diag(sigma)^-1.Fn are obtained with matrix products,
+     * and the per-item linear systems are then solved in parallel. The
+     * accumulators are reduced with matrix products over each batch.
+     */
+    void processXY(const bob::machine::FABase& m,
+      const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats,
+      const bool is_x, const bool accumulate);
+
     size_t m_Nid; // Number of identities 
     size_t m_dim_C; // Number of Gaussian components of the UBM GMM
     size_t m_dim_D; // Dimensionality of the feature space
     size_t m_dim_ru; // Rank of the U subspace
     size_t m_dim_rv; // Rank of the V subspace
+    size_t m_n_threads; // Number of threads
 
     std::vector<blitz::Array<double,2> > m_x; // matrix x of speaker factors for eigenchannels U, for each client
     std::vector<blitz::Array<double,1> > m_y; // vector y of spealer factors for eigenvoices V, for each client
@@ -319,30 +360,24 @@ class FABaseTrainer
     blitz::Array<double,1> m_acc_D_A2;
 
     // Cache/Precomputation
-    blitz::Array<double,2> m_cache_VtSigmaInv; // Vt * diag(sigma)^-1
+    blitz::Array<double,2> m_cache_SigmaInvV; // diag(sigma)^-1 * V (CD x rv)
     blitz::Array<double,3> m_cache_VProd; // first dimension is the Gaussian id
-    blitz::Array<double,2> m_cache_IdPlusVProd_i;
+    blitz::Array<double,2> m_cache_IdPlusVProd_i; // for the deprecated per-person updates
     blitz::Array<double,1> m_cache_Fn_y_i;
 
-    blitz::Array<double,2> m_cache_UtSigmaInv; // Ut * diag(sigma)^-1
+    blitz::Array<double,2> m_cache_SigmaInvU; // diag(sigma)^-1 * U (CD x ru)
     blitz::Array<double,3> m_cache_UProd; // first dimension is the Gaussian id
-    blitz::Array<double,2> m_cache_IdPlusUProd_ih;
+    blitz::Array<double,2> m_cache_IdPlusUProd_ih; // for the deprecated per-session updates
     blitz::Array<double,1> m_cache_Fn_x_ih;
 
     blitz::Array<double,1> m_cache_DtSigmaInv; // Dt * diag(sigma)^-1
     blitz::Array<double,1> m_cache_DProd; // supervector length dimension
-    blitz::Array<double,1> m_cache_IdPlusDProd_i;
+    blitz::Array<double,1> m_cache_IdPlusDProd_i; // for the deprecated per-person updates
     blitz::Array<double,1> m_cache_Fn_z_i;
 
     // Working arrays
     mutable blitz::Array<double,2> m_tmp_ruru;
-    mutable blitz::Array<double,2> m_tmp_ruD;
     mutable blitz::Array<double,2> m_tmp_rvrv;
-    mutable blitz::Array<double,2> m_tmp_rvD;
-    mutable blitz::Array<double,1> m_tmp_rv;
-    mutable blitz::Array<double,1> m_tmp_ru;
-    mutable blitz::Array<double,1> m_tmp_CD;
-    mutable blitz::Array<double,1> m_tmp_CD_b;
 };
 
 
@@ -482,6 +517,19 @@ class JFATrainer
     const boost::shared_ptr<boost::mt19937> getRng() const
     { return m_rng; }
 
+    /**
+     * @brief Sets the number of threads used to process the clients and
+     * sessions (0 means all hardware threads)
+     */
+    void setNThreads(const size_t n_threads)
+    { m_base_trainer.setNThreads(n_threads); }
+    /**
+     * @brief Gets the number of threads used to process the clients and
+     * sessions
+     */
+    size_t getNThreads() const
+    { return m_base_trainer.getNThreads(); }
+
     /**
      * @brief Get the x speaker factors
      */
@@ -632,6 +680,19 @@ class ISVTrainer: public EMTrainer<bob::machine::ISVBase, std::vector<std::vecto
       const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& features,
       const size_t n_iter);
 
+    /**
+     * @brief Sets the number of threads used to process the clients and
+     * sessions (0 means all hardware threads)
+     */
+    void setNThreads(const size_t n_threads)
+    { m_base_trainer.setNThreads(n_threads); }
+    /**
+     * @brief Gets the number of threads used to process the clients and
+     * sessions
+     */
+    size_t getNThreads() const
+    { return m_base_trainer.getNThreads(); }
+
     /**
      * @brief Get the x speaker factors
      */
@@ -15,7 +15,10 @@
 #define BOB_TRAINER_PCA_TRAINER_H
 
 #include <blitz/array.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/random.hpp>
 #include <bob/machine/LinearMachine.h>
+#include <bob/trainer/SampleReader.h>
 
 namespace bob { namespace trainer {
 
@@ -35,6 +38,9 @@ namespace bob { namespace trainer {
    *    Pages: 71-86
    * 2. http://en.wikipedia.org/wiki/Singular_value_decomposition
    * 3. http://en.wikipedia.org/wiki/Principal_component_analysis
+   * 4. Finding Structure with Randomness: Probabilistic Algorithms for
+   *    Constructing Approximate Matrix Decompositions, Halko, Martinsson &
+   *    Tropp, SIAM Review (2011) Volume: 53, Issue: 2, Pages: 217-288
    */
   class PCATrainer {
 
@@ -104,6 +110,74 @@ namespace bob { namespace trainer {
        */
       void setSafeSVD (bool value) { m_safe_svd = value; }
 
+      /**
+       * @brief Gets the number of threads used to compute the covariance
+       * matrix (Covariance method)
+       */
+      size_t getNThreads () const { return m_n_threads; }
+
+      /**
+       * @brief Sets the number of threads used to compute the covariance
+       * matrix (0 means all hardware threads)
+       */
+      void setNThreads (const size_t n_threads) { m_n_threads = n_threads; }
+
+      /**
+       * @brief Gets the number of principal components to compute. 0 (the
+       * default) means all of them.
+       */
+      size_t getRank () const { return m_rank; }
+
+      /**
+       * @brief Sets the number of principal components to compute. If
+       * non-zero, the in-memory training computes a truncated decomposition
+       * with a randomized range finder (see reference 4) instead of the SVD
+       * or Covariance method, which is much cheaper when only a few
+       * components out of many are required. 0 means all components.
+       */
+      void setRank (const size_t rank) { m_rank = rank; }
+
+      /**
+       * @brief Gets the number of additional random directions used by the
+       * randomized range finder
+       */
+      size_t getOversampling () const { return m_oversampling; }
+
+      /**
+       * @brief Sets the number of additional random directions used by the
+       * randomized range finder
+       */
+      void setOversampling (const size_t oversampling)
+      { m_oversampling = oversampling; }
+
+      /**
+       * @brief Gets the number of power iterations of the randomized range
+       * finder
+       */
+      size_t getPowerIterations () const { return m_power_iterations; }
+
+      /**
+       * @brief Sets the number of power iterations of the randomized range
+       * finder. Each iteration improves the accuracy when the spectrum of the
+       * data decays slowly, at the cost of two passes over the data.
+       */
+      void setPowerIterations (const size_t power_iterations)
+      { m_power_iterations = power_iterations; }
+
+      /**
+       * @brief Gets the random number generator used by the randomized range
+       * finder
+       */
+      const boost::shared_ptr<boost::mt19937> getRng () const
+      { return m_rng; }
+
+      /**
+       * @brief Sets the random number generator used by the randomized range
+       * finder
+       */
+      void setRng (const boost::shared_ptr<boost::mt19937> rng)
+      { m_rng = rng; }
+
       /**
        * @brief Similar to
        */
@@ -129,6 +203,19 @@ namespace bob { namespace trainer {
           blitz::Array<double,1>& eigen_values,
           const blitz::Array<double,2>& X) const;
 
+      /**
+       * @brief Trains the LinearMachine to perform the KLT, reading the
+       * training samples block by block from the given reader, such that
+       * the training set does not need to fit in memory. The mean and the
+       * covariance matrix are accumulated incrementally, and the eigen
+       * vectors are computed with the Covariance method, whatever the
+       * setting of the SVD flag. The machine and the eigen values must have
+       * the size returned by output_size(n_samples, n_features).
+       */
+      virtual void train(bob::machine::LinearMachine& machine,
+          blitz::Array<double,1>& eigen_values,
+          bob::trainer::SampleReader& reader) const;
+
       /**
        * @brief Calculates the maximum possible rank for the covariance matrix
        * of X, given X.
@@ -136,14 +223,28 @@ namespace bob { namespace trainer {
        * This determines what is the maximum number of non-zero eigen values
        * that can be generated by this trainer. It should be used to setup
        * Machines and input vectors prior to feeding them into this trainer.
+       * If a rank is set, the result is limited to this rank.
        */
       size_t output_size(const blitz::Array<double,2>& X) const;
 
+      /**
+       * @brief Calculates the maximum possible rank for the covariance matrix
+       * of a set of n_samples samples of dimension n_features.
+       */
+      size_t output_size(const size_t n_samples, const size_t n_features) const;
+
     private: //representation
 
       bool m_use_svd; ///< if this trainer should be using SVD or Covariance
       bool m_safe_svd; ///< if svd is set, tells which LAPACK function to use
                        ///  among dgesdd (false) and dgesvd (true)
+      size_t m_n_threads; ///< number of threads used to compute the
+                          ///  covariance matrix
+      size_t m_rank; ///< number of components to compute (0 means all)
+      size_t m_oversampling; ///< additional directions of the range finder
+      size_t m_power_iterations; ///< power iterations of the range finder
+      boost::shared_ptr<boost::mt19937> m_rng; ///< random generator of the
+                                               ///  range finder
 
   };
 
@@ -0,0 +1,165 @@
+/**
+ * @file bob/trainer/SampleReader.h
+ * @date Sun Oct 18 17:48:20 2026 +0200
+ *
+ * @brief Sources of training samples that are read block by block, which
+ * allows trainers to process data sets that do not fit in memory.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_TRAINER_SAMPLE_READER_H
+#define BOB_TRAINER_SAMPLE_READER_H
+
+#include <string>
+#include <blitz/array.h>
+#include <boost/function.hpp>
+#include <bob/io/HDF5File.h>
+#include <bob/math/stats.h>
+
+namespace bob { namespace trainer {
+/**
+ * @ingroup TRAINER
+ * @{
+ */
+
+/**
+ * @brief Base class of the sources of training samples that are read by
+ * blocks of rows (one sample per row).
+ */
+class SampleReader
+{
+  public:
+    /**
+     * @brief Constructor
+     * @param n_features The dimensionality of the samples
+     * @param block_size The maximum number of samples read at once
+     */
+    SampleReader(const size_t n_features, const size_t block_size);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~SampleReader();
+
+    /**
+     * @brief Returns the dimensionality of the samples
+     */
+    size_t getNFeatures() const
+    { return m_n_features; }
+
+    /**
+     * @brief Returns the maximum number of samples read at once
+     */
+    size_t getBlockSize() const
+    { return m_block_size; }
+
+    /**
+     * @brief Restarts reading from the first sample
+     */
+    virtual void reset() = 0;
+
+    /**
+     * @brief Reads the next samples into the first rows of the given block
+     * (of size block_size x n_features), and returns the number of samples
+     * that were read. 0 means that all the samples have been read.
+     */
+    virtual size_t read(blitz::Array<double,2>& block) = 0;
+
+  private:
+    size_t m_n_features;
+    size_t m_block_size;
+};
+
+/**
+ * @brief Reads the samples stored in a 2D dataset of an HDF5 file (one
+ * sample per row), or appended one by one as 1D arrays to a dataset.
+ * The file must remain open while the reader is in use.
+ */
+class HDF5SampleReader: public SampleReader
+{
+  public:
+    /**
+     * @brief Constructor
+     * @param file The HDF5 file
+     * @param path The path of the dataset in the file
+     * @param block_size The maximum number of samples read at once
+     */
+    HDF5SampleReader(bob::io::HDF5File& file, const std::string& path,
+      const size_t block_size=4096);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~HDF5SampleReader();
+
+    /**
+     * @brief Returns the total number of samples of the dataset
+     */
+    size_t getNSamples() const
+    { return m_n_samples; }
+
+    virtual void reset();
+    virtual size_t read(blitz::Array<double,2>& block);
+
+  private:
+    bob::io::HDF5File& m_file;
+    std::string m_path;
+    size_t m_n_samples;
+    size_t m_next;
+};
+
+/**
+ * @brief Gets the samples from user-provided functions.
+ */
+class CallbackSampleReader: public SampleReader
+{
+  public:
+    /**
+     * @brief Function that fills the first rows of the given block, and
+     * returns the number of rows that were filled (0 at the end of the
+     * data)
+     */
+    typedef boost::function<size_t (blitz::Array<double,2>&)> read_callback;
+    /**
+     * @brief Function that restarts reading from the first sample
+     */
+    typedef boost::function<void ()> reset_callback;
+
+    /**
+     * @brief Constructor
+     * @param n_features The dimensionality of the samples
+     * @param read The function that reads the next samples
+     * @param reset The function that restarts reading from the first sample
+     * @param block_size The maximum number of samples read at once
+     */
+    CallbackSampleReader(const size_t n_features, const read_callback& read,
+      const reset_callback& reset, const size_t block_size=4096);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~CallbackSampleReader();
+
+    virtual void reset();
+    virtual size_t read(blitz::Array<double,2>& block);
+
+  private:
+    read_callback m_read;
+    reset_callback m_reset;
+};
+
+/**
+ * @brief Reads all the samples of the given reader (from the first one),
+ * and accumulates their mean and scatter matrix. At most one block of
+ * samples is held in memory at any time.
+ */
+void accumulateScatter(SampleReader& reader,
+  bob::math::ScatterAccumulator& accumulator);
+
+/**
+ * @}
+ */
+}}
+
+#endif /* BOB_TRAINER_SAMPLE_READER_H */
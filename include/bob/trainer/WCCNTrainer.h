@@ -73,6 +73,18 @@ class WCCNTrainer: public Trainer<bob::machine::LinearMachine, std::vector<blitz
     bool is_similar_to(const WCCNTrainer& other, const double r_epsilon=1e-5,
       const double a_epsilon=1e-8) const;
 
+    /**
+     * @brief Gets the number of threads used to compute the scatter matrices
+     */
+    size_t getNThreads() const
+    { return m_n_threads; }
+    /**
+     * @brief Sets the number of threads used to compute the scatter matrices
+     *   (0 means all hardware threads)
+     */
+    void setNThreads(const size_t n_threads)
+    { m_n_threads = n_threads; }
+
     /**
      * @brief Trains the LinearMachine to perform the WCCN
      */
@@ -80,6 +92,7 @@ class WCCNTrainer: public Trainer<bob::machine::LinearMachine, std::vector<blitz
         const std::vector<blitz::Array<double, 2> >& data);
 
   private: //representation
+    size_t m_n_threads; ///< number of threads used for the scatter matrices
 };
 
 /**
@@ -11,6 +11,7 @@
 
 #include "Trainer.h"
 #include <bob/machine/LinearMachine.h>
+#include <bob/trainer/SampleReader.h>
 #include <blitz/array.h>
 
 namespace bob { namespace trainer {
@@ -68,13 +69,34 @@ class WhiteningTrainer: public Trainer<bob::machine::LinearMachine, blitz::Array
     bool is_similar_to(const WhiteningTrainer& other, const double r_epsilon=1e-5,
       const double a_epsilon=1e-8) const;
 
+    /**
+     * @brief Gets the number of threads used to compute the covariance matrix
+     */
+    size_t getNThreads() const
+    { return m_n_threads; }
+    /**
+     * @brief Sets the number of threads used to compute the covariance matrix
+     *   (0 means all hardware threads)
+     */
+    void setNThreads(const size_t n_threads)
+    { m_n_threads = n_threads; }
+
     /**
      * @brief Trains the LinearMachine to perform the Whitening
      */
     virtual void train(bob::machine::LinearMachine& machine, 
         const blitz::Array<double,2>& data);
 
+    /**
+     * @brief Trains the LinearMachine to perform the Whitening, reading the
+     * training samples block by block from the given reader, such that the
+     * training set does not need to fit in memory
+     */
+    void train(bob::machine::LinearMachine& machine,
+        bob::trainer::SampleReader& reader);
+
   private: //representation
+    size_t m_n_threads; ///< number of threads used for the covariance matrix
 };
 
 /**
@@ -35,14 +35,21 @@ namespace bob { namespace visioner {
       bool decode(	const boost::program_options::options_description& po_desc,
           boost::program_options::variables_map& po_vm);
 
+      // Clone the classifier with its own copy of the model
+      //  (e.g. to process images in parallel)
+      boost::shared_ptr<CVClassifier> clone() const;
+
       // Predict the object label of the keypoints in the <reg> region.
       bool classify(	const CVDetector& detector, const QRectF& reg, uint64_t& dt_label) const;
 
       // Compute the confusion matrix considering the 
       //      ground truth and the predicted labels.
+      // NB: The images are processed by <threads> worker threads (or in the
+      //  current thread if 0), the result does not depend on this number.
       void evaluate(  const std::vector<std::string>& ifiles, const std::vector<std::string>& gfiles,
           CVDetector& detector, 
-          Matrix<uint64_t>& hits_mat, std::vector<uint64_t>& hits_cnt) const;
+          Matrix<uint64_t>& hits_mat, std::vector<uint64_t>& hits_cnt,
+          size_t threads = boost::thread::hardware_concurrency()) const;
 
       // Retrieve the ground truth label for the given object
       bool classify(  const Object& object, uint64_t& gt_label) const;
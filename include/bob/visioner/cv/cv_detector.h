@@ -13,6 +13,8 @@
 #ifndef BOB_VISIONER_CV_DETECTOR_H
 #define BOB_VISIONER_CV_DETECTOR_H
 
+#include <boost/thread.hpp>
+
 #include "bob/visioner/model/model.h"
 #include "bob/visioner/util/geom.h"
 
@@ -26,9 +28,13 @@ namespace bob { namespace visioner {
     return std::make_pair(score, std::make_pair(reg, ilabel));
   }
 
+  // Tests the private methods of the CVDetector
+  class TestCVDetector;
+
   /////////////////////////////////////////////////////////////////////////////////////////
   // Object detector that processes a pyramid of images:
   //	::scan()	-> return the object detections (thresholded & clustered)
+  //	::track()	-> same on video frames, reusing the previous detections
   //	::label()	-> label detections as TP/FA
   //	::evaluate()	-> computes TPs/FAs ROC curve
   //
@@ -44,18 +50,31 @@ namespace bob { namespace visioner {
       {
         // Constructor
         stats_t()
-          :       m_gts(0), m_sws(0), m_evals(0), m_timing(0.0)
+          :       m_gts(0), m_sws(0), m_evals(0), m_timing(0.0),
+                  m_frames(0), m_frame_timing(0.0)
         {                                
         }
 
         // Display the statistics
         void show() const;
 
+        // Accumulate the statistics of another detector
+        void add(const stats_t& other)
+        {
+          m_gts += other.m_gts;
+          m_sws += other.m_sws;
+          m_evals += other.m_evals;
+          m_timing += other.m_timing;
+          m_frames += other.m_frames;
+        }
+
         // Attributes
         uint64_t         m_gts;          // #ground truth objects
         uint64_t         m_sws;          // #SWs processed (in total)
         uint64_t         m_evals;        // #LUT evaluations (in total)
         double        m_timing;       // total 
+        uint64_t         m_frames;       // #video frames processed by ::track()
+        double        m_frame_timing; // duration of the last video frame
       };
 
       enum Type
@@ -78,6 +97,10 @@ namespace bob { namespace visioner {
           uint64_t levels=0, uint64_t scale_variation=2, double clustering=0.05,
           Type detection_method=GroundTruth);
 
+      // Clone the detector with its own copy of the model and an empty
+      //  image pyramid (e.g. to process images in parallel)
+      boost::shared_ptr<CVDetector> clone() const;
+
       // Load an image (build the image pyramid)
       bool load(const std::string& ifile, const std::string& gfile);
       bool load(const ipscale_t& ipscale);
@@ -87,6 +110,16 @@ namespace bob { namespace visioner {
       // NB: The detections are thresholded and clustered!
       bool scan(std::vector<detection_t>& detections) const;
 
+      // Detect objects in the next frame of a video (thresholded & clustered):
+      //	the frame is scanned densely every <m_track_period> frames and
+      //	otherwise only around the detections of the previous frame
+      //	(within <m_track_margin> of their size and <m_track_scales> scales).
+      bool track(const uint8_t* image, uint64_t rows, uint64_t cols,
+          std::vector<detection_t>& detections);
+
+      // Restart the tracking (e.g. for a new video)
+      void reset_tracking();
+
       // Label detections
       bool label(const detection_t& detection) const;
       void label(const std::vector<detection_t>& detections, std::vector<int>& labels) const;
@@ -99,8 +132,15 @@ namespace bob { namespace visioner {
       void prune(std::vector<detection_t>& detections) const;
 
       // Compute the ROC - the number of true positives and false alarms
+      //	for <n_thress> threshold values evenly spaced between the minimum and
+      //	the maximum detection score, or for all distinct scores (the full
+      //	curve) if <n_thress> is 0.
+      // NB: The images are processed by <threads> worker threads (or in the
+      //  current thread if 0), the result does not depend on this number.
       void evaluate(const std::vector<std::string>& ifiles, const std::vector<std::string>& gfiles,
-          std::vector<double>& fas, std::vector<double>& tars);
+          std::vector<double>& fas, std::vector<double>& tars,
+          size_t threads = boost::thread::hardware_concurrency(),
+          uint64_t n_thress = 256);
 
       // Check the validity of different components
       bool valid() const;
@@ -127,6 +167,11 @@ namespace bob { namespace visioner {
       static void sort_asc(std::vector<detection_t>& detections);
       static void sort_desc(std::vector<detection_t>& detections);
 
+      // Cluster the detections of each output (greedy non-maximum suppression):
+      //	the detections are sorted by decreasing score and a detection is removed
+      //	if it overlaps by at least <thres> a higher scoring detection that was kept.
+      static void cluster(std::vector<detection_t>& detections, double thres, uint64_t n_outputs);
+
       // Save the model back to file
       void save(const std::string& filename) const;
 
@@ -151,13 +196,28 @@ namespace bob { namespace visioner {
     private:
 
       static void threshold(std::vector<detection_t>& detections, double thres);
-      static void cluster(std::vector<detection_t>& detections, double thres, uint64_t n_outputs);                 
 
-      // Compute the ROC - the number of true positives and false alarms
-      //	for the <min_score + t * delta_score, t < n_thress> threshold values.
+      // Score the sub-window at (x, y) of the current (preprocessed) scale
+      double score(uint64_t output, int x, int y) const;
+
+      // Scan the sub-windows around the <seeds> detections
+      void scan(const std::vector<detection_t>& seeds, std::vector<detection_t>& detections) const;
+
+      // Compute the ROC - the changes of the number of true positives and false
+      //	alarms for the (increasing) <thress> threshold values, accumulated in
+      //	<d_tps> and <d_fas> (the counts are their cumulated sums).
+      // NB: The <detections> are sorted by increasing score.
       static void roc(const Matrix<int>& labels, const std::vector<detection_t>& detections,
-          double min_score, uint64_t n_thress, double delta_score,
-          std::vector<uint64_t>& n_tps, std::vector<uint64_t>& n_fas);
+          const std::vector<double>& thress,
+          std::vector<int64_t>& d_tps, std::vector<int64_t>& d_fas);
+
+      // Choose the threshold values of the ROC: either <n_thress> values evenly
+      //	spaced between the minimum and the maximum score of the <idetections>
+      //	(sorted by increasing score), or (if 0) all their distinct scores.
+      static void roc_thresholds(const std::vector<std::vector<detection_t> >& idetections,
+          uint64_t n_thress, std::vector<double>& thress);
+
+      friend class TestCVDetector;
 
     public: //attributes
 
@@ -165,6 +225,9 @@ namespace bob { namespace visioner {
       double m_cluster;	  ///< NMS threshold
       double m_threshold;	///< Detection threshold
       Type     m_type;      ///< Mode: scanning vs. GT
+      uint64_t m_track_period; ///< Video: dense scanning every N frames
+      double m_track_margin;   ///< Video: search margin (relative to the detection size)
+      uint64_t m_track_scales; ///< Video: search band (in scales)
 
     private: //attributes
 
@@ -174,6 +237,8 @@ namespace bob { namespace visioner {
       uint64_t			m_levels;	       ///< number of levels (speed-up scanning)
       ipyramid_t  m_ipyramid;	     ///< Pyramid of images
       mutable stats_t m_stats;     ///< Scanning statistics
+      uint64_t m_track_frame;      ///< Video: index of the next frame
+      std::vector<detection_t> m_track_detections; ///< Video: detections of the previous frame
 
   };
 
@@ -47,15 +47,31 @@ namespace bob { namespace visioner {
        */
       CVLocalizer(const std::string& model, Type method=MultipleShots_Median);
 
+      // Clone the localizer with its own copy of the model
+      //  (e.g. to process images in parallel)
+      boost::shared_ptr<CVLocalizer> clone() const;
+
       // Predict the location of the keypoints in the <reg> region.
       bool locate(const CVDetector& detector,
           const QRectF& reg, std::vector<QPointF>& points) const;
 
+      // Predict the location of the keypoints for all the <detections> in the
+      //  image pyramid of the <detector> at once: the keypoints of the i-th
+      //  detection are stored in <points[i]>, which is left empty if it cannot
+      //  be localized. Returns the number of localized detections.
+      // NB: The sub-windows are processed by <m_threads> worker threads (or in
+      //  the current thread if 0), the result does not depend on this number.
+      uint64_t locate(const CVDetector& detector,
+          const std::vector<detection_t>& detections,
+          std::vector<std::vector<QPointF> >& points) const;
+
       // Compute the normalized distances [0.0 - 1.0] between
       //	each ground truth keypoints and its predicted points.
+      // NB: The images are processed by <threads> worker threads (or in the
+      //  current thread if 0), the result does not depend on this number.
       void evaluate(const std::vector<std::string>& ifiles, const std::vector<std::string>& gfiles,
           CVDetector& detector, std::vector<Histogram>& histos, Histogram&
-          histo) const;
+          histo, size_t threads = boost::thread::hardware_concurrency()) const;
 
       // Compute the normalized distances [0.0 - 1.0] between
       //	each ground truth keypoints and its predicted points.
@@ -98,10 +114,22 @@ namespace bob { namespace visioner {
           const Object& gt_object, const std::vector<QPointF>& dt_points,
           std::vector<Histogram>& histos, Histogram& histo) const;
 
-      // Collect predictions from the neighbourhood of <seed_sw>
-      void locate(const CVDetector& detector, const subwindow_t& seed_sw, 
-          int n_ds, int n_dx, int dx, int n_dy, int dy,
-          std::vector<std::vector<QPointF> >& preds) const;
+      // Sub-window to evaluate for a given region: (region index, sub-window)
+      typedef std::pair<uint64_t, subwindow_t> sw_task_t;
+
+      // Collect the sub-windows to evaluate for the <r>-th region <reg>
+      //	(in the neighbourhood of its sub-window, for each scale)
+      bool neighbours(const CVDetector& detector, uint64_t r, const QRectF& reg,
+          std::vector<std::vector<sw_task_t> >& stasks) const;
+
+      // Predict the keypoints for the <chunk>-th range of sub-windows
+      //	(all at the same scale) using the <ith> worker model
+      void locate_chunk(uint64_t ith, uint64_t chunk, const CVDetector& detector,
+          const std::vector<sw_task_t>& tasks,
+          const std::vector<std::pair<uint64_t, uint64_t> >& chunks,
+          const std::vector<boost::shared_ptr<Model> >& wmodels,
+          std::vector<const ipscale_t*>& wscales,
+          std::vector<QPointF>& preds) const;
 
       // Average the collection of predictions
       void avg(const std::vector<std::vector<QPointF> >& preds, std::vector<QPointF>& pred) const;
@@ -119,6 +147,7 @@ namespace bob { namespace visioner {
       // Attributes
       boost::shared_ptr<Model>                m_model;	// Keypoint localizers
       Type			m_type;
+      size_t                                  m_threads;	// Worker threads (0: current thread)
   };
 
 }}
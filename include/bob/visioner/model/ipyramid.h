@@ -108,6 +108,9 @@ namespace bob { namespace visioner {
 
     private:
 
+      // Build the scaled versions of the original image (already stored at the top of the pyramid)
+      void build(const std::vector<double>& scales);
+
       // Project a sub-window to another scale
       subwindow_t map(const subwindow_t& sw, int s, const param_t& param) const;
 
@@ -117,6 +120,7 @@ namespace bob { namespace visioner {
     private: // representation
 
       std::vector<ipscale_t>  m_ipscales; // Images at different scales        
+      Matrix<float>           m_buffer;   // Temporary buffer to resample the images
   };
 
 }}
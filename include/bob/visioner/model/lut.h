@@ -15,6 +15,7 @@
 
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include "bob/visioner/model/ml.h"
 
@@ -72,6 +73,110 @@ namespace bob { namespace visioner {
       std::vector<double> m_entries;
   };
 
+  /**
+   * Read-only contiguous storage of the LUTs of a multivariate model:
+   *	the LUTs of the output <o> are in the [begin(o), end(o)) range,
+   *	the LUT <r> uses the feature features()[r] and its entries are stored at
+   *	entries()[r * n_fvalues() + fv].
+   * NB: The storage is shared between copies (e.g. the memory-mapped model file).
+   */
+  class LUTTable {
+
+    public:
+
+      // Constructor
+      LUTTable()
+        :	m_n_outputs(0), m_n_fvalues(0), m_begins(0), m_features(0), m_entries(0)
+      {
+      }
+
+      // Copy the std::vector<LUT>
+      explicit LUTTable(const std::vector<std::vector<LUT> >& mluts)
+        :	m_n_outputs(mluts.size()), m_n_fvalues(0)
+      {
+        boost::shared_ptr<storage_t> storage(new storage_t);
+        std::vector<uint64_t>& indices = storage->m_indices;
+        std::vector<double>& entries = storage->m_entries;
+
+        indices.push_back(0);
+        for (uint64_t o = 0; o < mluts.size(); o ++)
+        {
+          indices.push_back(indices.back() + mluts[o].size());
+          for (uint64_t r = 0; r < mluts[o].size(); r ++)
+          {
+            m_n_fvalues = std::max(m_n_fvalues, mluts[o][r].n_fvalues());
+          }
+        }
+
+        entries.resize(indices.back() * m_n_fvalues, 0.0);
+        for (uint64_t o = 0, i = 0; o < mluts.size(); o ++)
+        {
+          for (uint64_t r = 0; r < mluts[o].size(); r ++, i ++)
+          {
+            const LUT& lut = mluts[o][r];
+            indices.push_back(lut.feature());
+            std::copy(lut.begin(), lut.end(), entries.begin() + i * m_n_fvalues);
+          }
+        }
+
+        m_begins = &indices[0];
+        m_features = m_begins + m_n_outputs + 1;
+        m_entries = entries.empty() ? 0 : &entries[0];
+        m_storage = storage;
+      }
+
+      // Use external storage (e.g. a memory-mapped file), kept alive by <storage>
+      LUTTable(const boost::shared_ptr<const void>& storage, 
+          uint64_t n_outputs, uint64_t n_fvalues,
+          const uint64_t* begins, const uint64_t* features, const double* entries)
+        :	m_storage(storage), m_n_outputs(n_outputs), m_n_fvalues(n_fvalues),
+        m_begins(begins), m_features(features), m_entries(entries)
+      {
+      }
+
+      // Copy back to std::vector<LUT>
+      void get(std::vector<std::vector<LUT> >& mluts) const
+      {
+        mluts.resize(m_n_outputs);
+        for (uint64_t o = 0; o < m_n_outputs; o ++)
+        {
+          mluts[o].clear();
+          for (uint64_t r = begin(o); r < end(o); r ++)
+          {
+            LUT lut(m_features[r], m_n_fvalues);
+            std::copy(m_entries + r * m_n_fvalues, m_entries + (r + 1) * m_n_fvalues, lut.begin());
+            mluts[o].push_back(lut);
+          }
+        }
+      }
+
+      // Access functions
+      uint64_t n_outputs() const { return m_n_outputs; }
+      uint64_t n_fvalues() const { return m_n_fvalues; }
+      uint64_t n_luts() const { return m_n_outputs > 0 ? m_begins[m_n_outputs] : 0; }
+      uint64_t n_luts(uint64_t o) const { return end(o) - begin(o); }
+      uint64_t begin(uint64_t o) const { return m_begins[o]; }
+      uint64_t end(uint64_t o) const { return m_begins[o + 1]; }
+      const uint64_t* begins() const { return m_begins; }
+      const uint64_t* features() const { return m_features; }
+      const double* entries() const { return m_entries; }
+
+    private: // representation
+
+      struct storage_t 
+      {
+        std::vector<uint64_t>   m_indices;      // LUT ranges per output + features
+        std::vector<double>     m_entries;      // LUT entries
+      };
+
+      boost::shared_ptr<const void>   m_storage;      // Keeps the storage alive
+      uint64_t                        m_n_outputs;
+      uint64_t                        m_n_fvalues;
+      const uint64_t*                 m_begins;       // [n_outputs + 1]
+      const uint64_t*                 m_features;     // [n_luts]
+      const double*                   m_entries;      // [n_luts x n_fvalues]
+  };
+
 }}
 
 #endif // BOB_VISIONER_LUT_H
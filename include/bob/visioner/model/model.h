@@ -52,6 +52,8 @@ namespace bob { namespace visioner {
       virtual bool project() = 0;
 
       // Save/load to/from file
+      //	NB: The '.vflat' files use a flat binary format that is memory-mapped
+      //	on loading and used directly for scoring.
       bool save(const std::string& filename) const;
       bool load(const std::string& filename);
       static bool load(const std::string& filename, boost::shared_ptr<Model>& model);
@@ -61,7 +63,7 @@ namespace bob { namespace visioner {
 
       // Compute the model score at the (x, y) position for the output <o>
       double score(uint64_t o, int x, int y) const;
-      double score(uint64_t o, uint64_t rbegin, uint64_t rend, int x, int y) const;
+      virtual double score(uint64_t o, uint64_t rbegin, uint64_t rend, int x, int y) const;
 
       // Compute the value of the feature <f> at the (x, y) position
       virtual uint64_t get(uint64_t f, int x, int y) const = 0;
@@ -69,9 +71,10 @@ namespace bob { namespace visioner {
       // Access functions
       virtual uint64_t n_features() const = 0;
       virtual uint64_t n_fvalues() const = 0;
-      uint64_t n_outputs() const { return m_mluts.size(); }
-      uint64_t n_luts(uint64_t o) const { return m_mluts[o].size(); }
+      uint64_t n_outputs() const { return m_table.n_outputs(); }
+      uint64_t n_luts(uint64_t o) const { return m_table.n_luts(o); }
       const std::vector<std::vector<LUT> >& luts() const { return m_mluts; }
+      const LUTTable& table() const { return m_table; }
       virtual std::vector<uint64_t> features() const;
 
       // Describe a feature
@@ -82,11 +85,14 @@ namespace bob { namespace visioner {
       virtual void save(boost::archive::binary_oarchive& oa) const = 0;
       virtual void load(boost::archive::text_iarchive& ia) = 0;
       virtual void load(boost::archive::binary_iarchive& ia) = 0;
+      virtual void save(std::vector<unsigned char>& data) const = 0;
+      virtual bool load(const unsigned char* data, uint64_t size) = 0;
 
     private: //representation
 
       // Attributes
-      std::vector<std::vector<LUT> >               m_mluts;        // Multivariate std::vector<LUT>
+      LUTTable                                  m_table;        // Multivariate LUTs (used for scoring)
+      std::vector<std::vector<LUT> >            m_mluts;        // Multivariate std::vector<LUT> (copied from m_table)
   };
 
 }}
@@ -32,13 +32,17 @@ namespace bob { namespace visioner {
     "dLBP",
     "MCT"};
 
-  template <uint64_t (*TLBPOp) (const Matrix<uint32_t>&, int, int, int, int), int TNameIndex, int NFeatureValues> class MBxxxLBPModel : public IIModel {
+  // NB: <TLBPOp> computes the code from the 4x4 grid of integral values of the 3x3 cells.
+  //	The LUTs are compiled for each scale in ::preprocess() by precomputing the offsets
+  //	of the grid relative to the sub-window, so that ::score() only reads the integral
+  //	image and the contiguous LUT entries.
+  template <uint64_t (*TLBPOp) (const uint32_t*), int TNameIndex, int NFeatureValues> class MBxxxLBPModel : public IIModel {
 
     public:
 
       // Constructor
       MBxxxLBPModel(const param_t& param = param_t())
-        :	IIModel(param), m_delta(1) {
+        :	IIModel(param), m_delta(1), m_stride(0) {
           reset(param);
         }
 
@@ -61,11 +65,50 @@ namespace bob { namespace visioner {
         return _project();
       }
 
+      // Preprocess the current image
+      virtual void preprocess(const ipscale_t& ipscale)
+      {
+        IIModel::preprocess(ipscale);
+        _compile();
+      }
+
+      // Compute the model score at the (x, y) position for the output <o>
+      virtual double score(uint64_t o, uint64_t rbegin, uint64_t rend, int x, int y) const
+      {
+        const LUTTable& luts = table();
+        if (    m_compiled.features() != luts.features() || 
+            m_stride != m_iimage.cols())
+        {
+          // The LUTs have changed since the last ::preprocess()
+          return Model::score(o, rbegin, rend, x, y);
+        }
+
+        const uint64_t n_fvalues = luts.n_fvalues();
+        const uint64_t begin = luts.begin(o) + rbegin;
+        const uint32_t* ii = &m_iimage(y, x);
+        const int* offsets = &m_offsets[begin * 16];
+        const double* entries = luts.entries() + begin * n_fvalues;
+
+        uint32_t P[16];
+        double sum = 0.0;
+        for (uint64_t r = rbegin; r < rend; r ++, offsets += 16, entries += n_fvalues)
+        {
+          for (int k = 0; k < 16; k ++)
+          {
+            P[k] = ii[offsets[k]];
+          }
+          sum += entries[TLBPOp(P)];
+        }
+        return sum;
+      }
+
       // Compute the value of the feature <f> at the (x, y) position
       virtual uint64_t get(uint64_t f, int x, int y) const
       {
         const mb_t& mb = m_mbs[f];
-        return TLBPOp(m_iimage, x + mb.m_dx, y + mb.m_dy, mb.m_cx, mb.m_cy);
+        uint32_t P[16];
+        mb_grid(m_iimage, x + mb.m_dx, y + mb.m_dy, mb.m_cx, mb.m_cy, P);
+        return TLBPOp(P);
       }
 
       // Access functions
@@ -100,6 +143,31 @@ namespace bob { namespace visioner {
       {
         ia & m_mbs;
       }
+      virtual void save(std::vector<unsigned char>& data) const
+      {
+        for (uint64_t f = 0; f < m_mbs.size(); f ++)
+        {
+          const mb_t& mb = m_mbs[f];
+          data.push_back(mb.m_dx);
+          data.push_back(mb.m_dy);
+          data.push_back(mb.m_cx);
+          data.push_back(mb.m_cy);
+        }
+      }
+      virtual bool load(const unsigned char* data, uint64_t size)
+      {
+        if (size % 4 != 0)
+        {
+          return false;
+        }
+
+        m_mbs.resize(size / 4);
+        for (uint64_t f = 0; f < m_mbs.size(); f ++, data += 4)
+        {
+          m_mbs[f] = mb_t(data[0], data[1], data[2], data[3]);
+        }
+        return true;
+      }
 
     public:
 
@@ -131,6 +199,20 @@ namespace bob { namespace visioner {
 
     private:
 
+      // Compile the LUTs for the current integral image
+      void _compile()
+      {
+        const LUTTable& luts = table();
+        m_compiled = luts;
+        m_stride = m_iimage.cols();
+        m_offsets.resize(luts.n_luts() * 16);
+        for (uint64_t r = 0; r < luts.n_luts(); r ++)
+        {
+          const mb_t& mb = m_mbs[luts.features()[r]];
+          mb_grid_offsets(mb.m_dx, mb.m_dy, mb.m_cx, mb.m_cy, m_stride, &m_offsets[r * 16]);
+        }
+      }
+
       // Reset to new parameters
       void _reset()
       {
@@ -230,16 +312,20 @@ namespace bob { namespace visioner {
       // Attributes
       std::vector<mb_t>           m_mbs;		// MB-features
       uint64_t         m_delta;        // Projection level
+
+      LUTTable                    m_compiled;     // LUTs compiled by the last ::preprocess()
+      uint64_t                    m_stride;       // ... for this integral image width
+      std::vector<int>            m_offsets;      // ... 4x4 grid offsets of each LUT
   };
 
   // xLBP feature pools
-  typedef MBxxxLBPModel<mb_lbp<uint32_t, uint64_t>, 0, 256>                 MBLBPModel;
-  typedef MBxxxLBPModel<mb_mlbp<uint32_t, uint64_t>, 1, 256>                MBmLBPModel;
-  typedef MBxxxLBPModel<mb_tlbp<uint32_t, uint64_t>, 2, 256>                MBtLBPModel;
-  typedef MBxxxLBPModel<mb_dlbp<uint32_t, uint64_t>, 3, 256>                MBdLBPModel;
+  typedef MBxxxLBPModel<mb_lbp_grid<uint32_t, uint64_t>, 0, 256>            MBLBPModel;
+  typedef MBxxxLBPModel<mb_mlbp_grid<uint32_t, uint64_t>, 1, 256>           MBmLBPModel;
+  typedef MBxxxLBPModel<mb_tlbp_grid<uint32_t, uint64_t>, 2, 256>           MBtLBPModel;
+  typedef MBxxxLBPModel<mb_dlbp_grid<uint32_t, uint64_t>, 3, 256>           MBdLBPModel;
 
   // MCT feature pool
-  typedef MBxxxLBPModel<mb_mct<uint32_t, 3, 3, uint64_t>, 4, 512>           MBMCTModel;
+  typedef MBxxxLBPModel<mb_mct_grid<uint32_t, 3, 3, uint64_t>, 4, 512>      MBMCTModel;
 
 }}
 
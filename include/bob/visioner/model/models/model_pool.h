@@ -120,6 +120,32 @@ namespace bob { namespace visioner {
         m_fpool1.load(ia);
         m_fpool2.load(ia);
       }
+      virtual void save(std::vector<unsigned char>& data) const
+      {
+        // The size of the first block is stored first to split the feature descriptors
+        std::vector<unsigned char> data1;
+        m_fpool1.save(data1);
+        const uint64_t size1 = data1.size();
+        const unsigned char* psize1 = (const unsigned char*)&size1;
+        data.insert(data.end(), psize1, psize1 + sizeof(uint64_t));
+        data.insert(data.end(), data1.begin(), data1.end());
+        m_fpool2.save(data);
+      }
+      virtual bool load(const unsigned char* data, uint64_t size)
+      {
+        uint64_t size1 = 0;
+        if (size < sizeof(uint64_t))
+        {
+          return false;
+        }
+        std::copy(data, data + sizeof(uint64_t), (unsigned char*)&size1);
+        data += sizeof(uint64_t);
+        size -= sizeof(uint64_t);
+
+        return  size1 <= size &&
+          m_fpool1.load(data, size1) &&
+          m_fpool2.load(data + size1, size - size1);
+      }
 
     private:
 
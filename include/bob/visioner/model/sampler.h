@@ -42,9 +42,14 @@ namespace bob { namespace visioner {
        * the maximum number of threads this sampler should be able to work with.
        * This parameter will be used to initialize N random generators (one for
        * each thread). A value of zero will initialize a single random number
-       * generator.
+       * generator. The images listed in the parameters (if any) are loaded
+       * using the same number of threads.
+       *
+       * If <compact> is set, only the part of each scaled image covered by
+       * its samples is kept in memory (@see setCompact()).
        */
-      Sampler(const param_t& param, SamplerType type, size_t max_threads=0);
+      Sampler(const param_t& param, SamplerType type, size_t max_threads=0,
+          bool compact=false);
 
       /**
        * Samples, approximately, the given number of samples (uniformly). The
@@ -115,6 +120,11 @@ namespace bob { namespace visioner {
        */
       uint64_t n_types() const { return m_n_types; }
 
+      /**
+       * Number of samples loaded for each distinct target type.
+       */
+      const std::vector<uint64_t>& tcounts() const { return m_tcounts; }
+
       /**
        * Grabs all images.
        */
@@ -123,9 +133,23 @@ namespace bob { namespace visioner {
       /**
        * Resets to a list of images and (matching) ground truth files. Note:
        * This method is buggy and will only work after object initialization.
+       *
+       * The images are loaded and scanned by the given number of threads
+       * (zero to work in the current thread), the loaded images and samples
+       * are stored in the order of the list independently of this number.
        */
       void load(const std::vector<std::string>& ifiles, 
-          const std::vector<std::string>& gfiles);
+          const std::vector<std::string>& gfiles, size_t threads=0);
+
+      /**
+       * Compact storage: if set, the scaled images loaded afterwards are
+       * cropped to the smallest region containing all their samples (the
+       * scanning ranges and the ground truth are translated accordingly),
+       * instead of keeping the whole scaled images in memory. This is mostly
+       * useful for images with objects, where few sub-windows are samples.
+       */
+      void setCompact(bool compact) { m_compact = compact; }
+      bool getCompact() const { return m_compact; }
 
       /**
        * Returns the current sampler type.
@@ -174,6 +198,24 @@ namespace bob { namespace visioner {
       // Reset to a set of listfiles
       void load(const std::vector<std::string>& listfiles);
 
+      /**
+       * Scaled versions (with at least one sample) of a loaded image
+       */
+      struct iscales_t {
+        std::vector<ipscale_t> m_ipscales; ///< Scaled images
+        std::vector<uint64_t> m_n_samples; ///< # of samples / scaled image
+        std::vector<uint64_t> m_tcounts; ///< # of samples / distinct target type
+      };
+
+      /**
+       * Loading thread (image <i> of the list with the <ith> image pyramid)
+       */
+      void th_load(uint64_t ith, uint64_t i,
+          const std::vector<std::string>& ifiles,
+          const std::vector<std::string>& gfiles,
+          std::vector<ipyramid_t>& ipyramids,
+          std::vector<iscales_t>& iscales) const;
+
       /**
        * Uniform sampling worker thread
        */
@@ -210,6 +252,7 @@ namespace bob { namespace visioner {
       uint64_t m_n_outputs; //
       uint64_t m_n_samples; //
       uint64_t m_n_types; ///< # of distinct target types
+      bool m_compact; ///< Keep only the sampled part of the scaled images
 
       std::vector<ipscale_t> m_ipscales; ///< Input: image + annotations @ all scales
       std::vector<uint64_t> m_ipsbegins; ///< Sample interval [begin, end)
@@ -27,7 +27,7 @@ namespace bob { namespace visioner {
 
       // Constructor
       Trainer(const param_t& param = param_t())
-        :	Parametrizable(param) {	}
+        :	Parametrizable(param), m_compact(false) {	}
 
       // Clone the object
       virtual boost::shared_ptr<Trainer> clone() const = 0;
@@ -40,6 +40,18 @@ namespace bob { namespace visioner {
        */
       virtual bool train(const Sampler& t_sampler, const Sampler& v_sampler, 
           Model& model, size_t threads) = 0;
+
+      /**
+       * Compact training state: if set, the per-sample scores are kept in
+       * single precision, which halves the memory traffic of the boosting
+       * rounds at the cost of a slightly less accurate accumulation.
+       */
+      void setCompact(bool compact) { m_compact = compact; }
+      bool getCompact() const { return m_compact; }
+
+    protected:
+
+      bool m_compact; ///< Single precision training state
   };
 
 }}
@@ -27,7 +27,9 @@ namespace bob { namespace visioner {
     public:
 
       // Constructor
-      LUTProblem(const DataSet& dataset, const param_t& param, size_t threads);
+      //	NB: If <compact> is set, the scores are stored in single precision.
+      LUTProblem(const DataSet& dataset, const param_t& param, size_t threads,
+          bool compact = false);
 
       // Destructor
       virtual ~LUTProblem() {}
@@ -36,6 +38,10 @@ namespace bob { namespace visioner {
       virtual void update_loss_deriv() = 0;
       virtual void update_loss() = 0;
 
+      // Update predictions with the given LUTs and then the loss values and 
+      //	derivatives (in a single pass over the samples)
+      virtual void update_scores_loss_deriv(const std::vector<LUT>& luts) = 0;
+
       // Select the optimal feature
       virtual void select() = 0;
 
@@ -60,6 +66,8 @@ namespace bob { namespace visioner {
       const std::vector<std::vector<LUT> >& mluts() const { return m_mluts; }
       const std::vector<LUT>& luts() const { return m_luts; }
 
+      bool compact() const { return m_compact; }
+
       // Update predictions
       void update_scores(const std::vector<LUT>& luts);
 
@@ -77,14 +85,40 @@ namespace bob { namespace visioner {
 
     protected:
 
-      // Update current scores
-      void update_cscores(const double* x);
-
-    private:
- 
-      // Update scores (worker thread)
-      void update_cscores_mt(const double* x,
-          const std::pair<uint64_t,uint64_t>& range);
+      // Strong learner's scores of the sample <s> (copied to <buffer> if compact)
+      const double* sscores(uint64_t s, double* buffer) const
+      {
+        if (m_compact == false)
+        {
+          return m_sscores[s];
+        }
+        std::copy(m_fsscores[s], m_fsscores[s] + n_outputs(), buffer);
+        return buffer;
+      }
+
+      // Weak learner's score of the sample <s> for the output <o>
+      double wscore(uint64_t s, uint64_t o) const
+      {
+        return m_compact ? m_fwscores(s, o) : m_wscores(s, o);
+      }
+
+      // Add the given LUTs to the strong learner's scores of the sample <s>
+      void add_scores(const std::vector<LUT>& luts, uint64_t s)
+      {
+        for (uint64_t o = 0; o < n_outputs(); o ++)
+        {
+          const LUT& lut = luts[o];
+          const double score = lut[fvalue(lut.feature(), s)];
+          if (m_compact == true)
+          {
+            m_fsscores(s, o) += score;
+          }
+          else
+          {
+            m_sscores(s, o) += score;
+          }
+        }
+      }
 
     protected:
 
@@ -100,9 +134,11 @@ namespace bob { namespace visioner {
       std::vector<std::vector<LUT> >		m_mluts;	// Trained model
       std::vector<LUT>			m_luts;		// Buffered std::vector<LUT>
 
+      bool                      m_compact;      // Single precision scores
       Matrix<double>            m_sscores;	// Strong learner's score: (sample, output)
       Matrix<double>		m_wscores;	// Weak learner's score: (sample, output)
-      Matrix<double>            m_cscores;      // Current (strong + scale * weak) scores: (sample, output)
+      Matrix<float>             m_fsscores;     // ... in single precision (compact)
+      Matrix<float>             m_fwscores;
 
       Matrix<double>            m_umasks;       // Entries mask [0/1]: (feature, entry)
 
@@ -27,7 +27,8 @@ namespace bob { namespace visioner {
     public:
 
       // Constructor
-      LUTProblemEPT(const DataSet& data, const param_t& param, size_t threads);
+      LUTProblemEPT(const DataSet& data, const param_t& param, size_t threads,
+          bool compact = false);
 
       // Destructor
       virtual ~LUTProblemEPT() {}
@@ -36,6 +37,9 @@ namespace bob { namespace visioner {
       virtual void update_loss_deriv();
       virtual void update_loss();
 
+      // Update predictions and then loss values and derivatives
+      virtual void update_scores_loss_deriv(const std::vector<LUT>& luts);
+
       // Select the optimal feature
       virtual void select();
 
@@ -52,9 +56,32 @@ namespace bob { namespace visioner {
 
     protected:
 
-      // Update loss values and derivatives (for some particular scores)
-      virtual void update_loss_deriv(const Matrix<double>& scores);
-      virtual void update_loss(const Matrix<double>& scores);
+      // Sums accumulated over the samples during linesearch, for the
+      //	(cost adjusted) loss values <v> and gradients <d>:
+      //	sum(v), sum(v^2), sum(d * w) and sum(d * w * v) (w = weak learner's score).
+      struct lsearch_t
+      {
+        lsearch_t(uint64_t n_outputs = 0)
+          :	m_value(0.0), m_value_sq(0.0),
+          m_grad(n_outputs, 0.0), m_grad_value(n_outputs, 0.0)
+        {
+        }
+
+        void add(const lsearch_t& other);
+
+        double                  m_value;
+        double                  m_value_sq;
+        std::vector<double>     m_grad;
+        std::vector<double>     m_grad_value;
+      };
+
+      // Compute the gradient <g> and the function value from the linesearch sums
+      virtual double linesearch(const lsearch_t& sums, double* g) const;
+
+      // Update loss values and derivatives 
+      //	(after adding <luts> to the strong learner's scores, if given)
+      virtual void update_loss_deriv(const std::vector<LUT>* luts);
+      virtual void update_loss(const std::vector<LUT>* luts);
 
       // Compute the local loss decrease for a range of features
       void select(std::pair<uint64_t, uint64_t> frange);
@@ -68,12 +95,15 @@ namespace bob { namespace visioner {
 
     private: //multi-threading
 
-      void update_loss_deriv_mt(const Matrix<double>& scores, 
+      void update_loss_deriv_mt(const std::vector<LUT>* luts, 
           const std::pair<uint64_t,uint64_t>& range);
 
-      void update_loss_mt(const Matrix<double>& scores, 
+      void update_loss_mt(const std::vector<LUT>* luts, 
           const std::pair<uint64_t,uint64_t>& range);
 
+      void linesearch_mt(const double* x, 
+          const std::pair<uint64_t,uint64_t>& range, lsearch_t& sums) const;
+
     protected:
 
       // Attributes
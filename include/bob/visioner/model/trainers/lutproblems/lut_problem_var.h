@@ -29,21 +29,24 @@ namespace bob { namespace visioner {
 
       // Constructor
       LUTProblemVAR(const DataSet& data, const param_t& param, double lambda,
-          size_t threads);
+          size_t threads, bool compact = false);
 
       // Destructor
       virtual ~LUTProblemVAR() {} 
 
     protected:
 
-      // Update loss values and derivatives (for some particular scores)
-      virtual void update_loss_deriv(const Matrix<double>& scores);
-      virtual void update_loss(const Matrix<double>& scores);
+      // Compute the gradient <g> and the function value from the linesearch sums
+      virtual double linesearch(const lsearch_t& sums, double* g) const;
+
+      // Update loss values and derivatives 
+      //	(after adding <luts> to the strong learner's scores, if given)
+      virtual void update_loss_deriv(const std::vector<LUT>* luts);
+      virtual void update_loss(const std::vector<LUT>* luts);
 
     private: //multi-threading
       
-      void update_loss_deriv_mt(const Matrix<double>& scores,
-          double scale1, double scale2, double ept_sum,
+      void update_loss_deriv_mt(double scale1, double scale2, double ept_sum,
           const std::pair<uint64_t,uint64_t>& range);
 
     protected:
@@ -44,7 +44,9 @@ namespace bob { namespace visioner {
 
       // Clone the object
       virtual boost::shared_ptr<Trainer> clone() const {
-        return boost::shared_ptr<Trainer>(new TaylorBooster(m_param)); 
+        boost::shared_ptr<Trainer> trainer(new TaylorBooster(m_param));
+        trainer->setCompact(m_compact);
+        return trainer;
       }
 
       /**
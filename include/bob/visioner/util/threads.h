@@ -14,6 +14,8 @@
 #define BOB_VISIONER_UTIL_THREADS_H
 
 #include <vector>
+#include <string>
+#include <stdexcept>
 
 #include <boost/thread.hpp>
 #include <boost/lambda/bind.hpp>
@@ -119,6 +121,89 @@ namespace bob { namespace visioner {
 
   }
 
+  // Queue of items [0, size) processed by multiple threads: each thread takes
+  //  the next unprocessed item, which balances the load when the items have
+  //  very different costs (e.g. images of different sizes).
+  template <typename TOp> class thread_queue_t {
+
+    public:
+
+      thread_queue_t(TOp op, uint64_t size)
+        : m_op(op), m_size(size), m_next(0), m_error_item(size) {
+        }
+
+      // Process items until the queue is empty
+      void run(uint64_t ith) {
+        while (true) {
+          uint64_t item;
+          {
+            boost::mutex::scoped_lock lock(m_mutex);
+            if (m_next >= m_size) return;
+            item = m_next ++;
+          }
+
+          try {
+            m_op(ith, item);
+          }
+          catch (std::exception& e) {
+            error(item, e.what());
+          }
+          catch (...) {
+            error(item, "unknown exception");
+          }
+        }
+      }
+
+      // Raise the error of the first item (if any) that failed
+      void check() const {
+        if (m_error_item < m_size) throw std::runtime_error(m_error);
+      }
+
+    private:
+
+      void error(uint64_t item, const std::string& message) {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (item < m_error_item) {
+          m_error_item = item;
+          m_error = message;
+        }
+      }
+
+      TOp           m_op;
+      uint64_t      m_size;
+      uint64_t      m_next;
+      uint64_t      m_error_item;
+      std::string   m_error;
+      boost::mutex  m_mutex;
+  };
+
+  // Process the items [0, size) using multiple threads (taking the next
+  //  unprocessed item) or in the current thread if <num_of_threads> is 0.
+  // NB: State threads: op(thread_index, item), the exception of the first
+  //  failed item is raised after all threads have finished.
+  template <typename TOp> void thread_queue(TOp op, uint64_t size,
+      size_t num_of_threads=boost::thread::hardware_concurrency()) {
+
+    if (num_of_threads == 0) {
+      for (uint64_t i = 0; i < size; i ++) op(0, i);
+      return;
+    }
+
+    thread_queue_t<TOp> queue(op, size);
+    boost::shared_array<boost::thread> threads(new boost::thread[num_of_threads]);
+
+    for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
+      boost::thread t(boost::bind(&thread_queue_t<TOp>::run, &queue, ith));
+      threads[ith] = boost::move(t);
+    }
+
+    for (uint64_t ith = 0; ith < num_of_threads; ith ++) {
+      threads[ith].join();
+    }
+
+    queue.check();
+  }
+
 }}
 
 #endif /* BOB_VISIONER_UTIL_THREADS_H */
@@ -28,6 +28,15 @@ namespace bob { namespace visioner {
   bool load(const QImage& qimage, Matrix<uint8_t>& grays);
   bool load(const std::string& filename, Matrix<uint8_t>& grays);
 
+  // Size of the image scaled to a specific <scale> of a <rows> x <cols> image
+  void scaled_size(uint64_t rows, uint64_t cols, double scale,
+      uint64_t& new_rows, uint64_t& new_cols);
+
+  // Resample the <src> image to <rows> x <cols> (at most the size of <src>) by area averaging,
+  //  using <buffer> as (reusable) temporary storage
+  void resample(const Matrix<uint8_t>& src, uint64_t rows, uint64_t cols,
+      Matrix<uint8_t>& dst, Matrix<float>& buffer);
+
   // Scale the image to a specific <scale> of the <src> source image
   bool scale(const Matrix<uint8_t>& src, double scale, Matrix<uint8_t>& dst);
 
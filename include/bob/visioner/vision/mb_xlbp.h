@@ -72,14 +72,39 @@ namespace bob { namespace visioner {
   //      p8      xx      p4
   //      p7      p6      p5      
   ////////////////////////////////////////////////////////////////////////////
+
+  // Gather the 4x4 grid of integral values (P00, P01, ..., P33) at (x, y)
+  template <typename TII>
+    void mb_grid(const Matrix<TII>& ii, int x, int y, int cx, int cy, TII* P)
+    {
+      for (int i = 0, dy = y; i < 4; i ++, dy += cy)
+      {
+        const TII* row = ii[dy];
+        for (int j = 0, dx = x; j < 4; j ++, dx += cx)
+        {
+          *(P ++) = row[dx];
+        }
+      }
+    }
+
+  // Compute the offsets of the 4x4 grid of integral values relative to (x, y)
+  //	for an integral image with <stride> columns
+  inline void mb_grid_offsets(int x, int y, int cx, int cy, int stride, int* offsets)
+  {
+    for (int i = 0, dy = y; i < 4; i ++, dy += cy)
+    {
+      for (int j = 0, dx = x; j < 4; j ++, dx += cx)
+      {
+        *(offsets ++) = dy * stride + dx;
+      }
+    }
+  }
+
 #define INIT_xLBP \
-  const int x0 = x, x1 = x0 + cx, x2 = x1 + cx, x3 = x2 + cx;\
-  const int y0 = y, y1 = y0 + cy, y2 = y1 + cy, y3 = y2 + cy;\
-  \
-  const TII P00 = ii(y0, x0), P01 = ii(y0, x1), P02 = ii(y0, x2), P03 = ii(y0, x3);\
-  const TII P10 = ii(y1, x0), P11 = ii(y1, x1), P12 = ii(y1, x2), P13 = ii(y1, x3);\
-  const TII P20 = ii(y2, x0), P21 = ii(y2, x1), P22 = ii(y2, x2), P23 = ii(y2, x3);\
-  const TII P30 = ii(y3, x0), P31 = ii(y3, x1), P32 = ii(y3, x2), P33 = ii(y3, x3);\
+  const TII P00 = P[0], P01 = P[1], P02 = P[2], P03 = P[3];\
+  const TII P10 = P[4], P11 = P[5], P12 = P[6], P13 = P[7];\
+  const TII P20 = P[8], P21 = P[9], P22 = P[10], P23 = P[11];\
+  const TII P30 = P[12], P31 = P[13], P32 = P[14], P33 = P[15];\
   \
   const TII p1 = P00 + P11 - P01 - P10;\
   const TII p2 = P01 + P12 - P02 - P11;\
@@ -90,8 +115,9 @@ namespace bob { namespace visioner {
   const TII p7 = P20 + P31 - P21 - P30;\
   const TII p8 = P10 + P21 - P11 - P20;     
 
+  // Compute the codes from the 4x4 grid of integral values
   template <typename TII, typename TCODE>
-    TCODE mb_lbp(const Matrix<TII>& ii, int x, int y, int cx, int cy)
+    TCODE mb_lbp_grid(const TII* P)
     {
       INIT_xLBP
 
@@ -101,7 +127,7 @@ namespace bob { namespace visioner {
     }
 
   template <typename TII, typename TCODE>
-    TCODE mb_tlbp(const Matrix<TII>& ii, int x, int y, int cx, int cy)
+    TCODE mb_tlbp_grid(const TII* P)
     {
       INIT_xLBP
 
@@ -109,7 +135,7 @@ namespace bob { namespace visioner {
     }
 
   template <typename TII, typename TCODE>
-    TCODE mb_dlbp(const Matrix<TII>& ii, int x, int y, int cx, int cy)
+    TCODE mb_dlbp_grid(const TII* P)
     {
       INIT_xLBP
 
@@ -136,7 +162,7 @@ namespace bob { namespace visioner {
     }        
 
   template <typename TII, typename TCODE>
-    TCODE mb_mlbp(const Matrix<TII>& ii, int x, int y, int cx, int cy)
+    TCODE mb_mlbp_grid(const TII* P)
     {
       INIT_xLBP
 
@@ -145,6 +171,41 @@ namespace bob { namespace visioner {
       return mb_8bit_code_gt<TII, TCODE>(p1, p2, p3, p4, p5, p6, p7, p8, avg);
     }
 
+#undef INIT_xLBP
+
+  // Compute the codes at the (x, y) position
+  template <typename TII, typename TCODE>
+    TCODE mb_lbp(const Matrix<TII>& ii, int x, int y, int cx, int cy)
+    {
+      TII P[16];
+      mb_grid(ii, x, y, cx, cy, P);
+      return mb_lbp_grid<TII, TCODE>(P);
+    }
+
+  template <typename TII, typename TCODE>
+    TCODE mb_tlbp(const Matrix<TII>& ii, int x, int y, int cx, int cy)
+    {
+      TII P[16];
+      mb_grid(ii, x, y, cx, cy, P);
+      return mb_tlbp_grid<TII, TCODE>(P);
+    }
+
+  template <typename TII, typename TCODE>
+    TCODE mb_dlbp(const Matrix<TII>& ii, int x, int y, int cx, int cy)
+    {
+      TII P[16];
+      mb_grid(ii, x, y, cx, cy, P);
+      return mb_dlbp_grid<TII, TCODE>(P);
+    }
+
+  template <typename TII, typename TCODE>
+    TCODE mb_mlbp(const Matrix<TII>& ii, int x, int y, int cx, int cy)
+    {
+      TII P[16];
+      mb_grid(ii, x, y, cx, cy, P);
+      return mb_mlbp_grid<TII, TCODE>(P);
+    }
+
   /////////////////////////////////////////////////////////////////////////////////////////
   // Compute the dense MB-xLBP feature maps.
   /////////////////////////////////////////////////////////////////////////////////////////
@@ -70,6 +70,29 @@ namespace bob { namespace visioner {
       return true;
     }        
 
+  // Compute the code from the (NCELLSY + 1) x (NCELLSX + 1) grid of integral values
+  template <typename TII, int NCELLSX, int NCELLSY, typename TCODE>
+    TCODE mb_mct_grid(const TII* P)
+    {
+      const int n = NCELLSX + 1;
+      const TII avg = 
+        (P[0] + P[NCELLSY * n + NCELLSX] - P[NCELLSY * n] - P[NCELLSX]) / 
+        (NCELLSX * NCELLSY);
+
+      TCODE code = 0;                                
+      for (int icy = 0, bit = 0; icy < NCELLSY; icy ++)
+      {
+        for (int icx = 0; icx < NCELLSX; icx ++, bit ++)
+        {
+          const TII* p = P + icy * n + icx;
+          const TII val = p[0] + p[n + 1] - p[1] - p[n];
+          code |= (val > avg) << bit;
+        }
+      }
+
+      return code;
+    }
+
   template <typename TII, int NCELLSX, int NCELLSY, typename TCODE>
     TCODE mb_mct(const Matrix<TII>& ii, int x, int y, int cx, int cy)
     {
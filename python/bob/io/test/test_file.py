@@ -14,7 +14,7 @@ import sys
 import numpy
 import nose.tools
 
-from .. import load, write, File
+from .. import load, write, File, get_n_threads, set_n_threads
 from ...test import utils as testutils
 
 def transcode(filename):
@@ -272,3 +272,36 @@ def test_csv():
   arrayset_readwrite('.csv', a1, close=True)
   arrayset_readwrite(".csv", a2, close=True)
   arrayset_readwrite('.csv', a3, close=True)
+
+@testutils.extension_available('.csv')
+def test_csv_parsing():
+
+  # big enough to be parsed in parallel, with blanks, quotes and various
+  # number formats
+  data = numpy.random.normal(size=(20000,10)) * 10.**numpy.random.randint(-30, 30, size=(20000,10))
+  formats = ['%.17g', '%.10e', ' %g', '"%.17g"', '%.3f ']
+  tmpname = testutils.temporary_filename(suffix='.csv')
+
+  try:
+    with open(tmpname, 'wt') as f:
+      for row in data:
+        f.write(','.join([formats[k % len(formats)] % v for k,v in enumerate(row)]))
+        f.write('\r\n')
+
+    expected = numpy.array([[float(v.strip(' "')) for v in l.split(',')] for l in open(tmpname, 'rt')])
+    assert numpy.array_equal(load(tmpname), expected)
+
+    # the same, in the calling thread only
+    assert get_n_threads() == 0
+    set_n_threads(1)
+    try:
+      assert numpy.array_equal(load(tmpname), expected)
+    finally:
+      set_n_threads(0)
+
+    f = File(tmpname, 'r')
+    assert numpy.array_equal(f.read(12345), expected[12345])
+    del f
+
+  finally:
+    if os.path.exists(tmpname): os.unlink(tmpname)
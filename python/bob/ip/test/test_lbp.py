@@ -743,3 +743,36 @@ def test_vanilla_4p1r_4p1r_4p1r():
   nose.tools.eq_(proc2(values_5x5,plane_index=2,operator_coordinates=(0,0,0)),0x7)
 
 
+
+
+"""
+" Frame by frame processing gives the same planes as the 3D operator
+"""
+def test_lbptop_push():
+  lbp_XY = bob.ip.LBP(8, radius=2.0, circular=True, uniform=True, rotation_invariant=False)
+  lbp_XT = bob.ip.LBP(8, radius=2.0, circular=True, uniform=True, rotation_invariant=False)
+  lbp_YT = bob.ip.LBP(8, radius=2.0, circular=True, uniform=True, rotation_invariant=False)
+  op = bob.ip.LBPTop(lbp_XY, lbp_XT, lbp_YT)
+
+  numpy.random.seed(0)
+  video = numpy.random.randint(0, 256, size=(12, 15, 17)).astype('uint8')
+  R = 2
+  shape = (video.shape[0]-2*R, video.shape[1]-2*R, video.shape[2]-2*R)
+  XY = numpy.empty(shape, 'uint16')
+  XT = numpy.empty(shape, 'uint16')
+  YT = numpy.empty(shape, 'uint16')
+  op(video, XY, XT, YT)
+
+  xy = numpy.empty(shape[1:], 'uint16')
+  xt = numpy.empty(shape[1:], 'uint16')
+  yt = numpy.empty(shape[1:], 'uint16')
+  for n_pass in range(2):
+    op.reset()
+    for i in range(video.shape[0]):
+      ready = op.push(video[i], xy, xt, yt)
+      nose.tools.eq_(ready, i >= 2*R)
+      if ready:
+        assert numpy.array_equal(xy, XY[i-2*R])
+        assert numpy.array_equal(xt, XT[i-2*R])
+        assert numpy.array_equal(yt, YT[i-2*R])
+    nose.tools.eq_(op.n_frames, video.shape[0])
@@ -190,3 +190,73 @@ class FlowTest(unittest.TestCase):
     self.assertTrue(v_c.mean() < 1.1) #check for within 10%
     print("mean(u_ratio), mean(v_ratio): %.3e %.3e" % (u_c.mean(), v_c.mean()),
         "(as close to 1 as possible)")
+
+  def test04_HornAndSchunckThreadsEarlyExitAndPyramid(self):
+
+    # A smooth pattern moving by one pixel between the frames
+    y, x = numpy.mgrid[0:48, 0:64]
+    frames = [numpy.sin((x-k)/5.) * numpy.cos(y/7.) for k in range(3)]
+    alpha = 0.5
+
+    flow = bob.ip.HornAndSchunckFlow(frames[0].shape)
+    u1 = numpy.zeros(frames[0].shape, 'float64')
+    v1 = numpy.zeros(frames[0].shape, 'float64')
+    self.assertEqual( flow(alpha, 50, frames[0], frames[1], frames[2], u1, v1), 50 )
+
+    # the rows are split between the threads without changing the result
+    flow.n_threads = 4
+    u4 = numpy.zeros(frames[0].shape, 'float64')
+    v4 = numpy.zeros(frames[0].shape, 'float64')
+    flow(alpha, 50, frames[0], frames[1], frames[2], u4, v4)
+    self.assertTrue( numpy.array_equal(u1, u4) )
+    self.assertTrue( numpy.array_equal(v1, v4) )
+
+    # the iterations stop once converged
+    flow.tolerance = 1e-4
+    u = numpy.zeros(frames[0].shape, 'float64')
+    v = numpy.zeros(frames[0].shape, 'float64')
+    n_single = flow(alpha, 100000, frames[0], frames[1], frames[2], u, v)
+    self.assertTrue( n_single < 100000 )
+
+    # coarse-to-fine estimation: starting from the flow of the coarser
+    # levels, fewer iterations are run at the finest one for the same
+    # tolerance, and the flow found is the same (about 1 pixel per frame)
+    flow.n_levels = 3
+    self.assertEqual( flow.n_levels, 3 )
+    u_p = numpy.zeros(frames[0].shape, 'float64')
+    v_p = numpy.zeros(frames[0].shape, 'float64')
+    n_pyramid = flow(alpha, 100000, frames[0], frames[1], frames[2], u_p, v_p)
+    self.assertTrue( n_pyramid < n_single )
+    self.assertTrue( numpy.allclose(u_p, u, rtol=0, atol=2e-2) )
+    self.assertTrue( numpy.allclose(v_p, v, rtol=0, atol=2e-2) )
+
+  def test05_LaplacianAveraging(self):
+
+    # Values computed by hand: the average is centred on each pixel and the
+    # edge pixels are repeated around the borders
+    i = numpy.array([[1, 2, 3], [4, 5, 6], [7, 8, 10]], 'float64')
+
+    # [1/12 1/6 1/12; 1/6 0 1/6; 1/12 1/6 1/12], e.g. for the top-left
+    # pixel: (1 + 2*1 + 2 + 2*1 + 2*2 + 4 + 2*4 + 5) / 12 = 28/12
+    hs = numpy.array([
+      [ 28., 36.,  44.],
+      [ 52., 61.,  71.],
+      [ 76., 87.,  97.],
+      ]) / 12.
+    self.assertTrue( numpy.allclose(bob.ip.laplacian_avg_hs(i), hs,
+      rtol=0, atol=1e-12) )
+
+    # [0 1/4 0; 1/4 0 1/4; 0 1/4 0], e.g. for the top-left pixel:
+    # (1 + 1 + 2 + 4) / 4 = 8/4
+    opencv = numpy.array([
+      [  8., 11., 14.],
+      [ 17., 20., 24.],
+      [ 26., 30., 34.],
+      ]) / 4.
+    self.assertTrue( numpy.allclose(bob.ip.laplacian_avg_hs_opencv(i), opencv,
+      rtol=0, atol=1e-12) )
+
+    # a constant image is left unchanged, including the borders
+    c = 3. * numpy.ones((4, 5), 'float64')
+    self.assertTrue( numpy.allclose(bob.ip.laplacian_avg_hs(c), c) )
+    self.assertTrue( numpy.allclose(bob.ip.laplacian_avg_hs_opencv(c), c) )
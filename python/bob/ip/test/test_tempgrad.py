@@ -231,3 +231,31 @@ class GradientTest(unittest.TestCase):
     self.assertTrue( numpy.array_equal(ex_cxx, ex_python) )
     self.assertTrue( numpy.array_equal(ey_cxx, ey_python) )
     self.assertTrue( numpy.array_equal(et_cxx, et_python) )
+
+  def test03_PushAgainstPairwise(self):
+
+    numpy.random.seed(0)
+    video = numpy.random.randint(0, 256, size=(6,7,9)).astype('uint8')
+
+    grad = bob.ip.HornAndSchunckGradient(video.shape[1:])
+    self.assertEqual( grad.push(video[0]), None )
+    for k in range(1, video.shape[0]):
+      ex_push, ey_push, et_push = grad.push(video[k])
+      ex, ey, et = grad(video[k-1], video[k])
+      self.assertTrue( numpy.array_equal(ex_push, ex) )
+      self.assertTrue( numpy.array_equal(ey_push, ey) )
+      self.assertTrue( numpy.array_equal(et_push, et) )
+
+    grad = bob.ip.SobelGradient(video.shape[1:])
+    self.assertEqual( grad.push(video[0]), None )
+    self.assertEqual( grad.push(video[1]), None )
+    for k in range(2, video.shape[0]):
+      ex_push, ey_push, et_push = grad.push(video[k])
+      ex, ey, et = grad(video[k-2], video[k-1], video[k])
+      self.assertTrue( numpy.array_equal(ex_push, ex) )
+      self.assertTrue( numpy.array_equal(ey_push, ey) )
+      self.assertTrue( numpy.array_equal(et_push, et) )
+
+    # a new sequence starts after a reset
+    grad.reset()
+    self.assertEqual( grad.push(video[0]), None )
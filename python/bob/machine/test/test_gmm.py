@@ -217,3 +217,63 @@ class GMMMachineTest(unittest.TestCase):
     # implementation
     matlab_ll_ref = -2.361583051672024e+02
     self.assertTrue( abs(gmm(data) - matlab_ll_ref) < 1e-10)
+
+  def test05_GMMStatsExtractor(self):
+    # Test the multi-threaded extraction of the statistics of several
+    # utterances against the sequential accumulation
+
+    gmm = bob.machine.GMMMachine(3, 4)
+    gmm.weights   = numpy.array([0.2, 0.3, 0.5], 'float64')
+    gmm.means     = numpy.array([[0, 1, 2, 3], [1, 0, -1, 2], [-2, 1, 0, 1]], 'float64')
+    gmm.variances = numpy.array([[1, 2, 1, 2], [2, 1, 1, 1], [1, 1, 3, 1]], 'float64')
+
+    # Utterances of very different lengths
+    numpy.random.seed(0)
+    features = [numpy.random.randn(n, 4) for n in (1, 50, 3, 200, 7, 2, 31)]
+    references = []
+    for f in features:
+      stats = bob.machine.GMMStats(3, 4)
+      for x in f: gmm.acc_statistics(x, stats)
+      references.append(stats)
+
+    def check(stats, ref):
+      self.assertEqual(stats.t, ref.t)
+      self.assertTrue( numpy.allclose(stats.log_likelihood, ref.log_likelihood, rtol=1e-12, atol=1e-12) )
+      self.assertTrue( numpy.allclose(stats.n, ref.n, rtol=1e-12, atol=1e-12) )
+      self.assertTrue( numpy.allclose(stats.sum_px, ref.sum_px, rtol=1e-12, atol=1e-12) )
+      self.assertTrue( numpy.allclose(stats.sum_pxx, ref.sum_pxx, rtol=1e-12, atol=1e-12) )
+
+    for n_threads in (1, 3, 0):
+      for batch_size in (2, 256):
+        extractor = bob.machine.GMMStatsExtractor(gmm, n_threads, batch_size)
+        self.assertEqual(extractor.n_threads, n_threads)
+        self.assertEqual(extractor.batch_size, batch_size)
+        stats = extractor.extract(features)
+        self.assertEqual(len(stats), len(features))
+        for k in range(len(features)): check(stats[k], references[k])
+
+    # From feature files, to one statistics file per utterance or to a
+    # single HDF5 file
+    feature_files = [tempfile.mkstemp(".hdf5")[1] for f in features]
+    output_files = [tempfile.mkstemp(".hdf5")[1] for f in features]
+    output_file = tempfile.mkstemp(".hdf5")[1]
+    try:
+      for k in range(len(features)): bob.io.save(features[k], feature_files[k])
+      extractor = bob.machine.GMMStatsExtractor(gmm, 3, 2)
+      extractor.extract(feature_files, output_files)
+      for k in range(len(features)):
+        check(bob.machine.GMMStats(bob.io.HDF5File(output_files[k])), references[k])
+
+      hdf5 = bob.io.HDF5File(output_file, 'w')
+      extractor.extract(feature_files, hdf5)
+      del hdf5
+      hdf5 = bob.io.HDF5File(output_file)
+      for k in range(len(features)):
+        hdf5.cd("/stats%d" % k)
+        check(bob.machine.GMMStats(hdf5), references[k])
+      del hdf5
+    finally:
+      for f in feature_files + output_files + [output_file]: os.unlink(f)
+
+    # An empty world model is not accepted
+    self.assertRaises(RuntimeError, bob.machine.GMMStatsExtractor, None)
@@ -154,3 +154,19 @@ class IVectorTests(unittest.TestCase):
     wij = mc.forward(gs)
     self.assertTrue(numpy.allclose(wij_ref, wij, 1e-5))
 
+
+    # Batch of GMMStats (C++), row by row
+    gs2 = bob.machine.GMMStats(2,3)
+    gs2.t = 3
+    gs2.n = numpy.array([1.2, 0.3], numpy.float64)
+    gs2.sum_px = numpy.array([[2., 1., 5.], [1., 3., 2.]], numpy.float64)
+    gmmstats = [gs, gs2, bob.machine.GMMStats(2,3), gs]
+    for n_threads in (1, 2):
+      wijs = mc.forward(gmmstats, n_threads)
+      self.assertEqual(wijs.shape, (4, 2))
+      for i, s in enumerate(gmmstats):
+        self.assertTrue(numpy.allclose(mc.forward(s), wijs[i,:], 1e-10))
+      wijs2 = numpy.ndarray((4, 2), numpy.float64)
+      mc.forward(gmmstats, wijs2, n_threads)
+      self.assertTrue(numpy.allclose(wijs, wijs2, 1e-10))
+    self.assertTrue(numpy.allclose(wij_ref, mc.forward([gs])[0,:], 1e-5))
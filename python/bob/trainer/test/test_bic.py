@@ -89,3 +89,17 @@ class BICTrainerAndMachineTest(unittest.TestCase):
     self.assertAlmostEqual(machine(self.eval_data(0)), 0.)
     # while a positive vector should give a positive result
     self.assertTrue(machine(self.eval_data(1)) > 0.)
+
+  def test_batch(self):
+    # Tests that the scores of the rows of a 2D array are the ones of each row
+    intra_data, extra_data = self.training_data()
+    data = numpy.random.RandomState(0).normal(size=(300, 5)) * 5.
+
+    for machine, trainer in ((bob.machine.BICMachine(), bob.trainer.BICTrainer()),
+                             (bob.machine.BICMachine(False), bob.trainer.BICTrainer(2,2))):
+      trainer.train(machine, intra_data, extra_data)
+      reference = numpy.array([machine(x) for x in data])
+      self.assertTrue(numpy.allclose(machine(data), reference, rtol=1e-10, atol=1e-10))
+      self.assertTrue(numpy.allclose(machine.forward(data), reference, rtol=1e-10, atol=1e-10))
+      self.assertTrue(numpy.allclose(machine.forward_(data), reference, rtol=1e-10, atol=1e-10))
+      self.assertRaises(RuntimeError, machine.forward, data[:,:4])
@@ -361,3 +361,56 @@ class IVectorTests(unittest.TestCase):
       self.assertTrue(numpy.allclose(t_ref[it], m.t, 1e-5))
       self.assertTrue(numpy.allclose(sigma_ref[it], m.sigma, 1e-5))
 
+
+
+  def test03_trainer_batches(self):
+    # Checks that the batched E-step accumulates the same statistics as the
+    # per-utterance computation, for several batch sizes and numbers of threads
+    dim_c, dim_d, dim_t = 4, 3, 3
+    rng = numpy.random.RandomState(0)
+    ubm = bob.machine.GMMMachine(dim_c, dim_d)
+    ubm.weights = numpy.array([0.1, 0.2, 0.3, 0.4])
+    ubm.means = rng.normal(size=(dim_c, dim_d))
+    ubm.variances = rng.uniform(0.5, 1.5, size=(dim_c, dim_d))
+
+    data = []
+    for i in range(150):
+      gs = bob.machine.GMMStats(dim_c, dim_d)
+      gs.t = 1
+      gs.n = rng.uniform(0.1, 20., size=(dim_c,))
+      gs.sum_px = rng.normal(size=(dim_c, dim_d)) * gs.n.reshape((dim_c, 1))
+      gs.sum_pxx = rng.uniform(1., 2., size=(dim_c, dim_d)) * gs.n.reshape((dim_c, 1))
+      data.append(gs)
+    t = rng.normal(size=(dim_c*dim_d, dim_t))
+    sigma = rng.uniform(0.5, 1.5, size=(dim_c*dim_d,))
+
+    # Per-utterance reference
+    m = bob.machine.IVectorMachine(ubm, dim_t)
+    reference = IVectorTrainerPy(sigma_update=True)
+    reference.initialize(m, data)
+    m.t = t
+    m.sigma = sigma
+    reference.e_step(m, data)
+    reference.m_step(m, data)
+    t_ref, sigma_ref = m.t, m.sigma
+
+    eps = 1e-10
+    for n_threads, batch_size in ((1, 64), (3, 64), (2, 7), (4, 1), (3, 1000)):
+      m = bob.machine.IVectorMachine(ubm, dim_t)
+      m.variance_threshold = 1e-5
+      trainer = bob.trainer.IVectorTrainer(update_sigma=True)
+      trainer.n_threads = n_threads
+      trainer.batch_size = batch_size
+      trainer.initialize(m, data)
+      m.t = t
+      m.sigma = sigma
+      trainer.e_step(m, data)
+      for k in range(dim_c):
+        self.assertTrue(numpy.allclose(reference.m_acc_Nij_Sigma_wij2[k], trainer.acc_nij_wij2[k], eps, eps))
+        self.assertTrue(numpy.allclose(reference.m_acc_Fnorm_Sigma_wij[k], trainer.acc_fnormij_wij[k], eps, eps))
+      self.assertTrue(numpy.allclose(reference.m_acc_Snorm.reshape(dim_c, dim_d), trainer.acc_snormij, eps, eps))
+      self.assertTrue(numpy.allclose(reference.m_N, trainer.acc_nij, eps, eps))
+
+      trainer.m_step(m, data)
+      self.assertTrue(numpy.allclose(t_ref, m.t, eps, eps))
+      self.assertTrue(numpy.allclose(sigma_ref, m.sigma, eps, eps))
@@ -61,6 +61,88 @@ M_y=[y1, y2]
 M_x=[x1, x2]
 
 
+class FAReference:
+  """Per-client and per-session computation of the latent variables and of
+  the accumulators of the V, U and d updates, one item after the other"""
+
+  def __init__(self, ubm, stats, u, v, d, x, y, z):
+    self.C, self.D = ubm.dim_c, ubm.dim_d
+    self.m = ubm.mean_supervector
+    self.sigma = ubm.variance_supervector
+    self.stats = stats
+    self.u, self.v, self.d = u, v, d
+    self.x, self.y, self.z = x, y, z
+
+  def rep(self, n):
+    return numpy.repeat(n, self.D)
+
+  def prod(self, X):
+    # Xt_c * diag(sigma)^-1 * X_c for each Gaussian c
+    D = self.D
+    return [numpy.dot(X[c*D:(c+1)*D].T / self.sigma[c*D:(c+1)*D], X[c*D:(c+1)*D]) for c in range(self.C)]
+
+  def posterior(self, X, Xprod, n, Fn):
+    A = numpy.eye(X.shape[1])
+    for c in range(self.C): A += n[c] * Xprod[c]
+    Ainv = numpy.linalg.inv(A)
+    return Ainv, numpy.dot(Ainv, numpy.dot(X.T / self.sigma, Fn))
+
+  def accumulate(self, acc, Ainv, e, n, Fn):
+    for c in range(self.C): acc[0][c] += n[c] * (Ainv + numpy.outer(e, e))
+    acc[1] += numpy.outer(Fn, e)
+
+  def update_subspace(self, acc):
+    D = self.D
+    X = numpy.ndarray(acc[1].shape)
+    for c in range(self.C):
+      X[c*D:(c+1)*D] = numpy.dot(acc[1][c*D:(c+1)*D], numpy.linalg.inv(acc[0][c]))
+    return X
+
+  def client_stats(self, i):
+    N = sum([gs.n for gs in self.stats[i]])
+    F = sum([gs.sum_px.flatten() for gs in self.stats[i]])
+    return N, F
+
+  def update_y(self):
+    Vprod = self.prod(self.v)
+    ys, acc = [], [numpy.zeros((self.C,) + Vprod[0].shape), numpy.zeros(self.v.shape)]
+    for i in range(len(self.stats)):
+      N, F = self.client_stats(i)
+      Fn = F - self.rep(N) * (self.m + self.d * self.z[i])
+      for h, gs in enumerate(self.stats[i]):
+        Fn -= self.rep(gs.n) * numpy.dot(self.u, self.x[i][:,h])
+      Ainv, y = self.posterior(self.v, Vprod, N, Fn)
+      self.accumulate(acc, Ainv, y, N, Fn)
+      ys.append(y)
+    return ys, acc
+
+  def update_x(self):
+    Uprod = self.prod(self.u)
+    xs, acc = [], [numpy.zeros((self.C,) + Uprod[0].shape), numpy.zeros(self.u.shape)]
+    for i in range(len(self.stats)):
+      x = numpy.ndarray(self.x[i].shape)
+      for h, gs in enumerate(self.stats[i]):
+        Fn = gs.sum_px.flatten() - self.rep(gs.n) * (self.m + self.d * self.z[i] + numpy.dot(self.v, self.y[i]))
+        Ainv, x[:,h] = self.posterior(self.u, Uprod, gs.n, Fn)
+        self.accumulate(acc, Ainv, x[:,h], gs.n, Fn)
+      xs.append(x)
+    return xs, acc
+
+  def update_z(self):
+    zs, acc = [], [numpy.zeros(self.d.shape), numpy.zeros(self.d.shape)]
+    for i in range(len(self.stats)):
+      N, F = self.client_stats(i)
+      Fn = F - self.rep(N) * (self.m + numpy.dot(self.v, self.y[i]))
+      for h, gs in enumerate(self.stats[i]):
+        Fn -= self.rep(gs.n) * numpy.dot(self.u, self.x[i][:,h])
+      Ainv = 1. / (1. + self.d / self.sigma * self.d * self.rep(N))
+      z = Ainv * self.d / self.sigma * Fn
+      acc[0] += (Ainv + z * z) * self.rep(N)
+      acc[1] += Fn * z
+      zs.append(z)
+    return zs, acc
+
+
  
 
 class FATrainerTest(unittest.TestCase):
@@ -318,3 +400,79 @@ class FATrainerTest(unittest.TestCase):
     
     self.assertTrue( numpy.allclose(u1, u2, eps) )
     self.assertTrue( numpy.allclose(d1, d2, eps) )
+
+
+  def test08_JFATrainerBatches(self):
+    # Checks that the batched E-steps give the same latent variables,
+    # accumulators and V/U/d updates as the per-client and per-session
+    # computations, with more clients and sessions than in a batch
+    C, D, ru, rv = 3, 4, 2, 3
+    rng = numpy.random.RandomState(0)
+    ubm = bob.machine.GMMMachine(C, D)
+    ubm.mean_supervector = rng.normal(size=(C*D,))
+    ubm.variance_supervector = rng.uniform(0.5, 1.5, size=(C*D,))
+    stats = []
+    for i in range(70):
+      sessions = []
+      for h in range(1 + i % 3):
+        gs = bob.machine.GMMStats(C, D)
+        gs.n = rng.uniform(0.5, 10., size=(C,))
+        gs.sum_px = rng.normal(size=(C,D)) * gs.n.reshape((C,1))
+        sessions.append(gs)
+      stats.append(sessions)
+    u = rng.normal(size=(C*D,ru))
+    v = rng.normal(size=(C*D,rv))
+    d = rng.uniform(0.1, 1., size=(C*D,))
+    x = [rng.normal(size=(ru,len(s))) for s in stats]
+    y = [rng.normal(size=(rv,)) for s in stats]
+    z = [rng.normal(size=(C*D,)) for s in stats]
+
+    ref = FAReference(ubm, stats, u, v, d, x, y, z)
+    y_ref, acc_v = ref.update_y()
+    v_ref = ref.update_subspace(acc_v)
+    x_ref, acc_u = ref.update_x()
+    u_ref = ref.update_subspace(acc_u)
+    z_ref, acc_d = ref.update_z()
+    d_ref = acc_d[1] / acc_d[0]
+
+    eps = 1e-10
+    for n_threads in (1, 3):
+      m = bob.machine.JFABase(ubm, ru, rv)
+      t = bob.trainer.JFATrainer(10)
+      t.n_threads = n_threads
+      t.initialize(m, stats)
+      m.u = u
+      m.v = v
+      m.d = d
+      t.__X__ = x
+      t.__Y__ = y
+      t.__Z__ = z
+
+      t.e_step1(m, stats)
+      t.m_step1(m, stats)
+      for i in range(len(stats)):
+        self.assertTrue(numpy.allclose(t.__Y__[i], y_ref[i], eps, eps))
+      self.assertTrue(numpy.allclose(t.acc_v_a1, acc_v[0], eps, eps))
+      self.assertTrue(numpy.allclose(t.acc_v_a2, acc_v[1], eps, eps))
+      self.assertTrue(numpy.allclose(m.v, v_ref, eps, eps))
+
+      # NB: the U and d updates use the initial V and y
+      m.v = v
+      t.__Y__ = y
+      t.e_step2(m, stats)
+      t.m_step2(m, stats)
+      for i in range(len(stats)):
+        self.assertTrue(numpy.allclose(t.__X__[i], x_ref[i], eps, eps))
+      self.assertTrue(numpy.allclose(t.acc_u_a1, acc_u[0], eps, eps))
+      self.assertTrue(numpy.allclose(t.acc_u_a2, acc_u[1], eps, eps))
+      self.assertTrue(numpy.allclose(m.u, u_ref, eps, eps))
+
+      m.u = u
+      t.__X__ = x
+      t.e_step3(m, stats)
+      t.m_step3(m, stats)
+      for i in range(len(stats)):
+        self.assertTrue(numpy.allclose(t.__Z__[i], z_ref[i], eps, eps))
+      self.assertTrue(numpy.allclose(t.acc_d_a1, acc_d[0], eps, eps))
+      self.assertTrue(numpy.allclose(t.acc_d_a2, acc_d[1], eps, eps))
+      self.assertTrue(numpy.allclose(m.d, d_ref, eps, eps))
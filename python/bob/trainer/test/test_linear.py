@@ -8,8 +8,12 @@
 """Test trainers for the LinearMachine
 """
 
+import os
 import numpy
+import tempfile
 
+from ...core.random import mt19937
+from ...io import HDF5File
 from ...machine import LinearMachine
 from .. import PCATrainer, FisherLDATrainer, WhiteningTrainer, EMPCATrainer, WCCNTrainer
 
@@ -175,6 +179,35 @@ def test_pca_svd_vs_cov_random_2():
   assert numpy.allclose(abs(machine_svd.weights/machine_safe_svd.weights), 1.0)
 
 
+def test_pca_randomized_vs_svd():
+
+  # On a low-rank data set, the randomized range finder should recover the
+  # leading eigen values and the subspace of the leading eigen vectors
+  numpy.random.seed(11)
+  data = numpy.dot(numpy.random.randn(200,5), numpy.random.randn(5,50)) + \
+      numpy.random.rand(50)
+
+  T = PCATrainer()
+  machine_svd, eig_vals_svd = T.train(data)
+
+  for rank in (3, 5):
+    T.rank = rank
+    T.rng = mt19937(42)
+    machine, eig_vals = T.train(data)
+
+    assert machine.weights.shape == (50,rank)
+    assert numpy.allclose(eig_vals, eig_vals_svd[:rank])
+    assert numpy.allclose(machine.input_subtract, machine_svd.input_subtract)
+    W = machine.weights
+    W_svd = machine_svd.weights[:,:rank]
+    assert numpy.allclose(numpy.dot(W, W.T), numpy.dot(W_svd, W_svd.T))
+
+    # the same seed gives the same machine
+    T.rng = mt19937(42)
+    machine2, eig_vals2 = T.train(data)
+    assert numpy.allclose(machine2.weights, machine.weights)
+    assert numpy.allclose(eig_vals2, eig_vals)
+
 def test_fisher_lda_settings():
 
   t = FisherLDATrainer()
@@ -459,3 +492,54 @@ def test_wccn_train():
   assert numpy.allclose(m2.input_subtract, mean_ref, eps, eps)
   assert numpy.allclose(m2.weights, weight_ref, eps, eps)
   assert numpy.allclose(s2, sample_wccn_ref, eps, eps)
+
+def same_directions(w1, w2):
+  """Checks that the columns of w1 and w2 are equal, up to their sign"""
+  signs = numpy.sign((w1 * w2).sum(axis=0))
+  return numpy.allclose(w1, w2 * signs)
+
+def test_train_hdf5():
+
+  # The streaming trainers should give the in-memory results, whatever the
+  # block size and whether the samples were stored at once or appended
+  numpy.random.seed(7)
+  data = [numpy.random.rand(50,5) + 2*k for k in range(3)]
+
+  filename = str(tempfile.mkstemp(".hdf5")[1])
+  try:
+    f = HDF5File(filename, 'w')
+    for k, d in enumerate(data):
+      f.set('set%d' % k, d)
+      for row in d: f.append('appended%d' % k, row)
+    del f
+
+    f = HDF5File(filename)
+    pca = PCATrainer(False) #the streaming PCA uses the covariance method
+    pca_ref, pca_vals_ref = pca.train(data[0])
+    lda = FisherLDATrainer()
+    lda_ref, lda_vals_ref = lda.train(data)
+    whitening = WhiteningTrainer()
+    whitening_ref = whitening.train(data[0])
+
+    for prefix in ('set', 'appended'):
+      paths = ['%s%d' % (prefix, k) for k in range(len(data))]
+      for block_size in (1, 7, 50, 4096):
+        machine, eig_vals = pca.train_hdf5(f, paths[0], block_size)
+        assert numpy.allclose(eig_vals, pca_vals_ref)
+        assert numpy.allclose(machine.input_subtract, pca_ref.input_subtract)
+        assert numpy.allclose(machine.input_divide, pca_ref.input_divide)
+        assert same_directions(machine.weights, pca_ref.weights)
+
+        machine, eig_vals = lda.train_hdf5(f, paths, block_size)
+        assert numpy.allclose(eig_vals, lda_vals_ref)
+        assert numpy.allclose(machine.input_subtract, lda_ref.input_subtract)
+        assert same_directions(machine.weights, lda_ref.weights)
+
+        machine = whitening.train_hdf5(f, paths[0], block_size)
+        assert numpy.allclose(machine.input_subtract,
+            whitening_ref.input_subtract)
+        assert numpy.allclose(machine.weights, whitening_ref.weights)
+
+    del f
+  finally:
+    os.unlink(filename)
@@ -26,7 +26,7 @@ class MaxDetector(CVDetector):
     Keyword Parameters:
 
     model
-      file containing the model to be loaded; **note**: Serialization will use a native text format by default. Files that have their names suffixed with '.gz' will be automatically decompressed. If the filename ends in '.vbin' or '.vbgz' the format used will be the native binary format.
+      file containing the model to be loaded; **note**: Serialization will use a native text format by default. Files that have their names suffixed with '.gz' will be automatically decompressed. If the filename ends in '.vbin' or '.vbgz' the format used will be the native binary format. If the filename ends in '.vflat' the flat binary format is used, which is memory-mapped on loading.
 
     threshold
       object classification threshold
@@ -76,7 +76,7 @@ class Detector(CVDetector):
     Keyword Parameters:
 
     model
-      file containing the model to be loaded; **note**: Serialization will use a native text format by default. Files that have their names suffixed with '.gz' will be automatically decompressed. If the filename ends in '.vbin' or '.vbgz' the format used will be the native binary format.
+      file containing the model to be loaded; **note**: Serialization will use a native text format by default. Files that have their names suffixed with '.gz' will be automatically decompressed. If the filename ends in '.vbin' or '.vbgz' the format used will be the native binary format. If the filename ends in '.vflat' the flat binary format is used, which is memory-mapped on loading.
 
     threshold
       object classification threshold
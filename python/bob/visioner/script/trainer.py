@@ -87,6 +87,9 @@ def main():
       dest = 'subwindow_labelling', help=bob.visioner.param.subwindow_labelling.__doc__ + " (options: %s; default: %%(default)s)" % '|'.join(bob.visioner.TAGGERS))
   parser.add_argument("-y", "--threads", dest="threads", type=int,
       default=0, help="Set to zero to execute the training in the current thread, set to 1 or greater to spawn that many threads (defaults to %(default)s)")
+  parser.add_argument("-C", "--compact", dest="compact",
+      default=False, action='store_true',
+      help="keep the per-sample scores in single precision during training, which reduces the memory usage and traffic")
   parser.add_argument("-v", "--verbose", dest="verbose",
       default=False, action='store_true',
       help="enable verbose output")
@@ -113,7 +116,7 @@ def main():
   if args.verbose: print("Ok. Loading time was %.2f seconds" % total)
 
   if args.verbose: print("Training the model...")
-  train_ok = model.train(training, validation)
+  train_ok = model.train(training, validation, args.threads, args.compact)
   
   if not train_ok:
     raise RuntimeError("A training error was detected... Cannot save model.")
@@ -26,6 +26,21 @@ def test_single():
   locdata = processor(ip.rgb_to_gray(io.load(IMAGE)))
   assert locdata is not None
 
+@utils.visioner_available
+def test_flat_model():
+
+  from .. import MaxDetector
+  image = ip.rgb_to_gray(io.load(IMAGE))
+  processor = MaxDetector(scanning_levels=10)
+  filename = utils.temporary_filename(suffix='.vflat')
+  try:
+    # the memory-mapped model should give the same detections
+    processor.save(filename)
+    flat = MaxDetector(model_file=filename, scanning_levels=10)
+    assert processor.detect(image) == flat.detect(image)
+  finally:
+    if os.path.exists(filename): os.unlink(filename)
+
 @utils.visioner_available
 @utils.ffmpeg_found()
 def test_faster():
@@ -40,6 +55,71 @@ def test_faster():
     locdata = processor(image)
     assert locdata is not None
 
+@utils.visioner_available
+@utils.ffmpeg_found()
+def test_tracking():
+
+  from .. import MaxDetector
+  video = io.VideoReader(TEST_VIDEO)
+  images = [ip.rgb_to_gray(k) for k in video[:20]]
+  processor = MaxDetector(scanning_levels=10)
+  processor.tracking_period = 5
+
+  # find faces on the video, scanning densely only every 5 frames
+  for image in images:
+    detections = processor.track(image)
+    assert detections is not None
+    assert processor.frame_timing > 0
+
+def overlap(d1, d2):
+  """Jaccard overlap of two (x, y, width, height, score) detections"""
+
+  w = min(d1[0] + d1[2], d2[0] + d2[2]) - max(d1[0], d2[0])
+  h = min(d1[1] + d1[3], d2[1] + d2[3]) - max(d1[1], d2[1])
+  if w <= 0 or h <= 0: return 0.
+  inter = w * h
+  return inter / (d1[2] * d1[3] + d2[2] * d2[3] - inter)
+
+@utils.visioner_available
+@utils.ffmpeg_found()
+def test_tracking_dense():
+
+  from .. import Detector
+  video = io.VideoReader(TEST_VIDEO)
+  images = [ip.rgb_to_gray(k) for k in video[:5]]
+  processor = Detector(scanning_levels=10)
+  processor.tracking_period = 1
+
+  # every frame is scanned densely, as by detect()
+  for image in images:
+    assert processor.track(image) == processor.detect(image)
+
+@utils.visioner_available
+@utils.ffmpeg_found()
+def test_tracking_keeps_face():
+
+  from .. import MaxDetector
+  video = io.VideoReader(TEST_VIDEO)
+  images = [ip.rgb_to_gray(k) for k in video[:5]]
+  processor = MaxDetector(scanning_levels=10)
+  processor.tracking_period = 5
+
+  # the same frame twice: the face of the dense scan is found again
+  dense = processor.track(images[0])
+  assert dense is not None
+  tracked = processor.track(images[0])
+  assert tracked is not None
+  assert tracked[0] == dense[0]
+
+  # the next frames: the face is still found close to the previous one
+  processor.reset_tracking()
+  previous = processor.track(images[0])[0]
+  for image in images[1:]:
+    tracked = processor.track(image)
+    assert tracked is not None
+    assert overlap(tracked[0], previous) > 0.5
+    previous = tracked[0]
+
 @utils.visioner_available
 @utils.ffmpeg_found()
 @nose.tools.nottest
@@ -71,3 +71,40 @@ def test_thorough():
   for image in images:
     locdata = processor(image)
     assert locdata is not None
+
+@utils.visioner_available
+def test_threads():
+
+  from .. import Localizer
+  image = ip.rgb_to_gray(io.load(IMAGE))
+  processor = Localizer()
+  processor.detector.scanning_levels = 10
+
+  # the localization does not depend on the number of threads
+  processor.threads = 0
+  reference = processor.locate_all(processor.detector, image)
+  assert len(reference) >= 1
+  for bbox, points in reference:
+    assert len(points) > 0
+  processor.threads = 4
+  nose.tools.eq_(processor.locate_all(processor.detector, image), reference)
+
+@utils.visioner_available
+def test_locate_all():
+
+  from .. import Localizer
+  image = ip.rgb_to_gray(io.load(IMAGE))
+  processor = Localizer()
+  processor.detector.scanning_levels = 10
+
+  # all the detected faces are localized at once, in the detection order
+  bboxes = [tuple(d[:4]) for d in processor.detector.detect(image)]
+  locdata = processor.locate_all(processor.detector, image)
+  assert len(locdata) >= 1
+  indices = [bboxes.index(k[0]) for k in locdata]
+  nose.tools.eq_(indices, sorted(indices))
+  for bbox, points in locdata:
+    assert len(points) > 0
+    for x, y in points:
+      assert bbox[0] - bbox[2] <= x <= bbox[0] + 2 * bbox[2]
+      assert bbox[1] - bbox[3] <= y <= bbox[1] + 2 * bbox[3]
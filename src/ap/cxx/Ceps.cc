@@ -13,6 +13,48 @@
 #include <bob/ap/Ceps.h>
 #include <bob/core/assert.h>
 #include <bob/core/cast.h>
+#include <bob/core/parallel.h>
+#include <bob/math/gemm.h>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+
+namespace bob { namespace ap { namespace detail {
+
+  /**
+   * Worker of the multi-utterance Ceps extraction: the utterances are
+   * handed out one at a time by bob::core::parallel_queue(), and each
+   * thread uses its own copy of the extractor (with its own caches). The
+   * input signal is copied sample by sample into a buffer owned by the
+   * thread, such that no blitz++ array is referenced by several threads
+   * (their reference counting is not thread-safe).
+   */
+  class CepsOp {
+
+    public:
+
+      CepsOp(std::vector<boost::shared_ptr<bob::ap::Ceps> >& ceps,
+          const std::vector<blitz::Array<double,1> >& inputs,
+          std::vector<blitz::Array<double,2> >& outputs):
+        m_ceps(ceps), m_inputs(inputs), m_outputs(outputs),
+        m_x(ceps.size()) {}
+
+      void operator()(size_t thread, size_t i) {
+        const blitz::Array<double,1>& input = m_inputs[i];
+        blitz::Array<double,1>& x = m_x[thread];
+        x.resize(input.extent(0));
+        for (int k=0; k<input.extent(0); ++k) x(k) = input(k);
+        (*m_ceps[thread])(x, m_outputs[i]);
+      }
+
+    private:
+
+      std::vector<boost::shared_ptr<bob::ap::Ceps> >& m_ceps;
+      const std::vector<blitz::Array<double,1> >& m_inputs;
+      std::vector<blitz::Array<double,2> >& m_outputs;
+      std::vector<blitz::Array<double,1> > m_x;
+  };
+
+}}}
 
 bob::ap::Ceps::Ceps(const double sampling_frequency,
     const double win_length_ms, const double win_shift_ms,
@@ -103,6 +145,9 @@ void bob::ap::Ceps::initCacheDctKernel()
   blitz::secondIndex j;
   double dct_coeff = m_dct_norm ? (double)sqrt(2./(double)(m_n_filters)) : 1.;
   m_dct_kernel = dct_coeff * blitz::cos(M_PI*(i+1)*(j+0.5)/(double)(m_n_filters));
+
+  m_cache_ceps_block.resize(bob::ap::spectrogram_block_size, m_n_ceps);
+  m_cache_energies.resize(bob::ap::spectrogram_block_size);
 }
 
 
@@ -143,26 +188,54 @@ void bob::ap::Ceps::operator()(const blitz::Array<double,1>& input,
   int n_frames=feature_shape(0);
 
   blitz::Range r1(0,m_n_ceps-1);
-  for (int i=0; i<n_frames; ++i) 
+  if (filterBankInBand())
+  {
+    // Processes the frames by blocks: the spectra are computed with a real
+    // FFT, and both the filter bank and the DCT are applied as matrix
+    // products.
+    blitz::Range rall = blitz::Range::all();
+    for (int b=0; b<n_frames; b+=bob::ap::spectrogram_block_size)
+    {
+      const int n = std::min(bob::ap::spectrogram_block_size, n_frames-b);
+      blitz::Range rn(0,n-1);
+      spectrumBlock(input, b, n, m_with_energy ? m_cache_energies.data() : 0);
+      filterBankBlock(n);
+      const blitz::Array<double,2> filters(m_cache_filters_block(rn,rall));
+      blitz::Array<double,2> ceps_block(m_cache_ceps_block(rn,rall));
+      bob::math::gemm_(filters, m_dct_kernel, ceps_block, false, true);
+      for (int k=0; k<n; ++k)
+      {
+        for (int j=0; j<(int)m_n_ceps; ++j)
+          ceps_matrix(b+k,j) = ceps_block(k,j);
+        // Update output with energy if required
+        if (m_with_energy)
+          ceps_matrix(b+k,(int)m_n_ceps) = m_cache_energies(k);
+      }
+    }
+  }
+  else
   {
-    // Set padded frame to zero
-    extractNormalizeFrame(input, i, m_cache_frame_d);
-
-    // Update output with energy if required
-    if (m_with_energy)
-      ceps_matrix(i,(int)m_n_ceps) = logEnergy(m_cache_frame_d);
-
-    // Apply pre-emphasis
-    pre_emphasis(m_cache_frame_d);
-    // Apply the Hamming window
-    hammingWindow(m_cache_frame_d);
-    // Take the power spectrum of the first part of the FFT
-    powerSpectrumFFT(m_cache_frame_d);
-    // Filter with the triangular filter bank (either in linear or Mel domain)
-    filterBank(m_cache_frame_d);
-    // Apply DCT kernel and update the output 
-    blitz::Array<double,1> ceps_matrix_row(ceps_matrix(i,r1));
-    applyDct(ceps_matrix_row);
+    for (int i=0; i<n_frames; ++i)
+    {
+      // Set padded frame to zero
+      extractNormalizeFrame(input, i, m_cache_frame_d);
+
+      // Update output with energy if required
+      if (m_with_energy)
+        ceps_matrix(i,(int)m_n_ceps) = logEnergy(m_cache_frame_d);
+
+      // Apply pre-emphasis
+      pre_emphasis(m_cache_frame_d);
+      // Apply the Hamming window
+      hammingWindow(m_cache_frame_d);
+      // Take the power spectrum of the first part of the FFT
+      powerSpectrumFFT(m_cache_frame_d);
+      // Filter with the triangular filter bank (either in linear or Mel domain)
+      filterBank(m_cache_frame_d);
+      // Apply DCT kernel and update the output 
+      blitz::Array<double,1> ceps_matrix_row(ceps_matrix(i,r1));
+      applyDct(ceps_matrix_row);
+    }
   }
 
   //compute the center of the cut-off frequencies
@@ -185,6 +258,24 @@ void bob::ap::Ceps::operator()(const blitz::Array<double,1>& input,
   }
 }
 
+void bob::ap::Ceps::operator()(
+  const std::vector<blitz::Array<double,1> >& inputs,
+  std::vector<blitz::Array<double,2> >& outputs, const size_t n_threads) const
+{
+  outputs.resize(inputs.size());
+  if (inputs.empty()) return;
+  for (size_t i=0; i<inputs.size(); ++i)
+    outputs[i].resize(getShape(inputs[i]));
+
+  const size_t n = std::min(bob::core::thread_count(n_threads), inputs.size());
+  std::vector<boost::shared_ptr<bob::ap::Ceps> > ceps;
+  for (size_t t=0; t<n; ++t)
+    ceps.push_back(boost::shared_ptr<bob::ap::Ceps>(new bob::ap::Ceps(*this)));
+
+  detail::CepsOp op(ceps, inputs, outputs);
+  bob::core::parallel_queue(op, inputs.size(), n);
+}
+
 void bob::ap::Ceps::applyDct(blitz::Array<double,1>& ceps_row) const
 {
   blitz::firstIndex i;
@@ -8,10 +8,14 @@
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
 
+#include <algorithm>
+#include <cmath>
 #include <bob/ap/Spectrogram.h>
 #include <bob/core/check.h>
 #include <bob/core/assert.h>
 #include <bob/core/cast.h>
+#include <bob/math/gemm.h>
+#include <bob/sp/fftpack.h>
 
 bob::ap::Spectrogram::Spectrogram(const double sampling_frequency,
     const double win_length_ms, const double win_shift_ms,
@@ -252,6 +256,25 @@ void bob::ap::Spectrogram::initCacheFilters()
     // Append filter into the filterbank vector
     m_filter_bank.push_back(filt);
   }
+
+  initCacheFilterBankMatrix();
+}
+
+void bob::ap::Spectrogram::initCacheFilterBankMatrix()
+{
+  // Dense version of the filter bank, such that the filter bank outputs of
+  // a block of frames is the product of their spectra by its transpose
+  const int n_bins = (int)m_win_size/2 + 1;
+  m_filter_bank_matrix.resize(m_n_filters, n_bins);
+  m_filter_bank_matrix = 0.;
+  if (filterBankInBand()) {
+    for (int i=0; i<(int)m_n_filters; ++i) {
+      const blitz::Array<double,1>& filt = m_filter_bank[i];
+      for (int k=0; k<filt.extent(0); ++k)
+        m_filter_bank_matrix(i, m_p_index(i)+k) = filt(k);
+    }
+  }
+  m_cache_filters_block.resize(bob::ap::spectrogram_block_size, m_n_filters);
 }
 
 void bob::ap::Spectrogram::initWinLength()
@@ -267,6 +290,10 @@ void bob::ap::Spectrogram::initWinSize()
   m_fft.setLength(m_win_size);
   m_cache_frame_c1.resize(m_win_size);
   m_cache_frame_c2.resize(m_win_size);
+  // Workspace of the real FFT (see fftpack)
+  m_rfft_wsave.resize(2*m_win_size+15);
+  rffti((int)m_win_size, m_rfft_wsave.data());
+  m_cache_spectrum.resize(bob::ap::spectrogram_block_size, m_win_size/2+1);
 }
 
 void bob::ap::Spectrogram::pre_emphasis(blitz::Array<double,1> &data) const
@@ -330,6 +357,54 @@ void bob::ap::Spectrogram::triangularFilterBank(blitz::Array<double,1>& data) co
   }
 }
 
+void bob::ap::Spectrogram::spectrumBlock(const blitz::Array<double,1>& input,
+  const int begin, const int n, double* log_energies) const
+{
+  const int N = (int)m_win_size;
+  const int n_bins = N/2 + 1;
+  double* frame = m_cache_frame_d.data();
+  for (int k=0; k<n; ++k)
+  {
+    // Extract and normalize frame
+    extractNormalizeFrame(input, begin+k, m_cache_frame_d);
+    if (log_energies)
+      log_energies[k] = logEnergy(m_cache_frame_d);
+    // Apply pre-emphasis
+    pre_emphasis(m_cache_frame_d);
+    // Apply the Hamming window
+    hammingWindow(m_cache_frame_d);
+
+    // Real FFT of the frame, in place. The output is packed as follows:
+    // [X_0, Re(X_1), Im(X_1), ..., Re(X_{N/2-1}), Im(X_{N/2-1}), X_{N/2}]
+    rfftf(N, frame, m_rfft_wsave.data());
+
+    // Magnitude (or energy) of the first half of the spectrum
+    double* spec = m_cache_spectrum.data() + k*n_bins;
+    spec[0] = std::fabs(frame[0]);
+    for (int b=1; b<N/2; ++b)
+      spec[b] = std::sqrt(frame[2*b-1]*frame[2*b-1] + frame[2*b]*frame[2*b]);
+    if (N > 1) spec[N/2] = std::fabs(frame[N-1]);
+    if (m_energy_filter)
+      for (int b=0; b<n_bins; ++b) spec[b] *= spec[b];
+  }
+}
+
+void bob::ap::Spectrogram::filterBankBlock(const int n) const
+{
+  blitz::Range rn(0,n-1);
+  blitz::Range rall = blitz::Range::all();
+  const blitz::Array<double,2> spectrum(m_cache_spectrum(rn,rall));
+  blitz::Array<double,2> filters(m_cache_filters_block(rn,rall));
+  bob::math::gemm_(spectrum, m_filter_bank_matrix, filters, false, true);
+
+  if (m_log_filter)
+  {
+    double* f = m_cache_filters_block.data();
+    for (int k=0; k<n*(int)m_n_filters; ++k)
+      f[k] = (f[k] < m_fb_out_floor ? m_log_fb_out_floor : log(f[k]));
+  }
+}
+
 void bob::ap::Spectrogram::operator()(const blitz::Array<double,1>& input,
   blitz::Array<double,2>& spectrogram_matrix)
 {
@@ -339,6 +414,27 @@ void bob::ap::Spectrogram::operator()(const blitz::Array<double,1>& input,
   bob::core::array::assertSameShape(spectrogram_matrix, spectrogram_shape);
   int n_frames=spectrogram_shape(0);
 
+  // Processes the frames by blocks: the spectra are computed with a real
+  // FFT, and the filter bank is applied as a matrix product. The frame by
+  // frame implementation below is only used if some triangular filters
+  // reach the second half of the spectrum.
+  if (!m_energy_bands || filterBankInBand())
+  {
+    const int n_bins = spectrogram_shape(1);
+    for (int b=0; b<n_frames; b+=bob::ap::spectrogram_block_size)
+    {
+      const int n = std::min(bob::ap::spectrogram_block_size, n_frames-b);
+      spectrumBlock(input, b, n);
+      if (m_energy_bands) filterBankBlock(n);
+      const blitz::Array<double,2>& block = m_energy_bands ?
+        m_cache_filters_block : m_cache_spectrum;
+      for (int k=0; k<n; ++k)
+        for (int j=0; j<n_bins; ++j)
+          spectrogram_matrix(b+k,j) = block(k,j);
+    }
+    return;
+  }
+
   // Computes the center of the cut-off frequencies
   blitz::Range r1 = blitz::Range(0,m_win_size/2);
   if (m_energy_bands)
@@ -0,0 +1,187 @@
+/**
+ * @file ap/cxx/test/ceps.cc
+ * @date Sun Oct 18 21:12:45 2026 +0200
+ *
+ * @brief Compares the block-wise and multi-utterance spectrogram and
+ * cepstral extraction with the frame by frame computation
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ap-Ceps Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/random.hpp>
+#include <blitz/array.h>
+#include <cmath>
+#include <vector>
+
+#include <bob/ap/Spectrogram.h>
+#include <bob/ap/Ceps.h>
+
+namespace bob { namespace ap {
+
+  /**
+   * Computes the static cepstral coefficients (and the log-energy) of each
+   * frame one after the other, as the Ceps extractor does when its filter
+   * bank reaches the second half of the spectrum.
+   */
+  class TestCeps {
+    public:
+      static void frameByFrame(bob::ap::Ceps& ceps,
+        const blitz::Array<double,1>& input, blitz::Array<double,2>& output)
+      {
+        const int n_frames = ceps.getShape(input)(0);
+        const int n_ceps = (int)ceps.m_n_ceps;
+        output.resize(n_frames, n_ceps + (ceps.m_with_energy ? 1 : 0));
+        blitz::Range r1(0, n_ceps-1);
+        for (int i=0; i<n_frames; ++i) {
+          ceps.extractNormalizeFrame(input, i, ceps.m_cache_frame_d);
+          if (ceps.m_with_energy)
+            output(i, n_ceps) = ceps.logEnergy(ceps.m_cache_frame_d);
+          ceps.pre_emphasis(ceps.m_cache_frame_d);
+          ceps.hammingWindow(ceps.m_cache_frame_d);
+          ceps.powerSpectrumFFT(ceps.m_cache_frame_d);
+          ceps.filterBank(ceps.m_cache_frame_d);
+          blitz::Array<double,1> row(output(i, r1));
+          ceps.applyDct(row);
+        }
+      }
+  };
+
+}}
+
+/**
+ * Spectrogram computed frame by frame
+ */
+class FrameSpectrogram: public bob::ap::Spectrogram {
+  public:
+    FrameSpectrogram(const double sampling_frequency):
+      bob::ap::Spectrogram(sampling_frequency) {}
+
+    void frameByFrame(const blitz::Array<double,1>& input,
+      blitz::Array<double,2>& output)
+    {
+      output.resize(getShape(input));
+      blitz::Range r1(0, output.extent(1)-1);
+      for (int i=0; i<output.extent(0); ++i) {
+        extractNormalizeFrame(input, i, m_cache_frame_d);
+        pre_emphasis(m_cache_frame_d);
+        hammingWindow(m_cache_frame_d);
+        powerSpectrumFFT(m_cache_frame_d);
+        blitz::Array<double,1> row(output(i, r1));
+        if (m_energy_bands) {
+          filterBank(m_cache_frame_d);
+          row = m_cache_filters(r1);
+        }
+        else row = m_cache_frame_d(r1);
+      }
+    }
+};
+
+static const double sampling_frequency = 8000.;
+
+/**
+ * Random signal of the given number of samples, with an optional silence
+ * in the middle (to exercise the energy flooring)
+ */
+static blitz::Array<double,1> make_signal(boost::mt19937& rng, const int n,
+  const bool with_silence=false)
+{
+  boost::normal_distribution<double> normal(0., 1000.);
+  boost::variate_generator<boost::mt19937&, boost::normal_distribution<double> >
+    gen(rng, normal);
+  blitz::Array<double,1> x(n);
+  for (int i=0; i<n; ++i) x(i) = gen();
+  if (with_silence) x(blitz::Range(n/3, n/2)) = 0.;
+  return x;
+}
+
+static void check_close(const blitz::Array<double,2>& a,
+  const blitz::Array<double,2>& b, const double eps)
+{
+  BOOST_REQUIRE_EQUAL(a.extent(0), b.extent(0));
+  BOOST_REQUIRE_EQUAL(a.extent(1), b.extent(1));
+  for (int i=0; i<a.extent(0); ++i)
+    for (int j=0; j<a.extent(1); ++j)
+      BOOST_CHECK_SMALL(a(i,j) - b(i,j), eps * (1. + std::fabs(b(i,j))));
+}
+
+BOOST_AUTO_TEST_SUITE( test_setup )
+
+BOOST_AUTO_TEST_CASE( test_spectrogram_block )
+{
+  boost::mt19937 rng(0);
+  // more frames than in a block
+  const blitz::Array<double,1> x = make_signal(rng, 28000);
+
+  for (int config=0; config<4; ++config) {
+    FrameSpectrogram spectrogram(sampling_frequency);
+    spectrogram.setEnergyBands(config & 1);
+    spectrogram.setEnergyFilter(config & 2);
+
+    blitz::Array<double,2> block(spectrogram.getShape(x)), frame;
+    spectrogram(x, block);
+    spectrogram.frameByFrame(x, frame);
+    BOOST_CHECK(block.extent(0) > bob::ap::spectrogram_block_size);
+    check_close(block, frame, 1e-10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_ceps_block )
+{
+  boost::mt19937 rng(0);
+  const blitz::Array<double,1> x = make_signal(rng, 28000, true);
+
+  for (int config=0; config<4; ++config) {
+    bob::ap::Ceps ceps(sampling_frequency);
+    ceps.setMelScale(config & 1);
+    ceps.setDctNorm(config & 2);
+    ceps.setWithEnergy(true);
+    ceps.setEnergyFloor(10.);
+
+    blitz::Array<double,2> block(ceps.getShape(x)), frame;
+    ceps(x, block);
+    bob::ap::TestCeps::frameByFrame(ceps, x, frame);
+    check_close(block, frame, 1e-10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_ceps_multi_utterance )
+{
+  boost::mt19937 rng(0);
+  std::vector<blitz::Array<double,1> > inputs;
+  for (int i=0; i<7; ++i)
+    inputs.push_back(make_signal(rng, 2000 + 3000*i, true));
+
+  bob::ap::Ceps ceps(sampling_frequency);
+  ceps.setWithEnergy(true);
+  ceps.setWithDelta(true);
+  ceps.setWithDeltaDelta(true);
+  ceps.setEnergyFloor(10.);
+
+  for (size_t n_threads=1; n_threads<=4; ++n_threads) {
+    std::vector<blitz::Array<double,2> > outputs;
+    ceps(inputs, outputs, n_threads);
+    BOOST_REQUIRE_EQUAL(outputs.size(), inputs.size());
+    for (size_t i=0; i<inputs.size(); ++i) {
+      blitz::Array<double,2> output(ceps.getShape(inputs[i]));
+      ceps(inputs[i], output);
+      BOOST_REQUIRE_EQUAL(outputs[i].extent(0), output.extent(0));
+      BOOST_REQUIRE_EQUAL(outputs[i].extent(1), output.extent(1));
+      BOOST_CHECK(blitz::all(outputs[i] == output));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_energy_copy )
+{
+  bob::ap::Ceps ceps(sampling_frequency);
+  ceps.setEnergyFloor(10.);
+  bob::ap::Ceps copy(ceps);
+  BOOST_CHECK_EQUAL(copy.getEnergyFloor(), 10.);
+  BOOST_CHECK(copy == ceps);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
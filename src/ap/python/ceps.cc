@@ -10,11 +10,13 @@
  */
 
 #include <boost/python.hpp>
+#include <boost/python/stl_iterator.hpp>
 #include <bob/ap/FrameExtractor.h>
 #include <bob/ap/Energy.h>
 #include <bob/ap/Spectrogram.h>
 #include <bob/ap/Ceps.h>
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 
 using namespace boost::python;
 
@@ -83,6 +85,25 @@ static object py_ceps_call(bob::ap::Ceps& ceps, bob::python::const_ndarray input
   return ceps_matrix.self();
 }
 
+static list py_ceps_call_many(const bob::ap::Ceps& ceps, object inputs,
+  const size_t n_threads)
+{
+  stl_input_iterator<bob::python::const_ndarray> ibegin(inputs), iend;
+  std::vector<bob::python::const_ndarray> inputs_ref(ibegin, iend);
+  std::vector<blitz::Array<double,1> > inputs_;
+  for (size_t i=0; i<inputs_ref.size(); ++i)
+    inputs_.push_back(inputs_ref[i].bz<double,1>());
+  // Extracts the features without the GIL, as the work is done in C++
+  std::vector<blitz::Array<double,2> > outputs_;
+  {
+    bob::python::no_gil unlock;
+    ceps(inputs_, outputs_, n_threads);
+  }
+  list outputs;
+  for (size_t i=0; i<outputs_.size(); ++i) outputs.append(outputs_[i]);
+  return outputs;
+}
+
 void bind_ap_ceps()
 {
   class_<bob::ap::FrameExtractor, boost::shared_ptr<bob::ap::FrameExtractor> >("FrameExtractor", FRAME_EXTRACTOR_DOC, init<const double, optional<const double, const double> >((arg("self"), arg("sampling_frequency"), arg("win_length_ms")=20., arg("win_shift_ms")=10.)))
@@ -135,6 +156,7 @@ void bind_ap_ceps()
     .add_property("with_delta", &bob::ap::Ceps::getWithDelta, &bob::ap::Ceps::setWithDelta, "Tells if we add the first derivatives to the output feature")
     .add_property("with_delta_delta", &bob::ap::Ceps::getWithDeltaDelta, &bob::ap::Ceps::setWithDeltaDelta, "Tells if we add the second derivatives to the output feature")
     .def("__call__", &py_ceps_call, (arg("self"), arg("input")), "Computes the cepstral coefficients")
+    .def("extract", &py_ceps_call_many, (arg("self"), arg("inputs"), arg("n_threads")=0), "Computes the cepstral coefficients of a list of 1D audio signals, which are distributed between n_threads threads (0 means all hardware threads). Returns the list of the corresponding 2D feature arrays.")
   ;
 }
 
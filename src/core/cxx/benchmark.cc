@@ -0,0 +1,162 @@
+/**
+ * @file core/cxx/benchmark.cc
+ * @date Sun Oct 18 19:05:12 2026 +0200
+ *
+ * @brief Implementation of the micro-benchmark harness
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/core/benchmark.h>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+bob::core::BenchmarkSuite::BenchmarkSuite(const std::string& name, int argc,
+    char** argv):
+  m_name(name), m_repetitions(10), m_warmup(1), m_format("text"),
+  m_running(false), m_iteration(0)
+{
+  parse(argc, argv);
+}
+
+void bob::core::BenchmarkSuite::parse(int argc, char** argv)
+{
+  for (int i=1; i<argc; ++i) {
+    const std::string arg(argv[i]);
+    if (arg.compare(0, 2, "--") != 0) {
+      m_arguments.push_back(arg);
+      continue;
+    }
+    const size_t eq = arg.find('=');
+    if (eq == std::string::npos) {
+      boost::format m("benchmark option '%s' should be of the form --option=value");
+      m % arg;
+      throw std::runtime_error(m.str());
+    }
+    const std::string key = arg.substr(2, eq-2);
+    const std::string value = arg.substr(eq+1);
+    if (key == "repetitions") m_repetitions = boost::lexical_cast<size_t>(value);
+    else if (key == "warmup") m_warmup = boost::lexical_cast<size_t>(value);
+    else if (key == "filter") m_filter = value;
+    else if (key == "format") {
+      if (value != "text" && value != "csv" && value != "json") {
+        boost::format m("unknown benchmark output format '%s' (should be text, csv or json)");
+        m % value;
+        throw std::runtime_error(m.str());
+      }
+      m_format = value;
+    }
+    else {
+      boost::format m("unknown benchmark option '%s'");
+      m % arg;
+      throw std::runtime_error(m.str());
+    }
+  }
+  if (m_repetitions == 0)
+    throw std::runtime_error("the number of benchmark repetitions should be strictly positive");
+}
+
+bool bob::core::BenchmarkSuite::enabled(const std::string& name) const
+{
+  return m_filter.empty() || name.find(m_filter) != std::string::npos;
+}
+
+bool bob::core::BenchmarkSuite::iterate(const std::string& name,
+  const std::string& size)
+{
+  const boost::posix_time::ptime now =
+    boost::posix_time::microsec_clock::local_time();
+
+  if (!m_running) {
+    if (!enabled(name)) return false;
+    m_running = true;
+    m_case_name = name;
+    m_case_size = size;
+    m_iteration = 0;
+    m_timings.clear();
+    m_start = boost::posix_time::microsec_clock::local_time();
+    return true;
+  }
+
+  // Records the duration of the previous run, if it was not a warm-up one
+  if (m_iteration >= m_warmup)
+    m_timings.push_back((now - m_start).total_microseconds());
+  ++m_iteration;
+
+  if (m_iteration == m_warmup + m_repetitions) {
+    record();
+    m_running = false;
+    return false;
+  }
+
+  m_start = boost::posix_time::microsec_clock::local_time();
+  return true;
+}
+
+void bob::core::BenchmarkSuite::record()
+{
+  std::vector<double> t(m_timings);
+  std::sort(t.begin(), t.end());
+  const size_t n = t.size();
+
+  BenchmarkResult r;
+  r.name = m_case_name;
+  r.size = m_case_size;
+  r.repetitions = n;
+  r.min = t.front();
+  r.max = t.back();
+  r.median = (n % 2) ? t[n/2] : 0.5 * (t[n/2-1] + t[n/2]);
+  double sum = 0.;
+  for (size_t i=0; i<n; ++i) sum += t[i];
+  r.mean = sum / n;
+  m_results.push_back(r);
+
+  // Progress for the human-readable output
+  if (m_format == "text") {
+    std::cerr << m_name << "/" << r.name << " (" << r.size << "): median "
+      << r.median << " us" << std::endl;
+  }
+}
+
+void bob::core::BenchmarkSuite::report(std::ostream& os) const
+{
+  if (m_format == "csv") {
+    os << "suite,name,size,repetitions,min_us,median_us,mean_us,max_us" << std::endl;
+    for (size_t i=0; i<m_results.size(); ++i) {
+      const BenchmarkResult& r = m_results[i];
+      os << m_name << "," << r.name << "," << r.size << "," << r.repetitions
+        << "," << r.min << "," << r.median << "," << r.mean << "," << r.max
+        << std::endl;
+    }
+  }
+  else if (m_format == "json") {
+    os << "{\"suite\": \"" << m_name << "\", \"results\": [";
+    for (size_t i=0; i<m_results.size(); ++i) {
+      const BenchmarkResult& r = m_results[i];
+      os << (i ? ", " : "") << "{\"name\": \"" << r.name
+        << "\", \"size\": \"" << r.size
+        << "\", \"repetitions\": " << r.repetitions
+        << ", \"min_us\": " << r.min << ", \"median_us\": " << r.median
+        << ", \"mean_us\": " << r.mean << ", \"max_us\": " << r.max << "}";
+    }
+    os << "]}" << std::endl;
+  }
+  else {
+    os << boost::format("%-32s %-20s %12s %12s %12s %12s")
+      % (m_name + " benchmark") % "size" % "min (us)" % "median (us)"
+      % "mean (us)" % "max (us)" << std::endl;
+    for (size_t i=0; i<m_results.size(); ++i) {
+      const BenchmarkResult& r = m_results[i];
+      os << boost::format("%-32s %-20s %12.0f %12.0f %12.0f %12.0f")
+        % r.name % r.size % r.min % r.median % r.mean % r.max << std::endl;
+    }
+  }
+}
+
+void bob::core::BenchmarkSuite::report() const
+{
+  report(std::cout);
+}
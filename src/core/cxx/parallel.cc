@@ -0,0 +1,42 @@
+/**
+ * @file core/cxx/parallel.cc
+ * @date Sun Oct 18 10:12:31 2026 +0200
+ *
+ * @brief Implements the loop splitting helpers
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/core/parallel.h>
+
+size_t bob::core::thread_count(const size_t n_threads) {
+  if (n_threads > 0) return n_threads;
+  const size_t hw = boost::thread::hardware_concurrency();
+  return hw > 0 ? hw : 1;
+}
+
+void bob::core::thread_split(const size_t size, std::vector<size_t>& begins,
+    std::vector<size_t>& ends, const size_t n_threads) {
+  begins.resize(n_threads);
+  ends.resize(n_threads);
+  const size_t base = size / n_threads;
+  const size_t extra = size % n_threads;
+  size_t begin = 0;
+  for (size_t i=0; i<n_threads; ++i) {
+    begins[i] = begin;
+    begin += base + (i < extra ? 1 : 0);
+    ends[i] = begin;
+  }
+}
+
+bool bob::core::detail::WorkQueue::pop(size_t& index) {
+  boost::mutex::scoped_lock lock(m_mutex);
+  if (m_next >= m_size) return false;
+  index = m_next++;
+  return true;
+}
+
+void bob::core::detail::WorkQueue::stop() {
+  boost::mutex::scoped_lock lock(m_mutex);
+  m_next = m_size;
+}
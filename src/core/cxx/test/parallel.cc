@@ -0,0 +1,114 @@
+/**
+ * @file core/cxx/test/parallel.cc
+ * @date Sun Oct 18 10:12:31 2026 +0200
+ *
+ * @brief Test the loop splitting helpers
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE core-parallel Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <bob/core/parallel.h>
+
+struct SumOp {
+  const std::vector<int>& data;
+  std::vector<long>& partial;
+  SumOp(const std::vector<int>& d, std::vector<long>& p): data(d), partial(p) {}
+  void operator()(size_t thread, size_t begin, size_t end) {
+    for (size_t i=begin; i<end; ++i) partial[thread] += data[i];
+  }
+};
+
+struct ThrowOp {
+  void operator()(size_t thread, size_t begin, size_t end) {
+    if (thread == 1) throw std::runtime_error("failure in thread");
+  }
+};
+
+struct CountOp {
+  std::vector<int>& counts;
+  std::vector<size_t>& threads;
+  CountOp(std::vector<int>& c, std::vector<size_t>& t): counts(c), threads(t) {}
+  void operator()(size_t thread, size_t i) {
+    ++counts[i];
+    threads[i] = thread;
+  }
+};
+
+struct ThrowItemOp {
+  void operator()(size_t thread, size_t i) {
+    if (i == 5) throw std::runtime_error("failure on item");
+  }
+};
+
+BOOST_AUTO_TEST_SUITE( test_setup )
+
+BOOST_AUTO_TEST_CASE( test_thread_split )
+{
+  std::vector<size_t> begins, ends;
+  bob::core::thread_split(10, begins, ends, 3);
+  BOOST_REQUIRE_EQUAL(begins.size(), 3);
+  BOOST_CHECK_EQUAL(begins[0], 0);
+  BOOST_CHECK_EQUAL(ends[0], 4);
+  BOOST_CHECK_EQUAL(begins[1], 4);
+  BOOST_CHECK_EQUAL(ends[1], 7);
+  BOOST_CHECK_EQUAL(begins[2], 7);
+  BOOST_CHECK_EQUAL(ends[2], 10);
+
+  bob::core::thread_split(2, begins, ends, 4);
+  BOOST_CHECK_EQUAL(ends[1], 2);
+  BOOST_CHECK_EQUAL(begins[3], ends[3]);
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_for )
+{
+  std::vector<int> data(1001);
+  for (size_t i=0; i<data.size(); ++i) data[i] = i;
+
+  for (size_t n=1; n<=4; ++n) {
+    std::vector<long> partial(n, 0);
+    SumOp op(data, partial);
+    bob::core::parallel_for(op, data.size(), n);
+    long total = 0;
+    for (size_t i=0; i<n; ++i) total += partial[i];
+    BOOST_CHECK_EQUAL(total, 500500);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_for_exception )
+{
+  ThrowOp op;
+  BOOST_CHECK_THROW(bob::core::parallel_for(op, 10, 3), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_queue )
+{
+  const size_t sizes[] = { 0, 1, 3, 1001 };
+  for (size_t s=0; s<sizeof(sizes)/sizeof(sizes[0]); ++s) {
+    for (size_t n=1; n<=4; ++n) {
+      std::vector<int> counts(sizes[s], 0);
+      std::vector<size_t> threads(sizes[s], 0);
+      CountOp op(counts, threads);
+      bob::core::parallel_queue(op, sizes[s], n);
+      for (size_t i=0; i<sizes[s]; ++i) {
+        BOOST_CHECK_EQUAL(counts[i], 1);
+        BOOST_CHECK(threads[i] < std::min(n, sizes[s]));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_queue_exception )
+{
+  ThrowItemOp op;
+  BOOST_CHECK_THROW(bob::core::parallel_queue(op, 10, 1), std::runtime_error);
+  BOOST_CHECK_THROW(bob::core::parallel_queue(op, 10, 3), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -9,21 +9,186 @@
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
 
-#include <sstream>
 #include <fstream>
 #include <string>
+#include <cstdlib>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
-#include <boost/filesystem.hpp>
 #include <boost/make_shared.hpp>
-#include <boost/tokenizer.hpp>
-
-#include <boost/shared_array.hpp>
-#include <boost/algorithm/string.hpp>
+#include <boost/cstdint.hpp>
 
+#include <bob/core/parallel.h>
 #include <bob/io/CodecRegistry.h>
 
-typedef boost::tokenizer<boost::escaped_list_separator<char> > Tokenizer;
+/**
+ * Number of bytes read at once while indexing the file and while reading
+ * all of its lines. Blocks of lines bigger than the threshold are parsed
+ * using the number of threads set in the codec registry.
+ */
+static const size_t CSV_INDEX_BLOCK_SIZE = 1 << 20;
+static const size_t CSV_BLOCK_SIZE = 1 << 25;
+static const size_t CSV_PARALLEL_THRESHOLD = 1 << 20;
+
+/**
+ * Exact powers of ten, for the fast path of the number parser
+ */
+static const double CSV_POW10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool csv_is_blank(const char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool csv_is_digit(const char c) {
+  return c >= '0' && c <= '9';
+}
+
+/**
+ * Parses a floating-point number starting at p and stores it into value.
+ * Returns a pointer to the first character after the number or 0 if no
+ * number could be parsed. Plain decimal numbers with up to 19 significant
+ * digits and small exponents are converted exactly without calling the C
+ * library (mantissa and power of ten are both exactly representable). The
+ * other cases (long mantissas, large exponents, inf, nan...) are delegated
+ * to strtod(), which stops at the separators and at the NUL character that
+ * terminates the buffers.
+ */
+static const char* csv_parse_double(const char* p, const char* end,
+    double& value) {
+
+  const char* q = p;
+  bool negative = false;
+  if (q < end && (*q == '-' || *q == '+')) negative = (*(q++) == '-');
+
+  boost::uint64_t mantissa = 0;
+  int digits = 0; ///< significant digits stored in the mantissa
+  int exponent = 0;
+  bool any = false;
+  bool exact = true;
+
+  for (; q < end && csv_is_digit(*q); ++q) {
+    any = true;
+    if (digits < 19) {
+      mantissa = 10 * mantissa + (*q - '0');
+      if (mantissa) ++digits;
+    }
+    else {
+      ++exponent;
+      exact = false;
+    }
+  }
+
+  if (q < end && *q == '.') {
+    for (++q; q < end && csv_is_digit(*q); ++q) {
+      any = true;
+      if (digits < 19) {
+        mantissa = 10 * mantissa + (*q - '0');
+        if (mantissa) ++digits;
+        --exponent;
+      }
+      else exact = false;
+    }
+  }
+
+  if (any && q < end && (*q == 'e' || *q == 'E')) {
+    const char* r = q + 1;
+    bool negative_exponent = false;
+    if (r < end && (*r == '-' || *r == '+')) negative_exponent = (*(r++) == '-');
+    if (r < end && csv_is_digit(*r)) {
+      int e = 0;
+      for (; r < end && csv_is_digit(*r); ++r) if (e < 100000) e = 10 * e + (*r - '0');
+      exponent += negative_exponent ? -e : e;
+      q = r;
+    }
+    else exact = false; ///< let strtod() decide
+  }
+
+  if (any && exact && mantissa <= (boost::uint64_t(1) << 53) &&
+      exponent >= -22 && exponent <= 22) {
+    value = static_cast<double>(mantissa);
+    if (exponent < 0) value /= CSV_POW10[-exponent];
+    else value *= CSV_POW10[exponent];
+    if (negative) value = -value;
+    return q;
+  }
+
+  char* stop = 0;
+  value = std::strtod(p, &stop);
+  if (stop == p || stop > end) return 0;
+  return stop;
+}
+
+/**
+ * Parses a line [begin, end) containing n comma-separated numbers into out.
+ * Entries may be surrounded by blanks and by double quotes. Returns the
+ * (1-based) index of the first entry that could not be parsed or 0 on
+ * success.
+ */
+static size_t csv_parse_line(const char* begin, const char* end,
+    double* out, const size_t n) {
+
+  const char* p = begin;
+  for (size_t k=0; k<n; ++k) {
+    while (p < end && csv_is_blank(*p)) ++p;
+    const bool quoted = (p < end && *p == '"');
+    if (quoted) ++p;
+    p = csv_parse_double(p, end, out[k]);
+    if (!p) return k+1;
+    if (quoted) {
+      if (p == end || *p != '"') return k+1;
+      ++p;
+    }
+    while (p < end && csv_is_blank(*p)) ++p;
+    if (k+1 < n) {
+      if (p == end || *p != ',') return k+1;
+      ++p;
+    }
+    else if (p != end) return k+1;
+  }
+  return 0;
+}
+
+/**
+ * Parses a block of lines, possibly in parallel. Lines are given by their
+ * offsets in the block: line i spans [starts[i], starts[i+1]).
+ */
+class CSVParseOp {
+
+  public:
+
+    CSVParseOp(const char* block, const std::vector<size_t>& starts,
+        double* out, const size_t n_columns, const size_t first_line,
+        const std::string& filename):
+      m_block(block), m_starts(starts), m_out(out), m_n_columns(n_columns),
+      m_first_line(first_line), m_filename(filename) {}
+
+    void operator()(const size_t, const size_t begin, const size_t end) const {
+      for (size_t i=begin; i<end; ++i) {
+        const char* b = m_block + m_starts[i];
+        const char* e = m_block + m_starts[i+1];
+        if (e > b && *(e-1) == '\n') --e;
+        const size_t error = csv_parse_line(b, e, m_out + i*m_n_columns,
+            m_n_columns);
+        if (error) {
+          boost::format m("cannot parse entry %u of line %u at file '%s' as a number");
+          m % error % (m_first_line + i + 1) % m_filename;
+          throw std::runtime_error(m.str());
+        }
+      }
+    }
+
+  private:
+
+    const char* m_block;
+    const std::vector<size_t>& m_starts;
+    double* m_out;
+    size_t m_n_columns;
+    size_t m_first_line;
+    const std::string& m_filename;
+
+};
 
 class CSVFile: public bob::io::File {
 
@@ -36,26 +201,51 @@ class CSVFile: public bob::io::File {
      */
     void peek() {
 
-      std::string line;
       size_t line_number = 0;
       size_t entries = 0;
-      std::streampos cur_pos = 0;
+      size_t offset = 0;
+
+      // state of the current line
+      bool in_line = false;
+      bool non_empty = false;
+      bool quoted = false;
+      bool escaped = false;
+      size_t separators = 0;
 
+      m_pos.clear();
+      if (m_file.eof()) m_file.clear();
       m_file.seekg(0); //< returns to the begin of file and start reading...
 
-      while (std::getline(m_file,line)) {
-        ++line_number;
-        m_pos.push_back(cur_pos);
-        cur_pos = m_file.tellg();
-        Tokenizer tok(line);
-        size_t size = std::distance(tok.begin(), tok.end());
-        if (!entries) entries = size;
-        else if (entries != size) {
-          boost::format m("line %d at file '%s' contains %d entries instead of %d (expected)");
-          m % line_number % m_filename % size % entries;
-          throw std::runtime_error(m.str());
+      m_buffer.resize(CSV_INDEX_BLOCK_SIZE);
+      while (m_file.read(&m_buffer[0], m_buffer.size()) || m_file.gcount()) {
+        const size_t n = m_file.gcount();
+        for (size_t k=0; k<n; ++k) {
+          const char c = m_buffer[k];
+          if (!in_line) {
+            m_pos.push_back(offset + k);
+            in_line = true;
+            non_empty = quoted = escaped = false;
+            separators = 0;
+          }
+          if (c == '\n') {
+            check_line(++line_number, non_empty ? separators + 1 : 0, entries);
+            in_line = false;
+            continue;
+          }
+          non_empty = true;
+          if (escaped) escaped = false;
+          else if (c == '\\') escaped = true;
+          else if (c == '"') quoted = !quoted;
+          else if (c == ',' && !quoted) ++separators;
         }
+        offset += n;
       }
+      if (in_line) check_line(++line_number, non_empty ? separators + 1 : 0,
+          entries);
+
+      m_file.clear(); ///< clear the "end" state, for appending
+      m_end = offset;
+      std::vector<char>().swap(m_buffer); ///< gives the memory back
 
       if (!line_number) {
         m_newfile = true;
@@ -77,7 +267,8 @@ class CSVFile: public bob::io::File {
 
     CSVFile(const std::string& path, char mode):
       m_filename(path),
-      m_newfile(false) {
+      m_newfile(false),
+      m_end(0) {
 
         if (mode == 'r' || (mode == 'a' && boost::filesystem::exists(path))) { //try peeking
           
@@ -139,17 +330,30 @@ class CSVFile: public bob::io::File {
 
       if (!buffer.type().is_compatible(m_array_type)) buffer.set(m_array_type);
 
-      //read contents
-      std::string line;
-      if (m_file.eof()) m_file.clear(); ///< clear current "end" state.
-      m_file.seekg(0);
+      //read contents, block of lines by block of lines
+      const size_t n_lines = m_pos.size();
+      const size_t n_columns = m_arrayset_type.shape[0];
       double* p = static_cast<double*>(buffer.ptr());
-      while (std::getline(m_file, line)) {
-        Tokenizer tok(line);
-        for(Tokenizer::iterator k=tok.begin(); k!=tok.end(); ++k) {
-          std::istringstream(*k) >> *(p++);
-        }
+      const size_t n_threads = bob::io::CodecRegistry::nThreads();
+      std::vector<size_t> starts;
+      size_t first = 0;
+      while (first < n_lines) {
+        size_t last = first + 1;
+        while (last < n_lines &&
+            line_start(last+1) - line_start(first) <= CSV_BLOCK_SIZE) ++last;
+
+        const size_t base = line_start(first);
+        read_block(base, line_start(last) - base);
+        starts.resize(last - first + 1);
+        for (size_t i=first; i<=last; ++i) starts[i-first] = line_start(i) - base;
+
+        CSVParseOp op(&m_buffer[0], starts, p + first*n_columns, n_columns,
+            first, m_filename);
+        bob::core::parallel_for(op, last - first,
+            (starts.back() > CSV_PARALLEL_THRESHOLD) ? n_threads : 1);
+        first = last;
       }
+      std::vector<char>().swap(m_buffer); ///< gives the memory back
     }
 
     virtual void read(bob::core::array::interface& buffer, size_t index) {
@@ -167,19 +371,13 @@ class CSVFile: public bob::io::File {
       }
 
       //reads a specific line from the file.
-      std::string line;
-      if (m_file.eof()) m_file.clear(); ///< clear current "end" state.
-      m_file.seekg(m_pos[index]);
-      if (!std::getline(m_file, line)) {
-        boost::format m("could not seek to line %u (offset %u) while reading file '%s'");
-        m % index % m_pos[index] % m_filename;
-        throw std::runtime_error(m.str());
-      }
-      Tokenizer tok(line);
-      double* p = static_cast<double*>(buffer.ptr());
-      for(Tokenizer::iterator k=tok.begin(); k!=tok.end(); ++k) {
-        std::istringstream(*k) >> *(p++);
-      }
+      const size_t base = line_start(index);
+      read_block(base, line_start(index+1) - base);
+      std::vector<size_t> starts(2, 0);
+      starts[1] = line_start(index+1) - base;
+      CSVParseOp op(&m_buffer[0], starts, static_cast<double*>(buffer.ptr()),
+          m_arrayset_type.shape[0], index, m_filename);
+      op(0, 0, 1);
 
     }
 
@@ -215,6 +413,7 @@ class CSVFile: public bob::io::File {
       m_pos.push_back(m_file.tellp()); ///< register start of line
       for (size_t k=1; k<type.shape[0]; ++k) m_file << *(p++) << ",";
       m_file << *(p++);
+      m_end = m_file.tellp();
       m_array_type.shape[0] = m_pos.size();
       m_array_type.update_strides();
       return (m_pos.size()-1);
@@ -239,6 +438,7 @@ class CSVFile: public bob::io::File {
         }
         for (size_t k=1; k<type.shape[1]; ++k) m_file << *(p++) << ",";
         m_file << *(p++);
+        m_end = m_file.tellp();
         m_arrayset_type = type;
         m_arrayset_type.nd = 1;
         m_arrayset_type.shape[0] = type.shape[1];
@@ -253,13 +453,54 @@ class CSVFile: public bob::io::File {
 
     }
 
+  private: //helpers
+
+    /**
+     * Checks the number of entries of a line against the previous ones
+     */
+    void check_line(const size_t line_number, const size_t size,
+        size_t& entries) const {
+      if (!entries) entries = size;
+      else if (entries != size) {
+        boost::format m("line %d at file '%s' contains %d entries instead of %d (expected)");
+        m % line_number % m_filename % size % entries;
+        throw std::runtime_error(m.str());
+      }
+    }
+
+    /**
+     * Offset of the start of a line; the start of the line after the last
+     * one is the end of the file
+     */
+    size_t line_start(const size_t index) const {
+      return (index < m_pos.size()) ? m_pos[index] : m_end;
+    }
+
+    /**
+     * Reads size bytes at the given offset into the (NUL-terminated)
+     * internal buffer
+     */
+    void read_block(const size_t offset, const size_t size) {
+      m_buffer.resize(size + 1);
+      m_buffer[size] = 0;
+      if (m_file.eof()) m_file.clear(); ///< clear current "end" state.
+      m_file.seekg(offset);
+      if (!m_file.read(&m_buffer[0], size)) {
+        boost::format m("could not read %u bytes at offset %u of file '%s'");
+        m % size % offset % m_filename;
+        throw std::runtime_error(m.str());
+      }
+    }
+
   private: //representation
     std::fstream m_file;
     std::string m_filename;
     bool m_newfile;
     bob::core::array::typeinfo m_array_type;
     bob::core::array::typeinfo m_arrayset_type;
-    std::vector<std::streampos> m_pos; ///< dictionary of line starts
+    std::vector<size_t> m_pos; ///< dictionary of line starts
+    size_t m_end; ///< offset of the end of the file
+    std::vector<char> m_buffer; ///< lines being parsed
 
     static std::string s_codecname;
 
@@ -491,6 +491,44 @@ void bob::io::detail::hdf5::Dataset::read_buffer (size_t index, const bob::io::H
   if (status < 0) throw status_error("H5Dread", status);
 }
 
+void bob::io::detail::hdf5::Dataset::read_block_buffer (size_t index,
+    const bob::io::HDF5Type& dest, void* buffer) {
+
+  //the first type lists the stored arrays one by one: a block of them
+  //should have the same element type, with one leading dimension more
+  const bob::io::HDF5Descriptor& d = m_descr[0];
+  const bob::io::HDF5Shape& block = dest.shape();
+  bob::io::HDF5Shape item(block);
+  if (block.n() >= 2) item <<= 1;
+  if (block.n() < 2 || d.hyperslab_count.n() != block.n() ||
+      bob::io::HDF5Type(dest.type(), item) != d.type) {
+    boost::format m("trying to read a block `%s' at `%s' that only accepts `%s'");
+    m % dest.str() % url() % d.type.str();
+    throw std::runtime_error(m.str());
+  }
+
+  //checks indexing
+  if (index + block[0] > d.size) {
+    boost::format m("trying to access elements %d to %d in Dataset '%s' that only contains %d elements");
+    m % index % (index + block[0]) % url() % d.size;
+    throw std::runtime_error(m.str());
+  }
+
+  set_memspace(m_memspace, block);
+
+  bob::io::HDF5Shape start(d.hyperslab_start);
+  start[0] = index;
+
+  herr_t status = H5Sselect_hyperslab(*m_filespace, H5S_SELECT_SET,
+      start.get(), 0, block.get(), 0);
+  if (status < 0) throw status_error("H5Sselect_hyperslab", status);
+
+  status = H5Dread(*m_id, *dest.htype(), *m_memspace, *m_filespace,
+      H5P_DEFAULT, buffer);
+
+  if (status < 0) throw status_error("H5Dread", status);
+}
+
 void bob::io::detail::hdf5::Dataset::write_buffer (size_t index, const bob::io::HDF5Type& dest,
     const void* buffer) {
 
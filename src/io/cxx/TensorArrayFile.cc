@@ -8,9 +8,16 @@
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
 
+#include <algorithm>
 #include <bob/io/TensorFile.h>
 #include <bob/io/CodecRegistry.h>
 
+/**
+ * Maximum number of arrays and of bytes read at once when reading
+ */
+static const size_t TENSOR_READ_AHEAD_ARRAYS = 64;
+static const size_t TENSOR_READ_AHEAD_BYTES = 1 << 20;
+
 class TensorArrayFile: public bob::io::File {
 
   public: //api
@@ -18,7 +25,13 @@ class TensorArrayFile: public bob::io::File {
     TensorArrayFile(const std::string& path, bob::io::TensorFile::openmode mode):
       m_file(path, mode),
       m_filename(path) {
-        if (m_file.size()) m_file.peek(m_type);
+        if (m_file.size()) {
+          m_file.peek(m_type);
+          // lists are mostly scanned sequentially: reads several arrays at once
+          if (mode == bob::io::TensorFile::in)
+            m_file.setReadAhead(std::min(TENSOR_READ_AHEAD_ARRAYS,
+                  TENSOR_READ_AHEAD_BYTES / m_type.buffer_size()));
+        }
       }
 
     virtual ~TensorArrayFile() { }
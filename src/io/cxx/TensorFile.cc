@@ -8,6 +8,7 @@
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
 
+#include <algorithm>
 #include <bob/core/array_type.h>
 #include <bob/io/TensorFile.h>
 #include <bob/io/reorder.h>
@@ -17,7 +18,10 @@ bob::io::TensorFile::TensorFile(const std::string& filename,
   m_header_init(false),
   m_current_array(0),
   m_n_arrays_written(0),
-  m_openmode(flag)
+  m_openmode(flag),
+  m_read_ahead(0),
+  m_ahead_first(0),
+  m_ahead_count(0)
 {
   if((flag & bob::io::TensorFile::out) && (flag & bob::io::TensorFile::in)) {
     m_stream.open(filename.c_str(), std::ios::in | std::ios::out |
@@ -113,6 +117,7 @@ void bob::io::TensorFile::write(const bob::core::array::interface& data) {
 
   bob::io::row_to_col_order(data.ptr(), m_buffer.get(), info);
 
+  prepareWrite();
   m_stream.write(static_cast<const char*>(m_buffer.get()), info.buffer_size());
 
   // increment m_n_arrays_written and m_current_array
@@ -127,6 +132,16 @@ void bob::io::TensorFile::read (bob::core::array::interface& buf) {
   }
   if(!buf.type().is_compatible(m_header.m_type)) buf.set(m_header.m_type);
 
+  if (m_read_ahead > 1) {
+    if (m_current_array < m_ahead_first ||
+        m_current_array >= m_ahead_first + m_ahead_count) fillReadAhead();
+    const size_t size = m_header.m_type.buffer_size();
+    bob::io::col_to_row_order(&m_ahead[(m_current_array - m_ahead_first) * size],
+        buf.ptr(), m_header.m_type);
+    ++m_current_array;
+    return;
+  }
+
   m_stream.read(reinterpret_cast<char*>(m_buffer.get()),
       m_header.m_type.buffer_size());
 
@@ -144,10 +159,126 @@ void bob::io::TensorFile::read (size_t index, bob::core::array::interface& buf)
     throw std::runtime_error(m.str());
   }
 
-  // Set the stream pointer at the correct position
-  m_stream.seekg( m_header.getArrayIndex(index) );
+  // Set the stream pointer at the correct position (the read-ahead buffer
+  // seeks by itself, only if required)
+  if (m_read_ahead <= 1) m_stream.seekg( m_header.getArrayIndex(index) );
   m_current_array = index;
 
   // Put the content of the stream in the blitz array.
   read(buf);
 }
+
+void bob::io::TensorFile::readBlock (size_t index, size_t count,
+    bob::core::array::interface& buf) {
+
+  headerInitialized();
+
+  if (index + count > m_n_arrays_written) {
+    boost::format m("request to read list items [%d, %d) which are outside the bounds of declared object with size %d");
+    m % index % (index + count) % m_n_arrays_written;
+    throw std::runtime_error(m.str());
+  }
+
+  // The block has the shape of the arrays, preceded by count
+  bob::core::array::typeinfo info(m_header.m_type);
+  for (size_t k=info.nd; k>0; --k) info.shape[k] = info.shape[k-1];
+  info.shape[0] = count;
+  ++info.nd;
+  info.update_strides();
+  if(!buf.type().is_compatible(info)) buf.set(info);
+
+  const size_t size = m_header.m_type.buffer_size();
+  if (count) {
+    m_block.resize(count * size);
+    m_stream.seekg(m_header.getArrayIndex(index));
+    if (!m_stream.read(&m_block[0], count * size)) {
+      boost::format m("TensorFile: could not read %d arrays starting at position %d");
+      m % count % index;
+      throw std::runtime_error(m.str());
+    }
+  }
+
+  char* dst = static_cast<char*>(buf.ptr());
+  for (size_t k=0; k<count; ++k)
+    bob::io::col_to_row_order(&m_block[k * size], dst + k * size,
+        m_header.m_type);
+
+  m_current_array = index + count;
+}
+
+void bob::io::TensorFile::writeBlock(const bob::core::array::interface& data) {
+
+  const bob::core::array::typeinfo& info = data.type();
+  if (info.nd < 2) {
+    boost::format m("TensorFile::writeBlock(): cannot split %s into arrays - the block should have at least 2 dimensions");
+    m % info.str();
+    throw std::runtime_error(m.str());
+  }
+
+  // Type of each array of the block
+  bob::core::array::typeinfo array_info(info.dtype, info.nd - 1,
+      &info.shape[1]);
+
+  if (!m_header_init) initHeader(array_info);
+  else {
+    //checks compatibility with previously written stuff
+    if (!m_header.m_type.is_compatible(array_info))
+      throw std::runtime_error("buffer does not conform to expected type");
+  }
+
+  const size_t count = info.shape[0];
+  const size_t size = array_info.buffer_size();
+  if (!count) return;
+
+  m_block.resize(count * size);
+  const char* src = static_cast<const char*>(data.ptr());
+  for (size_t k=0; k<count; ++k)
+    bob::io::row_to_col_order(src + k * size, &m_block[k * size], array_info);
+
+  prepareWrite();
+  m_stream.write(&m_block[0], count * size);
+
+  // increment m_n_arrays_written and m_current_array
+  m_current_array += count;
+  if (m_current_array>m_n_arrays_written) m_n_arrays_written = m_current_array;
+}
+
+void bob::io::TensorFile::setReadAhead(size_t n_arrays) {
+  // Puts the stream back where sequential reads expect it to be
+  if (m_ahead_count) {
+    m_stream.seekg(m_header.getArrayIndex(m_current_array));
+    m_ahead_count = 0;
+  }
+  m_read_ahead = n_arrays;
+  if (m_read_ahead <= 1) std::vector<char>().swap(m_ahead);
+}
+
+void bob::io::TensorFile::fillReadAhead() {
+
+  if (m_current_array >= m_n_arrays_written) {
+    boost::format m("TensorFile: current array index == %d is outside the bounds of declared object with size %d");
+    m % m_current_array % m_n_arrays_written;
+    throw std::runtime_error(m.str());
+  }
+
+  const size_t size = m_header.m_type.buffer_size();
+  const size_t count = std::min(m_read_ahead,
+      m_n_arrays_written - m_current_array);
+  m_ahead.resize(count * size);
+  m_stream.seekg(m_header.getArrayIndex(m_current_array));
+  if (!m_stream.read(&m_ahead[0], count * size)) {
+    boost::format m("TensorFile: could not read %d arrays starting at position %d");
+    m % count % m_current_array;
+    throw std::runtime_error(m.str());
+  }
+  m_ahead_first = m_current_array;
+  m_ahead_count = count;
+}
+
+void bob::io::TensorFile::prepareWrite() {
+  // The stream was moved by the read-ahead: puts it back at the current array
+  if (m_ahead_count) {
+    m_stream.seekp(m_header.getArrayIndex(m_current_array));
+    m_ahead_count = 0;
+  }
+}
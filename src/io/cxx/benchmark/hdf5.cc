@@ -0,0 +1,57 @@
+/**
+ * @file io/cxx/benchmark/hdf5.cc
+ * @date Sun Oct 18 19:55:08 2026 +0200
+ *
+ * @brief Benchmark of the HDF5 array I/O
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/core/array_random.h>
+#include <bob/core/benchmark.h>
+#include <bob/core/logging.h>
+#include <bob/io/HDF5File.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/random.hpp>
+
+void benchmark_hdf5(bob::core::BenchmarkSuite& suite, boost::mt19937& rng,
+  const int N, const int D)
+{
+  blitz::Array<double,1> x(D);
+  bob::core::array::randn(rng, x);
+  const std::string filename = bob::core::tmpfile();
+  const std::string size = (boost::format("%dx%d") % N % D).str();
+
+  while (suite.iterate("HDF5File::appendArray", size)) {
+    bob::io::HDF5File file(filename, 'w');
+    for (int i=0; i<N; ++i) file.appendArray("array", x);
+  }
+
+  {
+    // makes sure the file exists if the previous case was filtered out
+    bob::io::HDF5File file(filename, 'w');
+    for (int i=0; i<N; ++i) file.appendArray("array", x);
+  }
+
+  while (suite.iterate("HDF5File::readArray", size)) {
+    bob::io::HDF5File file(filename, 'r');
+    for (int i=0; i<N; ++i) file.readArray("array", i, x);
+  }
+
+  boost::filesystem::remove(filename);
+}
+
+/*************** HDF5 benchmarks *****************/
+int main(int argc, char** argv)
+{
+  bob::core::BenchmarkSuite suite("io", argc, argv);
+  boost::mt19937 rng(0);
+
+  benchmark_hdf5(suite, rng, 1000, 60);
+  benchmark_hdf5(suite, rng, 10000, 60);
+
+  suite.report();
+  return 0;
+}
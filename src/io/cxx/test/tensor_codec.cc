@@ -18,6 +18,7 @@
 #include <blitz/array.h>
 #include "bob/core/logging.h"
 #include "bob/io/utils.h"
+#include "bob/io/TensorFile.h"
 
 struct T {
   blitz::Array<int8_t,2> a, b;
@@ -72,4 +73,39 @@ BOOST_AUTO_TEST_CASE( tensor_2d_read_T5alpha )
   check_equal( bob::io::load<int8_t,2>(testdata_path.string()), b );
 }
 
+BOOST_AUTO_TEST_CASE( tensor_block_read_write )
+{
+  std::string filename = bob::core::tmpfile(".tensor");
+
+  // 4 arrays of shape 2x3, written at once
+  blitz::Array<int8_t,3> block(4,2,3);
+  block = blitz::tensor::i * 6 + blitz::tensor::j * 3 + blitz::tensor::k;
+  {
+    bob::io::TensorFile out(filename, bob::io::TensorFile::out);
+    out.writeBlock(bob::core::array::blitz_array(block));
+    BOOST_CHECK_EQUAL( out.size(), 4 );
+  }
+
+  bob::io::TensorFile in(filename, bob::io::TensorFile::in);
+  BOOST_REQUIRE_EQUAL( in.size(), 4 );
+  blitz::Array<int8_t,3> middle = in.readBlock<int8_t,3>(1, 2);
+  BOOST_REQUIRE_EQUAL( middle.extent(0), 2 );
+  for (int i=0; i<2; ++i) check_equal( middle(i, blitz::Range::all(),
+        blitz::Range::all()), block(i+1, blitz::Range::all(),
+        blitz::Range::all()) );
+
+  // sequential and indexed reads, served from the read-ahead buffer
+  in.setReadAhead(3);
+  check_equal( in.read<int8_t,2>(0), block(0, blitz::Range::all(),
+        blitz::Range::all()) );
+  for (int i=1; i<4; ++i) check_equal( in.read<int8_t,2>(), block(i,
+        blitz::Range::all(), blitz::Range::all()) );
+  check_equal( in.read<int8_t,2>(2), block(2, blitz::Range::all(),
+        blitz::Range::all()) );
+  BOOST_CHECK_THROW( in.readBlock<int8_t,3>(3, 2), std::runtime_error );
+
+  in.close();
+  boost::filesystem::remove(filename);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
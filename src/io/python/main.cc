@@ -21,6 +21,14 @@ static void set_ignore_double_registration(bool v) {
   bob::io::CodecRegistry::instance()->ignoreDoubleRegistration(v);
 }
 
+static size_t get_n_threads() {
+  return bob::io::CodecRegistry::nThreads();
+}
+
+static void set_n_threads(size_t n) {
+  bob::io::CodecRegistry::nThreads(n);
+}
+
 void bind_io_version();
 void bind_io_file();
 void bind_io_hdf5();
@@ -47,4 +55,7 @@ BOOST_PYTHON_MODULE(_io) {
 
   boost::python::def("__get_ignore_double_registration__", &get_ignore_double_registration);
   boost::python::def("__set_ignore_double_registration__", &set_ignore_double_registration);
+
+  boost::python::def("get_n_threads", &get_n_threads, "Returns the number of threads the codecs may use to decode a file (0 means all the hardware threads).");
+  boost::python::def("set_n_threads", &set_n_threads, (boost::python::arg("n_threads")), "Sets the number of threads the codecs may use to decode a file (0, the default, uses all the hardware threads; 1 decodes in the calling thread only).");
 }
@@ -8,34 +8,299 @@
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
 #include <bob/core/assert.h>
-#include <bob/sp/conv.h>
-#include <bob/sp/extrapolate.h>
+#include <bob/core/check.h>
+#include <bob/core/array_copy.h>
+#include <bob/core/parallel.h>
 #include <bob/ip/HornAndSchunckFlow.h>
 
-static const double LAPLACIAN_014_KERNEL_DATA[] = {0,.25,0,.25,0,.25,0,.25,0};
-static const blitz::Array<double,2> LAPLACIAN_014_KERNEL(const_cast<double*>(LAPLACIAN_014_KERNEL_DATA), blitz::shape(3,3), blitz::neverDeleteData);
+/**
+ * The coarsest level of the multiresolution pyramid is never smaller than
+ * this, in both directions
+ */
+static const int HS_MIN_LEVEL_SIZE = 8;
 
-void bob::ip::optflow::laplacian_avg_hs_opencv(const blitz::Array<double,2>& input,
-    blitz::Array<double,2>& output) {
-  blitz::Array<double,2> inputExtra(bob::sp::getConvOutputSize(input, LAPLACIAN_014_KERNEL, bob::sp::Conv::Full));
-  bob::sp::extrapolateMirror(input, inputExtra);
-  bob::sp::conv(input, LAPLACIAN_014_KERNEL, output,
-      bob::sp::Conv::Valid);
-}
+/**
+ * The averaging kernels of the Laplacian approximations, applied at column x
+ * of a row, given the row above (up), the row itself (mid) and the row below
+ * (down). xm and xp are the columns on the left and on the right, which are
+ * clamped at the borders (mirror extrapolation).
+ */
+struct avg_opencv {
+  static inline double apply(const double* up, const double* mid,
+      const double* down, const int xm, const int x, const int xp) {
+    return .25*up[x] + .25*mid[xm] + .25*mid[xp] + .25*down[x];
+  }
+};
 
 static const double _12 = 1./12.;
 static const double _6 = 1./6.;
-static const double LAPLACIAN_12_KERNEL_DATA[] = {_12,_6,_12,_6,0,_6,_12,_6,_12};
-static const blitz::Array<double,2> LAPLACIAN_12_KERNEL(const_cast<double*>(LAPLACIAN_12_KERNEL_DATA), blitz::shape(3,3), blitz::neverDeleteData);
+
+struct avg_hs {
+  static inline double apply(const double* up, const double* mid,
+      const double* down, const int xm, const int x, const int xp) {
+    return _12*up[xm] + _6*up[x] + _12*up[xp] + _6*mid[xm] + _6*mid[xp] +
+      _12*down[xm] + _6*down[x] + _12*down[xp];
+  }
+};
+
+/**
+ * Applies the averaging kernel to the row y of a (C-contiguous) image of
+ * the given shape
+ */
+template <typename TAvg>
+static inline void avg_row(const double* in, const int height,
+    const int width, const int y, double* out) {
+  const double* up = in + std::max(y-1, 0)*width;
+  const double* mid = in + y*width;
+  const double* down = in + std::min(y+1, height-1)*width;
+  if (width == 1) {
+    out[0] = TAvg::apply(up, mid, down, 0, 0, 0);
+    return;
+  }
+  out[0] = TAvg::apply(up, mid, down, 0, 0, 1);
+  for (int x=1; x<width-1; ++x)
+    out[x] = TAvg::apply(up, mid, down, x-1, x, x+1);
+  out[width-1] = TAvg::apply(up, mid, down, width-2, width-1, width-1);
+}
+
+template <typename TAvg>
+static void laplacian_avg(const blitz::Array<double,2>& input,
+    blitz::Array<double,2>& output) {
+  bob::core::array::assertSameShape(input, output);
+  blitz::Array<double,2> in = bob::core::array::isCZeroBaseContiguous(input) ?
+    input : bob::core::array::ccopy(input);
+  blitz::Array<double,2> out = bob::core::array::isCZeroBaseContiguous(output) ?
+    output : blitz::Array<double,2>(output.shape());
+  const int height = in.extent(0), width = in.extent(1);
+  for (int y=0; y<height; ++y)
+    avg_row<TAvg>(in.data(), height, width, y, out.data() + y*width);
+  if (out.data() != output.data()) output = out;
+}
+
+void bob::ip::optflow::laplacian_avg_hs_opencv(const blitz::Array<double,2>& input,
+    blitz::Array<double,2>& output) {
+  laplacian_avg<avg_opencv>(input, output);
+}
 
 void bob::ip::optflow::laplacian_avg_hs(const blitz::Array<double,2>& input,
     blitz::Array<double,2>& output) {
-  blitz::Array<double,2> inputExtra(bob::sp::getConvOutputSize(input, LAPLACIAN_12_KERNEL, bob::sp::Conv::Full));
-  bob::sp::extrapolateMirror(input, inputExtra);
-  bob::sp::conv(input, LAPLACIAN_12_KERNEL, output,
-      bob::sp::Conv::Valid);
+  laplacian_avg<avg_hs>(input, output);
+}
+
+/**
+ * One Jacobi iteration of the Horn & Schunck method over a block of rows.
+ * The averaging of the velocities and their update are done in a single
+ * pass, reading the velocities of the previous iteration (u, v) and writing
+ * the new ones (u_next, v_next). The largest change of the velocities is
+ * recorded per thread for the convergence test.
+ */
+template <typename TAvg>
+class HSIterationOp {
+
+  public:
+
+    HSIterationOp(const blitz::Array<double,2>& ex,
+        const blitz::Array<double,2>& ey, const blitz::Array<double,2>& et,
+        const blitz::Array<double,2>& den, const size_t n_threads):
+      m_ex(ex.data()), m_ey(ey.data()), m_et(et.data()), m_den(den.data()),
+      m_height(ex.extent(0)), m_width(ex.extent(1)),
+      m_change(bob::core::thread_count(n_threads)) {}
+
+    void set(const double* u, const double* v, double* u_next,
+        double* v_next) {
+      m_u = u; m_v = v; m_u_next = u_next; m_v_next = v_next;
+      std::fill(m_change.begin(), m_change.end(), 0.);
+    }
+
+    void operator()(size_t thread, size_t begin, size_t end) {
+      double change = 0.;
+      for (size_t y=begin; y<end; ++y) {
+        const size_t offset = y*m_width;
+        double* u_bar = m_u_next + offset;
+        double* v_bar = m_v_next + offset;
+        avg_row<TAvg>(m_u, m_height, m_width, (int)y, u_bar);
+        avg_row<TAvg>(m_v, m_height, m_width, (int)y, v_bar);
+        for (int x=0; x<m_width; ++x) {
+          const size_t i = offset + x;
+          const double cterm = (m_ex[i]*u_bar[x] + m_ey[i]*v_bar[x] + m_et[i]) /
+            m_den[i];
+          u_bar[x] -= m_ex[i]*cterm;
+          v_bar[x] -= m_ey[i]*cterm;
+          change = std::max(change, std::max(std::fabs(u_bar[x] - m_u[i]),
+                std::fabs(v_bar[x] - m_v[i])));
+        }
+      }
+      m_change[thread] = change;
+    }
+
+    double getChange() const {
+      return *std::max_element(m_change.begin(), m_change.end());
+    }
+
+  private:
+
+    const double* m_ex;
+    const double* m_ey;
+    const double* m_et;
+    const double* m_den;
+    const int m_height;
+    const int m_width;
+    const double* m_u;
+    const double* m_v;
+    double* m_u_next;
+    double* m_v_next;
+    std::vector<double> m_change;
+};
+
+/**
+ * Runs the Horn & Schunck iterations given the (C-contiguous) gradients,
+ * starting from the velocities u and v, which are also the outputs. den, u2
+ * and v2 are buffers of the same shape. Returns the number of iterations
+ * run.
+ */
+template <typename TAvg>
+static size_t hs_iterate(double alpha, size_t iterations, double tolerance,
+    size_t n_threads, const blitz::Array<double,2>& ex,
+    const blitz::Array<double,2>& ey, const blitz::Array<double,2>& et,
+    blitz::Array<double,2>& den, blitz::Array<double,2>& u,
+    blitz::Array<double,2>& v, blitz::Array<double,2>& u2,
+    blitz::Array<double,2>& v2) {
+
+  // the denominator of the common term does not change between iterations
+  double a2 = std::pow(alpha, 2);
+  den = blitz::pow2(ex) + blitz::pow2(ey) + a2;
+
+  HSIterationOp<TAvg> op(ex, ey, et, den, n_threads);
+  double* cur_u = u.data(); double* cur_v = v.data();
+  double* next_u = u2.data(); double* next_v = v2.data();
+  size_t i = 0;
+  while (i < iterations) {
+    op.set(cur_u, cur_v, next_u, next_v);
+    bob::core::parallel_for(op, ex.extent(0), n_threads);
+    std::swap(cur_u, next_u);
+    std::swap(cur_v, next_v);
+    ++i;
+    if (tolerance > 0. && op.getChange() <= tolerance) break;
+  }
+  if (cur_u != u.data()) {
+    u = u2;
+    v = v2;
+  }
+  return i;
 }
+
+/**
+ * Downsamples an image by 2 in both directions, averaging blocks of 2x2
+ * pixels (the last row or column is repeated if the size is odd)
+ */
+static blitz::Array<double,2> hs_downsample(const blitz::Array<double,2>& src) {
+  const int height = src.extent(0), width = src.extent(1);
+  blitz::Array<double,2> dst((height+1)/2, (width+1)/2);
+  for (int y=0; y<dst.extent(0); ++y) {
+    const int y0 = 2*y, y1 = std::min(2*y+1, height-1);
+    for (int x=0; x<dst.extent(1); ++x) {
+      const int x0 = 2*x, x1 = std::min(2*x+1, width-1);
+      dst(y,x) = .25 * (src(y0,x0) + src(y0,x1) + src(y1,x0) + src(y1,x1));
+    }
+  }
+  return dst;
+}
+
+/**
+ * Upsamples a velocity field to the given shape (nearest neighbour),
+ * scaling the velocities by the given factor
+ */
+static blitz::Array<double,2> hs_upsample(const blitz::Array<double,2>& src,
+    const blitz::TinyVector<int,2>& shape, const double scale) {
+  blitz::Array<double,2> dst(shape);
+  for (int y=0; y<shape(0); ++y) {
+    const int ys = std::min(y/2, src.extent(0)-1);
+    for (int x=0; x<shape(1); ++x)
+      dst(y,x) = scale * src(ys, std::min(x/2, src.extent(1)-1));
+  }
+  return dst;
+}
+
+static void hs_gradient(const bob::ip::ForwardGradient& g,
+    const std::vector<blitz::Array<double,2> >& i, blitz::Array<double,2>& ex,
+    blitz::Array<double,2>& ey, blitz::Array<double,2>& et) {
+  g(i[0], i[1], ex, ey, et);
+}
+
+static void hs_gradient(const bob::ip::CentralGradient& g,
+    const std::vector<blitz::Array<double,2> >& i, blitz::Array<double,2>& ex,
+    blitz::Array<double,2>& ey, blitz::Array<double,2>& et) {
+  g(i[0], i[1], i[2], ex, ey, et);
+}
+
+/**
+ * Coarse-to-fine estimation of the flow: the images are downsampled
+ * n_levels-1 times (at most), and the flow estimated at each level is
+ * upsampled to initialize the iterations of the next finer one. The
+ * iterations at the finest level use the given gradient operator and
+ * buffers.
+ */
+template <typename TAvg, typename TGradient>
+static size_t hs_pyramid(double alpha, size_t iterations, size_t n_levels,
+    double tolerance, size_t n_threads,
+    const std::vector<blitz::Array<double,2> >& images,
+    const TGradient& gradient, blitz::Array<double,2>& ex,
+    blitz::Array<double,2>& ey, blitz::Array<double,2>& et,
+    blitz::Array<double,2>& den, blitz::Array<double,2>& u,
+    blitz::Array<double,2>& v, blitz::Array<double,2>& u2,
+    blitz::Array<double,2>& v2) {
+
+  // builds the image pyramid, level 0 being the images themselves
+  std::vector<std::vector<blitz::Array<double,2> > > pyramid(1, images);
+  while (pyramid.size() < n_levels) {
+    const blitz::Array<double,2>& last = pyramid.back()[0];
+    if (std::min(last.extent(0), last.extent(1)) < 2*HS_MIN_LEVEL_SIZE) break;
+    std::vector<blitz::Array<double,2> > level;
+    for (size_t k=0; k<images.size(); ++k)
+      level.push_back(hs_downsample(pyramid.back()[k]));
+    pyramid.push_back(level);
+  }
+
+  // the initial velocities are brought down to the coarsest level
+  blitz::Array<double,2> u_level(u.copy()), v_level(v.copy());
+  for (size_t l=1; l<pyramid.size(); ++l) {
+    const blitz::Array<double,2>& fine = pyramid[l-1][0];
+    const blitz::Array<double,2>& coarse = pyramid[l][0];
+    u_level.reference(hs_downsample(u_level));
+    u_level *= (double)coarse.extent(1) / fine.extent(1);
+    v_level.reference(hs_downsample(v_level));
+    v_level *= (double)coarse.extent(0) / fine.extent(0);
+  }
+
+  // estimates the flow from the coarsest to the finest level but the last
+  for (size_t l=pyramid.size()-1; l>0; --l) {
+    const blitz::TinyVector<int,2> shape = pyramid[l][0].shape();
+    blitz::Array<double,2> ex_l(shape), ey_l(shape), et_l(shape),
+      den_l(shape), u2_l(shape), v2_l(shape);
+    hs_gradient(TGradient(shape), pyramid[l], ex_l, ey_l, et_l);
+    hs_iterate<TAvg>(alpha, iterations, tolerance, n_threads, ex_l, ey_l,
+        et_l, den_l, u_level, v_level, u2_l, v2_l);
+
+    const blitz::TinyVector<int,2> fine_shape = pyramid[l-1][0].shape();
+    u_level.reference(hs_upsample(u_level, fine_shape,
+          (double)fine_shape(1) / shape(1)));
+    v_level.reference(hs_upsample(v_level, fine_shape,
+          (double)fine_shape(0) / shape(0)));
+  }
+
+  // the finest level
+  u = u_level;
+  v = v_level;
+  hs_gradient(gradient, images, ex, ey, et);
+  return hs_iterate<TAvg>(alpha, iterations, tolerance, n_threads, ex, ey,
+      et, den, u, v, u2, v2);
+}
+
 bob::ip::optflow::VanillaHornAndSchunckFlow::VanillaHornAndSchunckFlow
 (const blitz::TinyVector<int,2>& shape) :
   m_gradient(shape),
@@ -44,7 +309,12 @@ bob::ip::optflow::VanillaHornAndSchunckFlow::VanillaHornAndSchunckFlow
   m_et(shape),
   m_u(shape),
   m_v(shape),
-  m_cterm(shape)
+  m_u2(shape),
+  m_v2(shape),
+  m_cterm(shape),
+  m_n_threads(1),
+  m_tolerance(0.),
+  m_n_levels(1)
 {
 }
 
@@ -58,10 +328,18 @@ void bob::ip::optflow::VanillaHornAndSchunckFlow::setShape
   m_et.resize(shape);
   m_u.resize(shape);
   m_v.resize(shape);
+  m_u2.resize(shape);
+  m_v2.resize(shape);
   m_cterm.resize(shape);
 }
 
-void bob::ip::optflow::VanillaHornAndSchunckFlow::operator() (double alpha,
+void bob::ip::optflow::VanillaHornAndSchunckFlow::setNLevels(size_t n_levels) {
+  if (n_levels == 0)
+    throw std::runtime_error("the number of levels of the pyramid should be at least 1");
+  m_n_levels = n_levels;
+}
+
+size_t bob::ip::optflow::VanillaHornAndSchunckFlow::operator() (double alpha,
     size_t iterations, const blitz::Array<double,2>& i1, 
     const blitz::Array<double,2>& i2, blitz::Array<double,2>& u0,
     blitz::Array<double,2>& v0) const {
@@ -71,16 +349,25 @@ void bob::ip::optflow::VanillaHornAndSchunckFlow::operator() (double alpha,
   bob::core::array::assertSameShape(u0, m_u);
   bob::core::array::assertSameShape(v0, m_v);
 
-  m_gradient(i1, i2, m_ex, m_ey, m_et);
-  double a2 = std::pow(alpha, 2);
-  for (size_t i=0; i<iterations; ++i) {
-    bob::ip::optflow::laplacian_avg_hs(u0, m_u);
-    bob::ip::optflow::laplacian_avg_hs(v0, m_v);
-    m_cterm = (m_ex*m_u + m_ey*m_v + m_et) / 
-      (blitz::pow2(m_ex) + blitz::pow2(m_ey) + a2);
-    u0 = m_u - m_ex*m_cterm;
-    v0 = m_v - m_ey*m_cterm;
+  m_u = u0;
+  m_v = v0;
+  size_t n;
+  if (m_n_levels > 1) {
+    std::vector<blitz::Array<double,2> > images;
+    images.push_back(i1);
+    images.push_back(i2);
+    n = hs_pyramid<avg_hs>(alpha, iterations, m_n_levels, m_tolerance,
+        m_n_threads, images, m_gradient, m_ex, m_ey, m_et, m_cterm, m_u, m_v,
+        m_u2, m_v2);
+  }
+  else {
+    m_gradient(i1, i2, m_ex, m_ey, m_et);
+    n = hs_iterate<avg_hs>(alpha, iterations, m_tolerance, m_n_threads, m_ex,
+        m_ey, m_et, m_cterm, m_u, m_v, m_u2, m_v2);
   }
+  u0 = m_u;
+  v0 = m_v;
+  return n;
 }
 
 void bob::ip::optflow::VanillaHornAndSchunckFlow::evalEc2
@@ -119,7 +406,12 @@ bob::ip::optflow::HornAndSchunckFlow::HornAndSchunckFlow
   m_et(shape),
   m_u(shape),
   m_v(shape),
-  m_cterm(shape)
+  m_u2(shape),
+  m_v2(shape),
+  m_cterm(shape),
+  m_n_threads(1),
+  m_tolerance(0.),
+  m_n_levels(1)
 {
 }
 
@@ -133,10 +425,18 @@ void bob::ip::optflow::HornAndSchunckFlow::setShape
   m_et.resize(shape);
   m_u.resize(shape);
   m_v.resize(shape);
+  m_u2.resize(shape);
+  m_v2.resize(shape);
   m_cterm.resize(shape);
 }
 
-void bob::ip::optflow::HornAndSchunckFlow::operator() (double alpha,
+void bob::ip::optflow::HornAndSchunckFlow::setNLevels(size_t n_levels) {
+  if (n_levels == 0)
+    throw std::runtime_error("the number of levels of the pyramid should be at least 1");
+  m_n_levels = n_levels;
+}
+
+size_t bob::ip::optflow::HornAndSchunckFlow::operator() (double alpha,
     size_t iterations, const blitz::Array<double,2>& i1,
     const blitz::Array<double,2>& i2, const blitz::Array<double,2>& i3,
     blitz::Array<double,2>& u0, blitz::Array<double,2>& v0) const {
@@ -147,16 +447,26 @@ void bob::ip::optflow::HornAndSchunckFlow::operator() (double alpha,
   bob::core::array::assertSameShape(u0, m_u);
   bob::core::array::assertSameShape(v0, m_v);
 
-  m_gradient(i1, i2, i3, m_ex, m_ey, m_et);
-  double a2 = std::pow(alpha, 2);
-  for (size_t i=0; i<iterations; ++i) {
-    bob::ip::optflow::laplacian_avg_hs_opencv(u0, m_u);
-    bob::ip::optflow::laplacian_avg_hs_opencv(v0, m_v);
-    m_cterm = (m_ex*m_u + m_ey*m_v + m_et) / 
-      (blitz::pow2(m_ex) + blitz::pow2(m_ey) + a2);
-    u0 = m_u - m_ex*m_cterm;
-    v0 = m_v - m_ey*m_cterm;
+  m_u = u0;
+  m_v = v0;
+  size_t n;
+  if (m_n_levels > 1) {
+    std::vector<blitz::Array<double,2> > images;
+    images.push_back(i1);
+    images.push_back(i2);
+    images.push_back(i3);
+    n = hs_pyramid<avg_opencv>(alpha, iterations, m_n_levels, m_tolerance,
+        m_n_threads, images, m_gradient, m_ex, m_ey, m_et, m_cterm, m_u, m_v,
+        m_u2, m_v2);
+  }
+  else {
+    m_gradient(i1, i2, i3, m_ex, m_ey, m_et);
+    n = hs_iterate<avg_opencv>(alpha, iterations, m_tolerance, m_n_threads,
+        m_ex, m_ey, m_et, m_cterm, m_u, m_v, m_u2, m_v2);
   }
+  u0 = m_u;
+  v0 = m_v;
+  return n;
 }
 
 void bob::ip::optflow::HornAndSchunckFlow::evalEc2
@@ -22,7 +22,8 @@ bob::ip::LBPTop::LBPTop(const bob::ip::LBP& lbp_xy,
                    const bob::ip::LBP& lbp_yt)
 : m_lbp_xy(lbp_xy),
   m_lbp_xt(lbp_xt),
-  m_lbp_yt(lbp_yt)
+  m_lbp_yt(lbp_yt),
+  m_n_frames(0)
 {
   /*
    * Checking the inputs. The radius in XY,XT and YT must be the same
@@ -50,7 +51,8 @@ bob::ip::LBPTop::LBPTop(const bob::ip::LBP& lbp_xy,
 bob::ip::LBPTop::LBPTop(const LBPTop& other)
 : m_lbp_xy(other.m_lbp_xy),
   m_lbp_xt(other.m_lbp_xt),
-  m_lbp_yt(other.m_lbp_yt)
+  m_lbp_yt(other.m_lbp_yt),
+  m_n_frames(0)
 {
 }
 
@@ -60,6 +62,7 @@ bob::ip::LBPTop& bob::ip::LBPTop::operator= (const LBPTop& other) {
   m_lbp_xy = other.m_lbp_xy;
   m_lbp_xt = other.m_lbp_xt;
   m_lbp_yt = other.m_lbp_yt;
+  reset();
   return *this;
 }
 
@@ -85,3 +88,40 @@ void bob::ip::LBPTop::operator()(const blitz::Array<double,3>& src,
 {
   process<double>(src, xy, xt, yt);
 }
+
+int bob::ip::LBPTop::getMaxRadius() const
+{
+  int radius_x = m_lbp_xy.getRadii()[0];
+  int radius_y = m_lbp_xy.getRadii()[1];
+  int radius_t = m_lbp_yt.getRadii()[1];
+  return std::max(std::max(radius_x, radius_y), radius_t);
+}
+
+void bob::ip::LBPTop::reset()
+{
+  m_n_frames = 0;
+}
+
+bool bob::ip::LBPTop::push(const blitz::Array<uint8_t,2>& frame,
+    blitz::Array<uint16_t,2>& xy,
+    blitz::Array<uint16_t,2>& xt,
+    blitz::Array<uint16_t,2>& yt)
+{
+  return pushFrame<uint8_t>(frame, xy, xt, yt);
+}
+
+bool bob::ip::LBPTop::push(const blitz::Array<uint16_t,2>& frame,
+    blitz::Array<uint16_t,2>& xy,
+    blitz::Array<uint16_t,2>& xt,
+    blitz::Array<uint16_t,2>& yt)
+{
+  return pushFrame<uint16_t>(frame, xy, xt, yt);
+}
+
+bool bob::ip::LBPTop::push(const blitz::Array<double,2>& frame,
+    blitz::Array<uint16_t,2>& xy,
+    blitz::Array<uint16_t,2>& xt,
+    blitz::Array<uint16_t,2>& yt)
+{
+  return pushFrame<double>(frame, xy, xt, yt);
+}
@@ -23,13 +23,53 @@ static inline void fastconv(const blitz::Array<double,2>& image,
   bob::sp::convSep(imageExtra, kernel, result, dimension, bob::sp::Conv::Valid);
 }
 
+/**
+ * Computes the spatially filtered terms of a single frame, the same way as
+ * the operator() of the gradients do, and stores them at the given slot
+ */
+static void filter_frame(const blitz::Array<double,2>& frame,
+    const blitz::Array<double,1>& diff_kernel,
+    const blitz::Array<double,1>& avg_kernel,
+    blitz::Array<double,2>& tmp, blitz::Array<double,3>& ex,
+    blitz::Array<double,3>& ey, blitz::Array<double,3>& et, int slot) {
+  blitz::Range all = blitz::Range::all();
+  blitz::Array<double,2> x = ex(slot, all, all);
+  blitz::Array<double,2> y = ey(slot, all, all);
+  blitz::Array<double,2> t = et(slot, all, all);
+
+  fastconv(frame, diff_kernel, tmp, 1); // tmp = DK * frame
+  fastconv(tmp, avg_kernel, x, 0); // x = AK^T * tmp
+
+  fastconv(frame, diff_kernel, tmp, 0); // tmp = DK^T * frame
+  fastconv(tmp, avg_kernel, y, 1); // y = AK * tmp
+
+  fastconv(frame, avg_kernel, tmp, 1); // tmp = AK * frame
+  fastconv(tmp, avg_kernel, t, 0); // t = AK^T * tmp
+}
+
+/**
+ * Checks the shapes of a frame pushed to a gradient operator
+ */
+static void check_push(const blitz::Array<double,2>& frame,
+    const blitz::Array<double,2>& buffer, const blitz::Array<double,2>& Ex,
+    const blitz::Array<double,2>& Ey, const blitz::Array<double,2>& Et) {
+  bob::core::array::assertSameShape(frame, buffer);
+  bob::core::array::assertSameShape(frame, Ex);
+  bob::core::array::assertSameShape(Ex, Ey);
+  bob::core::array::assertSameShape(Ey, Et);
+}
+
 bob::ip::ForwardGradient::ForwardGradient(const blitz::Array<double,1>& diff_kernel,
     const blitz::Array<double,1>& avg_kernel,
     const blitz::TinyVector<int,2>& shape) :
   m_diff_kernel(diff_kernel.copy()),
   m_avg_kernel(avg_kernel.copy()),
   m_buffer1(shape),
-  m_buffer2(shape)
+  m_buffer2(shape),
+  m_frame_ex(2, shape(0), shape(1)),
+  m_frame_ey(2, shape(0), shape(1)),
+  m_frame_et(2, shape(0), shape(1)),
+  m_n_frames(0)
 {
   blitz::TinyVector<int,1> required_shape(2);
   bob::core::array::assertSameShape(m_diff_kernel, required_shape);
@@ -40,7 +80,11 @@ bob::ip::ForwardGradient::ForwardGradient(const bob::ip::ForwardGradient& other)
   m_diff_kernel(other.m_diff_kernel.copy()),
   m_avg_kernel(other.m_avg_kernel.copy()),
   m_buffer1(other.m_buffer1.shape()),
-  m_buffer2(other.m_buffer2.shape())
+  m_buffer2(other.m_buffer2.shape()),
+  m_frame_ex(other.m_frame_ex.shape()),
+  m_frame_ey(other.m_frame_ey.shape()),
+  m_frame_et(other.m_frame_et.shape()),
+  m_n_frames(0)
 {
 }
 
@@ -51,22 +95,36 @@ bob::ip::ForwardGradient& bob::ip::ForwardGradient::operator= (const bob::ip::Fo
   m_avg_kernel.reference(other.m_avg_kernel.copy());
   m_buffer1.resize(other.m_buffer1.shape());
   m_buffer2.resize(other.m_buffer2.shape());
+  m_frame_ex.resize(other.m_frame_ex.shape());
+  m_frame_ey.resize(other.m_frame_ey.shape());
+  m_frame_et.resize(other.m_frame_et.shape());
+  reset();
   return *this;
 }
 
 void bob::ip::ForwardGradient::setShape(const blitz::TinyVector<int,2>& shape) {
   m_buffer1.resize(shape);
   m_buffer2.resize(shape);
+  m_frame_ex.resize(2, shape(0), shape(1));
+  m_frame_ey.resize(2, shape(0), shape(1));
+  m_frame_et.resize(2, shape(0), shape(1));
+  reset();
+}
+
+void bob::ip::ForwardGradient::reset() {
+  m_n_frames = 0;
 }
 
 void bob::ip::ForwardGradient::setDiffKernel(const blitz::Array<double,1>& k) {
   bob::core::array::assertSameDimensionLength(k.extent(0), 2);
   m_diff_kernel.reference(k.copy());
+  reset();
 }
 
 void bob::ip::ForwardGradient::setAvgKernel(const blitz::Array<double,1>& k) {
   bob::core::array::assertSameDimensionLength(k.extent(0), 2);
   m_avg_kernel.reference(k.copy());
+  reset();
 }
 
 void bob::ip::ForwardGradient::operator()(const blitz::Array<double,2>& i1,
@@ -117,6 +175,31 @@ void bob::ip::ForwardGradient::operator()(const blitz::Array<double,2>& i1,
   Et = (m_diff_kernel(1) * m_buffer1) + (m_diff_kernel(0) * m_buffer2);
 }
 
+bool bob::ip::ForwardGradient::push(const blitz::Array<double,2>& frame,
+    blitz::Array<double,2>& Ex, blitz::Array<double,2>& Ey,
+    blitz::Array<double,2>& Et) {
+
+  check_push(frame, m_buffer1, Ex, Ey, Et);
+
+  filter_frame(frame, m_diff_kernel, m_avg_kernel, m_buffer1, m_frame_ex,
+      m_frame_ey, m_frame_et, m_n_frames % 2);
+  ++m_n_frames;
+  if (m_n_frames < 2) return false;
+
+  // i1 is the previous frame and i2 the last one
+  blitz::Range all = blitz::Range::all();
+  const int s1 = m_n_frames % 2, s2 = (m_n_frames + 1) % 2;
+
+  // The temporal operations are performed by hand, as in operator()
+  Ex = (m_avg_kernel(1) * m_frame_ex(s1, all, all)) +
+    (m_avg_kernel(0) * m_frame_ex(s2, all, all));
+  Ey = (m_avg_kernel(1) * m_frame_ey(s1, all, all)) +
+    (m_avg_kernel(0) * m_frame_ey(s2, all, all));
+  Et = (m_diff_kernel(1) * m_frame_et(s1, all, all)) +
+    (m_diff_kernel(0) * m_frame_et(s2, all, all));
+  return true;
+}
+
 static const double HS_DIFF_KERNEL_DATA[] = {+1/4., -1/4.};
 static const blitz::Array<double,1> HS_DIFF_KERNEL(const_cast<double*>(HS_DIFF_KERNEL_DATA), blitz::shape(2), blitz::neverDeleteData);
 static const double HS_AVG_KERNEL_DATA[] = {+1., +1.};
@@ -136,7 +219,11 @@ bob::ip::CentralGradient::CentralGradient(const blitz::Array<double,1>& diff_ker
   m_avg_kernel(avg_kernel.copy()),
   m_buffer1(shape),
   m_buffer2(shape),
-  m_buffer3(shape)
+  m_buffer3(shape),
+  m_frame_ex(3, shape(0), shape(1)),
+  m_frame_ey(3, shape(0), shape(1)),
+  m_frame_et(3, shape(0), shape(1)),
+  m_n_frames(0)
 {
   blitz::TinyVector<int,1> required_shape(3);
   bob::core::array::assertSameShape(m_diff_kernel, required_shape);
@@ -148,7 +235,11 @@ bob::ip::CentralGradient::CentralGradient(const bob::ip::CentralGradient& other)
   m_avg_kernel(other.m_avg_kernel.copy()),
   m_buffer1(other.m_buffer1.shape()),
   m_buffer2(other.m_buffer2.shape()),
-  m_buffer3(other.m_buffer3.shape())
+  m_buffer3(other.m_buffer3.shape()),
+  m_frame_ex(other.m_frame_ex.shape()),
+  m_frame_ey(other.m_frame_ey.shape()),
+  m_frame_et(other.m_frame_et.shape()),
+  m_n_frames(0)
 {
 }
 
@@ -160,6 +251,10 @@ bob::ip::CentralGradient& bob::ip::CentralGradient::operator= (const bob::ip::Ce
   m_buffer1.resize(other.m_buffer1.shape());
   m_buffer2.resize(other.m_buffer2.shape());
   m_buffer3.resize(other.m_buffer3.shape());
+  m_frame_ex.resize(other.m_frame_ex.shape());
+  m_frame_ey.resize(other.m_frame_ey.shape());
+  m_frame_et.resize(other.m_frame_et.shape());
+  reset();
   return *this;
 }
 
@@ -167,16 +262,26 @@ void bob::ip::CentralGradient::setShape(const blitz::TinyVector<int,2>& shape) {
   m_buffer1.resize(shape);
   m_buffer2.resize(shape);
   m_buffer3.resize(shape);
+  m_frame_ex.resize(3, shape(0), shape(1));
+  m_frame_ey.resize(3, shape(0), shape(1));
+  m_frame_et.resize(3, shape(0), shape(1));
+  reset();
+}
+
+void bob::ip::CentralGradient::reset() {
+  m_n_frames = 0;
 }
 
 void bob::ip::CentralGradient::setDiffKernel(const blitz::Array<double,1>& k) {
   bob::core::array::assertSameDimensionLength(k.extent(0), 3);
   m_diff_kernel.reference(k.copy());
+  reset();
 }
 
 void bob::ip::CentralGradient::setAvgKernel(const blitz::Array<double,1>& k) {
   bob::core::array::assertSameDimensionLength(k.extent(0), 3);
   m_avg_kernel.reference(k.copy());
+  reset();
 }
 
 void bob::ip::CentralGradient::operator() (const blitz::Array<double,2>& i1,
@@ -241,6 +346,35 @@ void bob::ip::CentralGradient::operator() (const blitz::Array<double,2>& i1,
     (m_diff_kernel(0) * m_buffer3);
 }
 
+bool bob::ip::CentralGradient::push(const blitz::Array<double,2>& frame,
+    blitz::Array<double,2>& Ex, blitz::Array<double,2>& Ey,
+    blitz::Array<double,2>& Et) {
+
+  check_push(frame, m_buffer1, Ex, Ey, Et);
+
+  filter_frame(frame, m_diff_kernel, m_avg_kernel, m_buffer1, m_frame_ex,
+      m_frame_ey, m_frame_et, m_n_frames % 3);
+  ++m_n_frames;
+  if (m_n_frames < 3) return false;
+
+  // i1, i2 and i3 are the last 3 frames, from the oldest to the newest
+  blitz::Range all = blitz::Range::all();
+  const int s1 = m_n_frames % 3, s2 = (m_n_frames + 1) % 3,
+        s3 = (m_n_frames + 2) % 3;
+
+  // The temporal operations are performed by hand, as in operator()
+  Ex = (m_avg_kernel(2) * m_frame_ex(s1, all, all)) +
+    (m_avg_kernel(1) * m_frame_ex(s2, all, all)) +
+    (m_avg_kernel(0) * m_frame_ex(s3, all, all));
+  Ey = (m_avg_kernel(2) * m_frame_ey(s1, all, all)) +
+    (m_avg_kernel(1) * m_frame_ey(s2, all, all)) +
+    (m_avg_kernel(0) * m_frame_ey(s3, all, all));
+  Et = (m_diff_kernel(2) * m_frame_et(s1, all, all)) +
+    (m_diff_kernel(1) * m_frame_et(s2, all, all)) +
+    (m_diff_kernel(0) * m_frame_et(s3, all, all));
+  return true;
+}
+
 static const double SOBEL_DIFF_KERNEL_DATA[] = {+1., 0., -1.};
 static const blitz::Array<double,1> SOBEL_DIFF_KERNEL(const_cast<double*>(SOBEL_DIFF_KERNEL_DATA), blitz::shape(3), blitz::neverDeleteData);
 static const double SOBEL_AVG_KERNEL_DATA[] = {+1., +2., +1};
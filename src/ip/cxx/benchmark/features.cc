@@ -0,0 +1,99 @@
+/**
+ * @file ip/cxx/benchmark/features.cc
+ * @date Sun Oct 18 19:49:30 2026 +0200
+ *
+ * @brief Benchmark of the LBP, block DCT and Gabor feature extractors, and
+ * of the Horn & Schunck optical flow
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/core/array_random.h>
+#include <bob/core/benchmark.h>
+#include <bob/ip/LBP.h>
+#include <bob/ip/DCTFeatures.h>
+#include <bob/ip/GaborWaveletTransform.h>
+#include <bob/ip/HornAndSchunckFlow.h>
+
+#include <boost/format.hpp>
+#include <boost/random.hpp>
+#include <complex>
+
+void benchmark_lbp(bob::core::BenchmarkSuite& suite,
+  const blitz::Array<double,2>& image)
+{
+  bob::ip::LBP lbp(8, 1.);
+  blitz::Array<uint16_t,2> dst(lbp.getLBPShape(image));
+  const std::string size = (boost::format("%dx%d") % image.extent(0) % image.extent(1)).str();
+  while (suite.iterate("LBP (8,1)", size)) lbp(image, dst);
+}
+
+void benchmark_dct_features(bob::core::BenchmarkSuite& suite,
+  const blitz::Array<double,2>& image)
+{
+  bob::ip::DCTFeatures dct(8, 8, 6, 6, 15);
+  blitz::Array<double,2> dst(dct.get2DOutputShape(image));
+  const std::string size = (boost::format("%dx%d") % image.extent(0) % image.extent(1)).str();
+  while (suite.iterate("DCTFeatures (8x8,6x6,15)", size)) dct(image, dst);
+}
+
+void benchmark_gabor(bob::core::BenchmarkSuite& suite,
+  const blitz::Array<double,2>& image)
+{
+  bob::ip::GaborWaveletTransform gwt;
+  blitz::Array<std::complex<double>,2> src(image.shape());
+  src = image;
+  blitz::Array<double,3> jets(image.extent(0), image.extent(1),
+    gwt.numberOfKernels());
+  const std::string size = (boost::format("%dx%d") % image.extent(0) % image.extent(1)).str();
+  while (suite.iterate("GaborWaveletTransform (jets)", size))
+    gwt.computeJetImage(src, jets);
+}
+
+void benchmark_hs_flow(bob::core::BenchmarkSuite& suite,
+  const blitz::Array<double,2>& image, const size_t n_threads,
+  const size_t n_levels)
+{
+  // the second and third frames are shifted by one and two pixels
+  const int h = image.extent(0), w = image.extent(1) - 2;
+  blitz::Range all = blitz::Range::all();
+  blitz::Array<double,2> i1 = image(all, blitz::Range(2, w+1));
+  blitz::Array<double,2> i2 = image(all, blitz::Range(1, w));
+  blitz::Array<double,2> i3 = image(all, blitz::Range(0, w-1));
+
+  bob::ip::optflow::HornAndSchunckFlow flow(blitz::shape(h, w));
+  flow.setNThreads(n_threads);
+  flow.setNLevels(n_levels);
+  blitz::Array<double,2> u(h, w), v(h, w);
+  const std::string name = (boost::format("HornAndSchunckFlow (50 it., %d threads, %d levels)") % n_threads % n_levels).str();
+  const std::string size = (boost::format("%dx%d") % h % w).str();
+  while (suite.iterate(name, size)) {
+    u = 0.;
+    v = 0.;
+    flow(15., 50, i1, i2, i3, u, v);
+  }
+}
+
+/*************** Feature extraction benchmarks *****************/
+int main(int argc, char** argv)
+{
+  bob::core::BenchmarkSuite suite("ip", argc, argv);
+  boost::mt19937 rng(0);
+
+  blitz::Array<double,2> small(80,64), large(480,640);
+  bob::core::array::randn(rng, small);
+  bob::core::array::randn(rng, large);
+
+  benchmark_lbp(suite, small);
+  benchmark_lbp(suite, large);
+  benchmark_dct_features(suite, small);
+  benchmark_dct_features(suite, large);
+  benchmark_gabor(suite, small);
+  benchmark_gabor(suite, large);
+  benchmark_hs_flow(suite, large, 1, 1);
+  benchmark_hs_flow(suite, large, 0, 1);
+  benchmark_hs_flow(suite, large, 0, 3);
+
+  suite.report();
+  return 0;
+}
@@ -23,6 +23,7 @@
 #include "bob/io/utils.h"
 
 #include <iostream>
+#include <vector>
 
 struct T {
   double eps,eps2;
@@ -179,4 +180,43 @@ BOOST_AUTO_TEST_CASE( test_facenorm3 )
   BOOST_CHECK_CLOSE(new_left_eye(1), 48., 1e-8);
 }
 
+BOOST_AUTO_TEST_CASE( test_facenorm_batch )
+{
+  // Get path to the XML Schema definition
+  char *testdata_cpath = getenv("BOB_TESTDATA_DIR");
+  if( !testdata_cpath || !strcmp( testdata_cpath, "") ) {
+    bob::core::error << "Environment variable $BOB_TESTDATA_DIR " <<
+      "is not set. " << "Have you setup your working environment " <<
+      "correctly?" << std::endl;
+    throw std::runtime_error("test failed");
+  }
+  // Load original image
+  boost::filesystem::path testdata_path_image(testdata_cpath);
+  testdata_path_image /= "Nicolas_Cage_0001.pgm";
+  boost::shared_ptr<bob::io::File> image_file = bob::io::open(testdata_path_image.string(), 'r');
+  blitz::Array<uint8_t,2> image = image_file->read_all<uint8_t,2>();
+
+  bob::ip::FaceEyesNorm facenorm(33,80,64,16,31.5);
+
+  // The same image with several eye positions, some of them leading to
+  // crops that do not lie entirely in the image
+  const int N = 7;
+  std::vector<blitz::Array<uint8_t,2> > images(N, image);
+  blitz::Array<double,2> eyes(N,4);
+  for (int i=0; i<N; ++i) {
+    eyes(i,0) = 116. + 3*i; eyes(i,1) = 104. - 15*i;
+    eyes(i,2) = 116. - 2*i; eyes(i,3) = 147. + 5*i;
+  }
+
+  std::vector<blitz::Array<double,2> > processed;
+  facenorm(images, processed, eyes, 3);
+  BOOST_REQUIRE_EQUAL(processed.size(), (size_t)N);
+
+  blitz::Array<double,2> reference(80,64);
+  for (int i=0; i<N; ++i) {
+    facenorm(image, reference, eyes(i,0), eyes(i,1), eyes(i,2), eyes(i,3));
+    checkBlitzClose(reference, processed[i], eps2);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -8,7 +8,9 @@
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
 
+#include <boost/python/stl_iterator.hpp>
 #include <bob/python/ndarray.h>
+#include <bob/python/gil.h>
 #include <bob/ip/FaceEyesNorm.h>
 
 using namespace boost::python;
@@ -92,6 +94,44 @@ static void call2(bob::ip::FaceEyesNorm& obj, bob::python::const_ndarray input,
   }
 }
 
+template <typename T>
+static list inner_extract(bob::ip::FaceEyesNorm& op,
+  const std::vector<bob::python::const_ndarray>& inputs,
+  bob::python::const_ndarray eyes, const size_t n_threads)
+{
+  std::vector<blitz::Array<T,2> > inputs_;
+  for (size_t i=0; i<inputs.size(); ++i)
+    inputs_.push_back(inputs[i].bz<T,2>());
+  const blitz::Array<double,2> eyes_ = eyes.bz<double,2>();
+  // Normalizes the faces without the GIL, as the work is done in C++
+  std::vector<blitz::Array<double,2> > outputs_;
+  {
+    bob::python::no_gil unlock;
+    op(inputs_, outputs_, eyes_, n_threads);
+  }
+  list outputs;
+  for (size_t i=0; i<outputs_.size(); ++i) outputs.append(outputs_[i]);
+  return outputs;
+}
+
+static list extract(bob::ip::FaceEyesNorm& op, object inputs,
+  bob::python::const_ndarray eyes, const size_t n_threads)
+{
+  stl_input_iterator<bob::python::const_ndarray> ibegin(inputs), iend;
+  std::vector<bob::python::const_ndarray> inputs_(ibegin, iend);
+  if (inputs_.empty()) return list();
+  const bob::core::array::typeinfo& info = inputs_[0].type();
+  switch (info.dtype) {
+    case bob::core::array::t_uint8:
+      return inner_extract<uint8_t>(op, inputs_, eyes, n_threads);
+    case bob::core::array::t_uint16:
+      return inner_extract<uint16_t>(op, inputs_, eyes, n_threads);
+    case bob::core::array::t_float64:
+      return inner_extract<double>(op, inputs_, eyes, n_threads);
+    default: PYTHON_ERROR(TypeError, "FaceEyesNorm extract does not support array of type '%s'.", info.str().c_str());
+  }
+}
+
 void bind_ip_faceeyesnorm() {
   class_<bob::ip::FaceEyesNorm, boost::shared_ptr<bob::ip::FaceEyesNorm> >("FaceEyesNorm", faceeyesnorm_doc, init<const double, const size_t, const size_t, const double, const double>((arg("self"), arg("eyes_distance"), arg("crop_height"), arg("crop_width"), arg("crop_eyecenter_offset_h"), arg("crop_eyecenter_offset_w")), "Constructs a FaceEyeNorm object."))
       .def(init<unsigned, unsigned, double, double, double, double>(args("self", "crop_height", "crop_width", "re_y", "re_x", "le_y", "le_x"), "Creates a FaceEyesNorm class that will put the eyes to the given locations and crop the image to the desired size."))
@@ -108,5 +148,6 @@ void bind_ip_faceeyesnorm() {
       .def("__call__", &call1, (arg("self"), arg("input"), arg("output"), arg("re_y"), arg("re_x"), arg("le_y"), arg("le_x")), "Extracts a face given the coordinates of the left (le_y, le_x) and right (re_y, re_x) eye centers. Please note that the horizontal position le_x of the left eye is usually larger than the position re_x of the right eye.")
       .def("__call__", &call1b, (arg("self"), arg("input"), arg("re_y"), arg("re_x"), arg("le_y"), arg("le_x")), "Extracts a face given the coordinates of the left (le_y, le_x) and right (re_y, re_x) eye centers. Please note that the horizontal position le_x of the left eye is usually larger than the position re_x of the right eye. The output is allocated and returned.")
       .def("__call__", &call2, (arg("self"), arg("input"), arg("input_mask"), arg("output"), arg("output_mask"), arg("re_y"), arg("re_x"), arg("le_y"), arg("le_x")), "Extracts a face given the coordinates of the left (le_y, le_x) and right (re_y, re_x) eye centers, taking mask into account.")
+      .def("extract", &extract, (arg("self"), arg("inputs"), arg("eyes"), arg("n_threads")=0), "Extracts the faces of a list of images (all of the same type), in parallel. The i-th row of the 2D array eyes contains the coordinates (re_y, re_x, le_y, le_x) of the eye centers in the i-th image. Returns the list of normalized faces. The last_angle and last_scale attributes are not updated.")
     ;
 }
@@ -122,6 +122,23 @@ static void call_lbptop (const bob::ip::LBPTop& op, bob::python::const_ndarray i
   }
 }
 
+template <typename T>
+static bool inner_push_lbptop (bob::ip::LBPTop& op, bob::python::const_ndarray input, bob::python::ndarray xy, bob::python::ndarray xt, bob::python::ndarray yt) {
+  blitz::Array<uint16_t,2> xy_ = xy.bz<uint16_t,2>();
+  blitz::Array<uint16_t,2> xt_ = xt.bz<uint16_t,2>();
+  blitz::Array<uint16_t,2> yt_ = yt.bz<uint16_t,2>();
+  return op.push(input.bz<T,2>(), xy_, xt_, yt_);
+}
+
+static bool push_lbptop (bob::ip::LBPTop& op, bob::python::const_ndarray input, bob::python::ndarray xy, bob::python::ndarray xt, bob::python::ndarray yt) {
+  switch(input.type().dtype) {
+    case bob::core::array::t_uint8: return inner_push_lbptop<uint8_t>(op, input, xy, xt, yt);
+    case bob::core::array::t_uint16: return inner_push_lbptop<uint16_t>(op, input, xy, xt, yt);
+    case bob::core::array::t_float64: return inner_push_lbptop<double>(op, input, xy, xt, yt);
+    default: PYTHON_ERROR(TypeError, "LBPTop operator cannot process frame of type '%s'", input.type().str().c_str()); return false;
+  }
+}
+
 
 template <typename T>
 static object inner_lbp_apply (bob::ip::LBPHSFeatures& op, bob::python::const_ndarray input) {
@@ -199,6 +216,9 @@ void bind_ip_lbp() {
     .add_property("xt", &bob::ip::LBPTop::getXT)
     .add_property("yt", &bob::ip::LBPTop::getYT)
     .def("__call__", &call_lbptop, (arg("self"),arg("input"), arg("xy"), arg("xt"), arg("yt")), "Processes a 3D array representing a set of <b>grayscale</b> images and returns (by argument) the three LBP planes calculated. The 3D array has to be arranged in this way:\n\n1st dimension => time\n2nd dimension => frame height\n3rd dimension => frame width\n\nThe central pixel is the point where the LBP planes intersect/have to be calculated from.")
+    .def("push", &push_lbptop, (arg("self"),arg("frame"), arg("xy"), arg("xt"), arg("yt")), "Processes a video sequence one 2D <b>grayscale</b> frame at a time, keeping only the last 2R+1 frames in memory (R being the largest radius). Once enough frames have been pushed, computes (by argument) the three LBP planes of the frame pushed R calls before, each of shape (height-2R, width-2R), which are the same as the ones computed by __call__ for this frame, and returns True. Returns False while the buffer is filling up.")
+    .def("reset", &bob::ip::LBPTop::reset, (arg("self")), "Forgets the frames pushed so far, to start processing a new sequence with push()")
+    .add_property("n_frames", &bob::ip::LBPTop::getNFrames, "The number of frames pushed since the last reset")
     ;
 
 
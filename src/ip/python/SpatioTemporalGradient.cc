@@ -177,6 +177,39 @@ static tuple central_gradient_3(const bob::ip::CentralGradient& g,
   return make_tuple(Ex.self(), Ey.self(), Et.self());
 }
 
+template <typename G>
+static bool gradient_push_2(G& g, bob::python::const_ndarray frame,
+    bob::python::ndarray Ex, bob::python::ndarray Ey, bob::python::ndarray Et) {
+
+  const bob::core::array::typeinfo& info = frame.type();
+
+  blitz::Array<double,2> Ex_ = Ex.bz<double,2>();
+  blitz::Array<double,2> Ey_ = Ey.bz<double,2>();
+  blitz::Array<double,2> Et_ = Et.bz<double,2>();
+
+  switch (info.dtype) {
+    case bob::core::array::t_uint8:
+      return g.push(bob::core::array::cast<double,uint8_t>(frame.bz<uint8_t,2>()), Ex_, Ey_, Et_);
+    case bob::core::array::t_float64:
+      return g.push(frame.bz<double,2>(), Ex_, Ey_, Et_);
+    default:
+      PYTHON_ERROR(TypeError, "gradient push does not support array with type '%s'", info.str().c_str());
+      return false;
+  }
+}
+
+template <typename G>
+static object gradient_push_1(G& g, bob::python::const_ndarray frame) {
+  const bob::core::array::typeinfo& info = frame.type();
+
+  bob::python::ndarray Ex(bob::core::array::t_float64, info.shape[0], info.shape[1]);
+  bob::python::ndarray Ey(bob::core::array::t_float64, info.shape[0], info.shape[1]);
+  bob::python::ndarray Et(bob::core::array::t_float64, info.shape[0], info.shape[1]);
+  if (!gradient_push_2(g, frame, Ex, Ey, Et)) return object();
+
+  return make_tuple(Ex.self(), Ey.self(), Et.self());
+}
+
 void bind_ip_spatiotempgrad() {
   class_<bob::ip::ForwardGradient>("ForwardGradient", "This class computes the spatio-temporal gradient using a 2-term approximation composed of 2 separable kernels (one for the diference term and another one for the averaging term).", init<const blitz::Array<double,1>&, const blitz::Array<double,1>&, const blitz::TinyVector<int,2>&>((arg("self"), arg("diff_kernel"), arg("avg_kernel"), arg("shape")), "Constructor. We initialize with the shape of the images we need to treat and with the kernels to be applied. The shape is used by the internal buffers.\n\n  diff_kernel\n    The kernel that contains the difference operation. Typically, this is [1; -1]. Note the kernel is mirrored during the convolution operation. To obtain a [-1; +1] sliding operator, specify [+1; -1]. This kernel must have a size = 2.\n\n  avg_kernel\n    The kernel that contains the spatial averaging operation. This kernel is typically [+1; +1]. This kernel must have a size = 2.\n\n  shape\n    This is the shape of the images to be treated. This has to match the input image height x width specifications (in that order)."))
     .add_property("shape", make_function(&bob::ip::ForwardGradient::getShape, return_value_policy<copy_const_reference>()), &bob::ip::ForwardGradient::setShape, "The internal buffer shape")
@@ -185,6 +218,9 @@ void bind_ip_spatiotempgrad() {
     .def("__call__", &forward_gradient_1, (arg("self"), arg("s")))
     .def("__call__", &forward_gradient_3, (arg("self"), arg("i1"), arg("i2")))
     .def("__call__", &forward_gradient_2, (arg("self"), arg("i1"), arg("i2"), arg("ex"), arg("ey"), arg("et")))
+    .def("push", &gradient_push_1<bob::ip::ForwardGradient>, (arg("self"), arg("frame")), "Processes a video sequence one frame at a time, filtering each frame only once. Returns None for the first frame of the sequence, then the tuple (ex, ey, et) of the gradients for the last 2 frames pushed, which is the same as the output of __call__ for these frames.")
+    .def("push", &gradient_push_2<bob::ip::ForwardGradient>, (arg("self"), arg("frame"), arg("ex"), arg("ey"), arg("et")), "Processes a video sequence one frame at a time, filtering each frame only once. Returns False for the first frame of the sequence, then sets ex, ey and et to the gradients for the last 2 frames pushed, which are the same as the ones of __call__ for these frames, and returns True.")
+    .def("reset", &bob::ip::ForwardGradient::reset, (arg("self")), "Forgets the frames pushed so far, to start a new sequence. This is also done when changing the shape or the kernels.")
     ;
 
   class_<bob::ip::HornAndSchunckGradient, bases<bob::ip::ForwardGradient> >("HornAndSchunckGradient", "This class computes the spatio-temporal gradient using the same approximation as the one described by Horn & Schunck in the paper titled 'Determining Optical Flow', published in 1981, Artificial Intelligence, * Vol. 17, No. 1-3, pp. 185-203.\n\nThis is equivalent to convolving the image sequence with the following (separate) kernels:\n\nEx = 1/4 * ([-1 +1]^T * ([+1 +1]*(i1)) + [-1 +1]^T * ([+1 +1]*(i2)))\n\nEy = 1/4 * ([+1 +1]^T * ([-1 +1]*(i1)) + [+1 +1]^T * ([-1 +1]*(i2)))\n\nEt = 1/4 * ([+1 +1]^T * ([+1 +1]*(i1)) - [+1 +1]^T * ([+1 +1]*(i2)))", init<const blitz::TinyVector<int,2>&>((arg("self"), arg("shape")), "We initialize with the shape of the images we need to treat. The shape is used by the internal buffers.\n\nThe difference kernel for this operator is [+1/4; -1/4]\n\nThe averaging kernel for this oeprator is [+1; +1]."))
@@ -197,6 +233,9 @@ void bind_ip_spatiotempgrad() {
     .def("__call__", &central_gradient_1, (arg("self"), arg("s")))
     .def("__call__", &central_gradient_3, (arg("self"), arg("i1"), arg("i2"), arg("i3")))
     .def("__call__", &central_gradient_2, (arg("self"), arg("i1"), arg("i2"), arg("i3"), arg("ex"), arg("ey"), arg("et")))
+    .def("push", &gradient_push_1<bob::ip::CentralGradient>, (arg("self"), arg("frame")), "Processes a video sequence one frame at a time, filtering each frame only once. Returns None for the first 2 frames of the sequence, then the tuple (ex, ey, et) of the gradients for the last 3 frames pushed, which is the same as the output of __call__ for these frames.")
+    .def("push", &gradient_push_2<bob::ip::CentralGradient>, (arg("self"), arg("frame"), arg("ex"), arg("ey"), arg("et")), "Processes a video sequence one frame at a time, filtering each frame only once. Returns False for the first 2 frames of the sequence, then sets ex, ey and et to the gradients for the last 3 frames pushed, which are the same as the ones of __call__ for these frames, and returns True.")
+    .def("reset", &bob::ip::CentralGradient::reset, (arg("self")), "Forgets the frames pushed so far, to start a new sequence. This is also done when changing the shape or the kernels.")
     ;
   
   class_<bob::ip::SobelGradient, bases<bob::ip::CentralGradient> >("SobelGradient", "This class computes the spatio-temporal gradient using a 3-D sobel filter. The gradients are calculated along the x, y and t directions. The Sobel operator can be decomposed into 2 1D kernels that are applied in sequence. Considering h'(.) = [+1 0 -1] and h(.) = [1 2 1] one can represent the operations like this:\n\nEx = h'(x)h(y)h(t)\n\nEy = h(x)h'(y)h(t)\n\nEt = h(x)h(y)h'(t)", init<const blitz::TinyVector<int,2>&>((arg("self"), arg("shape")), "We initialize with the shape of the images we need to treat. The shape is used by the internal buffers.\n\nThe difference kernel for this operator is [+1; 0; -1]\n\nThe averaging kernel for this oeprator is [+1; +2; +1]."))
@@ -38,21 +38,20 @@ static tuple vanillahs_call(const bob::ip::optflow::VanillaHornAndSchunckFlow& f
   return make_tuple(u.self(), v.self());
 }
 
-static void vanillahs_call2(const bob::ip::optflow::VanillaHornAndSchunckFlow& f,
+static size_t vanillahs_call2(const bob::ip::optflow::VanillaHornAndSchunckFlow& f,
     double alpha, size_t iterations, bob::python::const_ndarray i1,
     bob::python::const_ndarray i2, bob::python::ndarray u, bob::python::ndarray v) {
   blitz::Array<double,2> u_ = u.bz<double,2>();
   blitz::Array<double,2> v_ = v.bz<double,2>();
   switch (i1.type().dtype) {
     case bob::core::array::t_uint8:
-      f(alpha, iterations, bob::core::array::cast<double,uint8_t>(i1.bz<uint8_t,2>()), 
+      return f(alpha, iterations, bob::core::array::cast<double,uint8_t>(i1.bz<uint8_t,2>()), 
           bob::core::array::cast<double,uint8_t>(i2.bz<uint8_t,2>()), u_, v_);
-      break;
     case bob::core::array::t_float64:
-      f(alpha, iterations, i1.bz<double,2>(), i2.bz<double,2>(), u_, v_);
-      break;
+      return f(alpha, iterations, i1.bz<double,2>(), i2.bz<double,2>(), u_, v_);
     default:
       PYTHON_ERROR(TypeError, "vanilla Horn&Schunck operator does not support array with type '%s'", i1.type().str().c_str());
+      return 0;
   }
 }
 
@@ -112,23 +111,22 @@ static tuple hs_call(const bob::ip::optflow::HornAndSchunckFlow& f,
   return make_tuple(u.self(), v.self());
 }
 
-static void hs_call2(const bob::ip::optflow::HornAndSchunckFlow& f,
+static size_t hs_call2(const bob::ip::optflow::HornAndSchunckFlow& f,
     double alpha, size_t iterations, bob::python::const_ndarray i1, bob::python::const_ndarray i2,
     bob::python::const_ndarray i3, bob::python::ndarray u, bob::python::ndarray v) {
   blitz::Array<double,2> u_ = u.bz<double,2>();
   blitz::Array<double,2> v_ = v.bz<double,2>();
   switch (i1.type().dtype) {
     case bob::core::array::t_uint8:
-      f(alpha, iterations, bob::core::array::cast<double,uint8_t>(i1.bz<uint8_t,2>()), 
+      return f(alpha, iterations, bob::core::array::cast<double,uint8_t>(i1.bz<uint8_t,2>()), 
           bob::core::array::cast<double,uint8_t>(i2.bz<uint8_t,2>()), 
           bob::core::array::cast<double,uint8_t>(i3.bz<uint8_t,2>()), u_, v_);
-      break;
     case bob::core::array::t_float64:
-      f(alpha, iterations, i1.bz<double,2>(), i2.bz<double,2>(),
+      return f(alpha, iterations, i1.bz<double,2>(), i2.bz<double,2>(),
           i3.bz<double,2>(), u_, v_);
-      break;
     default:
       PYTHON_ERROR(TypeError, "Horn&Schunck operator does not support array with type '%s'", i1.type().str().c_str());
+      return 0;
   }
 }
 
@@ -196,22 +194,28 @@ static object laplacian_avg_hs(bob::python::const_ndarray i) {
   return o.self();
 }
 
-static const char laplacian_avg_hs_opencv_doc[] = "An approximation to the Laplacian (averaging) operator. Using the following (non-separable) kernel for the Laplacian:\n\n[ 0 -1  0]\n[-1  4 -1]\n[ 0 -1  0]\n\nThis is used as the Laplacian operator on OpenCV. To calculate the u_bar value we must remove the central mean and multiply by -1/4, yielding:\n\n[ 0  1/4  0  ]\n[1/4  0  1/4 ]\n[ 0  1/4  0  ]\n\nNote that you will get the WRONG results if you use the Laplacian kernel directly...";
+static const char laplacian_avg_hs_opencv_doc[] = "An approximation to the Laplacian (averaging) operator. Using the following (non-separable) kernel for the Laplacian:\n\n[ 0 -1  0]\n[-1  4 -1]\n[ 0 -1  0]\n\nThis is used as the Laplacian operator on OpenCV. To calculate the u_bar value we must remove the central mean and multiply by -1/4, yielding:\n\n[ 0  1/4  0  ]\n[1/4  0  1/4 ]\n[ 0  1/4  0  ]\n\nNote that you will get the WRONG results if you use the Laplacian kernel directly...\n\nThe input is mirrored (edge pixels repeated) around the borders, so that the output has the same shape as the input, and output[y,x] is the average around input[y,x]. **Behaviour change**: previous versions returned the average around input[y+1,x+1] at output[y,x], with a kernel truncated on the last two rows and columns, so the outputs (and the Horn & Schunck flows) differ from those versions.";
 
-static const char laplacian_avg_hs_doc[] = "An approximation to the Laplacian operator. Using the following (non-separable) kernel:\n\n[-1 -2 -1]\n[-2 12 -2]\n[-1 -2 -1]\n\nThis is used on the Horn & Schunck paper. To calculate the u_bar value we must remove the central mean and multiply by -1/12, yielding:\n\n[1/12 1/6 1/12]\n[1/6   0  1/6 ]\n[1/12 1/6 1/12]\n\nNote that you will get the WRONG results if you use the Laplacian kernel directly...";
+static const char laplacian_avg_hs_doc[] = "An approximation to the Laplacian operator. Using the following (non-separable) kernel:\n\n[-1 -2 -1]\n[-2 12 -2]\n[-1 -2 -1]\n\nThis is used on the Horn & Schunck paper. To calculate the u_bar value we must remove the central mean and multiply by -1/12, yielding:\n\n[1/12 1/6 1/12]\n[1/6   0  1/6 ]\n[1/12 1/6 1/12]\n\nNote that you will get the WRONG results if you use the Laplacian kernel directly...\n\nThe input is mirrored (edge pixels repeated) around the borders, so that the output has the same shape as the input, and output[y,x] is the average around input[y,x]. **Behaviour change**: previous versions returned the average around input[y+1,x+1] at output[y,x], with a kernel truncated on the last two rows and columns, so the outputs (and the Horn & Schunck flows) differ from those versions.";
 
 void bind_ip_flow() {
   //Horn & Schunck 
   class_<bob::ip::optflow::VanillaHornAndSchunckFlow>("VanillaHornAndSchunckFlow", "Calculates the Optical Flow between two sequences of images (i1, the starting image and i2, the final image). It does this using the iterative method described by Horn & Schunck in the paper titled \"Determining Optical Flow\", published in 1981, Artificial Intelligence, Vol. 17, No. 1-3, pp. 185-203. Parameters: i1 -- first frame, i2 -- second frame, (u,v) -- estimates of the speed in x,y directions (zero if uninitialized)", init<const blitz::TinyVector<int,2>&>((arg("self"), arg("shape")), "Initializes the vanilla Horn&Schunck operator with the size of images to be fed"))
       .def("__call__", &vanillahs_call, (arg("self"), arg("alpha"), arg("iterations"), arg("image1"), arg("image2")))
-      .def("__call__", &vanillahs_call2, (arg("self"), arg("alpha"), arg("iterations"), arg("image1"), arg("image2"), arg("u"), arg("v")))
+      .def("__call__", &vanillahs_call2, (arg("self"), arg("alpha"), arg("iterations"), arg("image1"), arg("image2"), arg("u"), arg("v")), "Updates the velocities u and v in place and returns the number of iterations run at the finest level")
+      .add_property("n_threads", &bob::ip::optflow::VanillaHornAndSchunckFlow::getNThreads, &bob::ip::optflow::VanillaHornAndSchunckFlow::setNThreads, "The number of threads used by the iterations (0 means all hardware threads)")
+      .add_property("tolerance", &bob::ip::optflow::VanillaHornAndSchunckFlow::getTolerance, &bob::ip::optflow::VanillaHornAndSchunckFlow::setTolerance, "The convergence threshold: the iterations stop as soon as no velocity changes by more than this value (0, the default, disables the early exit)")
+      .add_property("n_levels", &bob::ip::optflow::VanillaHornAndSchunckFlow::getNLevels, &bob::ip::optflow::VanillaHornAndSchunckFlow::setNLevels, "The number of levels of the multiresolution pyramid. With more than 1 level, the flow is estimated from the coarsest level (images downsampled by 2 per level, but never smaller than 8 pixels) to the finest one, each level being initialized with the flow of the previous one.")
       .def("eval_ec2", &vanillahs_ec2, (arg("self"), arg("u"), arg("v")), "Calculates the square of the smoothness error (Ec^2) by using the formula described in the paper: Ec^2 = (u_bar - u)^2 + (v_bar - v)^2. Sets the input matrix with the discrete values.")
       .def("eval_eb", &vanillahs_eb, (arg("self"), arg("i1"), arg("i2"), arg("u"), arg("v")), "Calculates the brightness error (Eb) as defined in the paper: Eb = (Ex*u + Ey*v + Et). Sets the input matrix with the discrete values")
       ;
 
   class_<bob::ip::optflow::HornAndSchunckFlow>("HornAndSchunckFlow", "This is a clone of the Vanilla HornAndSchunck method that uses a Sobel gradient estimator instead of the forward estimator used by the classical method. The Laplacian operator is also replaced with a more common method.", init<const blitz::TinyVector<int,2>&>((arg("self"), arg("shape")), "Initializes the vanilla Horn&Schunck operator with the size of images to be fed"))
       .def("__call__", &hs_call, (arg("self"), arg("alpha"), arg("iterations"), arg("image1"), arg("image2"), arg("image3")))
-      .def("__call__", &hs_call2, (arg("self"), arg("alpha"), arg("iterations"), arg("image1"), arg("image2"), arg("image3"), arg("u"), arg("v")))
+      .def("__call__", &hs_call2, (arg("self"), arg("alpha"), arg("iterations"), arg("image1"), arg("image2"), arg("image3"), arg("u"), arg("v")), "Updates the velocities u and v in place and returns the number of iterations run at the finest level")
+      .add_property("n_threads", &bob::ip::optflow::HornAndSchunckFlow::getNThreads, &bob::ip::optflow::HornAndSchunckFlow::setNThreads, "The number of threads used by the iterations (0 means all hardware threads)")
+      .add_property("tolerance", &bob::ip::optflow::HornAndSchunckFlow::getTolerance, &bob::ip::optflow::HornAndSchunckFlow::setTolerance, "The convergence threshold: the iterations stop as soon as no velocity changes by more than this value (0, the default, disables the early exit)")
+      .add_property("n_levels", &bob::ip::optflow::HornAndSchunckFlow::getNLevels, &bob::ip::optflow::HornAndSchunckFlow::setNLevels, "The number of levels of the multiresolution pyramid. With more than 1 level, the flow is estimated from the coarsest level (images downsampled by 2 per level, but never smaller than 8 pixels) to the finest one, each level being initialized with the flow of the previous one.")
       .def("eval_ec2", &hs_ec2, (arg("self"), arg("u"), arg("v")), "Calculates the square of the smoothness error (Ec^2) by using the formula described in the paper: Ec^2 = (u_bar - u)^2 + (v_bar - v)^2. Sets the input matrix with the discrete values.")
       .def("eval_eb", &hs_eb, (arg("self"), arg("i1"), arg("i2"), arg("i3"), arg("u"), arg("v")), "Calculates the brightness error (Eb) as defined in the paper: Eb = (Ex*u + Ey*v + Et). Sets the input matrix with the discrete values")
       ;
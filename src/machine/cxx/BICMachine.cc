@@ -16,9 +16,14 @@
  */
 
 #include <bob/machine/BICMachine.h>
+#include <bob/machine/Gaussian.h>
 #include <bob/math/linear.h>
+#include <bob/math/gemm.h>
 #include <bob/core/assert.h>
 #include <bob/core/check.h>
+#include <bob/core/array_copy.h>
+#include <algorithm>
+#include <vector>
 
 /**
  * Initializes an empty BIC Machine
@@ -347,3 +352,89 @@ void bob::machine::BICMachine::forward(const blitz::Array<double,1>& input, doub
   forward_(input, output);
 }
 
+/**
+ * Computes the distances of the input vectors [begin, begin+n) to one class in the BIC mode,
+ * i.e., the Mahalanobis distance in the subspace, plus the DFFS if requested.
+ */
+static void bicDistances(const blitz::Array<double,2>& input, const int begin, const int n,
+    const blitz::Array<double,1>& mu, const blitz::Array<double,1>& lambda,
+    const blitz::Array<double,2>& Phi, const bool use_DFFS, const double rho, double* dist){
+  const int D = Phi.extent(0), K = Phi.extent(1);
+  // subtract mean and project data to the subspace
+  blitz::Array<double,2> diff(n, D), proj(n, K);
+  for (int k = 0; k < n; ++k)
+    for (int d = 0; d < D; ++d)
+      diff(k,d) = input(begin+k, d) - mu(d);
+  bob::math::gemm_(diff, Phi, proj, false, false, 1., 0., 1);
+
+  // Mahalanobis distance, using the batch Gaussian kernel (which returns -0.5 * distance)
+  std::vector<double> proj_t(K*n), zeros(K, 0.);
+  blitz::Array<double,1> inv_lambda(1. / lambda);
+  bob::machine::detail::transposeBlock(proj, 0, n, &proj_t[0]);
+  bob::machine::detail::diagonalGaussianKernel(&proj_t[0], n, K, &zeros[0], inv_lambda.data(), 0., dist);
+  for (int k = 0; k < n; ++k) dist[k] *= -2.;
+
+  // add the DFFS?
+  if (use_DFFS){
+    blitz::firstIndex i;
+    blitz::secondIndex j;
+    blitz::Array<double,1> dffs(blitz::sum(blitz::pow2(diff(i,j)), j) - blitz::sum(blitz::pow2(proj(i,j)), j));
+    for (int k = 0; k < n; ++k) dist[k] += dffs(k) / rho;
+  }
+}
+
+/**
+ * Computes the BIC or IEC scores for the given input vectors (one per row).
+ * The Gaussian terms are evaluated by blocks of samples using the batch kernel of the Gaussian machine.
+ * No sanity checks of input and output are performed.
+ *
+ * @param  input  The vectors (of difference values) to compute the BIC or IEC score for, one per row.
+ * @param  output The array that will contain the score of each vector afterwards.
+ */
+void bob::machine::BICMachine::forward_(const blitz::Array<double,2>& input, blitz::Array<double,1>& output) const{
+  const int N = input.extent(0);
+  const int D = m_mu_E.extent(0);
+  const int B = std::min(N, bob::machine::detail::gaussian_block_size);
+  std::vector<double> dist_E(B), dist_I(B);
+  if (m_project_data){
+    const double norm = 1. / (m_Phi_E.extent(1) + m_Phi_I.extent(1));
+    for (int b = 0; b < N; b += B){
+      const int n = std::min(B, N-b);
+      bicDistances(input, b, n, m_mu_E, m_lambda_E, m_Phi_E, m_use_DFFS, m_rho_E, &dist_E[0]);
+      bicDistances(input, b, n, m_mu_I, m_lambda_I, m_Phi_I, m_use_DFFS, m_rho_I, &dist_I[0]);
+      for (int k = 0; k < n; ++k)
+        output(b+k) = (dist_E[k] - dist_I[k]) * norm;
+    }
+  } else {
+    // forward without projection; the kernel requires contiguous parameters
+    blitz::Array<double,1> mu_E(bob::core::array::ccopy(m_mu_E)), mu_I(bob::core::array::ccopy(m_mu_I));
+    blitz::Array<double,1> inv_lambda_E(1. / m_lambda_E), inv_lambda_I(1. / m_lambda_I);
+    std::vector<double> Xt(D*B);
+    for (int b = 0; b < N; b += B){
+      const int n = std::min(B, N-b);
+      bob::machine::detail::transposeBlock(input, b, n, &Xt[0]);
+      bob::machine::detail::diagonalGaussianKernel(&Xt[0], n, D, mu_E.data(), inv_lambda_E.data(), 0., &dist_E[0]);
+      bob::machine::detail::diagonalGaussianKernel(&Xt[0], n, D, mu_I.data(), inv_lambda_I.data(), 0., &dist_I[0]);
+      // the kernel returns -0.5 times the (weighted) squared distances
+      for (int k = 0; k < n; ++k)
+        output(b+k) = 2. * (dist_I[k] - dist_E[k]) / D;
+    }
+  }
+}
+
+/**
+ * Computes the BIC or IEC scores for the given input vectors (one per row).
+ * Sanity checks of input and output shape are performed.
+ *
+ * @param  input  The vectors (of difference values) to compute the BIC or IEC score for, one per row.
+ * @param  output The array that will contain the score of each vector afterwards.
+ */
+void bob::machine::BICMachine::forward(const blitz::Array<double,2>& input, blitz::Array<double,1>& output) const{
+  // perform some checks
+  bob::core::array::assertSameDimensionLength(input.extent(1), m_mu_E.extent(0));
+  bob::core::array::assertSameDimensionLength(output.extent(0), input.extent(0));
+
+  // call the actual method
+  forward_(input, output);
+}
+
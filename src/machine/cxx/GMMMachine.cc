@@ -10,6 +10,7 @@
 #include <bob/machine/GMMMachine.h>
 #include <bob/core/assert.h>
 #include <bob/math/log.h>
+#include <algorithm>
 
 bob::machine::GMMMachine::GMMMachine(): m_gaussians(0) {
   resize(0,0);
@@ -257,6 +258,64 @@ double bob::machine::GMMMachine::logLikelihood_(const blitz::Array<double, 1> &x
   return logLikelihood_(x,m_cache_log_weighted_gaussian_likelihoods);
 }
 
+void bob::machine::GMMMachine::logWeightedLikelihoodsBlock(
+  const blitz::Array<double,2>& X, const int begin, const int n,
+  std::vector<double>& Xt, std::vector<double>& l) const
+{
+  bob::machine::detail::transposeBlock(X, begin, n, &Xt[0]);
+  for(size_t i=0; i<m_n_gaussians; ++i)
+    m_gaussians[i]->logLikelihoodBlock_(&Xt[0], n, m_cache_log_weights(i),
+      &l[i*n]);
+}
+
+void bob::machine::GMMMachine::logLikelihood(const blitz::Array<double,2> &X,
+  blitz::Array<double,1> &output) const
+{
+  // Check dimension
+  bob::core::array::assertSameDimensionLength(X.extent(1), m_n_inputs);
+  bob::core::array::assertSameDimensionLength(output.extent(0), X.extent(0));
+  logLikelihood_(X, output);
+}
+
+void bob::machine::GMMMachine::logLikelihood_(const blitz::Array<double,2> &X,
+  blitz::Array<double,1> &output) const
+{
+  const int N = X.extent(0);
+  const int B = std::min(N, bob::machine::detail::gaussian_block_size);
+  std::vector<double> Xt(m_n_inputs*B), l(m_n_gaussians*B);
+  for(int b=0; b<N; b+=B) {
+    const int n = std::min(B, N-b);
+    logWeightedLikelihoodsBlock(X, b, n, Xt, l);
+    for(int k=0; k<n; ++k) {
+      double log_likelihood = bob::math::Log::LogZero;
+      for(size_t i=0; i<m_n_gaussians; ++i)
+        log_likelihood = bob::math::Log::logAdd(log_likelihood, l[i*n+k]);
+      output(b+k) = log_likelihood;
+    }
+  }
+}
+
+void bob::machine::GMMMachine::logLikelihood_(const blitz::Array<double,2> &X,
+  blitz::Array<double,2> &log_weighted_gaussian_likelihoods,
+  blitz::Array<double,1> &output) const
+{
+  const int N = X.extent(0);
+  const int B = std::min(N, bob::machine::detail::gaussian_block_size);
+  std::vector<double> Xt(m_n_inputs*B), l(m_n_gaussians*B);
+  for(int b=0; b<N; b+=B) {
+    const int n = std::min(B, N-b);
+    logWeightedLikelihoodsBlock(X, b, n, Xt, l);
+    for(int k=0; k<n; ++k) {
+      double log_likelihood = bob::math::Log::LogZero;
+      for(size_t i=0; i<m_n_gaussians; ++i) {
+        log_weighted_gaussian_likelihoods(b+k,i) = l[i*n+k];
+        log_likelihood = bob::math::Log::logAdd(log_likelihood, l[i*n+k]);
+      }
+      output(b+k) = log_likelihood;
+    }
+  }
+}
+
 void bob::machine::GMMMachine::forward(const blitz::Array<double,1>& input, double& output) const {
   if(static_cast<size_t>(input.extent(0)) != m_n_inputs) {
     boost::format m("expected input size (%u) does not match the size of input array (%d)");
@@ -274,24 +333,38 @@ void bob::machine::GMMMachine::forward_(const blitz::Array<double,1>& input,
 
 void bob::machine::GMMMachine::accStatistics(const blitz::Array<double,2>& input,
     bob::machine::GMMStats& stats) const {
-  // iterate over data
-  blitz::Range a = blitz::Range::all();
-  for(int i=0; i<input.extent(0); ++i) {
-    // Get example
-    blitz::Array<double,1> x(input(i,a));
-    // Accumulate statistics
-    accStatistics(x,stats);
-  }
+  // check input and GMMStats size
+  bob::core::array::assertSameDimensionLength(input.extent(1), m_n_inputs);
+  bob::core::array::assertSameDimensionLength(stats.sumPx.extent(0), m_n_gaussians);
+  bob::core::array::assertSameDimensionLength(stats.sumPx.extent(1), m_n_inputs);
+
+  accStatistics_(input, stats);
 }
 
 void bob::machine::GMMMachine::accStatistics_(const blitz::Array<double,2>& input, bob::machine::GMMStats& stats) const {
+  // The Gaussian likelihoods are computed by blocks of samples, with the
+  // batch kernel of the Gaussians
+  const int N = input.extent(0);
+  const int B = std::min(N, bob::machine::detail::gaussian_block_size);
+  std::vector<double> Xt(m_n_inputs*B), l(m_n_gaussians*B);
+
   // iterate over data
   blitz::Range a = blitz::Range::all();
-  for(int i=0; i<input.extent(0); ++i) {
-    // Get example
-    blitz::Array<double,1> x(input(i, a));
-    // Accumulate statistics
-    accStatistics_(x,stats);
+  for(int b=0; b<N; b+=B) {
+    const int n = std::min(B, N-b);
+    logWeightedLikelihoodsBlock(input, b, n, Xt, l);
+    for(int k=0; k<n; ++k) {
+      double log_likelihood = bob::math::Log::LogZero;
+      for(size_t i=0; i<m_n_gaussians; ++i) {
+        m_cache_log_weighted_gaussian_likelihoods(i) = l[i*n+k];
+        log_likelihood = bob::math::Log::logAdd(log_likelihood, l[i*n+k]);
+      }
+      // Get example
+      blitz::Array<double,1> x(input(b+k, a));
+      // Accumulate statistics
+      accStatisticsInternal(x, stats, log_likelihood,
+        m_cache_log_weighted_gaussian_likelihoods, m_cache_P, m_cache_Px);
+    }
   }
 }
 
@@ -305,7 +378,8 @@ void bob::machine::GMMMachine::accStatistics(const blitz::Array<double, 1>& x, b
   // - log_likelihood = log(sum_i(weight_i*p(x|gaussian_i)))
   double log_likelihood = logLikelihood(x, m_cache_log_weighted_gaussian_likelihoods);
 
-  accStatisticsInternal(x, stats, log_likelihood);
+  accStatisticsInternal(x, stats, log_likelihood,
+    m_cache_log_weighted_gaussian_likelihoods, m_cache_P, m_cache_Px);
 }
 
 void bob::machine::GMMMachine::accStatistics_(const blitz::Array<double, 1>& x, bob::machine::GMMStats& stats) const {
@@ -314,14 +388,27 @@ void bob::machine::GMMMachine::accStatistics_(const blitz::Array<double, 1>& x,
   // - log_likelihood = log(sum_i(weight_i*p(x|gaussian_i)))
   double log_likelihood = logLikelihood_(x, m_cache_log_weighted_gaussian_likelihoods);
 
-  accStatisticsInternal(x, stats, log_likelihood);
+  accStatisticsInternal(x, stats, log_likelihood,
+    m_cache_log_weighted_gaussian_likelihoods, m_cache_P, m_cache_Px);
+}
+
+void bob::machine::GMMMachine::accStatistics_(const blitz::Array<double,1>& x,
+  bob::machine::GMMStats& stats,
+  blitz::Array<double,1>& log_weighted_gaussian_likelihoods,
+  blitz::Array<double,1>& P, blitz::Array<double,2>& Px) const
+{
+  double log_likelihood = logLikelihood_(x, log_weighted_gaussian_likelihoods);
+  accStatisticsInternal(x, stats, log_likelihood,
+    log_weighted_gaussian_likelihoods, P, Px);
 }
 
 void bob::machine::GMMMachine::accStatisticsInternal(const blitz::Array<double, 1>& x,
-  bob::machine::GMMStats& stats, const double log_likelihood) const
+  bob::machine::GMMStats& stats, const double log_likelihood,
+  const blitz::Array<double,1>& log_weighted_gaussian_likelihoods,
+  blitz::Array<double,1>& P, blitz::Array<double,2>& Px) const
 {
   // Calculate responsibilities
-  m_cache_P = blitz::exp(m_cache_log_weighted_gaussian_likelihoods - log_likelihood);
+  P = blitz::exp(log_weighted_gaussian_likelihoods - log_likelihood);
 
   // Accumulate statistics
   // - total likelihood
@@ -331,18 +418,18 @@ void bob::machine::GMMMachine::accStatisticsInternal(const blitz::Array<double,
   stats.T++;
 
   // - responsibilities
-  stats.n += m_cache_P;
+  stats.n += P;
 
   // - first order stats
   blitz::firstIndex i;
   blitz::secondIndex j;
 
-  m_cache_Px = m_cache_P(i) * x(j);
+  Px = P(i) * x(j);
 
-  stats.sumPx += m_cache_Px;
+  stats.sumPx += Px;
 
   // - second order stats
-  stats.sumPxx += (m_cache_Px(i,j) * x(j));
+  stats.sumPxx += (Px(i,j) * x(j));
 }
 
 boost::shared_ptr<const bob::machine::Gaussian> bob::machine::GMMMachine::getGaussian(const size_t i) const {
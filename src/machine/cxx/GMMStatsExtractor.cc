@@ -0,0 +1,203 @@
+/**
+ * @file machine/cxx/GMMStatsExtractor.cc
+ * @date Sun Oct 18 13:02:45 2026 +0200
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/machine/GMMStatsExtractor.h>
+#include <bob/core/assert.h>
+#include <bob/core/logging.h>
+#include <bob/core/parallel.h>
+#include <bob/io/utils.h>
+#include <boost/format.hpp>
+#include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace bob { namespace machine { namespace detail {
+
+  /**
+   * Worker of the GMMStatsExtractor: bob::core::parallel_queue() hands out
+   * the utterances one at a time, which balances the load between
+   * utterances of different lengths. The features are copied sample by
+   * sample into buffers owned by each thread, such that no blitz++ array is
+   * referenced by several threads (their reference counting is not
+   * thread-safe).
+   */
+  class GMMStatsExtractorOp {
+
+    public:
+
+      GMMStatsExtractorOp(const bob::machine::GMMMachine& ubm,
+          const std::vector<blitz::Array<double,2> >* features,
+          const std::vector<std::string>* feature_files, const size_t begin,
+          const size_t n_threads,
+          std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats):
+        m_ubm(ubm), m_features(features), m_feature_files(feature_files),
+        m_begin(begin), m_x(n_threads), m_log_weighted_gaussian_likelihoods(n_threads),
+        m_P(n_threads), m_Px(n_threads), m_stats(stats)
+      {
+        const size_t C = m_ubm.getNGaussians();
+        const size_t D = m_ubm.getNInputs();
+        for (size_t t=0; t<n_threads; ++t) {
+          m_x[t].resize(D);
+          m_log_weighted_gaussian_likelihoods[t].resize(C);
+          m_P[t].resize(C);
+          m_Px[t].resize(C,D);
+        }
+      }
+
+      void operator()(size_t thread, size_t item) {
+        const size_t i = m_begin + item;
+        boost::shared_ptr<bob::machine::GMMStats> stats(
+          new bob::machine::GMMStats(m_ubm.getNGaussians(), m_ubm.getNInputs()));
+        if (m_features) {
+          accumulate(thread, (*m_features)[i], *stats);
+        }
+        else {
+          blitz::Array<double,2> data;
+          {
+            boost::mutex::scoped_lock lock(m_io_mutex);
+            data.reference(bob::io::load<double,2>((*m_feature_files)[i]));
+          }
+          if (static_cast<size_t>(data.extent(1)) != m_ubm.getNInputs()) {
+            boost::format m("the features of file '%s' have %d dimensions, whereas the world model expects %u");
+            m % (*m_feature_files)[i] % data.extent(1) % m_ubm.getNInputs();
+            throw std::runtime_error(m.str());
+          }
+          accumulate(thread, data, *stats);
+        }
+        m_stats[item] = stats;
+      }
+
+    private:
+
+      void accumulate(const size_t thread, const blitz::Array<double,2>& data,
+          bob::machine::GMMStats& stats) {
+        blitz::Array<double,1>& x = m_x[thread];
+        for (int r=0; r<data.extent(0); ++r) {
+          for (int d=0; d<data.extent(1); ++d) x(d) = data(r,d);
+          m_ubm.accStatistics_(x, stats,
+            m_log_weighted_gaussian_likelihoods[thread], m_P[thread],
+            m_Px[thread]);
+        }
+      }
+
+      const bob::machine::GMMMachine& m_ubm;
+      const std::vector<blitz::Array<double,2> >* m_features;
+      const std::vector<std::string>* m_feature_files;
+      const size_t m_begin;
+      std::vector<blitz::Array<double,1> > m_x;
+      std::vector<blitz::Array<double,1> > m_log_weighted_gaussian_likelihoods;
+      std::vector<blitz::Array<double,1> > m_P;
+      std::vector<blitz::Array<double,2> > m_Px;
+      boost::mutex m_io_mutex;
+      std::vector<boost::shared_ptr<bob::machine::GMMStats> >& m_stats;
+  };
+
+}}}
+
+bob::machine::GMMStatsExtractor::GMMStatsExtractor(
+    const boost::shared_ptr<const bob::machine::GMMMachine> ubm,
+    const size_t n_threads, const size_t batch_size):
+  m_ubm(ubm), m_n_threads(n_threads), m_batch_size(batch_size)
+{
+  if (!m_ubm) throw std::runtime_error("GMMStatsExtractor: no world model was given");
+  if (m_batch_size == 0) throw std::runtime_error("GMMStatsExtractor: the batch size should be strictly positive");
+}
+
+bob::machine::GMMStatsExtractor::~GMMStatsExtractor()
+{
+}
+
+void bob::machine::GMMStatsExtractor::setUbm(
+    const boost::shared_ptr<const bob::machine::GMMMachine> ubm)
+{
+  if (!ubm) throw std::runtime_error("GMMStatsExtractor: no world model was given");
+  m_ubm = ubm;
+}
+
+void bob::machine::GMMStatsExtractor::setBatchSize(const size_t batch_size)
+{
+  if (batch_size == 0) throw std::runtime_error("GMMStatsExtractor: the batch size should be strictly positive");
+  m_batch_size = batch_size;
+}
+
+void bob::machine::GMMStatsExtractor::extractBatch(
+    const std::vector<blitz::Array<double,2> >* features,
+    const std::vector<std::string>* feature_files, const size_t begin,
+    const size_t end,
+    std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats) const
+{
+  stats.resize(end - begin);
+  const size_t n_threads = std::min(bob::core::thread_count(m_n_threads),
+    end - begin);
+  detail::GMMStatsExtractorOp op(*m_ubm, features, feature_files, begin,
+    n_threads, stats);
+  bob::core::parallel_queue(op, end - begin, n_threads);
+
+  bob::core::info << "# GMMStats extraction: " << end << " items processed" << std::endl;
+}
+
+void bob::machine::GMMStatsExtractor::extract(
+    const std::vector<blitz::Array<double,2> >& features,
+    std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats) const
+{
+  for (size_t i=0; i<features.size(); ++i) {
+    bob::core::array::assertZeroBase(features[i]);
+    bob::core::array::assertSameDimensionLength(features[i].extent(1),
+      m_ubm->getNInputs());
+  }
+
+  stats.clear();
+  stats.reserve(features.size());
+  std::vector<boost::shared_ptr<bob::machine::GMMStats> > batch;
+  for (size_t b=0; b<features.size(); b+=m_batch_size) {
+    const size_t e = std::min(b + m_batch_size, features.size());
+    extractBatch(&features, 0, b, e, batch);
+    stats.insert(stats.end(), batch.begin(), batch.end());
+  }
+}
+
+void bob::machine::GMMStatsExtractor::extract(
+    const std::vector<std::string>& feature_files,
+    bob::io::HDF5File& output) const
+{
+  std::vector<boost::shared_ptr<bob::machine::GMMStats> > batch;
+  for (size_t b=0; b<feature_files.size(); b+=m_batch_size) {
+    const size_t e = std::min(b + m_batch_size, feature_files.size());
+    extractBatch(0, &feature_files, b, e, batch);
+
+    // Writes the statistics of this batch, in order
+    for (size_t i=b; i<e; ++i) {
+      std::ostringstream oss;
+      oss << "stats" << i;
+      if (!output.hasGroup(oss.str())) output.createGroup(oss.str());
+      output.cd(oss.str());
+      batch[i-b]->save(output);
+      output.cd("..");
+    }
+  }
+}
+
+void bob::machine::GMMStatsExtractor::extract(
+    const std::vector<std::string>& feature_files,
+    const std::vector<std::string>& output_files) const
+{
+  bob::core::array::assertSameDimensionLength(feature_files.size(),
+    output_files.size());
+
+  std::vector<boost::shared_ptr<bob::machine::GMMStats> > batch;
+  for (size_t b=0; b<feature_files.size(); b+=m_batch_size) {
+    const size_t e = std::min(b + m_batch_size, feature_files.size());
+    extractBatch(0, &feature_files, b, e, batch);
+
+    // Writes the statistics of this batch
+    for (size_t i=b; i<e; ++i) {
+      bob::io::HDF5File output(output_files[i], 'w');
+      batch[i-b]->save(output);
+    }
+  }
+}
@@ -11,6 +11,34 @@
 
 #include <bob/core/assert.h>
 #include <bob/math/log.h>
+#include <algorithm>
+#include <vector>
+
+void bob::machine::detail::transposeBlock(const blitz::Array<double,2>& X,
+  const int begin, const int n, double* Xt)
+{
+  const int D = X.extent(1);
+  for (int k=0; k<n; ++k)
+    for (int d=0; d<D; ++d)
+      Xt[d*n+k] = X(begin+k,d);
+}
+
+void bob::machine::detail::diagonalGaussianKernel(const double* Xt,
+  const int n, const int D, const double* mean, const double* inv_variance,
+  const double constant, double* out)
+{
+  std::fill(out, out+n, 0.);
+  for (int d=0; d<D; ++d) {
+    const double m = mean[d];
+    const double iv = inv_variance[d];
+    const double* x = Xt + d*n;
+    for (int k=0; k<n; ++k) {
+      const double t = x[k] - m;
+      out[k] += t * t * iv;
+    }
+  }
+  for (int k=0; k<n; ++k) out[k] = constant - 0.5 * out[k];
+}
 
 bob::machine::Gaussian::Gaussian() {
   resize(0);
@@ -69,6 +97,9 @@ void bob::machine::Gaussian::copy(const bob::machine::Gaussian& other) {
   m_variance_thresholds.resize(m_n_inputs);
   m_variance_thresholds = other.m_variance_thresholds;
 
+  m_cache_inv_variance.resize(m_n_inputs);
+  m_cache_inv_variance = other.m_cache_inv_variance;
+
   m_n_log2pi = other.m_n_log2pi;
   m_g_norm = other.m_g_norm;
 }
@@ -143,12 +174,45 @@ double bob::machine::Gaussian::logLikelihood_(const blitz::Array<double,1> &x) c
   return (-0.5 * (m_g_norm + z));
 }
 
+void bob::machine::Gaussian::logLikelihood(const blitz::Array<double,2>& X,
+  blitz::Array<double,1>& output) const
+{
+  // Check
+  bob::core::array::assertSameDimensionLength(X.extent(1), m_n_inputs);
+  bob::core::array::assertSameDimensionLength(output.extent(0), X.extent(0));
+  logLikelihood_(X, output);
+}
+
+void bob::machine::Gaussian::logLikelihood_(const blitz::Array<double,2>& X,
+  blitz::Array<double,1>& output) const
+{
+  const int N = X.extent(0);
+  const int B = std::min(N, detail::gaussian_block_size);
+  std::vector<double> Xt(m_n_inputs * B);
+  std::vector<double> ll(B);
+  for (int b=0; b<N; b+=B) {
+    const int n = std::min(B, N-b);
+    detail::transposeBlock(X, b, n, &Xt[0]);
+    logLikelihoodBlock_(&Xt[0], n, 0., &ll[0]);
+    for (int k=0; k<n; ++k) output(b+k) = ll[k];
+  }
+}
+
+void bob::machine::Gaussian::logLikelihoodBlock_(const double* Xt,
+  const int n, const double offset, double* output) const
+{
+  detail::diagonalGaussianKernel(Xt, n, m_n_inputs, m_mean.data(),
+    m_cache_inv_variance.data(), offset - 0.5 * m_g_norm, output);
+}
+
 void bob::machine::Gaussian::preComputeNLog2Pi() {
   m_n_log2pi = m_n_inputs * bob::math::Log::Log2Pi;
 }
 
 void bob::machine::Gaussian::preComputeConstants() {
   m_g_norm = m_n_log2pi + blitz::sum(blitz::log(m_variance));
+  m_cache_inv_variance.resize(m_n_inputs);
+  m_cache_inv_variance = 1. / m_variance;
 }
 
 void bob::machine::Gaussian::save(bob::io::HDF5File& config) const {
@@ -174,6 +238,8 @@ void bob::machine::Gaussian::load(bob::io::HDF5File& config) {
 
   preComputeNLog2Pi();
   m_g_norm = config.read<double>("g_norm");
+  m_cache_inv_variance.resize(m_n_inputs);
+  m_cache_inv_variance = 1. / m_variance;
 }
 
 namespace bob{
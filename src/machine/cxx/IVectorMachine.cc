@@ -8,9 +8,87 @@
 
 #include <bob/machine/IVectorMachine.h>
 #include <bob/core/array_copy.h>
+#include <bob/core/assert.h>
 #include <bob/core/check.h>
+#include <bob/core/parallel.h>
+#include <bob/math/gemm.h>
 #include <bob/math/linear.h>
 #include <bob/math/linsolve.h>
+#include <algorithm>
+
+namespace bob { namespace machine { namespace detail {
+
+  /**
+   * Solves the system (Id + sum_c N_c T_c^T Sigma_c^{-1} T_c).[Cov|w] =
+   * [Id|T^T Sigma^{-1} Fnorm] of a block of utterances. The batch arrays
+   * are only accessed through raw pointers in the worker threads, as the
+   * reference counting of blitz++ arrays is not thread-safe.
+   */
+  class IVectorPosteriorOp {
+
+    public:
+
+      IVectorPosteriorOp(const int rt, const double* A, const double* b,
+          double* Ew, double* Eww):
+        m_rt(rt), m_A(A), m_b(b), m_Ew(Ew), m_Eww(Eww) {}
+
+      void operator()(size_t, size_t begin, size_t end) const {
+        const int rt = m_rt;
+        const int rt2 = rt * rt;
+        // Buffers of this thread
+        blitz::Array<double,2> A(rt, rt);
+        blitz::Array<double,1> b(rt);
+        blitz::Array<double,1> w(rt);
+        blitz::Array<double,2> B;
+        blitz::Array<double,2> X;
+        if (m_Eww) {
+          B.resize(rt, rt+1);
+          X.resize(rt, rt+1);
+        }
+
+        for (size_t u=begin; u<end; ++u) {
+          const double* A_u = m_A + u * rt2;
+          const double* b_u = m_b + u * rt;
+          double* Ew_u = m_Ew + u * rt;
+          std::copy(A_u, A_u + rt2, A.data());
+
+          if (m_Eww) {
+            // The posterior covariance is the inverse of A, obtained from
+            // the same Cholesky factorization as E{w}
+            B = 0.;
+            for (int r=0; r<rt; ++r) {
+              B(r,r) = 1.;
+              B(r,rt) = b_u[r];
+            }
+            bob::math::linsolveSympos_(A, X, B);
+            double* Eww_u = m_Eww + u * rt2;
+            for (int r1=0; r1<rt; ++r1) {
+              Ew_u[r1] = X(r1,rt);
+              for (int r2=0; r2<rt; ++r2)
+                Eww_u[r1*rt+r2] = X(r1,r2) + X(r1,rt) * X(r2,rt);
+            }
+          }
+          else {
+            std::copy(b_u, b_u + rt, b.data());
+            bob::math::linsolveSympos_(A, w, b);
+            std::copy(w.data(), w.data() + rt, Ew_u);
+          }
+        }
+      }
+
+    private:
+
+      const int m_rt;
+      const double* m_A;
+      const double* m_b;
+      double* m_Ew;
+      double* m_Eww;
+  };
+
+}}}
+
+// Number of utterances processed at once by the batch forward_()
+static const size_t s_forward_batch_size = 64;
 
 bob::machine::IVectorMachine::IVectorMachine()
 {
@@ -149,28 +227,26 @@ void bob::machine::IVectorMachine::precompute()
     // Apply variance threshold
     applyVarianceThreshold();
 
-    blitz::firstIndex i;
-    blitz::secondIndex j;
-    blitz::Range rall = blitz::Range::all();
     const int C = (int)m_ubm->getNGaussians();
     const int D = (int)m_ubm->getNInputs();
-    // T_{c}^{T}.sigma_{c}^{-1}
+    const int rt = (int)m_rt;
+    // sigma^{-1}.T
+    for (int i=0; i<C*D; ++i)
+      for (int r=0; r<rt; ++r)
+        m_cache_sigmaInvT(i,r) = m_T(i,r) / m_sigma(i);
+
+    // T_{c}^{T}.sigma_{c}^{-1}.T_{c}, computed with a matrix product on
+    // the contiguous blocks of rows of T and sigma^{-1}.T
     for (int c=0; c<C; ++c)
     {
-      blitz::Array<double,2> Tct_sigmacInv = m_cache_Tct_sigmacInv(c, rall, rall);
-      blitz::Array<double,2> Tc = m_T(blitz::Range(c*D,(c+1)*D-1), rall);
-      blitz::Array<double,2> Tct = Tc.transpose(1,0);
-      blitz::Array<double,1> sigma_c = m_sigma(blitz::Range(c*D,(c+1)*D-1));
-      Tct_sigmacInv = Tct(i,j) / sigma_c(j);
-    }
-
-    // T_{c}^{T}.sigma_{c}^{-1}.T_{c}
-    for (int c=0; c<C; ++c)
-    {
-      blitz::Array<double,2> Tc = m_T(blitz::Range(c*D,(c+1)*D-1), rall);
-      blitz::Array<double,2> Tct_sigmacInv = m_cache_Tct_sigmacInv(c, rall, rall);
-      blitz::Array<double,2> Tct_sigmacInv_Tc = m_cache_Tct_sigmacInv_Tc(c, rall, rall);
-      bob::math::prod(Tct_sigmacInv, Tc, Tct_sigmacInv_Tc);
+      blitz::Array<double,2> Tc(m_T.data() + c*D*rt, blitz::shape(D,rt),
+        blitz::neverDeleteData);
+      blitz::Array<double,2> sigmacInvTc(m_cache_sigmaInvT.data() + c*D*rt,
+        blitz::shape(D,rt), blitz::neverDeleteData);
+      blitz::Array<double,2> Tct_sigmacInv_Tc(
+        m_cache_Tct_sigmacInv_Tc.data() + c*rt*rt, blitz::shape(rt,rt),
+        blitz::neverDeleteData);
+      bob::math::gemm_(Tc, sigmacInvTc, Tct_sigmacInv_Tc, true, false);
     }
   }
 }
@@ -188,17 +264,14 @@ void bob::machine::IVectorMachine::resizeCache()
   {
     const int C = (int)m_ubm->getNGaussians();
     const int D = (int)m_ubm->getNInputs();
-    m_cache_Tct_sigmacInv.resize(C, (int)m_rt, D); 
-    m_cache_Tct_sigmacInv_Tc.resize(C, (int)m_rt, (int)m_rt);
+    m_cache_sigmaInvT.resize(C*D, (int)m_rt);
+    m_cache_Tct_sigmacInv_Tc.resize(C, (int)(m_rt*m_rt));
   }
 }
 
 void bob::machine::IVectorMachine::resizeTmp()
 {
-  if (m_ubm)
-    m_tmp_d.resize(m_ubm->getNInputs());
   m_tmp_t1.resize(m_rt);
-  m_tmp_t2.resize(m_rt);
   m_tmp_tt.resize(m_rt, m_rt);
 }
 
@@ -213,24 +286,34 @@ void bob::machine::IVectorMachine::computeIdTtSigmaInvT(
   const bob::machine::GMMStats& gs, blitz::Array<double,2>& output) const
 { 
   // Computes \f$(Id + \sum_{c=1}^{C} N_{i,j,c} T^{T} \Sigma_{c}^{-1} T)\f$
-  blitz::Range rall = blitz::Range::all();
+  const int rt = (int)m_rt;
   bob::math::eye(output);
   for (int c=0; c<(int)getDimC(); ++c)
-    output += gs.n(c) * m_cache_Tct_sigmacInv_Tc(c, rall, rall);
+  {
+    const double n_c = gs.n(c);
+    for (int r1=0; r1<rt; ++r1)
+      for (int r2=0; r2<rt; ++r2)
+        output(r1,r2) += n_c * m_cache_Tct_sigmacInv_Tc(c, r1*rt+r2);
+  }
 }
 
 void bob::machine::IVectorMachine::computeTtSigmaInvFnorm(
   const bob::machine::GMMStats& gs, blitz::Array<double,1>& output) const
 {
   // Computes \f$T^{T} \Sigma^{-1} \sum_{c=1}^{C} (F_c - N_c ubmmean_{c})\f$
-  blitz::Range rall = blitz::Range::all();
+  const int D = (int)getDimD();
+  const int rt = (int)m_rt;
+  const blitz::Array<double,1>& ubm_mean = m_ubm->getMeanSupervector();
   output = 0;
   for (int c=0; c<(int)getDimC(); ++c)
   {
-    m_tmp_d = gs.sumPx(c,rall) - gs.n(c) * m_ubm->getGaussian(c)->getMean();
-    blitz::Array<double,2> Tct_sigmacInv = m_cache_Tct_sigmacInv(c, rall, rall);
-    bob::math::prod(Tct_sigmacInv, m_tmp_d, m_tmp_t2);
-    output += m_tmp_t2;
+    for (int d=0; d<D; ++d)
+    {
+      const int i = c*D+d;
+      const double fnorm = gs.sumPx(c,d) - gs.n(c) * ubm_mean(i);
+      for (int r=0; r<rt; ++r)
+        output(r) += m_cache_sigmaInvT(i,r) * fnorm;
+    }
   }
 }
 
@@ -243,7 +326,94 @@ void bob::machine::IVectorMachine::forward_(const bob::machine::GMMStats& gs,
   // Computes \f$T^{T} \Sigma^{-1} \sum_{c=1}^{C} (F_c - N_c ubmmean_{c})\f$
   computeTtSigmaInvFnorm(gs, m_tmp_t1);
 
-  // Solves m_tmp_tt.ivector = m_tmp_t1
-  bob::math::linsolve(m_tmp_tt, ivector, m_tmp_t1);
+  // Solves m_tmp_tt.ivector = m_tmp_t1 (m_tmp_tt is symmetric positive
+  // definite, such that a Cholesky decomposition can be used)
+  bob::math::linsolveSympos_(m_tmp_tt, ivector, m_tmp_t1);
+}
+
+void bob::machine::IVectorMachine::computePosteriors_(
+  const std::vector<bob::machine::GMMStats>& input, const size_t begin,
+  const size_t end, blitz::Array<double,2>& N, blitz::Array<double,2>& Fnorm,
+  blitz::Array<double,2>& Ew, blitz::Array<double,2>* Eww,
+  const size_t n_threads) const
+{
+  const int U = (int)(end - begin);
+  const int C = (int)getDimC();
+  const int D = (int)getDimD();
+  const int rt = (int)m_rt;
+  if (U == 0) return;
+
+  // Zeroth order and centered first order statistics
+  const blitz::Array<double,1>& ubm_mean = m_ubm->getMeanSupervector();
+  for (int u=0; u<U; ++u)
+  {
+    const bob::machine::GMMStats& gs = input[begin+u];
+    for (int c=0; c<C; ++c)
+    {
+      const double n_c = gs.n(c);
+      N(u,c) = n_c;
+      for (int d=0; d<D; ++d)
+        Fnorm(u,c*D+d) = gs.sumPx(c,d) - n_c * ubm_mean(c*D+d);
+    }
+  }
+
+  // Computes \f$(Id + \sum_{c=1}^{C} N_{i,j,c} T^{T} \Sigma_{c}^{-1} T)\f$
+  // for all the utterances at once (one flattened rt x rt matrix per row).
+  // The Eww array is used as storage, as the solver only reads A before
+  // writing E{w.w^T} for the same utterance.
+  blitz::Array<double,2> A;
+  if (Eww) A.reference(*Eww);
+  else A.resize(U, rt*rt);
+  bob::math::gemm_(N, m_cache_Tct_sigmacInv_Tc, A, false, false, 1., 0.,
+    n_threads);
+  for (int u=0; u<U; ++u)
+    for (int r=0; r<rt; ++r)
+      A(u,r*rt+r) += 1.;
+
+  // Computes \f$T^{T} \Sigma^{-1} \sum_{c=1}^{C} (F_c - N_c ubmmean_{c})\f$
+  // for all the utterances at once
+  blitz::Array<double,2> b(U, rt);
+  bob::math::gemm_(Fnorm, m_cache_sigmaInvT, b, false, false, 1., 0.,
+    n_threads);
+
+  // Solves the U linear systems
+  detail::IVectorPosteriorOp op(rt, A.data(), b.data(), Ew.data(),
+    Eww ? Eww->data() : 0);
+  bob::core::parallel_for(op, U, n_threads);
+}
+
+void bob::machine::IVectorMachine::forward(
+  const std::vector<bob::machine::GMMStats>& input,
+  blitz::Array<double,2>& ivectors, const size_t n_threads) const
+{
+  bob::core::array::assertZeroBase(ivectors);
+  bob::core::array::assertSameDimensionLength(ivectors.extent(0),
+    (int)input.size());
+  bob::core::array::assertSameDimensionLength(ivectors.extent(1), (int)m_rt);
+  forward_(input, ivectors, n_threads);
 }
 
+void bob::machine::IVectorMachine::forward_(
+  const std::vector<bob::machine::GMMStats>& input,
+  blitz::Array<double,2>& ivectors, const size_t n_threads) const
+{
+  const size_t batch_size = std::min(s_forward_batch_size, input.size());
+  blitz::Array<double,2> N(batch_size, getDimC());
+  blitz::Array<double,2> Fnorm(batch_size, getDimCD());
+  blitz::Array<double,2> Ew(batch_size, m_rt);
+  const blitz::Range rall = blitz::Range::all();
+  for (size_t b=0; b<input.size(); b+=batch_size)
+  {
+    const size_t e = std::min(b + batch_size, input.size());
+    const int U = (int)(e - b);
+    // Views on the first U rows (contiguous)
+    blitz::Array<double,2> N_b(N.data(), blitz::shape(U, N.extent(1)),
+      blitz::neverDeleteData);
+    blitz::Array<double,2> Fnorm_b(Fnorm.data(),
+      blitz::shape(U, Fnorm.extent(1)), blitz::neverDeleteData);
+    blitz::Array<double,2> Ew_b(Ew.data(), blitz::shape(U, Ew.extent(1)),
+      blitz::neverDeleteData);
+    computePosteriors_(input, b, e, N_b, Fnorm_b, Ew_b, 0, n_threads);
+    ivectors(blitz::Range((int)b, (int)e-1), rall) = Ew_b;
+  }
+}
@@ -8,11 +8,14 @@
  */
 
 #include <bob/machine/KMeansMachine.h>
+#include <bob/machine/Gaussian.h>
 
 #include <bob/core/assert.h>
 #include <bob/core/check.h>
 #include <bob/core/array_copy.h>
+#include <algorithm>
 #include <limits>
+#include <vector>
 
 bob::machine::KMeansMachine::KMeansMachine():
   m_n_means(0), m_n_inputs(0), m_means(0,0),
@@ -172,21 +175,37 @@ void bob::machine::KMeansMachine::getVariancesAndWeightsForEachClusterAcc(const
   bob::core::array::assertSameShape(variances, m_means);
   bob::core::array::assertSameDimensionLength(weights.extent(0), m_n_means);
 
+  // The distances to the means are computed by blocks of samples, using the
+  // batch kernel of the Gaussians with unit variances: it returns
+  // -0.5*sum(pow2(x-mean)), which is maximal for the closest mean
+  const int N = data.extent(0);
+  const int B = std::min(N, bob::machine::detail::gaussian_block_size);
+  std::vector<double> Xt(m_n_inputs*B), l(m_n_means*B);
+  std::vector<double> ones(m_n_inputs, 1.);
+
   // iterate over data
   blitz::Range a = blitz::Range::all();
-  for(int i=0; i<data.extent(0); ++i) {
-    // - get example
-    blitz::Array<double,1> x(data(i,a));
-
-    // - find closest mean
-    size_t closest_mean = 0;
-    double min_distance = 0;
-    getClosestMean(x,closest_mean,min_distance);
-
-    // - accumulate stats
-    m_cache_means(closest_mean, blitz::Range::all()) += x;
-    variances(closest_mean, blitz::Range::all()) += blitz::pow2(x);
-    ++weights(closest_mean);
+  for(int b=0; b<N; b+=B) {
+    const int n = std::min(B, N-b);
+    bob::machine::detail::transposeBlock(data, b, n, &Xt[0]);
+    for(size_t j=0; j<m_n_means; ++j)
+      bob::machine::detail::diagonalGaussianKernel(&Xt[0], n, m_n_inputs,
+        m_means.data() + j*m_n_inputs, &ones[0], 0., &l[j*n]);
+
+    for(int k=0; k<n; ++k) {
+      // - get example
+      blitz::Array<double,1> x(data(b+k,a));
+
+      // - find closest mean
+      size_t closest_mean = 0;
+      for(size_t j=1; j<m_n_means; ++j)
+        if(l[j*n+k] > l[closest_mean*n+k]) closest_mean = j;
+
+      // - accumulate stats
+      m_cache_means(closest_mean, blitz::Range::all()) += x;
+      variances(closest_mean, blitz::Range::all()) += blitz::pow2(x);
+      ++weights(closest_mean);
+    }
   }
 }
 
@@ -6,71 +6,176 @@
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
 #include <bob/machine/LinearScoring.h>
-#include <bob/math/linear.h>
+#include <bob/math/gemm.h>
+#include <bob/core/parallel.h>
+#include <algorithm>
+#include <limits>
 
 namespace bob { namespace machine {
 
 namespace detail {
 
-  void linearScoring(const std::vector<blitz::Array<double,1> >& models,
+  /**
+   * Fills B for a block of test statistics (one contiguous row of B' per
+   * trial). Only element accesses are performed on the shared arrays, as the
+   * reference counting of blitz++ arrays is not thread-safe.
+   */
+  class LinearScoringProbeOp {
+
+    public:
+
+      LinearScoringProbeOp(const blitz::Array<double,1>& ubm_mean,
+          const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
+          const std::vector<blitz::Array<double,1> >* test_channelOffset,
+          const bool frame_length_normalisation, const size_t offset,
+          blitz::Array<double,2>& Bt):
+        m_ubm_mean(ubm_mean), m_test_stats(test_stats),
+        m_test_channelOffset(test_channelOffset),
+        m_frame_length_normalisation(frame_length_normalisation),
+        m_offset(offset), m_Bt(Bt) {}
+
+      void operator()(size_t, size_t begin, size_t end) const {
+        for (size_t i=begin; i<end; ++i) {
+          const bob::machine::GMMStats& stats = *m_test_stats[m_offset+i];
+          const int C = stats.sumPx.extent(0);
+          const int D = stats.sumPx.extent(1);
+          double* row = m_Bt.data() + i*m_Bt.extent(1);
+
+          if (m_test_channelOffset == 0) {
+            for (int c=0, s=0; c<C; ++c) {
+              const double n_c = stats.n(c);
+              for (int d=0; d<D; ++d, ++s)
+                row[s] = stats.sumPx(c,d) - n_c * m_ubm_mean(s);
+            }
+          }
+          else {
+            const blitz::Array<double,1>& offset = (*m_test_channelOffset)[m_offset+i];
+            for (int c=0, s=0; c<C; ++c) {
+              const double n_c = stats.n(c);
+              for (int d=0; d<D; ++d, ++s)
+                row[s] = stats.sumPx(c,d) - n_c * (m_ubm_mean(s) + offset(s));
+            }
+          }
+
+          // Apply the normalisation if needed
+          if (m_frame_length_normalisation) {
+            const double sum_N = stats.T;
+            const int CD = C*D;
+            if (sum_N <= std::numeric_limits<double>::epsilon() && sum_N >= -std::numeric_limits<double>::epsilon())
+              std::fill(row, row+CD, 0.);
+            else {
+              const double inv_sum_N = 1. / sum_N;
+              for (int s=0; s<CD; ++s) row[s] *= inv_sum_N;
+            }
+          }
+        }
+      }
+
+    private:
+
+      const blitz::Array<double,1>& m_ubm_mean;
+      const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& m_test_stats;
+      const std::vector<blitz::Array<double,1> >* m_test_channelOffset;
+      const bool m_frame_length_normalisation;
+      const size_t m_offset;
+      blitz::Array<double,2>& m_Bt;
+  };
+
+  /**
+   * Computes the scores, given A = (models - ubm_mean) / ubm_variance with
+   * one model per row. The test statistics are processed by chunks, such
+   * that B is never fully materialised: for each chunk, B' is filled in
+   * row-major order and scores(:,chunk) = A * B' is computed with the BLAS.
+   */
+  void linearScoring(const blitz::Array<double,2>& A,
                      const blitz::Array<double,1>& ubm_mean,
-                     const blitz::Array<double,1>& ubm_variance,
                      const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                      const std::vector<blitz::Array<double,1> >* test_channelOffset,
                      const bool frame_length_normalisation,
-                     blitz::Array<double,2>& scores) 
+                     blitz::Array<double,2>& scores,
+                     const size_t n_threads, const size_t chunk_size)
   {
-    int C = test_stats[0]->sumPx.extent(0);
-    int D = test_stats[0]->sumPx.extent(1);
-    int CD = C*D;
-    int Tt = test_stats.size();
-    int Tm = models.size();
+    const int CD = A.extent(1);
+    const int Tt = test_stats.size();
 
     // Check output size
-    bob::core::array::assertSameDimensionLength(scores.extent(0), models.size());
-    bob::core::array::assertSameDimensionLength(scores.extent(1), test_stats.size());
+    bob::core::array::assertSameDimensionLength(scores.extent(0), A.extent(0));
+    bob::core::array::assertSameDimensionLength(scores.extent(1), Tt);
+    bob::core::array::assertSameDimensionLength(ubm_mean.extent(0), CD);
+    if (Tt == 0) return;
 
-    blitz::Array<double,2> A(Tm, CD);
-    blitz::Array<double,2> B(CD, Tt);
+    if (test_channelOffset != 0) {
+      bob::core::array::assertSameDimensionLength((*test_channelOffset).size(), Tt);
+      for (int t=0; t<Tt; ++t)
+        bob::core::array::assertSameDimensionLength((*test_channelOffset)[t].extent(0), CD);
+    }
+    for (int t=0; t<Tt; ++t) {
+      bob::core::array::assertSameDimensionLength(test_stats[t]->sumPx.extent(0)*test_stats[t]->sumPx.extent(1), CD);
+    }
+
+    const int chunk = (chunk_size == 0 ? Tt : std::min((int)chunk_size, Tt));
+    blitz::Array<double,2> Bt(chunk, CD);
+    for (int b=0; b<Tt; b+=chunk) {
+      const int n = std::min(chunk, Tt-b);
+      blitz::Array<double,2> Bt_n = Bt(blitz::Range(0,n-1), blitz::Range::all());
+
+      // 2) Compute B' for this chunk
+      LinearScoringProbeOp op(ubm_mean, test_stats, test_channelOffset,
+        frame_length_normalisation, b, Bt_n);
+      bob::core::parallel_for(op, n, n_threads);
+
+      // 3) Compute LLR
+      blitz::Array<double,2> scores_n = scores(blitz::Range::all(), blitz::Range(b,b+n-1));
+      bob::math::gemm_(A, Bt_n, scores_n, false, true, 1., 0., n_threads);
+    }
+  }
+
+  void linearScoring(const std::vector<blitz::Array<double,1> >& models,
+                     const blitz::Array<double,1>& ubm_mean,
+                     const blitz::Array<double,1>& ubm_variance,
+                     const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
+                     const std::vector<blitz::Array<double,1> >* test_channelOffset,
+                     const bool frame_length_normalisation,
+                     blitz::Array<double,2>& scores,
+                     const size_t n_threads, const size_t chunk_size)
+  {
+    const int CD = ubm_mean.extent(0);
+    const int Tm = models.size();
 
     // 1) Compute A
+    blitz::Array<double,2> A(Tm, CD);
     for(int t=0; t<Tm; ++t) {
       blitz::Array<double, 1> tmp = A(t, blitz::Range::all());
       tmp = (models[t] - ubm_mean) / ubm_variance;
     }
 
-    // 2) Compute B
-    if(test_channelOffset == 0) {
-      for(int t=0; t<Tt; ++t) 
-        for(int s=0; s<CD; ++s)
-          B(s, t) = test_stats[t]->sumPx(s/D, s%D) - (ubm_mean(s) * test_stats[t]->n(s/D));
-    }
-    else {
-      bob::core::array::assertSameDimensionLength((*test_channelOffset).size(), Tt);
-      
-      for(int t=0; t<Tt; ++t) {
-        bob::core::array::assertSameDimensionLength((*test_channelOffset)[t].extent(0), CD);
-        for(int s=0; s<CD; ++s) 
-          B(s, t) = test_stats[t]->sumPx(s/D, s%D) - (test_stats[t]->n(s/D) * (ubm_mean(s) + (*test_channelOffset)[t](s)));
-      }
-    }
+    linearScoring(A, ubm_mean, test_stats, test_channelOffset,
+      frame_length_normalisation, scores, n_threads, chunk_size);
+  }
 
-    // Apply the normalisation if needed
-    if(frame_length_normalisation) {
-      for(int t=0; t<Tt; ++t) {
-        double sum_N = test_stats[t]->T;
-        blitz::Array<double, 1> v_t = B(blitz::Range::all(),t);
+  void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
+                     const bob::machine::GMMMachine& ubm,
+                     const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
+                     const std::vector<blitz::Array<double,1> >* test_channelOffset,
+                     const bool frame_length_normalisation,
+                     blitz::Array<double,2>& scores,
+                     const size_t n_threads, const size_t chunk_size)
+  {
+    const blitz::Array<double,1>& ubm_mean = ubm.getMeanSupervector();
+    const blitz::Array<double,1>& ubm_variance = ubm.getVarianceSupervector();
+    const int CD = ubm_mean.extent(0);
+    const int Tm = models.size();
 
-        if (sum_N <= std::numeric_limits<double>::epsilon() && sum_N >= -std::numeric_limits<double>::epsilon())
-          v_t = 0;
-        else 
-          v_t /= sum_N;
-      }
+    // 1) Compute A, directly from the cached mean supervectors
+    blitz::Array<double,2> A(Tm, CD);
+    for(int t=0; t<Tm; ++t) {
+      blitz::Array<double, 1> tmp = A(t, blitz::Range::all());
+      tmp = (models[t]->getMeanSupervector() - ubm_mean) / ubm_variance;
     }
 
-    // 3) Compute LLR
-    bob::math::prod(A, B, scores);
-  } 
+    linearScoring(A, ubm_mean, test_stats, test_channelOffset,
+      frame_length_normalisation, scores, n_threads, chunk_size);
+  }
 }
 
 
@@ -79,39 +184,30 @@ void linearScoring(const std::vector<blitz::Array<double,1> >& models,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const std::vector<blitz::Array<double,1> >& test_channelOffset,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores)
+                   blitz::Array<double, 2>& scores,
+                   const size_t n_threads, const size_t chunk_size)
 {
-  detail::linearScoring(models, ubm_mean, ubm_variance, test_stats, &test_channelOffset, frame_length_normalisation, scores);
+  detail::linearScoring(models, ubm_mean, ubm_variance, test_stats, &test_channelOffset, frame_length_normalisation, scores, n_threads, chunk_size);
 }
 
 void linearScoring(const std::vector<blitz::Array<double,1> >& models,
                    const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores)
+                   blitz::Array<double, 2>& scores,
+                   const size_t n_threads, const size_t chunk_size)
 {
-  detail::linearScoring(models, ubm_mean, ubm_variance, test_stats, 0, frame_length_normalisation, scores);
+  detail::linearScoring(models, ubm_mean, ubm_variance, test_stats, 0, frame_length_normalisation, scores, n_threads, chunk_size);
 }
 
 void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
                    const bob::machine::GMMMachine& ubm,
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores) 
+                   blitz::Array<double, 2>& scores,
+                   const size_t n_threads, const size_t chunk_size)
 {
-  int C = test_stats[0]->sumPx.extent(0);
-  int D = test_stats[0]->sumPx.extent(1);
-  int CD = C*D;
-  std::vector<blitz::Array<double,1> > models_b;
-  // Allocate and get the mean supervector
-  for(size_t i=0; i<models.size(); ++i) {
-    blitz::Array<double,1> mod(CD);
-    models[i]->getMeanSupervector(mod);
-    models_b.push_back(mod);
-  }
-  const blitz::Array<double,1>& ubm_mean = ubm.getMeanSupervector();
-  const blitz::Array<double,1>& ubm_variance = ubm.getVarianceSupervector();
-  detail::linearScoring(models_b, ubm_mean, ubm_variance, test_stats, 0, frame_length_normalisation, scores);
+  detail::linearScoring(models, ubm, test_stats, 0, frame_length_normalisation, scores, n_threads, chunk_size);
 }
 
 void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMachine> >& models,
@@ -119,21 +215,10 @@ void linearScoring(const std::vector<boost::shared_ptr<const bob::machine::GMMMa
                    const std::vector<boost::shared_ptr<const bob::machine::GMMStats> >& test_stats,
                    const std::vector<blitz::Array<double,1> >& test_channelOffset,
                    const bool frame_length_normalisation,
-                   blitz::Array<double, 2>& scores) 
+                   blitz::Array<double, 2>& scores,
+                   const size_t n_threads, const size_t chunk_size)
 {
-  int C = test_stats[0]->sumPx.extent(0);
-  int D = test_stats[0]->sumPx.extent(1);
-  int CD = C*D;
-  std::vector<blitz::Array<double,1> > models_b;
-  // Allocate and get the mean supervector
-  for(size_t i=0; i<models.size(); ++i) {
-    blitz::Array<double,1> mod(CD);
-    models[i]->getMeanSupervector(mod);
-    models_b.push_back(mod);
-  }
-  const blitz::Array<double,1>& ubm_mean = ubm.getMeanSupervector();
-  const blitz::Array<double,1>& ubm_variance = ubm.getVarianceSupervector();
-  detail::linearScoring(models_b, ubm_mean, ubm_variance, test_stats, &test_channelOffset, frame_length_normalisation, scores);
+  detail::linearScoring(models, ubm, test_stats, &test_channelOffset, frame_length_normalisation, scores, n_threads, chunk_size);
 }
 
 
@@ -156,8 +241,11 @@ double linearScoring(const blitz::Array<double,1>& models,
   A = (models - ubm_mean) / ubm_variance;
 
   // 2) Compute B
-  for (int s=0; s<CD; ++s) 
-    B(s) = test_stats.sumPx(s/D, s%D) - (test_stats.n(s/D) * (ubm_mean(s) + test_channelOffset(s)));
+  for (int c=0, s=0; c<C; ++c) {
+    const double n_c = test_stats.n(c);
+    for (int d=0; d<D; ++d, ++s)
+      B(s) = test_stats.sumPx(c,d) - (n_c * (ubm_mean(s) + test_channelOffset(s)));
+  }
 
   // Apply the normalisation if needed
   if (frame_length_normalisation) {
@@ -0,0 +1,112 @@
+/**
+ * @file machine/cxx/benchmark/gaussian.cc
+ * @date Sun Oct 18 16:21:37 2026 +0200
+ *
+ * @brief Benchmark of the per-sample and batch log-likelihood computations
+ * of Gaussians and GMMs
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/core/array_random.h>
+#include <bob/machine/Gaussian.h>
+#include <bob/machine/GMMMachine.h>
+
+#include <boost/random.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <iostream>
+
+void benchmark_gaussian(const blitz::Array<double,2>& X,
+  const bob::machine::Gaussian& g)
+{
+  const int N = X.extent(0);
+  blitz::Array<double,1> ll_sample(N), ll_batch(N);
+  boost::posix_time::ptime t1;
+  boost::posix_time::ptime t2;
+  boost::posix_time::time_duration diff;
+
+  std::cout << "Gaussian of dimension " << X.extent(1) << " on " << N << " samples..." << std::endl;
+
+  // process sample by sample
+  t1 = boost::posix_time::microsec_clock::local_time();
+  for (int i=0; i<N; ++i)
+    ll_sample(i) = g.logLikelihood_(X(i,blitz::Range::all()));
+  t2 = boost::posix_time::microsec_clock::local_time();
+  diff = t2 - t1;
+  std::cout << "  Per-sample duration in (microseconds) " << diff.total_microseconds() << std::endl;
+
+  // process using the batch kernel
+  t1 = boost::posix_time::microsec_clock::local_time();
+  g.logLikelihood_(X, ll_batch);
+  t2 = boost::posix_time::microsec_clock::local_time();
+  diff = t2 - t1;
+  std::cout << "  Batch duration in (microseconds) " << diff.total_microseconds() << std::endl;
+  std::cout << "  Maximum absolute difference " << blitz::max(blitz::abs(ll_sample - ll_batch)) << std::endl;
+}
+
+void benchmark_gmm(const blitz::Array<double,2>& X,
+  const bob::machine::GMMMachine& gmm)
+{
+  const int N = X.extent(0);
+  blitz::Array<double,1> ll_sample(N), ll_batch(N);
+  boost::posix_time::ptime t1;
+  boost::posix_time::ptime t2;
+  boost::posix_time::time_duration diff;
+
+  std::cout << "GMM of " << gmm.getNGaussians() << " Gaussians of dimension " << X.extent(1) << " on " << N << " samples..." << std::endl;
+
+  // process sample by sample
+  t1 = boost::posix_time::microsec_clock::local_time();
+  for (int i=0; i<N; ++i)
+    ll_sample(i) = gmm.logLikelihood_(X(i,blitz::Range::all()));
+  t2 = boost::posix_time::microsec_clock::local_time();
+  diff = t2 - t1;
+  std::cout << "  Per-sample duration in (microseconds) " << diff.total_microseconds() << std::endl;
+
+  // process using the batch kernel
+  t1 = boost::posix_time::microsec_clock::local_time();
+  gmm.logLikelihood_(X, ll_batch);
+  t2 = boost::posix_time::microsec_clock::local_time();
+  diff = t2 - t1;
+  std::cout << "  Batch duration in (microseconds) " << diff.total_microseconds() << std::endl;
+  std::cout << "  Maximum absolute difference " << blitz::max(blitz::abs(ll_sample - ll_batch)) << std::endl;
+}
+
+/*************** Gaussian benchmarks *****************/
+int main()
+{
+  boost::mt19937 rng(0);
+  const int N = 10000;
+
+  const int P=4;
+  int dims[P] = {20, 39, 60, 120};
+  for(int i=0; i<P; ++i)
+  {
+    const int D = dims[i];
+    blitz::Array<double,2> X(N,D);
+    bob::core::array::randn(rng, X);
+
+    // Single Gaussian
+    bob::machine::Gaussian g(D);
+    blitz::Array<double,1> mean(D), variance(D);
+    bob::core::array::randn(rng, mean);
+    bob::core::array::randn(rng, variance);
+    variance = 0.5 + blitz::abs(variance);
+    g.setMean(mean);
+    g.setVariance(variance);
+    benchmark_gaussian(X, g);
+
+    // Mixture of Gaussians
+    const int C = 256;
+    bob::machine::GMMMachine gmm(C, D);
+    blitz::Array<double,2> means(C,D), variances(C,D);
+    bob::core::array::randn(rng, means);
+    bob::core::array::randn(rng, variances);
+    variances = 0.5 + blitz::abs(variances);
+    gmm.setMeans(means);
+    gmm.setVariances(variances);
+    benchmark_gmm(X, gmm);
+  }
+
+  return 0;
+}
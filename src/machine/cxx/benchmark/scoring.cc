@@ -0,0 +1,106 @@
+/**
+ * @file machine/cxx/benchmark/scoring.cc
+ * @date Sun Oct 18 19:26:40 2026 +0200
+ *
+ * @brief Benchmark of the GMM statistics accumulation, of the linear
+ * scoring and of the ZT-normalization
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/core/array_random.h>
+#include <bob/core/benchmark.h>
+#include <bob/machine/GMMMachine.h>
+#include <bob/machine/GMMStats.h>
+#include <bob/machine/LinearScoring.h>
+#include <bob/machine/ZTNorm.h>
+
+#include <boost/format.hpp>
+#include <boost/random.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+void benchmark_acc_statistics(bob::core::BenchmarkSuite& suite,
+  boost::mt19937& rng, const int C, const int D, const int N)
+{
+  bob::machine::GMMMachine gmm(C, D);
+  blitz::Array<double,2> means(C,D), variances(C,D), X(N,D);
+  bob::core::array::randn(rng, means);
+  bob::core::array::randn(rng, variances);
+  variances = 0.5 + blitz::abs(variances);
+  gmm.setMeans(means);
+  gmm.setVariances(variances);
+  bob::core::array::randn(rng, X);
+
+  bob::machine::GMMStats stats(C, D);
+  const std::string size = (boost::format("C=%d,D=%d,N=%d") % C % D % N).str();
+  while (suite.iterate("GMMMachine::accStatistics", size)) {
+    stats.init();
+    gmm.accStatistics(X, stats);
+  }
+}
+
+void benchmark_linear_scoring(bob::core::BenchmarkSuite& suite,
+  boost::mt19937& rng, const int C, const int D, const int n_models,
+  const int n_tests)
+{
+  blitz::Array<double,1> ubm_mean(C*D), ubm_variance(C*D);
+  bob::core::array::randn(rng, ubm_mean);
+  bob::core::array::randn(rng, ubm_variance);
+  ubm_variance = 0.5 + blitz::abs(ubm_variance);
+
+  std::vector<blitz::Array<double,1> > models;
+  for (int i=0; i<n_models; ++i) {
+    blitz::Array<double,1> m(C*D);
+    bob::core::array::randn(rng, m);
+    models.push_back(m);
+  }
+  std::vector<boost::shared_ptr<const bob::machine::GMMStats> > stats;
+  for (int i=0; i<n_tests; ++i) {
+    boost::shared_ptr<bob::machine::GMMStats> s(new bob::machine::GMMStats(C, D));
+    bob::core::array::randn(rng, s->n);
+    s->n = blitz::abs(s->n) * 10.;
+    bob::core::array::randn(rng, s->sumPx);
+    s->T = 1000;
+    stats.push_back(s);
+  }
+
+  blitz::Array<double,2> scores(n_models, n_tests);
+  const std::string size = (boost::format("C=%d,D=%d,%dx%d") % C % D % n_models % n_tests).str();
+  while (suite.iterate("linearScoring", size))
+    bob::machine::linearScoring(models, ubm_mean, ubm_variance, stats, true,
+      scores);
+}
+
+void benchmark_ztnorm(bob::core::BenchmarkSuite& suite, boost::mt19937& rng,
+  const int n_models, const int n_probes, const int n_tmodels,
+  const int n_zprobes)
+{
+  blitz::Array<double,2> A(n_probes, n_models), B(n_zprobes, n_models),
+    C(n_probes, n_tmodels), D(n_zprobes, n_tmodels), out(n_probes, n_models);
+  bob::core::array::randn(rng, A);
+  bob::core::array::randn(rng, B);
+  bob::core::array::randn(rng, C);
+  bob::core::array::randn(rng, D);
+
+  const std::string size = (boost::format("%dx%d,%dx%d") % n_probes % n_models % n_zprobes % n_tmodels).str();
+  while (suite.iterate("ztNorm", size))
+    bob::machine::ztNorm(A, B, C, D, out);
+}
+
+/*************** Scoring benchmarks *****************/
+int main(int argc, char** argv)
+{
+  bob::core::BenchmarkSuite suite("machine", argc, argv);
+  boost::mt19937 rng(0);
+
+  benchmark_acc_statistics(suite, rng, 256, 60, 1000);
+  benchmark_acc_statistics(suite, rng, 512, 60, 1000);
+  benchmark_linear_scoring(suite, rng, 256, 60, 100, 1000);
+  benchmark_linear_scoring(suite, rng, 512, 60, 500, 1000);
+  benchmark_ztnorm(suite, rng, 500, 1000, 200, 200);
+  benchmark_ztnorm(suite, rng, 2000, 2000, 500, 500);
+
+  suite.report();
+  return 0;
+}
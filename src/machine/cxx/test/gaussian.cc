@@ -0,0 +1,206 @@
+/**
+ * @file machine/cxx/test/gaussian.cc
+ * @date Mon Oct 19 09:12:44 2026 +0200
+ *
+ * @brief Compares the batch log-likelihood computations of the Gaussian,
+ * GMM, KMeans and BIC machines with the per-sample ones
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE machine-Gaussian Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/random.hpp>
+#include <blitz/array.h>
+#include <cmath>
+#include <vector>
+
+#include <bob/core/array_random.h>
+#include <bob/machine/Gaussian.h>
+#include <bob/machine/GMMMachine.h>
+#include <bob/machine/KMeansMachine.h>
+#include <bob/machine/BICMachine.h>
+
+/**
+ * Random samples of a few sizes around the block size of the batch kernel,
+ * and of two dimensionalities
+ */
+struct T {
+  boost::mt19937 rng;
+  std::vector<int> sizes, dims;
+
+  T(): rng(0) {
+    const int n[] = { 1, 7, 127, 128, 129, 300 };
+    sizes.assign(n, n + sizeof(n) / sizeof(n[0]));
+    const int d[] = { 3, 39 };
+    dims.assign(d, d + sizeof(d) / sizeof(d[0]));
+  }
+
+  blitz::Array<double,2> samples(const int N, const int D) {
+    blitz::Array<double,2> X(N, D);
+    bob::core::array::randn(rng, X);
+    return X;
+  }
+
+  blitz::Array<double,1> variances(const int D) {
+    blitz::Array<double,1> v(D);
+    bob::core::array::randn(rng, v);
+    v = 0.5 + blitz::abs(v);
+    return v;
+  }
+};
+
+/**
+ * Checks that the relative difference between a and b is below eps
+ */
+static void check_close(double a, double b, double eps)
+{
+  BOOST_CHECK_SMALL(a - b, eps * (1.0 + std::fabs(b)));
+}
+
+template <int N>
+static void check_close(const blitz::Array<double,N>& a,
+  const blitz::Array<double,N>& b, double eps)
+{
+  for (int i = 0; i < N; ++i) BOOST_REQUIRE_EQUAL(a.extent(i), b.extent(i));
+  typename blitz::Array<double,N>::const_iterator ia = a.begin(), ib = b.begin();
+  for ( ; ia != a.end(); ++ia, ++ib) check_close(*ia, *ib, eps);
+}
+
+static const double eps = 1e-12;
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_gaussian )
+{
+  blitz::Range all = blitz::Range::all();
+  for (size_t d = 0; d < dims.size(); ++d)
+    for (size_t s = 0; s < sizes.size(); ++s) {
+      const int N = sizes[s], D = dims[d];
+      bob::machine::Gaussian g(D);
+      blitz::Array<double,1> mean(D);
+      bob::core::array::randn(rng, mean);
+      g.setMean(mean);
+      g.setVariance(variances(D));
+
+      // NB: every other row of the samples, to check strided inputs
+      blitz::Array<double,2> data = samples(2 * N, D);
+      blitz::Array<double,2> X = data(blitz::Range(0, 2 * N - 1, 2), all);
+      blitz::Array<double,1> ll(N), ll_ref(N);
+      for (int i = 0; i < N; ++i) ll_ref(i) = g.logLikelihood(X(i, all));
+      g.logLikelihood(X, ll);
+      check_close(ll, ll_ref, eps);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_gmm )
+{
+  blitz::Range all = blitz::Range::all();
+  const int C = 5;
+  for (size_t d = 0; d < dims.size(); ++d)
+    for (size_t s = 0; s < sizes.size(); ++s) {
+      const int N = sizes[s], D = dims[d];
+      bob::machine::GMMMachine gmm(C, D);
+      blitz::Array<double,2> means = samples(C, D), vars(C, D);
+      for (int c = 0; c < C; ++c) vars(c, all) = variances(D);
+      blitz::Array<double,1> weights(C);
+      weights = 0.1, 0.3, 0.05, 0.25, 0.3;
+      gmm.setMeans(means);
+      gmm.setVariances(vars);
+      gmm.setWeights(weights);
+
+      const blitz::Array<double,2> X = samples(N, D);
+      blitz::Array<double,1> ll(N), ll_ref(N), lwgl(C);
+      blitz::Array<double,2> lwgls(N, C), lwgls_ref(N, C);
+      for (int i = 0; i < N; ++i) {
+        ll_ref(i) = gmm.logLikelihood(X(i, all), lwgl);
+        lwgls_ref(i, all) = lwgl;
+      }
+      gmm.logLikelihood(X, ll);
+      check_close(ll, ll_ref, eps);
+      ll = 0.;
+      gmm.logLikelihood_(X, lwgls, ll);
+      check_close(ll, ll_ref, eps);
+      check_close(lwgls, lwgls_ref, eps);
+
+      // The statistics accumulated over the samples at once
+      bob::machine::GMMStats stats(C, D), stats_ref(C, D);
+      for (int i = 0; i < N; ++i) gmm.accStatistics(X(i, all), stats_ref);
+      gmm.accStatistics(X, stats);
+      BOOST_CHECK_EQUAL(stats.T, stats_ref.T);
+      check_close(stats.log_likelihood, stats_ref.log_likelihood, eps);
+      check_close(stats.n, stats_ref.n, eps);
+      check_close(stats.sumPx, stats_ref.sumPx, eps);
+      check_close(stats.sumPxx, stats_ref.sumPxx, eps);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_kmeans )
+{
+  blitz::Range all = blitz::Range::all();
+  const int C = 4;
+  for (size_t d = 0; d < dims.size(); ++d)
+    for (size_t s = 0; s < sizes.size(); ++s) {
+      const int N = sizes[s], D = dims[d];
+      bob::machine::KMeansMachine kmeans(samples(C, D));
+      const blitz::Array<double,2> X = samples(N, D);
+
+      // The closest means found one sample after the other
+      blitz::Array<double,2> sums(C, D), sums_sq(C, D);
+      blitz::Array<double,1> counts(C);
+      sums = 0.;
+      sums_sq = 0.;
+      counts = 0.;
+      for (int i = 0; i < N; ++i) {
+        size_t closest_mean;
+        double min_distance;
+        kmeans.getClosestMean(X(i, all), closest_mean, min_distance);
+        sums(closest_mean, all) += X(i, all);
+        sums_sq(closest_mean, all) += blitz::pow2(X(i, all));
+        ++counts(closest_mean);
+      }
+
+      blitz::Array<double,2> vars(C, D);
+      blitz::Array<double,1> weights(C);
+      kmeans.getVariancesAndWeightsForEachClusterInit(vars, weights);
+      kmeans.getVariancesAndWeightsForEachClusterAcc(X, vars, weights);
+      check_close(weights, counts, eps);
+      check_close(vars, sums_sq, eps);
+      check_close(kmeans.getCacheMeans(), sums, eps);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_bic )
+{
+  blitz::Range all = blitz::Range::all();
+  for (size_t d = 0; d < dims.size(); ++d) {
+    const int D = dims[d], K = (D + 1) / 2;
+    blitz::Array<double,1> mu_I(D), mu_E(D);
+    bob::core::array::randn(rng, mu_I);
+    bob::core::array::randn(rng, mu_E);
+
+    // IEC mode, and BIC mode with and without DFFS
+    std::vector<bob::machine::BICMachine> machines(3);
+    machines[0].setIEC(false, mu_I, variances(D), true);
+    machines[0].setIEC(true, mu_E, variances(D), true);
+    machines[2].use_DFFS(true);
+    for (int m = 1; m < 3; ++m) {
+      machines[m].setBIC(false, mu_I, variances(K), samples(D, K), 0.7, true);
+      machines[m].setBIC(true, mu_E, variances(K), samples(D, K), 1.3, true);
+    }
+
+    for (size_t m = 0; m < machines.size(); ++m)
+      for (size_t s = 0; s < sizes.size(); ++s) {
+        const int N = sizes[s];
+        const blitz::Array<double,2> X = samples(N, D);
+        blitz::Array<double,1> scores(N), scores_ref(N);
+        for (int i = 0; i < N; ++i) machines[m].forward(X(i, all), scores_ref(i));
+        machines[m].forward(X, scores);
+        check_close(scores, scores_ref, 1e-10);
+      }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
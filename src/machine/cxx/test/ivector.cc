@@ -0,0 +1,97 @@
+/**
+ * @file machine/cxx/test/ivector.cc
+ * @date Mon Oct 19 11:58:41 2026 +0200
+ *
+ * @brief Checks that the batch i-vector extraction gives the i-vectors of
+ * each utterance, whatever the number of threads
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE machine-IVector Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/random.hpp>
+#include <blitz/array.h>
+#include <cmath>
+#include <vector>
+
+#include <bob/core/array_random.h>
+#include <bob/machine/IVectorMachine.h>
+
+/**
+ * A random machine and 131 utterances (more than two batches of the batch
+ * forward), some of them without any frame
+ */
+struct T {
+  enum { C = 4, D = 3, Rt = 5, U = 131 };
+  boost::mt19937 rng;
+  boost::shared_ptr<bob::machine::GMMMachine> ubm;
+  bob::machine::IVectorMachine machine;
+  std::vector<bob::machine::GMMStats> stats;
+
+  T(): rng(0), ubm(boost::make_shared<bob::machine::GMMMachine>(C, D)),
+    machine(ubm, Rt)
+  {
+    blitz::Array<double,1> mean(C*D), variance(C*D), sigma(C*D);
+    bob::core::array::randn(rng, mean);
+    bob::core::array::randn(rng, variance);
+    variance = 0.5 + blitz::abs(variance);
+    ubm->setMeanSupervector(mean);
+    ubm->setVarianceSupervector(variance);
+
+    blitz::Array<double,2> t(C*D, Rt);
+    bob::core::array::randn(rng, t);
+    bob::core::array::randn(rng, sigma);
+    sigma = 0.5 + blitz::abs(sigma);
+    machine.setT(t);
+    machine.setSigma(sigma);
+
+    boost::uniform_real<> n(0., 10.);
+    for (int u = 0; u < U; ++u) {
+      bob::machine::GMMStats s(C, D);
+      for (int c = 0; c < C; ++c) s.n(c) = (u % 11 == 5 ? 0. : n(rng));
+      bob::core::array::randn(rng, s.sumPx);
+      s.T = (u % 11 == 5 ? 0 : 1 + u);
+      stats.push_back(s);
+    }
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_forward )
+{
+  blitz::Range all = blitz::Range::all();
+  blitz::Array<double,2> ref(U, Rt);
+  for (int u = 0; u < U; ++u) {
+    blitz::Array<double,1> ivector(Rt);
+    machine.forward(stats[u], ivector);
+    ref(u, all) = ivector;
+  }
+
+  // NB: one thread, more threads than needed, and all the hardware threads
+  const size_t n_threads[] = { 1, 3, 0 };
+  for (size_t k = 0; k < sizeof(n_threads) / sizeof(n_threads[0]); ++k) {
+    blitz::Array<double,2> ivectors(U, Rt);
+    ivectors = 0.;
+    machine.forward(stats, ivectors, n_threads[k]);
+    for (int u = 0; u < U; ++u)
+      for (int r = 0; r < Rt; ++r)
+        BOOST_CHECK_SMALL(ivectors(u,r) - ref(u,r),
+          1e-10 * (1.0 + std::fabs(ref(u,r))));
+  }
+
+  // The first utterances only (a single, partial batch)
+  std::vector<bob::machine::GMMStats> few(stats.begin(), stats.begin() + 7);
+  blitz::Array<double,2> ivectors(7, Rt);
+  machine.forward_(few, ivectors, 2);
+  for (int u = 0; u < 7; ++u)
+    for (int r = 0; r < Rt; ++r)
+      BOOST_CHECK_SMALL(ivectors(u,r) - ref(u,r),
+        1e-10 * (1.0 + std::fabs(ref(u,r))));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,153 @@
+/**
+ * @file machine/cxx/test/linearscoring.cc
+ * @date Mon Oct 19 10:03:26 2026 +0200
+ *
+ * @brief Checks that the linear scores do not depend on the chunk size nor
+ * on the number of threads
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE machine-LinearScoring Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/random.hpp>
+#include <blitz/array.h>
+#include <cmath>
+#include <vector>
+
+#include <bob/core/array_random.h>
+#include <bob/machine/LinearScoring.h>
+
+/**
+ * A few models and 37 test statistics (a prime number of trials), some of
+ * them without any frame, with their channel offsets
+ */
+struct T {
+  enum { C = 4, D = 3, Tm = 5, Tt = 37 };
+  boost::mt19937 rng;
+  blitz::Array<double,1> ubm_mean, ubm_variance;
+  std::vector<blitz::Array<double,1> > models, offsets;
+  std::vector<boost::shared_ptr<const bob::machine::GMMMachine> > gmms;
+  boost::shared_ptr<bob::machine::GMMMachine> ubm;
+  std::vector<boost::shared_ptr<const bob::machine::GMMStats> > stats;
+
+  T(): rng(0), ubm_mean(C*D), ubm_variance(C*D) {
+    bob::core::array::randn(rng, ubm_mean);
+    bob::core::array::randn(rng, ubm_variance);
+    ubm_variance = 0.5 + blitz::abs(ubm_variance);
+    ubm = boost::make_shared<bob::machine::GMMMachine>(C, D);
+    ubm->setMeanSupervector(ubm_mean);
+    ubm->setVarianceSupervector(ubm_variance);
+
+    for (int t = 0; t < Tm; ++t) {
+      blitz::Array<double,1> model(C*D);
+      bob::core::array::randn(rng, model);
+      models.push_back(model);
+      boost::shared_ptr<bob::machine::GMMMachine> gmm =
+        boost::make_shared<bob::machine::GMMMachine>(C, D);
+      gmm->setMeanSupervector(model);
+      gmms.push_back(gmm);
+    }
+
+    boost::uniform_real<> n(0., 10.);
+    for (int t = 0; t < Tt; ++t) {
+      boost::shared_ptr<bob::machine::GMMStats> s =
+        boost::make_shared<bob::machine::GMMStats>(C, D);
+      for (int c = 0; c < C; ++c) s->n(c) = n(rng);
+      bob::core::array::randn(rng, s->sumPx);
+      s->T = (t % 7 == 3 ? 0 : 1 + t);
+      stats.push_back(s);
+
+      blitz::Array<double,1> offset(C*D);
+      bob::core::array::randn(rng, offset);
+      offsets.push_back(offset);
+    }
+  }
+};
+
+/**
+ * Checks that the relative differences between the scores are below eps
+ */
+static void check_close(const blitz::Array<double,2>& a,
+  const blitz::Array<double,2>& b, double eps)
+{
+  BOOST_REQUIRE_EQUAL(a.extent(0), b.extent(0));
+  BOOST_REQUIRE_EQUAL(a.extent(1), b.extent(1));
+  for (int i = 0; i < a.extent(0); ++i)
+    for (int j = 0; j < a.extent(1); ++j)
+      BOOST_CHECK_SMALL(a(i,j) - b(i,j), eps * (1.0 + std::fabs(b(i,j))));
+}
+
+// NB: smaller than, equal to, not dividing and larger than the number of
+// trials
+static const size_t chunk_sizes[] = { 1, 5, 8, 36, 37, 256 };
+static const size_t n_chunk_sizes = sizeof(chunk_sizes) / sizeof(chunk_sizes[0]);
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_reference )
+{
+  // The unchunked scores are the ones of each trial
+  for (int fln = 0; fln < 2; ++fln) {
+    blitz::Array<double,2> scores(Tm, Tt);
+    bob::machine::linearScoring(models, ubm_mean, ubm_variance, stats, offsets,
+      fln != 0, scores, 1, 0);
+    for (int i = 0; i < Tm; ++i)
+      for (int j = 0; j < Tt; ++j) {
+        const double ref = bob::machine::linearScoring(models[i], ubm_mean,
+          ubm_variance, *stats[j], offsets[j], fln != 0);
+        BOOST_CHECK_SMALL(scores(i,j) - ref, 1e-12 * (1.0 + std::fabs(ref)));
+      }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_chunks )
+{
+  for (int fln = 0; fln < 2; ++fln) {
+    blitz::Array<double,2> ref(Tm, Tt), ref_offsets(Tm, Tt),
+      ref_gmms(Tm, Tt), ref_gmms_offsets(Tm, Tt);
+    bob::machine::linearScoring(models, ubm_mean, ubm_variance, stats,
+      fln != 0, ref, 1, 0);
+    bob::machine::linearScoring(models, ubm_mean, ubm_variance, stats,
+      offsets, fln != 0, ref_offsets, 1, 0);
+    bob::machine::linearScoring(gmms, *ubm, stats, fln != 0, ref_gmms, 1, 0);
+    bob::machine::linearScoring(gmms, *ubm, stats, offsets, fln != 0,
+      ref_gmms_offsets, 1, 0);
+    check_close(ref_gmms, ref, 1e-12);
+
+    for (size_t n_threads = 1; n_threads < 5; n_threads += 3)
+      for (size_t k = 0; k < n_chunk_sizes; ++k) {
+        blitz::Array<double,2> scores(Tm, Tt);
+        scores = 0.;
+        bob::machine::linearScoring(models, ubm_mean, ubm_variance, stats,
+          fln != 0, scores, n_threads, chunk_sizes[k]);
+        check_close(scores, ref, 1e-12);
+
+        scores = 0.;
+        bob::machine::linearScoring(models, ubm_mean, ubm_variance, stats,
+          offsets, fln != 0, scores, n_threads, chunk_sizes[k]);
+        check_close(scores, ref_offsets, 1e-12);
+
+        scores = 0.;
+        bob::machine::linearScoring(gmms, *ubm, stats, fln != 0, scores,
+          n_threads, chunk_sizes[k]);
+        check_close(scores, ref_gmms, 1e-12);
+
+        scores = 0.;
+        bob::machine::linearScoring(gmms, *ubm, stats, offsets, fln != 0,
+          scores, n_threads, chunk_sizes[k]);
+        check_close(scores, ref_gmms_offsets, 1e-12);
+      }
+
+    // All the hardware threads, and no chunk
+    blitz::Array<double,2> scores(Tm, Tt);
+    bob::machine::linearScoring(models, ubm_mean, ubm_variance, stats,
+      offsets, fln != 0, scores, 0, 0);
+    check_close(scores, ref_offsets, 1e-12);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -13,16 +13,46 @@
 #include <bob/python/exception.h>
 
 
-static double bic_call_(const bob::machine::BICMachine& machine, bob::python::const_ndarray input){
-  double o;
-  machine.forward_(input.bz<double,1>(), o);
-  return o;
+static boost::python::object bic_call_(const bob::machine::BICMachine& machine, bob::python::const_ndarray input){
+  const bob::core::array::typeinfo& info = input.type();
+  switch(info.nd){
+    case 1:
+      {
+        double o;
+        machine.forward_(input.bz<double,1>(), o);
+        return boost::python::object(o);
+      }
+    case 2:
+      {
+        bob::python::ndarray output(bob::core::array::t_float64, info.shape[0]);
+        blitz::Array<double,1> output_ = output.bz<double,1>();
+        machine.forward_(input.bz<double,2>(), output_);
+        return output.self();
+      }
+    default:
+      PYTHON_ERROR(TypeError, "cannot forward arrays with " SIZE_T_FMT " dimensions (only with 1 or 2 dimensions).", info.nd);
+  }
 }
 
-static double bic_call(const bob::machine::BICMachine& machine, bob::python::const_ndarray input){
-  double o;
-  machine.forward(input.bz<double,1>(), o);
-  return o;
+static boost::python::object bic_call(const bob::machine::BICMachine& machine, bob::python::const_ndarray input){
+  const bob::core::array::typeinfo& info = input.type();
+  switch(info.nd){
+    case 1:
+      {
+        double o;
+        machine.forward(input.bz<double,1>(), o);
+        return boost::python::object(o);
+      }
+    case 2:
+      {
+        bob::python::ndarray output(bob::core::array::t_float64, info.shape[0]);
+        blitz::Array<double,1> output_ = output.bz<double,1>();
+        machine.forward(input.bz<double,2>(), output_);
+        return output.self();
+      }
+    default:
+      PYTHON_ERROR(TypeError, "cannot forward arrays with " SIZE_T_FMT " dimensions (only with 1 or 2 dimensions).", info.nd);
+  }
 }
 
 void bind_machine_bic(){
@@ -89,6 +119,7 @@ void bind_machine_bic(){
       ),
       "Computes the BIC or IEC score for the given input vector, which results of a comparison of two (facial) images. "
       "The resulting value is returned as a single float value. "
+      "If a 2D array is given, the scores of its rows are returned as a 1D array. "
       "The score itself is the log-likelihood score of the given input vector belonging to the intrapersonal class. "
       "No sanity checks of input and output are performed."
     )
@@ -102,6 +133,7 @@ void bind_machine_bic(){
       ),
       "Computes the BIC or IEC score for the given input vector, which results of a comparison of two (facial) images. "
       "The score itself is the log-likelihood score of the given input vector belonging to the intrapersonal class. "
+      "If a 2D array is given, the scores of its rows are returned as a 1D array. "
       "No sanity checks of input are performed."
     )
 
@@ -114,6 +146,7 @@ void bind_machine_bic(){
       ),
       "Computes the BIC or IEC score for the given input vector, which results of a comparison of two (facial) images. "
       "The score itself is the log-likelihood score of the given input vector belonging to the intrapersonal class. "
+      "If a 2D array is given, the scores of its rows are returned as a 1D array. "
       "Sanity checks of input shape are performed."
     )
 
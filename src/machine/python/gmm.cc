@@ -10,6 +10,8 @@
 #include <boost/concept_check.hpp>
 #include <bob/machine/GMMStats.h>
 #include <bob/machine/GMMMachine.h>
+#include <bob/machine/GMMStatsExtractor.h>
+#include <bob/python/gil.h>
 #include <blitz/array.h>
 
 
@@ -213,6 +215,67 @@ static void py_gmmmachine_accStatistics_(const bob::machine::GMMMachine& machine
   }
 }
 
+static boost::shared_ptr<bob::machine::GMMStatsExtractor> py_gmmstatsextractor_init(
+  boost::shared_ptr<bob::machine::GMMMachine> ubm, const size_t n_threads,
+  const size_t batch_size)
+{
+  return boost::shared_ptr<bob::machine::GMMStatsExtractor>(
+    new bob::machine::GMMStatsExtractor(ubm, n_threads, batch_size));
+}
+
+static boost::shared_ptr<bob::machine::GMMMachine> py_gmmstatsextractor_getUbm(
+  const bob::machine::GMMStatsExtractor& extractor)
+{
+  return boost::const_pointer_cast<bob::machine::GMMMachine>(extractor.getUbm());
+}
+
+static void py_gmmstatsextractor_setUbm(bob::machine::GMMStatsExtractor& extractor,
+  boost::shared_ptr<bob::machine::GMMMachine> ubm)
+{
+  extractor.setUbm(ubm);
+}
+
+static list py_gmmstatsextractor_extract(
+  const bob::machine::GMMStatsExtractor& extractor, object features)
+{
+  stl_input_iterator<bob::python::const_ndarray> fbegin(features), fend;
+  std::vector<bob::python::const_ndarray> features_ref(fbegin, fend);
+  std::vector<blitz::Array<double,2> > features_;
+  for (size_t i=0; i<features_ref.size(); ++i)
+    features_.push_back(features_ref[i].bz<double,2>());
+  // Extracts the statistics without the GIL, as the work is done in C++
+  std::vector<boost::shared_ptr<bob::machine::GMMStats> > stats;
+  {
+    bob::python::no_gil unlock;
+    extractor.extract(features_, stats);
+  }
+  list retval;
+  for (size_t i=0; i<stats.size(); ++i) retval.append(stats[i]);
+  return retval;
+}
+
+static void py_gmmstatsextractor_extract_files(
+  const bob::machine::GMMStatsExtractor& extractor, object feature_files,
+  object output_files)
+{
+  stl_input_iterator<std::string> fbegin(feature_files), fend;
+  const std::vector<std::string> feature_files_(fbegin, fend);
+  stl_input_iterator<std::string> obegin(output_files), oend;
+  const std::vector<std::string> output_files_(obegin, oend);
+  bob::python::no_gil unlock;
+  extractor.extract(feature_files_, output_files_);
+}
+
+static void py_gmmstatsextractor_extract_hdf5(
+  const bob::machine::GMMStatsExtractor& extractor, object feature_files,
+  bob::io::HDF5File& output)
+{
+  stl_input_iterator<std::string> fbegin(feature_files), fend;
+  const std::vector<std::string> feature_files_(fbegin, fend);
+  bob::python::no_gil unlock;
+  extractor.extract(feature_files_, output);
+}
+
 void bind_machine_gmm()
 {
   class_<bob::machine::GMMStats, boost::shared_ptr<bob::machine::GMMStats> >("GMMStats",
@@ -292,4 +355,21 @@ void bind_machine_gmm()
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<bob::machine::GMMStatsExtractor, boost::shared_ptr<bob::machine::GMMStatsExtractor>, boost::noncopyable>("GMMStatsExtractor",
+      "Extracts one GMMStats per utterance (set of feature vectors) with respect to a world model (UBM). "
+      "The utterances are distributed to a pool of worker threads, which all share the same GMMMachine, and are processed by batches of at most 'batch_size' utterances. "
+      "The statistics are the same as the ones accumulated by GMMMachine.acc_statistics(), independently of the number of threads.",
+      no_init)
+    .def("__init__", make_constructor(&py_gmmstatsextractor_init, default_call_policies(), (arg("ubm"), arg("n_threads")=0, arg("batch_size")=256)), "Creates an extractor for the given world model, using 'n_threads' worker threads (0 means all hardware threads) and processing at most 'batch_size' utterances at once.")
+    .add_property("ubm", &py_gmmstatsextractor_getUbm, &py_gmmstatsextractor_setUbm, "The world model")
+    .add_property("n_threads", &bob::machine::GMMStatsExtractor::getNThreads, &bob::machine::GMMStatsExtractor::setNThreads, "The number of worker threads (0 means all hardware threads)")
+    .add_property("batch_size", &bob::machine::GMMStatsExtractor::getBatchSize, &bob::machine::GMMStatsExtractor::setBatchSize, "The maximum number of utterances processed at once")
+    .def("extract", &py_gmmstatsextractor_extract_files, (arg("self"), arg("feature_files"), arg("output_files")),
+         "Computes the statistics of each of the feature files (2D arrays, one feature vector per row), and saves them in the output file of the same index.")
+    .def("extract", &py_gmmstatsextractor_extract_hdf5, (arg("self"), arg("feature_files"), arg("output")),
+         "Computes the statistics of each of the feature files (2D arrays, one feature vector per row), and saves the ones of the i-th file in the group 'statsI' of the given HDF5File.")
+    .def("extract", &py_gmmstatsextractor_extract, (arg("self"), arg("features")),
+         "Computes and returns the statistics (a list of GMMStats) of each of the given utterances (2D arrays, one feature vector per row).")
+  ;
+
 }
@@ -81,6 +81,35 @@ static object py_iv_forward2(const bob::machine::IVectorMachine& machine,
   return ivector.self();
 }
 
+static void py_iv_forward3(const bob::machine::IVectorMachine& machine,
+  object data, bob::python::ndarray ivectors, const size_t n_threads)
+{
+  stl_input_iterator<bob::machine::GMMStats> dbegin(data), dend;
+  std::vector<bob::machine::GMMStats> vdata(dbegin, dend);
+  blitz::Array<double,2> ivectors_ = ivectors.bz<double,2>();
+  machine.forward(vdata, ivectors_, n_threads);
+}
+
+static void py_iv_forward3_(const bob::machine::IVectorMachine& machine,
+  object data, bob::python::ndarray ivectors, const size_t n_threads)
+{
+  stl_input_iterator<bob::machine::GMMStats> dbegin(data), dend;
+  std::vector<bob::machine::GMMStats> vdata(dbegin, dend);
+  blitz::Array<double,2> ivectors_ = ivectors.bz<double,2>();
+  machine.forward_(vdata, ivectors_, n_threads);
+}
+
+static object py_iv_forward4(const bob::machine::IVectorMachine& machine,
+  object data, const size_t n_threads)
+{
+  stl_input_iterator<bob::machine::GMMStats> dbegin(data), dend;
+  std::vector<bob::machine::GMMStats> vdata(dbegin, dend);
+  bob::python::ndarray ivectors(bob::core::array::t_float64, vdata.size(), machine.getDimRt());
+  blitz::Array<double,2> ivectors_ = ivectors.bz<double,2>();
+  machine.forward(vdata, ivectors_, n_threads);
+  return ivectors.self();
+}
+
 
 void bind_machine_ivector()
 {
@@ -107,6 +136,9 @@ void bind_machine_ivector()
     .def("__compute_Id_TtSigmaInvT__", &py_computeIdTtSigmaInvT2, (arg("self"), arg("gmmstats")), "Computes (Id + sum_{c=1}^{C} N_{i,j,c} T^{T} Sigma_{c}^{-1} T)")
     .def("__compute_TtSigmaInvFnorm__", &py_computeTtSigmaInvFnorm1, (arg("self"), arg("gmmstats"), arg("output")), "Computes T^{T} Sigma^{-1} sum_{c=1}^{C} (F_c - N_c mean(c))")
     .def("__compute_TtSigmaInvFnorm__", &py_computeTtSigmaInvFnorm2, (arg("self"), arg("gmmstats")), "Computes T^{T} Sigma^{-1} sum_{c=1}^{C} (F_c - N_c mean(c))")
+    .def("forward", &py_iv_forward3, (arg("self"), arg("gmmstats"), arg("ivectors"), arg("n_threads")=1), "Executes the machine on a list of GMMStats, and updates the 2D ivectors array (one ivector per row). The utterances are processed by batch, using n_threads threads (0 means all hardware threads).")
+    .def("forward_", &py_iv_forward3_, (arg("self"), arg("gmmstats"), arg("ivectors"), arg("n_threads")=1), "Executes the machine on a list of GMMStats, and updates the 2D ivectors array (one ivector per row). The utterances are processed by batch, using n_threads threads (0 means all hardware threads). NO CHECK is performed.")
+    .def("forward", &py_iv_forward4, (arg("self"), arg("gmmstats"), arg("n_threads")=1), "Executes the machine on a list of GMMStats. The 2D ivectors array (one ivector per row) is allocated and returned. The utterances are processed by batch, using n_threads threads (0 means all hardware threads).")
     .def("__call__", &py_iv_forward1_, (arg("self"), arg("gmmstats"), arg("ivector")), "Executes the machine on the GMMStats, and updates the ivector array. NO CHECK is performed.")
     .def("__call__", &py_iv_forward2, (arg("self"), arg("gmmstats")), "Executes the machine on the GMMStats. The ivector is allocated an returned.")
     .def("forward", &py_iv_forward1, (arg("self"), arg("gmmstats"), arg("ivector")), "Executes the machine on the GMMStats, and updates the ivector array.")
@@ -0,0 +1,58 @@
+/**
+ * @file math/cxx/benchmark/linear.cc
+ * @date Sun Oct 18 19:41:17 2026 +0200
+ *
+ * @brief Benchmark of the matrix products
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/core/array_random.h>
+#include <bob/core/benchmark.h>
+#include <bob/math/linear.h>
+#include <bob/math/gemm.h>
+
+#include <boost/format.hpp>
+#include <boost/random.hpp>
+
+void benchmark_prod(bob::core::BenchmarkSuite& suite, boost::mt19937& rng,
+  const int N)
+{
+  blitz::Array<double,2> A(N,N), B(N,N), C(N,N);
+  bob::core::array::randn(rng, A);
+  bob::core::array::randn(rng, B);
+
+  const std::string size = (boost::format("%dx%d") % N % N).str();
+  while (suite.iterate("prod", size)) bob::math::prod_(A, B, C);
+  while (suite.iterate("gemm", size)) bob::math::gemm_(A, B, C);
+  while (suite.iterate("gemm (transposed A)", size))
+    bob::math::gemm_(A, B, C, true, false);
+}
+
+void benchmark_prod_vector(bob::core::BenchmarkSuite& suite,
+  boost::mt19937& rng, const int N)
+{
+  blitz::Array<double,2> A(N,N);
+  blitz::Array<double,1> b(N), c(N);
+  bob::core::array::randn(rng, A);
+  bob::core::array::randn(rng, b);
+
+  const std::string size = (boost::format("%dx%d") % N % N).str();
+  while (suite.iterate("prod (matrix-vector)", size)) bob::math::prod_(A, b, c);
+}
+
+/*************** Linear algebra benchmarks *****************/
+int main(int argc, char** argv)
+{
+  bob::core::BenchmarkSuite suite("math", argc, argv);
+  boost::mt19937 rng(0);
+
+  benchmark_prod(suite, rng, 64);
+  benchmark_prod(suite, rng, 256);
+  benchmark_prod(suite, rng, 512);
+  benchmark_prod_vector(suite, rng, 256);
+  benchmark_prod_vector(suite, rng, 1024);
+
+  suite.report();
+  return 0;
+}
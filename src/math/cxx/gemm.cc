@@ -0,0 +1,131 @@
+/**
+ * @file math/cxx/gemm.cc
+ * @date Sun Oct 18 10:48:02 2026 +0200
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/math/gemm.h>
+#include <bob/core/assert.h>
+#include <bob/core/check.h>
+#include <bob/core/array_copy.h>
+#include <bob/core/parallel.h>
+#include <algorithm>
+
+// Declaration of the external BLAS function
+// General matrix-matrix multiplication (dgemm)
+extern "C" void dgemm_( const char *transa, const char *transb, const int *M,
+  const int *N, const int *K, const double *alpha, const double *A,
+  const int *lda, const double *B, const int *ldb, const double *beta,
+  double *C, const int *ldc);
+
+namespace bob { namespace math { namespace detail {
+
+  /**
+   * Calls dgemm on a block of rows of C. Only raw pointers are manipulated
+   * in the worker threads, as the reference counting of blitz++ arrays is
+   * not thread-safe.
+   */
+  class GemmOp {
+
+    public:
+
+      GemmOp(const bool transA, const bool transB, const int N, const int P,
+          const double alpha, const double* A, const int lda,
+          const double* B, const int ldb, const double beta, double* C,
+          const int ldc):
+        m_tA(transA ? 'T' : 'N'), m_tB(transB ? 'T' : 'N'),
+        m_transA(transA), m_N(N), m_P(P), m_alpha(alpha), m_A(A),
+        m_lda(lda), m_B(B), m_ldb(ldb), m_beta(beta), m_C(C), m_ldc(ldc) {}
+
+      void operator()(size_t, size_t begin, size_t end) const {
+        if (begin >= end) return;
+        const int M = end - begin;
+        // Row m of op(A) is either the row m or the column m of A
+        const double* A = m_transA ? m_A + begin : m_A + begin * m_lda;
+        double* C = m_C + begin * m_ldc;
+        // BLAS uses column-major order: a row-major C-array is seen by BLAS
+        // as its transpose. Hence, we compute C' = op(B)' * op(A)', which
+        // does not require any copy.
+        dgemm_( &m_tB, &m_tA, &m_P, &M, &m_N, &m_alpha, m_B, &m_ldb, A,
+          &m_lda, &m_beta, C, &m_ldc);
+      }
+
+    private:
+
+      const char m_tA;
+      const char m_tB;
+      const bool m_transA;
+      const int m_N;
+      const int m_P;
+      const double m_alpha;
+      const double* m_A;
+      const int m_lda;
+      const double* m_B;
+      const int m_ldb;
+      const double m_beta;
+      double* m_C;
+      const int m_ldc;
+  };
+
+}}}
+
+void bob::math::gemm(const blitz::Array<double,2>& A,
+  const blitz::Array<double,2>& B, blitz::Array<double,2>& C,
+  const bool transA, const bool transB, const double alpha, const double beta,
+  const size_t n_threads)
+{
+  // Size variables
+  const int M = transA ? A.extent(1) : A.extent(0);
+  const int N = transA ? A.extent(0) : A.extent(1);
+  const int NB = transB ? B.extent(1) : B.extent(0);
+  const int P = transB ? B.extent(0) : B.extent(1);
+
+  bob::core::array::assertZeroBase(A);
+  bob::core::array::assertZeroBase(B);
+  bob::core::array::assertZeroBase(C);
+
+  bob::core::array::assertSameDimensionLength(N, NB);
+  bob::core::array::assertSameDimensionLength(C.extent(0), M);
+  bob::core::array::assertSameDimensionLength(C.extent(1), P);
+
+  bob::math::gemm_(A, B, C, transA, transB, alpha, beta, n_threads);
+}
+
+void bob::math::gemm_(const blitz::Array<double,2>& A,
+  const blitz::Array<double,2>& B, blitz::Array<double,2>& C,
+  const bool transA, const bool transB, const double alpha, const double beta,
+  const size_t n_threads)
+{
+  // Size variables
+  const int M = transA ? A.extent(1) : A.extent(0);
+  const int N = transA ? A.extent(0) : A.extent(1);
+  const int P = transB ? B.extent(0) : B.extent(1);
+  if (M == 0 || P == 0) return;
+
+  // Makes sure that the arrays are C-contiguous, as BLAS requires
+  // contiguous storage with a constant leading dimension
+  blitz::Array<double,2> A_blas;
+  if (bob::core::array::isCZeroBaseContiguous(A)) A_blas.reference(A);
+  else A_blas.reference(bob::core::array::ccopy(A));
+  blitz::Array<double,2> B_blas;
+  if (bob::core::array::isCZeroBaseContiguous(B)) B_blas.reference(B);
+  else B_blas.reference(bob::core::array::ccopy(B));
+  const bool C_direct_use = bob::core::array::isCZeroBaseContiguous(C);
+  blitz::Array<double,2> C_blas;
+  if (C_direct_use) C_blas.reference(C);
+  else C_blas.reference(bob::core::array::ccopy(C));
+
+  const int lda = std::max(1, A_blas.extent(1));
+  const int ldb = std::max(1, B_blas.extent(1));
+  const int ldc = P;
+
+  // Splits the rows of C between the threads
+  detail::GemmOp op(transA, transB, N, P, alpha, A_blas.data(), lda,
+    B_blas.data(), ldb, beta, C_blas.data(), ldc);
+  bob::core::parallel_for(op, M, n_threads);
+
+  // Copy back content to C if required
+  if (!C_direct_use)
+    C = C_blas;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file math/cxx/stats.cc
+ * @date Sun Oct 18 17:05:12 2026 +0200
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/math/stats.h>
+#include <bob/core/assert.h>
+
+// Declaration of the external BLAS functions
+// Symmetric rank-k update (ssyrk/dsyrk)
+extern "C" void ssyrk_( const char *uplo, const char *trans, const int *N,
+  const int *K, const float *alpha, const float *A, const int *lda,
+  const float *beta, float *C, const int *ldc);
+extern "C" void dsyrk_( const char *uplo, const char *trans, const int *N,
+  const int *K, const double *alpha, const double *A, const int *lda,
+  const double *beta, double *C, const int *ldc);
+
+// BLAS uses column-major order: the C-contiguous block X of k samples is
+// seen as a D x k matrix, and the upper triangle of the column-major matrix
+// S is the lower triangle of the C-contiguous one.
+void bob::math::detail::syrk(const int D, const int k, const double* X,
+  double* S)
+{
+  if (D == 0 || k == 0) return;
+  const char uplo = 'U';
+  const char trans = 'N';
+  const double alpha = 1.;
+  const double beta = 1.;
+  dsyrk_( &uplo, &trans, &D, &k, &alpha, X, &D, &beta, S, &D);
+}
+
+void bob::math::detail::syrk(const int D, const int k, const float* X,
+  float* S)
+{
+  if (D == 0 || k == 0) return;
+  const char uplo = 'U';
+  const char trans = 'N';
+  const float alpha = 1.;
+  const float beta = 1.;
+  ssyrk_( &uplo, &trans, &D, &k, &alpha, X, &D, &beta, S, &D);
+}
+
+bob::math::ScatterAccumulator::ScatterAccumulator(const size_t n_features,
+    const size_t n_threads):
+  m_n_samples(0), m_n_threads(n_threads),
+  m_mean(n_features), m_scatter(n_features, n_features),
+  m_block_mean(n_features), m_block_scatter(n_features, n_features)
+{
+  reset();
+}
+
+void bob::math::ScatterAccumulator::reset()
+{
+  m_n_samples = 0;
+  m_mean = 0.;
+  m_scatter = 0.;
+}
+
+void bob::math::ScatterAccumulator::accumulate(
+  const blitz::Array<double,2>& block)
+{
+  bob::core::array::assertSameDimensionLength(block.extent(1),
+    m_mean.extent(0));
+  const size_t n_b = block.extent(0);
+  if (n_b == 0) return;
+
+  bob::math::scatter_(block, m_block_scatter, m_block_mean, m_n_threads);
+
+  const size_t n_a = m_n_samples;
+  const size_t n = n_a + n_b;
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  // m_block_mean is overwritten by the difference of the means
+  m_block_mean -= m_mean;
+  m_scatter += m_block_scatter +
+    (m_block_mean(i) * m_block_mean(j)) * ((double)n_a * n_b / n);
+  m_mean += m_block_mean * ((double)n_b / n);
+  m_n_samples = n;
+}
@@ -13,6 +13,7 @@
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 #include <bob/math/linear.h>
+#include <bob/math/gemm.h>
 
 
 struct T {
@@ -99,6 +100,30 @@ BOOST_AUTO_TEST_CASE( test_matrix_matrix_prod )
   checkBlitzClose( A_23, sol, eps);
 }
 
+BOOST_AUTO_TEST_CASE( test_matrix_matrix_gemm )
+{
+  blitz::Array<double,2> sol(2,3);
+  bob::math::gemm( A_24, A_43, sol);
+  checkBlitzClose( A_23, sol, eps);
+
+  // Transposed operands
+  blitz::Array<double,2> A_42 = A_24.copy().transpose(1,0);
+  blitz::Array<double,2> A_34(3,4);
+  A_34 = A_43.transpose(1,0);
+  sol = 0.;
+  bob::math::gemm( A_42, A_34, sol, true, true);
+  checkBlitzClose( A_23, sol, eps);
+
+  // Accumulation into a non-contiguous output
+  blitz::Array<double,2> sol_t(3,2);
+  sol_t = 1.;
+  blitz::Array<double,2> sol_view = sol_t.transpose(1,0);
+  bob::math::gemm( A_24, A_43, sol_view, false, false, 2., 1.);
+  blitz::Array<double,2> ref(2,3);
+  ref = 2. * A_23 + 1.;
+  checkBlitzClose( ref, sol_view, eps);
+}
+
 BOOST_AUTO_TEST_CASE( test_matrix_vector_prod )
 {
   blitz::Array<double,1> sol(2);
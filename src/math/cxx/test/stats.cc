@@ -111,5 +111,40 @@ BOOST_AUTO_TEST_CASE( test_stats )
   }
 }
 
+BOOST_AUTO_TEST_CASE( test_scatter_blocked )
+{
+  // several blocks of samples, the last one being incomplete, and an offset
+  // that is large compared to the spread of the data
+  const int M = 1000;
+  const int N = 17;
+  blitz::Array<double,2> t(M,N);
+  for (int i=0; i < M; ++i)
+    for (int j=0; j < N; ++j)
+      t(i,j) = 1e6 + (rand()/(double)RAND_MAX);
+
+  // Reference: mean and sum of outer products
+  blitz::Array<double,1> mean_ref(N);
+  mean_ref = 0.;
+  for (int i=0; i < M; ++i)
+    for (int j=0; j < N; ++j)
+      mean_ref(j) += t(i,j) / M;
+  blitz::Array<double,2> S_ref(N,N);
+  S_ref = 0.;
+  for (int i=0; i < M; ++i)
+    for (int j=0; j < N; ++j)
+      for (int k=0; k < N; ++k)
+        S_ref(j,k) += (t(i,j) - mean_ref(j)) * (t(i,k) - mean_ref(k));
+
+  // Single- and multi-threaded blocked versions
+  for (size_t n_threads=1; n_threads<=4; n_threads+=3) {
+    blitz::Array<double,1> mean(N);
+    blitz::Array<double,2> S(N,N);
+    bob::math::scatter(t, S, mean, n_threads);
+    for (int j=0; j < N; ++j)
+      BOOST_CHECK_SMALL( fabs(mean(j) - mean_ref(j)), eps);
+    checkBlitzClose(S, S_ref, eps);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
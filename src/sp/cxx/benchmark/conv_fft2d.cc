@@ -0,0 +1,59 @@
+/**
+ * @file sp/cxx/benchmark/conv_fft2d.cc
+ * @date Sun Oct 18 19:44:52 2026 +0200
+ *
+ * @brief Benchmark of the 2D convolution and of the 2D FFT
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/core/array_random.h>
+#include <bob/core/benchmark.h>
+#include <bob/sp/conv.h>
+#include <bob/sp/FFT2D.h>
+
+#include <boost/format.hpp>
+#include <boost/random.hpp>
+#include <complex>
+
+void benchmark_conv2D(bob::core::BenchmarkSuite& suite, boost::mt19937& rng,
+  const int H, const int W, const int K)
+{
+  blitz::Array<double,2> A(H,W), B(K,K), C(H,W);
+  bob::core::array::randn(rng, A);
+  bob::core::array::randn(rng, B);
+
+  const std::string size = (boost::format("%dx%d * %dx%d") % H % W % K % K).str();
+  while (suite.iterate("conv (same)", size))
+    bob::sp::conv(A, B, C, bob::sp::Conv::Same);
+}
+
+void benchmark_fft2D(bob::core::BenchmarkSuite& suite, boost::mt19937& rng,
+  const int H, const int W)
+{
+  blitz::Array<double,2> re(H,W), im(H,W);
+  bob::core::array::randn(rng, re);
+  bob::core::array::randn(rng, im);
+  blitz::Array<std::complex<double>,2> src(H,W), dst(H,W);
+  src = blitz::zip(re, im, std::complex<double>());
+
+  bob::sp::FFT2D fft(H, W);
+  const std::string size = (boost::format("%dx%d") % H % W).str();
+  while (suite.iterate("FFT2D", size)) fft(src, dst);
+}
+
+/*************** Convolution and FFT benchmarks *****************/
+int main(int argc, char** argv)
+{
+  bob::core::BenchmarkSuite suite("sp", argc, argv);
+  boost::mt19937 rng(0);
+
+  benchmark_conv2D(suite, rng, 256, 256, 5);
+  benchmark_conv2D(suite, rng, 512, 512, 15);
+  benchmark_fft2D(suite, rng, 256, 256);
+  benchmark_fft2D(suite, rng, 512, 512);
+  benchmark_fft2D(suite, rng, 480, 640);
+
+  suite.report();
+  return 0;
+}
@@ -22,14 +22,16 @@
 bob::trainer::FisherLDATrainer::FisherLDATrainer
   (bool use_pinv, bool strip_to_rank)
 : m_use_pinv(use_pinv),
-  m_strip_to_rank(strip_to_rank)
+  m_strip_to_rank(strip_to_rank),
+  m_n_threads(1)
 {
 }
 
 bob::trainer::FisherLDATrainer::FisherLDATrainer
   (const bob::trainer::FisherLDATrainer& other)
 : m_use_pinv(other.m_use_pinv),
-  m_strip_to_rank(other.m_strip_to_rank)
+  m_strip_to_rank(other.m_strip_to_rank),
+  m_n_threads(other.m_n_threads)
 {
 }
 
@@ -44,6 +46,7 @@ bob::trainer::FisherLDATrainer& bob::trainer::FisherLDATrainer::operator=
   {
     m_use_pinv = other.m_use_pinv;
     m_strip_to_rank = other.m_strip_to_rank;
+    m_n_threads = other.m_n_threads;
   }
   return *this;
 }
@@ -89,6 +92,67 @@ static std::vector<size_t> sort_indexes(const blitz::Array<double,1>& v) {
   return idx;
 }
 
+/**
+ * Sets up the machine from the within- and between-class scatter matrices
+ * and from the mean of the data. Sw and Sb are overwritten.
+ */
+static void lda_from_scatters(bob::machine::LinearMachine& machine,
+  blitz::Array<double,1>& eigen_values, blitz::Array<double,2>& Sw,
+  blitz::Array<double,2>& Sb, const blitz::Array<double,1>& preMean,
+  const int osize, const bool use_pinv)
+{
+  const int n_features = Sw.extent(0);
+
+  // computes the generalized eigenvalue decomposition
+  // so to find the eigen vectors/values of Sw^(-1) * Sb
+  blitz::Array<double,2> V(Sw.shape());
+  blitz::Array<double,1> eigen_values_(n_features);
+
+  if (use_pinv) {
+
+    //note: misuse V and Sw as temporary place holders for data
+    bob::math::pinv_(Sw, V); //V now contains Sw^-1
+    bob::math::prod_(V, Sb, Sw); //Sw now contains Sw^-1*Sb
+    blitz::Array<std::complex<double>,1> Dtemp(eigen_values_.shape());
+    blitz::Array<std::complex<double>,2> Vtemp(V.shape());
+    bob::math::eig_(Sw, Vtemp, Dtemp); //V now contains eigen-vectors
+
+    //sorting: we know this problem on has real eigen-values
+    blitz::Range a = blitz::Range::all();
+    blitz::Array<double,1> Dunordered(blitz::real(Dtemp));
+    std::vector<size_t> order = sort_indexes(Dunordered);
+    for (int i=0; i<n_features; ++i) {
+      eigen_values_(i) = Dunordered(order[i]);
+      V(a,i) = blitz::real(Vtemp(a,order[i]));
+    }
+  }
+  else {
+    bob::math::eigSym_(Sb, Sw, V, eigen_values_);
+  }
+
+  // Convert ascending order to descending order
+  eigen_values_.reverseSelf(0);
+  V.reverseSelf(1);
+
+  // limit the dimensions of the resulting projection matrix and eigen values
+  eigen_values = eigen_values_(blitz::Range(0,osize-1));
+  V.resizeAndPreserve(V.extent(0), osize);
+
+  // normalizes the eigen vectors so they have unit length
+  blitz::Range a = blitz::Range::all();
+  for (int column=0; column<V.extent(1); ++column) {
+    math::normalizeSelf(V(a,column));
+  }
+
+  // updates the machine
+  machine.setWeights(V);
+  machine.setInputSubtraction(preMean);
+
+  // also set input_div and biases to neutral values...
+  machine.setInputDivision(1.0);
+  machine.setBiases(0.0);
+}
+
 void bob::trainer::FisherLDATrainer::train
 (bob::machine::LinearMachine& machine, blitz::Array<double,1>& eigen_values,
   const std::vector<blitz::Array<double, 2> >& data) const
@@ -133,64 +197,110 @@ void bob::trainer::FisherLDATrainer::train
   blitz::Array<double,1> preMean(n_features);
   blitz::Array<double,2> Sw(n_features, n_features);
   blitz::Array<double,2> Sb(n_features, n_features);
-  bob::math::scatters_(data, Sw, Sb, preMean);
+  bob::math::scatters_(data, Sw, Sb, preMean, m_n_threads);
 
-  // computes the generalized eigenvalue decomposition
-  // so to find the eigen vectors/values of Sw^(-1) * Sb
-  blitz::Array<double,2> V(Sw.shape());
-  blitz::Array<double,1> eigen_values_(n_features);
+  lda_from_scatters(machine, eigen_values, Sw, Sb, preMean, osize, m_use_pinv);
+}
 
-  if (m_use_pinv) {
+void bob::trainer::FisherLDATrainer::train(bob::machine::LinearMachine& machine,
+    const std::vector<blitz::Array<double,2> >& data) const {
+  blitz::Array<double,1> throw_away(output_size(data));
+  train(machine, throw_away, data);
+}
 
-    //note: misuse V and Sw as temporary place holders for data
-    bob::math::pinv_(Sw, V); //V now contains Sw^-1
-    bob::math::prod_(V, Sb, Sw); //Sw now contains Sw^-1*Sb
-    blitz::Array<std::complex<double>,1> Dtemp(eigen_values_.shape());
-    blitz::Array<std::complex<double>,2> Vtemp(V.shape());
-    bob::math::eig_(Sw, Vtemp, Dtemp); //V now contains eigen-vectors
+size_t bob::trainer::FisherLDATrainer::output_size(const std::vector<blitz::Array<double,2> >& data) const {
+  return m_strip_to_rank ? std::min(data.size()-1, (size_t)data[0].extent(1)) : data[0].extent(1);
+}
 
-    //sorting: we know this problem on has real eigen-values
-    blitz::Range a = blitz::Range::all();
-    blitz::Array<double,1> Dunordered(blitz::real(Dtemp));
-    std::vector<size_t> order = sort_indexes(Dunordered);
-    for (int i=0; i<n_features; ++i) {
-      eigen_values_(i) = Dunordered(order[i]);
-      V(a,i) = blitz::real(Vtemp(a,order[i]));
-    }
+void bob::trainer::FisherLDATrainer::train
+(bob::machine::LinearMachine& machine, blitz::Array<double,1>& eigen_values,
+  std::vector<boost::shared_ptr<bob::trainer::SampleReader> >& data) const
+{
+  // if #classes < 2, then throw
+  if (data.size() < 2) {
+    boost::format m("The number of readers in the input data == %d whereas for LDA you should provide at least 2");
+    m % data.size();
+    throw std::runtime_error(m.str());
   }
-  else {
-    bob::math::eigSym_(Sb, Sw, V, eigen_values_);
+
+  // checks the dimensionality of each class once
+  const size_t n_features = data[0]->getNFeatures();
+  for (size_t cl=0; cl<data.size(); ++cl) {
+    if (data[cl]->getNFeatures() != n_features) {
+      boost::format m("The number of features (%u) of the reader at position %u of your input differs from that of the reader at position 0 (%u)");
+      m % data[cl]->getNFeatures() % cl % n_features;
+      throw std::runtime_error(m.str());
+    }
   }
 
-  // Convert ascending order to descending order
-  eigen_values_.reverseSelf(0);
-  V.reverseSelf(1);
+  const int osize = output_size(data);
 
-  // limit the dimensions of the resulting projection matrix and eigen values
-  eigen_values = eigen_values_(blitz::Range(0,osize-1));
-  V.resizeAndPreserve(V.extent(0), osize);
+  // Checks that the dimensions are matching
+  if (machine.inputSize() != n_features) {
+    boost::format m("Number of features at input data set (%u columns) does not match machine input size (%d)");
+    m % n_features % machine.inputSize();
+    throw std::runtime_error(m.str());
+  }
+  if (machine.outputSize() != (size_t)osize) {
+    boost::format m("Number of outputs of the given machine (%d) does not match the expected number of outputs calculated by this trainer = %d");
+    m % machine.outputSize() % osize;
+    throw std::runtime_error(m.str());
+  }
+  if (eigen_values.extent(0) != osize) {
+    boost::format m("Number of eigenvalues on the given 1D array (%d) does not match the expected number of outputs calculated by this trainer = %d");
+    m % eigen_values.extent(0) % osize;
+    throw std::runtime_error(m.str());
+  }
 
-  // normalizes the eigen vectors so they have unit length
-  blitz::Range a = blitz::Range::all();
-  for (int column=0; column<V.extent(1); ++column) {
-    math::normalizeSelf(V(a,column));
+  // Accumulates the mean and the scatter matrix of each class, one block at
+  // a time: Sw is the sum of the class scatters.
+  blitz::Array<double,2> Sw(n_features, n_features);
+  Sw = 0.;
+  std::vector<blitz::Array<double,1> > means;
+  std::vector<size_t> counts;
+  size_t n_samples = 0;
+  bob::math::ScatterAccumulator acc(n_features, m_n_threads);
+  for (size_t cl=0; cl<data.size(); ++cl) {
+    acc.reset();
+    bob::trainer::accumulateScatter(*data[cl], acc);
+    if (acc.getNSamples() == 0) {
+      boost::format m("The reader at position %u of your input does not provide any sample");
+      m % cl;
+      throw std::runtime_error(m.str());
+    }
+    Sw += acc.getScatter();
+    means.push_back(acc.getMean().copy());
+    counts.push_back(acc.getNSamples());
+    n_samples += acc.getNSamples();
   }
 
-  // updates the machine
-  machine.setWeights(V);
-  machine.setInputSubtraction(preMean);
+  // The overall mean is the weighted average of the class means, and Sb is
+  // the weighted scatter of the class means around it.
+  blitz::Array<double,1> preMean(n_features);
+  preMean = 0.;
+  for (size_t cl=0; cl<data.size(); ++cl)
+    preMean += (double)counts[cl] / n_samples * means[cl];
 
-  // also set input_div and biases to neutral values...
-  machine.setInputDivision(1.0);
-  machine.setBiases(0.0);
+  blitz::Array<double,2> Sb(n_features, n_features);
+  Sb = 0.;
+  blitz::Array<double,1> buffer(n_features);
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  for (size_t cl=0; cl<data.size(); ++cl) {
+    buffer = preMean - means[cl];
+    Sb += (double)counts[cl] * buffer(i) * buffer(j);
+  }
+
+  lda_from_scatters(machine, eigen_values, Sw, Sb, preMean, osize, m_use_pinv);
 }
 
 void bob::trainer::FisherLDATrainer::train(bob::machine::LinearMachine& machine,
-    const std::vector<blitz::Array<double,2> >& data) const {
+    std::vector<boost::shared_ptr<bob::trainer::SampleReader> >& data) const {
   blitz::Array<double,1> throw_away(output_size(data));
   train(machine, throw_away, data);
 }
 
-size_t bob::trainer::FisherLDATrainer::output_size(const std::vector<blitz::Array<double,2> >& data) const {
-  return m_strip_to_rank ? std::min(data.size()-1, (size_t)data[0].extent(1)) : data[0].extent(1);
+size_t bob::trainer::FisherLDATrainer::output_size(const std::vector<boost::shared_ptr<bob::trainer::SampleReader> >& data) const {
+  const size_t n_features = data[0]->getNFeatures();
+  return m_strip_to_rank ? std::min(data.size()-1, n_features) : n_features;
 }
@@ -12,11 +12,13 @@
 #include <bob/core/array_copy.h>
 #include <bob/core/array_random.h>
 #include <bob/core/check.h>
-#include <bob/math/inv.h>
+#include <bob/math/gemm.h>
 #include <bob/math/linear.h>
 #include <bob/math/linsolve.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/random.hpp>
+#include <algorithm>
+#include <stdexcept>
 
 bob::trainer::IVectorTrainer::IVectorTrainer(const bool update_sigma,
     const double convergence_threshold,
@@ -24,34 +26,40 @@ bob::trainer::IVectorTrainer::IVectorTrainer(const bool update_sigma,
   bob::trainer::EMTrainer<bob::machine::IVectorMachine, 
     std::vector<bob::machine::GMMStats> >(convergence_threshold,
       max_iterations, compute_likelihood), 
-  m_update_sigma(update_sigma)
+  m_update_sigma(update_sigma), m_n_threads(1), m_batch_size(64)
 {
 }
 
 bob::trainer::IVectorTrainer::IVectorTrainer(const bob::trainer::IVectorTrainer& other):
   bob::trainer::EMTrainer<bob::machine::IVectorMachine, 
     std::vector<bob::machine::GMMStats> >(other),
-  m_update_sigma(other.m_update_sigma)
+  m_update_sigma(other.m_update_sigma), m_n_threads(other.m_n_threads),
+  m_batch_size(other.m_batch_size)
 {
   m_acc_Nij_wij2.reference(bob::core::array::ccopy(other.m_acc_Nij_wij2));
   m_acc_Fnormij_wij.reference(bob::core::array::ccopy(other.m_acc_Fnormij_wij));
   m_acc_Nij.reference(bob::core::array::ccopy(other.m_acc_Nij));
   m_acc_Snormij.reference(bob::core::array::ccopy(other.m_acc_Snormij));
 
-  m_tmp_wij.reference(bob::core::array::ccopy(other.m_tmp_wij));
-  m_tmp_wij2.reference(bob::core::array::ccopy(other.m_tmp_wij2));
   m_tmp_d1.reference(bob::core::array::ccopy(other.m_tmp_d1));
-  m_tmp_t1.reference(bob::core::array::ccopy(other.m_tmp_t1));
   m_tmp_dd1.reference(bob::core::array::ccopy(other.m_tmp_dd1));
-  m_tmp_dt1.reference(bob::core::array::ccopy(other.m_tmp_dt1));
-  m_tmp_tt1.reference(bob::core::array::ccopy(other.m_tmp_tt1));
-  m_tmp_tt2.reference(bob::core::array::ccopy(other.m_tmp_tt2));
+  m_tmp_N.reference(bob::core::array::ccopy(other.m_tmp_N));
+  m_tmp_Fnorm.reference(bob::core::array::ccopy(other.m_tmp_Fnorm));
+  m_tmp_Ew.reference(bob::core::array::ccopy(other.m_tmp_Ew));
+  m_tmp_Eww.reference(bob::core::array::ccopy(other.m_tmp_Eww));
 }
 
 bob::trainer::IVectorTrainer::~IVectorTrainer() 
 {
 }
 
+void bob::trainer::IVectorTrainer::setBatchSize(const size_t batch_size)
+{
+  if (batch_size == 0)
+    throw std::runtime_error("IVectorTrainer: the batch size should be strictly positive");
+  m_batch_size = batch_size;
+}
+
 void bob::trainer::IVectorTrainer::initialize(
   bob::machine::IVectorMachine& machine,
   const std::vector<bob::machine::GMMStats>& data)
@@ -70,15 +78,14 @@ void bob::trainer::IVectorTrainer::initialize(
   }
 
   // Tmp
-  m_tmp_wij.resize(Rt);
-  m_tmp_wij2.resize(Rt,Rt);
   m_tmp_d1.resize(D);
-  m_tmp_t1.resize(Rt);
-  m_tmp_dt1.resize(D,Rt);
-  m_tmp_tt1.resize(Rt,Rt);
-  m_tmp_tt2.resize(Rt,Rt);
   if (m_update_sigma)
     m_tmp_dd1.resize(D,D);
+  const int B = (int)std::max((size_t)1, std::min(m_batch_size, data.size()));
+  m_tmp_N.resize(B,C);
+  m_tmp_Fnorm.resize(B,C*D);
+  m_tmp_Ew.resize(B,Rt);
+  m_tmp_Eww.resize(B,Rt*Rt);
 
   // Initializes \f$T\f$ and \f$\Sigma\f$ of the machine
   blitz::Array<double,2>& T = machine.updateT();
@@ -92,8 +99,18 @@ void bob::trainer::IVectorTrainer::eStep(
   bob::machine::IVectorMachine& machine,
   const std::vector<bob::machine::GMMStats>& data)
 {
-  blitz::Range rall = blitz::Range::all();
   const int C = machine.getDimC();
+  const int D = machine.getDimD();
+  const int Rt = machine.getDimRt();
+  const int B = (int)std::max((size_t)1, std::min(m_batch_size, data.size()));
+  if (m_tmp_N.extent(0) != B)
+  {
+    // The batch size has changed since initialize()
+    m_tmp_N.resize(B,C);
+    m_tmp_Fnorm.resize(B,C*D);
+    m_tmp_Ew.resize(B,Rt);
+    m_tmp_Eww.resize(B,Rt*Rt);
+  }
 
   // Reinitializes accumulators to 0
   m_acc_Nij_wij2 = 0.;
@@ -103,43 +120,52 @@ void bob::trainer::IVectorTrainer::eStep(
     m_acc_Nij = 0.;
     m_acc_Snormij = 0.;
   }
-  for (std::vector<bob::machine::GMMStats>::const_iterator it = data.begin();
-       it != data.end(); ++it)
+
+  // Flattened views on the accumulators:
+  // - acc_Nij_wij2(c, r1*Rt+r2) = m_acc_Nij_wij2(c,r1,r2)
+  // - acc_Fnormij_wij(c*D+d, r) = m_acc_Fnormij_wij(c,d,r)
+  blitz::Array<double,2> acc_Nij_wij2(m_acc_Nij_wij2.data(),
+    blitz::shape(C,Rt*Rt), blitz::neverDeleteData);
+  blitz::Array<double,2> acc_Fnormij_wij(m_acc_Fnormij_wij.data(),
+    blitz::shape(C*D,Rt), blitz::neverDeleteData);
+
+  for (size_t b=0; b<data.size(); b+=B)
   {
-    // Computes E{wij} and E{wij.wij^{T}}
-    // a. Computes \f$T^{T} \Sigma^{-1} F_{norm}\f$
-    machine.computeTtSigmaInvFnorm(*it, m_tmp_t1);
-    // b. Computes \f$Id + T^{T} \Sigma^{-1} T\f$
-    machine.computeIdTtSigmaInvT(*it, m_tmp_tt1);
-    // c. Computes \f$(Id + T^{T} \Sigma^{-1} T)^{-1}\f$
-    bob::math::inv(m_tmp_tt1, m_tmp_tt2);
-    // d. Computes \f$E{wij} = (Id + T^{T} \Sigma^{-1} T)^{-1} T^{T} \Sigma^{-1} F_{norm}\f$
-    bob::math::prod(m_tmp_tt2, m_tmp_t1, m_tmp_wij); // E{wij}
-    // e.  Computes \f$E{wij}.E{wij^{T}}\f$
-    bob::math::prod(m_tmp_wij, m_tmp_wij, m_tmp_wij2);
-    // f. Computes \f$E{wij.wij^{T}} = (Id + T^{T} \Sigma^{-1} T)^{-1} + E{wij}.E{wij^{T}}\f$
-    m_tmp_wij2 += m_tmp_tt2; // E{wij.wij^{T}}
+    const size_t e = std::min(b + B, data.size());
+    const int U = (int)(e - b);
+    // Views on the first U rows of the batch working arrays
+    blitz::Array<double,2> N(m_tmp_N.data(), blitz::shape(U,C),
+      blitz::neverDeleteData);
+    blitz::Array<double,2> Fnorm(m_tmp_Fnorm.data(), blitz::shape(U,C*D),
+      blitz::neverDeleteData);
+    blitz::Array<double,2> Ew(m_tmp_Ew.data(), blitz::shape(U,Rt),
+      blitz::neverDeleteData);
+    blitz::Array<double,2> Eww(m_tmp_Eww.data(), blitz::shape(U,Rt*Rt),
+      blitz::neverDeleteData);
 
-    if (m_update_sigma)
-      m_acc_Nij += (*it).n;
+    // Computes E{wij} and E{wij.wij^{T}} of the utterances of this batch
+    machine.computePosteriors_(data, b, e, N, Fnorm, Ew, &Eww, m_n_threads);
+
+    // acc_Nij_wij2_c += sum_{ij} Nijc . E{wij.wij^{T}}
+    bob::math::gemm_(N, Eww, acc_Nij_wij2, true, false, 1., 1., m_n_threads);
+    // acc_Fnormij_wij_c += sum_{ij} (Fijc - Nijc * ubmmean_{c}).E{wij}^{T}
+    bob::math::gemm_(Fnorm, Ew, acc_Fnormij_wij, true, false, 1., 1.,
+      m_n_threads);
 
-    for (int c=0; c<C; ++c)
+    if (m_update_sigma)
     {
-      blitz::Array<double,2> acc_Nij_wij2_c = m_acc_Nij_wij2(c,rall,rall);
-      blitz::Array<double,2> acc_Fnormij_wij = m_acc_Fnormij_wij(c,rall,rall);
-      // acc_Nij_wij2_c += Nijc . E{wij.wij^{T}}
-      acc_Nij_wij2_c += (*it).n(c) * m_tmp_wij2;
-      blitz::Array<double,1> mc = machine.getUbm()->getGaussian(c)->getMean();
-      // m_tmp_d1 = Fijc - Nijc * ubmmean_{c}
-      m_tmp_d1 = (*it).sumPx(c,rall) - (*it).n(c)*mc; // Fnorm_c
-      // m_tmp_dt1 = (Fijc - Nijc * ubmmean_{c}).E{wij}^{T}
-      bob::math::prod(m_tmp_d1, m_tmp_wij, m_tmp_dt1); 
-      // acc_Fnormij_wij += (Fijc - Nijc * ubmmean_{c}).E{wij}^{T}
-      acc_Fnormij_wij += m_tmp_dt1;
-      if (m_update_sigma)
+      const blitz::Array<double,1>& ubm_mean =
+        machine.getUbm()->getMeanSupervector();
+      for (int u=0; u<U; ++u)
       {
-        blitz::Array<double,1> acc_Snormij_c = m_acc_Snormij(c,rall);
-        acc_Snormij_c += (*it).sumPxx(c,rall) - mc*((*it).sumPx(c,rall) + m_tmp_d1);
+        const bob::machine::GMMStats& gs = data[b+u];
+        for (int c=0; c<C; ++c)
+        {
+          m_acc_Nij(c) += gs.n(c);
+          for (int d=0; d<D; ++d)
+            m_acc_Snormij(c,d) += gs.sumPxx(c,d) -
+              ubm_mean(c*D+d) * (gs.sumPx(c,d) + Fnorm(u,c*D+d));
+        }
       }
     }
   }
@@ -201,20 +227,20 @@ bob::trainer::IVectorTrainer& bob::trainer::IVectorTrainer::operator=
     bob::trainer::EMTrainer<bob::machine::IVectorMachine,
       std::vector<bob::machine::GMMStats> >::operator=(other);
     m_update_sigma = other.m_update_sigma;
+    m_n_threads = other.m_n_threads;
+    m_batch_size = other.m_batch_size;
 
     m_acc_Nij_wij2.reference(bob::core::array::ccopy(other.m_acc_Nij_wij2));
     m_acc_Fnormij_wij.reference(bob::core::array::ccopy(other.m_acc_Fnormij_wij));
     m_acc_Nij.reference(bob::core::array::ccopy(other.m_acc_Nij));
     m_acc_Snormij.reference(bob::core::array::ccopy(other.m_acc_Snormij));
 
-    m_tmp_wij.reference(bob::core::array::ccopy(other.m_tmp_wij));
-    m_tmp_wij2.reference(bob::core::array::ccopy(other.m_tmp_wij2));
     m_tmp_d1.reference(bob::core::array::ccopy(other.m_tmp_d1));
-    m_tmp_t1.reference(bob::core::array::ccopy(other.m_tmp_t1));
     m_tmp_dd1.reference(bob::core::array::ccopy(other.m_tmp_dd1));
-    m_tmp_dt1.reference(bob::core::array::ccopy(other.m_tmp_dt1));
-    m_tmp_tt1.reference(bob::core::array::ccopy(other.m_tmp_tt1));
-    m_tmp_tt2.reference(bob::core::array::ccopy(other.m_tmp_tt2)); 
+    m_tmp_N.reference(bob::core::array::ccopy(other.m_tmp_N));
+    m_tmp_Fnorm.reference(bob::core::array::ccopy(other.m_tmp_Fnorm));
+    m_tmp_Ew.reference(bob::core::array::ccopy(other.m_tmp_Ew));
+    m_tmp_Eww.reference(bob::core::array::ccopy(other.m_tmp_Eww));
   }
   return *this;
 }
@@ -12,8 +12,11 @@
 #include <bob/core/check.h>
 #include <bob/core/array_copy.h>
 #include <bob/core/array_random.h>
+#include <bob/core/parallel.h>
+#include <bob/math/gemm.h>
 #include <bob/math/inv.h>
 #include <bob/math/linear.h>
+#include <bob/math/linsolve.h>
 #include <bob/core/check.h>
 #include <bob/core/array_repmat.h>
 #include <algorithm>
@@ -21,11 +24,12 @@
 
 bob::trainer::FABaseTrainer::FABaseTrainer():
   m_Nid(0), m_dim_C(0), m_dim_D(0), m_dim_ru(0), m_dim_rv(0),
-  m_x(0), m_y(0), m_z(0), m_Nacc(0), m_Facc(0)
+  m_n_threads(1), m_x(0), m_y(0), m_z(0), m_Nacc(0), m_Facc(0)
 {
 }
 
-bob::trainer::FABaseTrainer::FABaseTrainer(const bob::trainer::FABaseTrainer& other)
+bob::trainer::FABaseTrainer::FABaseTrainer(const bob::trainer::FABaseTrainer& other):
+  m_n_threads(other.m_n_threads)
 {
 }
 
@@ -141,14 +145,14 @@ void bob::trainer::FABaseTrainer::initCache()
 {
   const size_t dim_CD = m_dim_C*m_dim_D;
   // U
-  m_cache_UtSigmaInv.resize(m_dim_ru, dim_CD);
+  m_cache_SigmaInvU.resize(dim_CD, m_dim_ru);
   m_cache_UProd.resize(m_dim_C, m_dim_ru, m_dim_ru);
   m_cache_IdPlusUProd_ih.resize(m_dim_ru, m_dim_ru);
   m_cache_Fn_x_ih.resize(dim_CD);
   m_acc_U_A1.resize(m_dim_C, m_dim_ru, m_dim_ru);
   m_acc_U_A2.resize(dim_CD, m_dim_ru);
   // V
-  m_cache_VtSigmaInv.resize(m_dim_rv, dim_CD);
+  m_cache_SigmaInvV.resize(dim_CD, m_dim_rv);
   m_cache_VProd.resize(m_dim_C, m_dim_rv, m_dim_rv);
   m_cache_IdPlusVProd_i.resize(m_dim_rv, m_dim_rv);
   m_cache_Fn_y_i.resize(dim_CD);
@@ -163,51 +167,404 @@ void bob::trainer::FABaseTrainer::initCache()
   m_acc_D_A2.resize(dim_CD);
 
   // tmp
-  m_tmp_CD.resize(dim_CD);
-  m_tmp_CD_b.resize(dim_CD);
-
-  m_tmp_ru.resize(m_dim_ru);
-  m_tmp_ruD.resize(m_dim_ru, m_dim_D);
   m_tmp_ruru.resize(m_dim_ru, m_dim_ru);
-
-  m_tmp_rv.resize(m_dim_rv);
-  m_tmp_rvD.resize(m_dim_rv, m_dim_D);
   m_tmp_rvrv.resize(m_dim_rv, m_dim_rv);
 }
 
 
+namespace bob { namespace trainer { namespace detail {
+
+  /**
+   * Subtracts N_{i,h} * U * x_{i,h} from Fn, for all the given sessions of
+   * a client.
+   */
+  static void subtractUx(const blitz::Array<double,2>& U,
+    const blitz::Array<double,2>& X,
+    const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats,
+    const int C, const int D, double* Fn)
+  {
+    for (int h=0; h<X.extent(1); ++h) // Loops over the sessions
+    {
+      const blitz::Array<double,1>& Nih = stats[h]->n;
+      for (int c=0; c<C; ++c)
+      {
+        const double n = Nih(c);
+        for (int d=0; d<D; ++d)
+        {
+          const int i = c*D+d;
+          double Ux = 0.;
+          for (int r=0; r<U.extent(1); ++r) Ux += U(i,r) * X(r,h);
+          Fn[i] -= n * Ux;
+        }
+      }
+    }
+  }
+
+  /**
+   * Computes the normalised first order statistics of a block of items:
+   *  - for y (one item per client):
+   *    Fn_y_i = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - U*x_{i,h})
+   *  - for x (one item per session):
+   *    Fn_x_ih = N_{i,h}*(o_{i,h} - m - D*z_{i} - V*y_{i})
+   * Each item is written as a row of a C-contiguous array. The shared
+   * arrays are only read element-wise in the worker threads, as the
+   * reference counting of blitz++ arrays is not thread-safe.
+   */
+  class FAFnOp {
+
+    public:
+
+      FAFnOp(const bool is_x, const bob::machine::FABase& mb,
+          const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats,
+          const std::vector<size_t>& ids, const std::vector<size_t>& sessions,
+          const size_t offset,
+          const std::vector<blitz::Array<double,2> >& x,
+          const std::vector<blitz::Array<double,1> >& y,
+          const std::vector<blitz::Array<double,1> >& z,
+          const std::vector<blitz::Array<double,1> >& Nacc,
+          const std::vector<blitz::Array<double,1> >& Facc,
+          const int C, const int D, double* Fn):
+        m_is_x(is_x), m_U(mb.getU()), m_V(mb.getV()), m_d(mb.getD()),
+        m_m(mb.getUbmMean()), m_stats(stats), m_ids(ids),
+        m_sessions(sessions), m_offset(offset), m_x(x), m_y(y), m_z(z),
+        m_Nacc(Nacc), m_Facc(Facc), m_C(C), m_D(D), m_Fn(Fn) {}
+
+      void operator()(size_t, size_t begin, size_t end) const {
+        for (size_t u=begin; u<end; ++u) {
+          const size_t id = m_ids[m_offset+u];
+          double* Fn = m_Fn + u * m_C * m_D;
+          const blitz::Array<double,1>& z = m_z[id];
+          if (m_is_x) {
+            const size_t h = m_sessions[m_offset+u];
+            const blitz::Array<double,2>& Fih = m_stats[id][h]->sumPx;
+            const blitz::Array<double,1>& Nih = m_stats[id][h]->n;
+            const blitz::Array<double,1>& y = m_y[id];
+            for (int c=0; c<m_C; ++c) {
+              const double n = Nih(c);
+              for (int d=0; d<m_D; ++d) {
+                const int i = c*m_D+d;
+                double Vy = 0.;
+                for (int r=0; r<m_V.extent(1); ++r) Vy += m_V(i,r) * y(r);
+                Fn[i] = Fih(c,d) - n * (m_m(i) + m_d(i) * z(i) + Vy);
+              }
+            }
+          }
+          else {
+            const blitz::Array<double,1>& Ni = m_Nacc[id];
+            const blitz::Array<double,1>& Fi = m_Facc[id];
+            for (int c=0; c<m_C; ++c) {
+              const double n = Ni(c);
+              for (int d=0; d<m_D; ++d) {
+                const int i = c*m_D+d;
+                Fn[i] = Fi(i) - n * (m_m(i) + m_d(i) * z(i));
+              }
+            }
+            subtractUx(m_U, m_x[id], m_stats[id], m_C, m_D, Fn);
+          }
+        }
+      }
+
+    private:
+
+      const bool m_is_x;
+      const blitz::Array<double,2>& m_U;
+      const blitz::Array<double,2>& m_V;
+      const blitz::Array<double,1>& m_d;
+      const blitz::Array<double,1>& m_m;
+      const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& m_stats;
+      const std::vector<size_t>& m_ids;
+      const std::vector<size_t>& m_sessions;
+      const size_t m_offset;
+      const std::vector<blitz::Array<double,2> >& m_x;
+      const std::vector<blitz::Array<double,1> >& m_y;
+      const std::vector<blitz::Array<double,1> >& m_z;
+      const std::vector<blitz::Array<double,1> >& m_Nacc;
+      const std::vector<blitz::Array<double,1> >& m_Facc;
+      const int m_C;
+      const int m_D;
+      double* m_Fn;
+  };
+
+  /**
+   * Solves the systems (I + sum_c N_c Xt_c.diag(sigma)^-1.X_c).e = b of a
+   * block of items with a Cholesky decomposition. If accumulate is set,
+   * the current estimates e are kept, and the matrices are replaced by
+   * E{e.e^T} = (I + sum_c N_c Xt_c.diag(sigma)^-1.X_c)^-1 + e.e^T.
+   */
+  class FAPosteriorOp {
+
+    public:
+
+      FAPosteriorOp(const int r, const bool accumulate, double* A,
+          const double* b, double* E):
+        m_r(r), m_accumulate(accumulate), m_A(A), m_b(b), m_E(E) {}
+
+      void operator()(size_t, size_t begin, size_t end) const {
+        const int r = m_r;
+        const int rr = r * r;
+        // Buffers of this thread
+        blitz::Array<double,2> A(r, r);
+        blitz::Array<double,1> b(r);
+        blitz::Array<double,1> e(r);
+        blitz::Array<double,2> Id;
+        blitz::Array<double,2> Cov;
+        if (m_accumulate) {
+          Id.resize(r, r);
+          bob::math::eye(Id);
+          Cov.resize(r, r);
+        }
+
+        for (size_t u=begin; u<end; ++u) {
+          double* A_u = m_A + u * rr;
+          double* E_u = m_E + u * r;
+          std::copy(A_u, A_u + rr, A.data());
+          if (m_accumulate) {
+            bob::math::linsolveSympos_(A, Cov, Id);
+            for (int r1=0; r1<r; ++r1)
+              for (int r2=0; r2<r; ++r2)
+                A_u[r1*r+r2] = Cov(r1,r2) + E_u[r1] * E_u[r2];
+          }
+          else {
+            std::copy(m_b + u * r, m_b + (u+1) * r, b.data());
+            bob::math::linsolveSympos_(A, e, b);
+            std::copy(e.data(), e.data() + r, E_u);
+          }
+        }
+      }
+
+    private:
+
+      const int m_r;
+      const bool m_accumulate;
+      double* m_A;
+      const double* m_b;
+      double* m_E;
+  };
+
+  /**
+   * Updates z, or computes the accumulators for d, for a block of clients.
+   * The accumulators are partial sums owned by each thread, which are
+   * reduced by the calling thread afterwards.
+   */
+  class FAZOp {
+
+    public:
+
+      FAZOp(const bool accumulate, const bob::machine::FABase& mb,
+          const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats,
+          const std::vector<blitz::Array<double,2> >& x,
+          const std::vector<blitz::Array<double,1> >& y,
+          std::vector<blitz::Array<double,1> >& z,
+          const std::vector<blitz::Array<double,1> >& Nacc,
+          const std::vector<blitz::Array<double,1> >& Facc,
+          const blitz::Array<double,1>& DtSigmaInv,
+          const blitz::Array<double,1>& DProd, const int C, const int D,
+          std::vector<blitz::Array<double,1> >& A1,
+          std::vector<blitz::Array<double,1> >& A2):
+        m_accumulate(accumulate), m_U(mb.getU()), m_V(mb.getV()),
+        m_m(mb.getUbmMean()), m_stats(stats), m_x(x), m_y(y), m_z(z),
+        m_Nacc(Nacc), m_Facc(Facc), m_DtSigmaInv(DtSigmaInv),
+        m_DProd(DProd), m_C(C), m_D(D), m_A1(A1), m_A2(A2) {}
+
+      void operator()(size_t thread, size_t begin, size_t end) const {
+        // Buffer of this thread
+        blitz::Array<double,1> Fn_buffer(m_C * m_D);
+        double* Fn = Fn_buffer.data();
+        for (size_t id=begin; id<end; ++id) {
+          // Fn_z_i = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i} - U*x_{i,h})
+          const blitz::Array<double,1>& Ni = m_Nacc[id];
+          const blitz::Array<double,1>& Fi = m_Facc[id];
+          const blitz::Array<double,1>& y = m_y[id];
+          for (int c=0; c<m_C; ++c) {
+            const double n = Ni(c);
+            for (int d=0; d<m_D; ++d) {
+              const int i = c*m_D+d;
+              double Vy = 0.;
+              for (int r=0; r<m_V.extent(1); ++r) Vy += m_V(i,r) * y(r);
+              Fn[i] = Fi(i) - n * (m_m(i) + Vy);
+            }
+          }
+          subtractUx(m_U, m_x[id], m_stats[id], m_C, m_D, Fn);
+
+          blitz::Array<double,1>& z = m_z[id];
+          for (int c=0; c<m_C; ++c) {
+            const double n = Ni(c);
+            for (int d=0; d<m_D; ++d) {
+              const int i = c*m_D+d;
+              // (I+Dt*diag(sigma)^-1*Ni*D)^-1
+              const double IdPlusDProd = 1. / (1. + m_DProd(i) * n);
+              if (m_accumulate) {
+                m_A1[thread](i) += (IdPlusDProd + z(i) * z(i)) * n;
+                m_A2[thread](i) += Fn[i] * z(i);
+              }
+              else
+                z(i) = IdPlusDProd * m_DtSigmaInv(i) * Fn[i];
+            }
+          }
+        }
+      }
+
+    private:
+
+      const bool m_accumulate;
+      const blitz::Array<double,2>& m_U;
+      const blitz::Array<double,2>& m_V;
+      const blitz::Array<double,1>& m_m;
+      const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& m_stats;
+      const std::vector<blitz::Array<double,2> >& m_x;
+      const std::vector<blitz::Array<double,1> >& m_y;
+      std::vector<blitz::Array<double,1> >& m_z;
+      const std::vector<blitz::Array<double,1> >& m_Nacc;
+      const std::vector<blitz::Array<double,1> >& m_Facc;
+      const blitz::Array<double,1>& m_DtSigmaInv;
+      const blitz::Array<double,1>& m_DProd;
+      const int m_C;
+      const int m_D;
+      std::vector<blitz::Array<double,1> >& m_A1;
+      std::vector<blitz::Array<double,1> >& m_A2;
+  };
+
+}}}
+
+// Number of clients (or sessions) processed at once when estimating x and y
+static const size_t s_fa_batch_size = 64;
+
+void bob::trainer::FABaseTrainer::processXY(const bob::machine::FABase& m,
+  const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats,
+  const bool is_x, const bool accumulate)
+{
+  const int C = (int)m_dim_C;
+  const int CD = (int)(m_dim_C*m_dim_D);
+  const int r = (int)(is_x ? m_dim_ru : m_dim_rv);
+  if (r == 0) return;
+
+  // Lists the items: one per session for x, one per client for y
+  std::vector<size_t> ids, sessions;
+  for (size_t id=0; id<stats.size(); ++id) {
+    const size_t n_items = is_x ? stats[id].size() : 1;
+    for (size_t h=0; h<n_items; ++h) {
+      ids.push_back(id);
+      sessions.push_back(h);
+    }
+  }
+  if (ids.empty()) return;
+
+  // Flattened views: Prod(c, r1*r+r2) and acc_A1(c, r1*r+r2)
+  blitz::Array<double,3>& Prod3 = is_x ? m_cache_UProd : m_cache_VProd;
+  blitz::Array<double,2> Prod(Prod3.data(), blitz::shape(C,r*r),
+    blitz::neverDeleteData);
+  const blitz::Array<double,2>& SigmaInvX = is_x ? m_cache_SigmaInvU :
+    m_cache_SigmaInvV;
+  blitz::Array<double,3>& acc_A1_3 = is_x ? m_acc_U_A1 : m_acc_V_A1;
+  blitz::Array<double,2> acc_A1(acc_A1_3.data(), blitz::shape(C,r*r),
+    blitz::neverDeleteData);
+  blitz::Array<double,2>& acc_A2 = is_x ? m_acc_U_A2 : m_acc_V_A2;
+
+  // Batch working arrays (one row per item)
+  const int B = (int)std::min(s_fa_batch_size, ids.size());
+  blitz::Array<double,2> N_buffer(B,C);
+  blitz::Array<double,2> Fn_buffer(B,CD);
+  blitz::Array<double,2> A_buffer(B,r*r);
+  blitz::Array<double,2> b_buffer(B,r);
+  blitz::Array<double,2> E_buffer(B,r);
+
+  for (size_t b0=0; b0<ids.size(); b0+=B)
+  {
+    const int n_batch = (int)(std::min(b0 + B, ids.size()) - b0);
+    blitz::Array<double,2> N(N_buffer.data(), blitz::shape(n_batch,C),
+      blitz::neverDeleteData);
+    blitz::Array<double,2> Fn(Fn_buffer.data(), blitz::shape(n_batch,CD),
+      blitz::neverDeleteData);
+    blitz::Array<double,2> A(A_buffer.data(), blitz::shape(n_batch,r*r),
+      blitz::neverDeleteData);
+    blitz::Array<double,2> b(b_buffer.data(), blitz::shape(n_batch,r),
+      blitz::neverDeleteData);
+    blitz::Array<double,2> E(E_buffer.data(), blitz::shape(n_batch,r),
+      blitz::neverDeleteData);
+
+    // Zeroth order statistics of the items (and current estimates)
+    for (int u=0; u<n_batch; ++u)
+    {
+      const size_t id = ids[b0+u];
+      const size_t h = sessions[b0+u];
+      const blitz::Array<double,1>& n = is_x ? stats[id][h]->n : m_Nacc[id];
+      for (int c=0; c<C; ++c) N(u,c) = n(c);
+      if (accumulate)
+        for (int k=0; k<r; ++k) E(u,k) = is_x ? m_x[id](k,h) : m_y[id](k);
+    }
+
+    // Normalised first order statistics of the items
+    detail::FAFnOp fn_op(is_x, m, stats, ids, sessions, b0, m_x, m_y, m_z,
+      m_Nacc, m_Facc, C, (int)m_dim_D, Fn.data());
+    bob::core::parallel_for(fn_op, n_batch, m_n_threads);
+
+    // A = I + sum_c N_c Xt_c.diag(sigma)^-1.X_c
+    bob::math::gemm_(N, Prod, A, false, false, 1., 0., m_n_threads);
+    for (int u=0; u<n_batch; ++u)
+      for (int k=0; k<r; ++k)
+        A(u,k*r+k) += 1.;
+    // b = Xt.diag(sigma)^-1.Fn
+    if (!accumulate)
+      bob::math::gemm_(Fn, SigmaInvX, b, false, false, 1., 0., m_n_threads);
+
+    detail::FAPosteriorOp op(r, accumulate, A.data(), b.data(), E.data());
+    bob::core::parallel_for(op, n_batch, m_n_threads);
+
+    if (accumulate)
+    {
+      // A1_c += sum_{items} N_c * E{e.e^T}
+      bob::math::gemm_(N, A, acc_A1, true, false, 1., 1., m_n_threads);
+      // A2 += sum_{items} Fn * E{e}^T
+      bob::math::gemm_(Fn, E, acc_A2, true, false, 1., 1., m_n_threads);
+    }
+    else
+    {
+      for (int u=0; u<n_batch; ++u)
+      {
+        const size_t id = ids[b0+u];
+        const size_t h = sessions[b0+u];
+        for (int k=0; k<r; ++k)
+        {
+          if (is_x) m_x[id](k,h) = E(u,k);
+          else m_y[id](k) = E(u,k);
+        }
+      }
+    }
+  }
+}
+
 
 //////////////////////////// V ///////////////////////////
-void bob::trainer::FABaseTrainer::computeVtSigmaInv(const bob::machine::FABase& m)
+void bob::trainer::FABaseTrainer::computeSigmaInvV(const bob::machine::FABase& m)
 {
   const blitz::Array<double,2>& V = m.getV();
-  // Blitz compatibility: ugly fix (const_cast, as old blitz version does not
-  // provide a non-const version of transpose())
-  const blitz::Array<double,2> Vt = const_cast<blitz::Array<double,2>&>(V).transpose(1,0);
   const blitz::Array<double,1>& sigma = m.getUbmVariance();
   blitz::firstIndex i;
   blitz::secondIndex j;
-  m_cache_VtSigmaInv = Vt(i,j) / sigma(j); // Vt * diag(sigma)^-1
+  m_cache_SigmaInvV = V(i,j) / sigma(i); // diag(sigma)^-1 * V
 }
 
 void bob::trainer::FABaseTrainer::computeVProd(const bob::machine::FABase& m)
 {
   const blitz::Array<double,2>& V = m.getV();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  const blitz::Array<double,1>& sigma = m.getUbmVariance();
   blitz::Range rall = blitz::Range::all();
   for (size_t c=0; c<m_dim_C; ++c)
   {
+    blitz::Range rc(c*m_dim_D, (c+1)*m_dim_D-1);
     blitz::Array<double,2> VProd_c = m_cache_VProd(c, rall, rall);
-    blitz::Array<double,2> Vv_c = V(blitz::Range(c*m_dim_D,(c+1)*m_dim_D-1), rall);
-    blitz::Array<double,2> Vt_c = Vv_c.transpose(1,0);
-    blitz::Array<double,1> sigma_c = sigma(blitz::Range(c*m_dim_D,(c+1)*m_dim_D-1));
-    m_tmp_rvD = Vt_c(i,j) / sigma_c(j); // Vt_c * diag(sigma)^-1
-    bob::math::prod(m_tmp_rvD, Vv_c, VProd_c);
+    const blitz::Array<double,2> Vv_c = V(rc, rall);
+    const blitz::Array<double,2> SigmaInvV_c = m_cache_SigmaInvV(rc, rall);
+    // Vt_c * diag(sigma)^-1 * V_c
+    bob::math::gemm_(Vv_c, SigmaInvV_c, VProd_c, true, false, 1., 0.,
+      m_n_threads);
   }
 }
 
+void bob::trainer::FABaseTrainer::computeVtSigmaInv(const bob::machine::FABase& m)
+{
+  computeSigmaInvV(m);
+}
+
 void bob::trainer::FABaseTrainer::computeIdPlusVProd_i(const size_t id)
 {
   const blitz::Array<double,1>& Ni = m_Nacc[id];
@@ -223,48 +580,32 @@ void bob::trainer::FABaseTrainer::computeIdPlusVProd_i(const size_t id)
 void bob::trainer::FABaseTrainer::computeFn_y_i(const bob::machine::FABase& mb,
   const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats, const size_t id)
 {
-  const blitz::Array<double,2>& U = mb.getU();
-  const blitz::Array<double,1>& d = mb.getD();
-  // Compute Fn_yi = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - U*x_{i,h}) (Normalised first order statistics)
-  const blitz::Array<double,1>& Fi = m_Facc[id];
-  const blitz::Array<double,1>& m = mb.getUbmMean();
-  const blitz::Array<double,1>& z = m_z[id];
-  bob::core::array::repelem(m_Nacc[id], m_tmp_CD);
-  m_cache_Fn_y_i = Fi - m_tmp_CD * (m + d * z); // Fn_yi = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i})
-  const blitz::Array<double,2>& X = m_x[id];
-  blitz::Range rall = blitz::Range::all();
-  for (int h=0; h<X.extent(1); ++h) // Loops over the sessions
-  {
-    blitz::Array<double,1> Xh = X(rall, h); // Xh = x_{i,h} (length: ru)
-    bob::math::prod(U, Xh, m_tmp_CD_b); // m_tmp_CD_b = U*x_{i,h}
-    const blitz::Array<double,1>& Nih = stats[h]->n;
-    bob::core::array::repelem(Nih, m_tmp_CD);
-    m_cache_Fn_y_i -= m_tmp_CD * m_tmp_CD_b; // N_{i,h} * U * x_{i,h}
-  }
+  // Fn_yi = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i})
+  blitz::Array<double,1> N(m_dim_C*m_dim_D);
+  bob::core::array::repelem(m_Nacc[id], N);
+  m_cache_Fn_y_i = m_Facc[id] - N * (mb.getUbmMean() + mb.getD() * m_z[id]);
   // Fn_yi = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - U*x_{i,h})
+  detail::subtractUx(mb.getU(), m_x[id], stats, (int)m_dim_C, (int)m_dim_D,
+    m_cache_Fn_y_i.data());
 }
 
 void bob::trainer::FABaseTrainer::updateY_i(const size_t id)
 {
-  // Computes yi = Ayi * Cvs * Fn_yi
-  blitz::Array<double,1>& y = m_y[id];
-  // m_tmp_rv = m_cache_VtSigmaInv * m_cache_Fn_y_i = Vt*diag(sigma)^-1 * sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - U*x_{i,h})
-  bob::math::prod(m_cache_VtSigmaInv, m_cache_Fn_y_i, m_tmp_rv);
-  bob::math::prod(m_cache_IdPlusVProd_i, m_tmp_rv, y);
+  // Computes yi = (I+Vt*diag(sigma)^-1*Ni*V)^-1 * Vt*diag(sigma)^-1 * Fn_yi
+  blitz::Array<double,1> VtSigmaInvFn(m_dim_rv);
+  bob::math::prod(m_cache_Fn_y_i, m_cache_SigmaInvV, VtSigmaInvFn);
+  bob::math::prod(m_cache_IdPlusVProd_i, VtSigmaInvFn, m_y[id]);
 }
 
 void bob::trainer::FABaseTrainer::updateY(const bob::machine::FABase& m,
   const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats)
 {
   // Precomputation
-  computeVtSigmaInv(m);
+  computeSigmaInvV(m);
   computeVProd(m);
-  // Loops over all people
-  for (size_t id=0; id<stats.size(); ++id) {
-    computeIdPlusVProd_i(id);
-    computeFn_y_i(m, stats[id], id);
-    updateY_i(id);
-  }
+  // Computes yi = (I+Vt*diag(sigma)^-1*Ni*V)^-1 * Vt*diag(sigma)^-1 * Fn_yi
+  // for all people
+  processXY(m, stats, false, false);
 }
 
 void bob::trainer::FABaseTrainer::computeAccumulatorsV(
@@ -274,25 +615,8 @@ void bob::trainer::FABaseTrainer::computeAccumulatorsV(
   // Initializes the cache accumulator
   m_acc_V_A1 = 0.;
   m_acc_V_A2 = 0.;
-  // Loops over all people
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  blitz::Range rall = blitz::Range::all();
-  for (size_t id=0; id<stats.size(); ++id) {
-    computeIdPlusVProd_i(id);
-    computeFn_y_i(m, stats[id], id);
-
-    // Needs to return values to be accumulated for estimating V
-    const blitz::Array<double,1>& y = m_y[id];
-    m_tmp_rvrv = m_cache_IdPlusVProd_i;
-    m_tmp_rvrv += y(i) * y(j);
-    for (size_t c=0; c<m_dim_C; ++c)
-    {
-      blitz::Array<double,2> A1_y_c = m_acc_V_A1(c, rall, rall);
-      A1_y_c += m_tmp_rvrv * m_Nacc[id](c);
-    }
-    m_acc_V_A2 += m_cache_Fn_y_i(i) * y(j);
-  }
+  // Accumulates over all people
+  processXY(m, stats, false, true);
 }
 
 void bob::trainer::FABaseTrainer::updateV(blitz::Array<double,2>& V)
@@ -310,42 +634,44 @@ void bob::trainer::FABaseTrainer::updateV(blitz::Array<double,2>& V)
 
 
 //////////////////////////// U ///////////////////////////
-void bob::trainer::FABaseTrainer::computeUtSigmaInv(const bob::machine::FABase& m)
+void bob::trainer::FABaseTrainer::computeSigmaInvU(const bob::machine::FABase& m)
 {
   const blitz::Array<double,2>& U = m.getU();
-  // Blitz compatibility: ugly fix (const_cast, as old blitz version does not
-  // provide a non-const version of transpose())
-  const blitz::Array<double,2> Ut = const_cast<blitz::Array<double,2>&>(U).transpose(1,0);
   const blitz::Array<double,1>& sigma = m.getUbmVariance();
   blitz::firstIndex i;
   blitz::secondIndex j;
-  m_cache_UtSigmaInv = Ut(i,j) / sigma(j); // Ut * diag(sigma)^-1
+  m_cache_SigmaInvU = U(i,j) / sigma(i); // diag(sigma)^-1 * U
 }
 
 void bob::trainer::FABaseTrainer::computeUProd(const bob::machine::FABase& m)
 {
   const blitz::Array<double,2>& U = m.getU();
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  const blitz::Array<double,1>& sigma = m.getUbmVariance();
+  blitz::Range rall = blitz::Range::all();
   for (size_t c=0; c<m_dim_C; ++c)
   {
-    blitz::Array<double,2> UProd_c = m_cache_UProd(c, blitz::Range::all(), blitz::Range::all());
-    blitz::Array<double,2> Uu_c = U(blitz::Range(c*m_dim_D,(c+1)*m_dim_D-1), blitz::Range::all());
-    blitz::Array<double,2> Ut_c = Uu_c.transpose(1,0);
-    blitz::Array<double,1> sigma_c = sigma(blitz::Range(c*m_dim_D,(c+1)*m_dim_D-1));
-    m_tmp_ruD = Ut_c(i,j) / sigma_c(j); // Ut_c * diag(sigma)^-1
-    bob::math::prod(m_tmp_ruD, Uu_c, UProd_c);
+    blitz::Range rc(c*m_dim_D, (c+1)*m_dim_D-1);
+    blitz::Array<double,2> UProd_c = m_cache_UProd(c, rall, rall);
+    const blitz::Array<double,2> Uu_c = U(rc, rall);
+    const blitz::Array<double,2> SigmaInvU_c = m_cache_SigmaInvU(rc, rall);
+    // Ut_c * diag(sigma)^-1 * U_c
+    bob::math::gemm_(Uu_c, SigmaInvU_c, UProd_c, true, false, 1., 0.,
+      m_n_threads);
   }
 }
 
+void bob::trainer::FABaseTrainer::computeUtSigmaInv(const bob::machine::FABase& m)
+{
+  computeSigmaInvU(m);
+}
+
 void bob::trainer::FABaseTrainer::computeIdPlusUProd_ih(
   const boost::shared_ptr<bob::machine::GMMStats>& stats)
 {
   const blitz::Array<double,1>& Nih = stats->n;
   bob::math::eye(m_tmp_ruru); // m_tmp_ruru = I
+  blitz::Range rall = blitz::Range::all();
   for (size_t c=0; c<m_dim_C; ++c) {
-    blitz::Array<double,2> UProd_c = m_cache_UProd(c,blitz::Range::all(),blitz::Range::all());
+    blitz::Array<double,2> UProd_c = m_cache_UProd(c, rall, rall);
     m_tmp_ruru += UProd_c * Nih(c);
   }
   bob::math::inv(m_tmp_ruru, m_cache_IdPlusUProd_ih); // m_cache_IdPlusUProd_ih = ( I+Ut*diag(sigma)^-1*Ni*U)^-1
@@ -354,50 +680,35 @@ void bob::trainer::FABaseTrainer::computeIdPlusUProd_ih(
 void bob::trainer::FABaseTrainer::computeFn_x_ih(const bob::machine::FABase& mb,
   const boost::shared_ptr<bob::machine::GMMStats>& stats, const size_t id)
 {
-  const blitz::Array<double,2>& V = mb.getV();
-  const blitz::Array<double,1>& d =  mb.getD();
-  // Compute Fn_x_ih = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - D*z_{i} - V*y_{i}) (Normalised first order statistics)
-  const blitz::Array<double,2>& Fih = stats->sumPx;
-  const blitz::Array<double,1>& m = mb.getUbmMean();
-  const blitz::Array<double,1>& z = m_z[id];
-  const blitz::Array<double,1>& Nih = stats->n;
-  bob::core::array::repelem(Nih, m_tmp_CD);
+  blitz::Array<double,1> N(m_dim_C*m_dim_D), Vy(m_dim_C*m_dim_D);
+  bob::core::array::repelem(stats->n, N);
+  bob::math::prod(mb.getV(), m_y[id], Vy);
   for (size_t c=0; c<m_dim_C; ++c) {
     blitz::Array<double,1> Fn_x_ih_c = m_cache_Fn_x_ih(blitz::Range(c*m_dim_D,(c+1)*m_dim_D-1));
-    Fn_x_ih_c = Fih(c,blitz::Range::all());
+    Fn_x_ih_c = stats->sumPx(c,blitz::Range::all());
   }
-  m_cache_Fn_x_ih -= m_tmp_CD * (m + d * z); // Fn_x_ih = N_{i,h}*(o_{i,h} - m - D*z_{i})
-
-  const blitz::Array<double,1>& y = m_y[id];
-  bob::math::prod(V, y, m_tmp_CD_b);
-  m_cache_Fn_x_ih -= m_tmp_CD * m_tmp_CD_b;
   // Fn_x_ih = N_{i,h}*(o_{i,h} - m - D*z_{i} - V*y_{i})
+  m_cache_Fn_x_ih -= N * (mb.getUbmMean() + mb.getD() * m_z[id] + Vy);
 }
 
 void bob::trainer::FABaseTrainer::updateX_ih(const size_t id, const size_t h)
 {
-  // Computes xih = Axih * Cus * Fn_x_ih
+  // Computes xih = (I+Ut*diag(sigma)^-1*Nih*U)^-1 * Ut*diag(sigma)^-1 * Fn_x_ih
+  blitz::Array<double,1> UtSigmaInvFn(m_dim_ru);
+  bob::math::prod(m_cache_Fn_x_ih, m_cache_SigmaInvU, UtSigmaInvFn);
   blitz::Array<double,1> x = m_x[id](blitz::Range::all(), h);
-  // m_tmp_ru = m_cache_UtSigmaInv * m_cache_Fn_x_ih = Ut*diag(sigma)^-1 * N_{i,h}*(o_{i,h} - m - D*z_{i} - V*y_{i})
-  bob::math::prod(m_cache_UtSigmaInv, m_cache_Fn_x_ih, m_tmp_ru);
-  bob::math::prod(m_cache_IdPlusUProd_ih, m_tmp_ru, x);
+  bob::math::prod(m_cache_IdPlusUProd_ih, UtSigmaInvFn, x);
 }
 
 void bob::trainer::FABaseTrainer::updateX(const bob::machine::FABase& m,
   const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats)
 {
   // Precomputation
-  computeUtSigmaInv(m);
+  computeSigmaInvU(m);
   computeUProd(m);
-  // Loops over all people
-  for (size_t id=0; id<stats.size(); ++id) {
-    int n_session_i = stats[id].size();
-    for (int s=0; s<n_session_i; ++s) {
-      computeIdPlusUProd_ih(stats[id][s]);
-      computeFn_x_ih(m, stats[id][s], id);
-      updateX_ih(id, s);
-    }
-  }
+  // Computes xih = (I+Ut*diag(sigma)^-1*Nih*U)^-1 * Ut*diag(sigma)^-1 * Fn_x_ih
+  // for all sessions of all people
+  processXY(m, stats, true, false);
 }
 
 void bob::trainer::FABaseTrainer::computeAccumulatorsU(
@@ -407,28 +718,8 @@ void bob::trainer::FABaseTrainer::computeAccumulatorsU(
   // Initializes the cache accumulator
   m_acc_U_A1 = 0.;
   m_acc_U_A2 = 0.;
-  // Loops over all people
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  blitz::Range rall = blitz::Range::all();
-  for (size_t id=0; id<stats.size(); ++id) {
-    int n_session_i = stats[id].size();
-    for (int h=0; h<n_session_i; ++h) {
-      computeIdPlusUProd_ih(stats[id][h]);
-      computeFn_x_ih(m, stats[id][h], id);
-
-      // Needs to return values to be accumulated for estimating U
-      blitz::Array<double,1> x = m_x[id](rall, h);
-      m_tmp_ruru = m_cache_IdPlusUProd_ih;
-      m_tmp_ruru += x(i) * x(j);
-      for (int c=0; c<(int)m_dim_C; ++c)
-      {
-        blitz::Array<double,2> A1_x_c = m_acc_U_A1(c,rall,rall);
-        A1_x_c += m_tmp_ruru * stats[id][h]->n(c);
-      }
-      m_acc_U_A2 += m_cache_Fn_x_ih(i) * x(j);
-    }
-  }
+  // Accumulates over all sessions of all people
+  processXY(m, stats, true, true);
 }
 
 void bob::trainer::FABaseTrainer::updateU(blitz::Array<double,2>& U)
@@ -461,46 +752,29 @@ void bob::trainer::FABaseTrainer::computeDProd(const bob::machine::FABase& m)
 
 void bob::trainer::FABaseTrainer::computeIdPlusDProd_i(const size_t id)
 {
-  const blitz::Array<double,1>& Ni = m_Nacc[id];
-  bob::core::array::repelem(Ni, m_tmp_CD); // m_tmp_CD = Ni 'repmat'
-  m_cache_IdPlusDProd_i = 1.; // m_cache_IdPlusDProd_i = Id
-  m_cache_IdPlusDProd_i += m_cache_DProd * m_tmp_CD; // m_cache_IdPlusDProd_i = I+Dt*diag(sigma)^-1*Ni*D
-  m_cache_IdPlusDProd_i = 1 / m_cache_IdPlusDProd_i; // m_cache_IdPlusVProd_i = (I+Dt*diag(sigma)^-1*Ni*D)^-1
+  blitz::Array<double,1> N(m_dim_C*m_dim_D);
+  bob::core::array::repelem(m_Nacc[id], N);
+  // m_cache_IdPlusDProd_i = (I+Dt*diag(sigma)^-1*Ni*D)^-1
+  m_cache_IdPlusDProd_i = 1. / (1. + m_cache_DProd * N);
 }
 
-void bob::trainer::FABaseTrainer::computeFn_z_i(
-  const bob::machine::FABase& mb,
+void bob::trainer::FABaseTrainer::computeFn_z_i(const bob::machine::FABase& mb,
   const std::vector<boost::shared_ptr<bob::machine::GMMStats> >& stats, const size_t id)
 {
-  const blitz::Array<double,2>& U = mb.getU();
-  const blitz::Array<double,2>& V = mb.getV();
-  // Compute Fn_z_i = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i} - U*x_{i,h}) (Normalised first order statistics)
-  const blitz::Array<double,1>& Fi = m_Facc[id];
-  const blitz::Array<double,1>& m = mb.getUbmMean();
-  const blitz::Array<double,1>& y = m_y[id];
-  bob::core::array::repelem(m_Nacc[id], m_tmp_CD);
-  bob::math::prod(V, y, m_tmp_CD_b); // m_tmp_CD_b = V * y
-  m_cache_Fn_z_i = Fi - m_tmp_CD * (m + m_tmp_CD_b); // Fn_yi = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i})
-
-  const blitz::Array<double,2>& X = m_x[id];
-  blitz::Range rall = blitz::Range::all();
-  for (int h=0; h<X.extent(1); ++h) // Loops over the sessions
-  {
-    const blitz::Array<double,1>& Nh = stats[h]->n; // Nh = N_{i,h} (length: C)
-    bob::core::array::repelem(Nh, m_tmp_CD);
-    blitz::Array<double,1> Xh = X(rall, h); // Xh = x_{i,h} (length: ru)
-    bob::math::prod(U, Xh, m_tmp_CD_b);
-    m_cache_Fn_z_i -= m_tmp_CD * m_tmp_CD_b;
-  }
+  // Fn_z_i = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i})
+  blitz::Array<double,1> N(m_dim_C*m_dim_D), Vy(m_dim_C*m_dim_D);
+  bob::core::array::repelem(m_Nacc[id], N);
+  bob::math::prod(mb.getV(), m_y[id], Vy);
+  m_cache_Fn_z_i = m_Facc[id] - N * (mb.getUbmMean() + Vy);
   // Fn_z_i = sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i} - U*x_{i,h})
+  detail::subtractUx(mb.getU(), m_x[id], stats, (int)m_dim_C, (int)m_dim_D,
+    m_cache_Fn_z_i.data());
 }
 
 void bob::trainer::FABaseTrainer::updateZ_i(const size_t id)
 {
-  // Computes zi = Azi * D^T.Sigma^-1 * Fn_zi
-  blitz::Array<double,1>& z = m_z[id];
-  // m_tmp_CD = m_cache_DtSigmaInv * m_cache_Fn_z_i = Dt*diag(sigma)^-1 * sum_{sessions h}(N_{i,h}*(o_{i,h} - m - V*y_{i} - U*x_{i,h})
-  z = m_cache_IdPlusDProd_i * m_cache_DtSigmaInv * m_cache_Fn_z_i;
+  // Computes zi = (I+Dt*diag(sigma)^-1*Ni*D)^-1 * Dt*diag(sigma)^-1 * Fn_zi
+  m_z[id] = m_cache_IdPlusDProd_i * m_cache_DtSigmaInv * m_cache_Fn_z_i;
 }
 
 void bob::trainer::FABaseTrainer::updateZ(const bob::machine::FABase& m,
@@ -509,33 +783,39 @@ void bob::trainer::FABaseTrainer::updateZ(const bob::machine::FABase& m,
   // Precomputation
   computeDtSigmaInv(m);
   computeDProd(m);
-  // Loops over all people
-  for (size_t id=0; id<m_Nid; ++id) {
-    computeIdPlusDProd_i(id);
-    computeFn_z_i(m, stats[id], id);
-    updateZ_i(id);
-  }
+  // Computes zi = (I+Dt*diag(sigma)^-1*Ni*D)^-1 * Dt*diag(sigma)^-1 * Fn_zi
+  // for all people
+  std::vector<blitz::Array<double,1> > A1, A2;
+  detail::FAZOp op(false, m, stats, m_x, m_y, m_z, m_Nacc, m_Facc,
+    m_cache_DtSigmaInv, m_cache_DProd, (int)m_dim_C, (int)m_dim_D, A1, A2);
+  bob::core::parallel_for(op, m_Nid, m_n_threads);
 }
 
 void bob::trainer::FABaseTrainer::computeAccumulatorsD(
   const bob::machine::FABase& m,
   const std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > >& stats)
 {
-  // Initializes the cache accumulator
+  // Partial accumulators of each thread
+  const size_t n_threads = bob::core::thread_count(m_n_threads);
+  std::vector<blitz::Array<double,1> > A1, A2;
+  for (size_t t=0; t<n_threads; ++t)
+  {
+    A1.push_back(blitz::Array<double,1>(m_dim_C*m_dim_D));
+    A1.back() = 0.;
+    A2.push_back(blitz::Array<double,1>(m_dim_C*m_dim_D));
+    A2.back() = 0.;
+  }
+  detail::FAZOp op(true, m, stats, m_x, m_y, m_z, m_Nacc, m_Facc,
+    m_cache_DtSigmaInv, m_cache_DProd, (int)m_dim_C, (int)m_dim_D, A1, A2);
+  bob::core::parallel_for(op, stats.size(), n_threads);
+
+  // Reduces the partial accumulators
   m_acc_D_A1 = 0.;
   m_acc_D_A2 = 0.;
-  // Loops over all people
-  blitz::firstIndex i;
-  blitz::secondIndex j;
-  for (size_t id=0; id<stats.size(); ++id) {
-    computeIdPlusDProd_i(id);
-    computeFn_z_i(m, stats[id], id);
-
-    // Needs to return values to be accumulated for estimating D
-    blitz::Array<double,1> z = m_z[id];
-    bob::core::array::repelem(m_Nacc[id], m_tmp_CD);
-    m_acc_D_A1 += (m_cache_IdPlusDProd_i + z * z) * m_tmp_CD;
-    m_acc_D_A2 += m_cache_Fn_z_i * z;
+  for (size_t t=0; t<n_threads; ++t)
+  {
+    m_acc_D_A1 += A1[t];
+    m_acc_D_A2 += A2[t];
   }
 }
 
@@ -558,6 +838,7 @@ bob::trainer::ISVTrainer::ISVTrainer(const bob::trainer::ISVTrainer& other):
   EMTrainer<bob::machine::ISVBase, std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > >
     (other.m_convergence_threshold, other.m_max_iterations,
      other.m_compute_likelihood),
+  m_base_trainer(other.m_base_trainer),
   m_relevance_factor(other.m_relevance_factor)
 {
 }
@@ -574,6 +855,7 @@ bob::trainer::ISVTrainer& bob::trainer::ISVTrainer::operator=
     bob::trainer::EMTrainer<bob::machine::ISVBase,
       std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > >::operator=(other);
     m_relevance_factor = other.m_relevance_factor;
+    m_base_trainer.setNThreads(other.m_base_trainer.getNThreads());
   }
   return *this;
 }
@@ -677,7 +959,8 @@ bob::trainer::JFATrainer::JFATrainer(const size_t max_iterations):
 }
 
 bob::trainer::JFATrainer::JFATrainer(const bob::trainer::JFATrainer& other):
-  m_max_iterations(other.m_max_iterations), m_rng(other.m_rng)
+  m_max_iterations(other.m_max_iterations), m_rng(other.m_rng),
+  m_base_trainer(other.m_base_trainer)
 {
 }
 
@@ -692,6 +975,7 @@ bob::trainer::JFATrainer& bob::trainer::JFATrainer::operator=
   {
     m_max_iterations = other.m_max_iterations;
     m_rng = other.m_rng;
+    m_base_trainer.setNThreads(other.m_base_trainer.getNThreads());
   }
   return *this;
 }
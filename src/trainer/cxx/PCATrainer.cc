@@ -6,7 +6,8 @@
  *
  * @brief Principal Component Analysis implemented with Singular Value
  * Decomposition or using the Covariance Method. Both are implemented using
- * LAPACK. Implementation.
+ * LAPACK. A truncated decomposition based on a randomized range finder is
+ * also available. Implementation.
  *
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
@@ -17,15 +18,20 @@
 #include <bob/math/stats.h>
 #include <bob/math/svd.h>
 #include <bob/math/eig.h>
+#include <bob/math/gemm.h>
 #include <bob/trainer/PCATrainer.h>
 
 bob::trainer::PCATrainer::PCATrainer(bool use_svd)
-  : m_use_svd(use_svd), m_safe_svd(false)
+  : m_use_svd(use_svd), m_safe_svd(false), m_n_threads(1), m_rank(0),
+    m_oversampling(10), m_power_iterations(2), m_rng(new boost::mt19937())
 {
 }
 
 bob::trainer::PCATrainer::PCATrainer(const bob::trainer::PCATrainer& other)
-  : m_use_svd(other.m_use_svd), m_safe_svd(other.m_safe_svd)
+  : m_use_svd(other.m_use_svd), m_safe_svd(other.m_safe_svd),
+    m_n_threads(other.m_n_threads), m_rank(other.m_rank),
+    m_oversampling(other.m_oversampling),
+    m_power_iterations(other.m_power_iterations), m_rng(other.m_rng)
 {
 }
 
@@ -37,6 +43,11 @@ bob::trainer::PCATrainer& bob::trainer::PCATrainer::operator=
   if (this != &other) {
     m_use_svd = other.m_use_svd;
     m_safe_svd = other.m_safe_svd;
+    m_n_threads = other.m_n_threads;
+    m_rank = other.m_rank;
+    m_oversampling = other.m_oversampling;
+    m_power_iterations = other.m_power_iterations;
+    m_rng = other.m_rng;
   }
   return *this;
 }
@@ -45,7 +56,10 @@ bool bob::trainer::PCATrainer::operator==
   (const bob::trainer::PCATrainer& other) const
 {
   return m_use_svd == other.m_use_svd && 
-    m_safe_svd == other.m_safe_svd;
+    m_safe_svd == other.m_safe_svd &&
+    m_rank == other.m_rank &&
+    m_oversampling == other.m_oversampling &&
+    m_power_iterations == other.m_power_iterations;
 }
 
 bool bob::trainer::PCATrainer::operator!=
@@ -62,26 +76,17 @@ bool bob::trainer::PCATrainer::is_similar_to
 }
 
 /**
- * Sets up the machine calculating the PC's via the Covariance Matrix
+ * Sets up the machine from the mean and the covariance matrix of the data
  */
-static void pca_via_covmat(
+static void pca_from_covmat(
     bob::machine::LinearMachine& machine,
     blitz::Array<double,1>& eigen_values, 
-    const blitz::Array<double,2>& X,
+    const blitz::Array<double,1>& mean,
+    blitz::Array<double,2>& Sigma,
     int rank
     ) {
-  /**
-   * computes the covariance matrix (X-mu)(X-mu)^T / (len(X)-1) and then solves
-   * the generalized eigen-value problem taking into consideration the
-   * covariance matrix is symmetric (and, by extension, hermitian).
-   */
-  blitz::Array<double,1> mean(X.extent(1));
-  blitz::Array<double,2> Sigma(X.extent(1), X.extent(1));
-  bob::math::scatter_(X, Sigma, mean);
-  Sigma /= (X.extent(0)-1); //unbiased variance estimator
-
-  blitz::Array<double,2> U(X.extent(1), X.extent(1));
-  blitz::Array<double,1> e(X.extent(1));
+  blitz::Array<double,2> U(Sigma.extent(0), Sigma.extent(0));
+  blitz::Array<double,1> e(Sigma.extent(0));
   bob::math::eigSym_(Sigma, U, e);
   e.reverseSelf(0);
   U.reverseSelf(1);
@@ -102,6 +107,28 @@ static void pca_via_covmat(
   }
 }
 
+/**
+ * Sets up the machine calculating the PC's via the Covariance Matrix
+ */
+static void pca_via_covmat(
+    bob::machine::LinearMachine& machine,
+    blitz::Array<double,1>& eigen_values, 
+    const blitz::Array<double,2>& X,
+    int rank, size_t n_threads
+    ) {
+  /**
+   * computes the covariance matrix (X-mu)(X-mu)^T / (len(X)-1) and then solves
+   * the generalized eigen-value problem taking into consideration the
+   * covariance matrix is symmetric (and, by extension, hermitian).
+   */
+  blitz::Array<double,1> mean(X.extent(1));
+  blitz::Array<double,2> Sigma(X.extent(1), X.extent(1));
+  bob::math::scatter_(X, Sigma, mean, n_threads);
+  Sigma /= (X.extent(0)-1); //unbiased variance estimator
+
+  pca_from_covmat(machine, eigen_values, mean, Sigma, rank);
+}
+
 /**
  * Sets up the machine calculating the PC's via SVD
  */
@@ -156,6 +183,105 @@ static void pca_via_svd(
   eigen_values = (blitz::pow2(sigma)/(X.extent(0)-1))(up_to_rank);
 }
 
+/**
+ * Computes Y = (X - 1 mean^T) B (transX false) or Y = (X - 1 mean^T)^T B
+ * (transX true), without explicitly centering the data matrix X
+ */
+static void centered_prod(const blitz::Array<double,2>& X,
+    const blitz::Array<double,1>& mean, const blitz::Array<double,2>& B,
+    blitz::Array<double,2>& Y, bool transX, size_t n_threads) {
+  bob::math::gemm_(X, B, Y, transX, false, 1., 0., n_threads);
+  blitz::Range a = blitz::Range::all();
+  if (!transX) {
+    // (1 mean^T) B = 1 (B^T mean)^T
+    for (int j=0; j<B.extent(1); ++j) {
+      const double c = blitz::sum(mean * B(a,j));
+      Y(a,j) -= c;
+    }
+  }
+  else {
+    // (1 mean^T)^T B = mean (1^T B)
+    for (int j=0; j<B.extent(1); ++j) {
+      const double c = blitz::sum(B(a,j));
+      Y(a,j) -= c * mean;
+    }
+  }
+}
+
+/**
+ * Sets Q to an orthonormal basis of the range of Y (which has more rows than
+ * columns), using the left singular vectors of Y.
+ */
+static void orthonormalize(const blitz::Array<double,2>& Y,
+    blitz::Array<double,2>& Q, blitz::Array<double,1>& sigma) {
+  bob::math::svd_(Y, Q, sigma);
+}
+
+/**
+ * Sets up the machine calculating the rank first PC's via a randomized range
+ * finder with power iterations (Halko et al., algorithms 4.4 and 5.1). Only
+ * products of X with thin matrices and factorizations of thin matrices are
+ * required.
+ */
+static void pca_via_randomized(
+    bob::machine::LinearMachine& machine,
+    blitz::Array<double,1>& eigen_values, 
+    const blitz::Array<double,2>& X,
+    int rank, size_t oversampling, size_t power_iterations,
+    boost::mt19937& rng, bool safe_svd, size_t n_threads
+    ) {
+  const int N = X.extent(0);
+  const int D = X.extent(1);
+  const int l = std::min(rank + (int)oversampling, std::min(N, D));
+  blitz::Range a = blitz::Range::all();
+
+  // computes the mean of the training data
+  blitz::Array<double,1> mean(D);
+  mean = 0.;
+  for (int i=0; i<N; ++i) mean += X(i,a);
+  mean /= N;
+
+  // draws the random test matrix
+  blitz::Array<double,2> Omega(D, l);
+  boost::normal_distribution<double> normal;
+  boost::variate_generator<boost::mt19937&, boost::normal_distribution<double> >
+    vg(rng, normal);
+  for (int d=0; d<D; ++d)
+    for (int j=0; j<l; ++j)
+      Omega(d,j) = vg();
+
+  // finds an orthonormal basis Q of the range of the centered data
+  blitz::Array<double,2> Y(N, l);
+  blitz::Array<double,2> Q(N, l);
+  blitz::Array<double,2> Z(D, l);
+  blitz::Array<double,2> P(D, l);
+  blitz::Array<double,1> sigma(l);
+  centered_prod(X, mean, Omega, Y, false, n_threads);
+  orthonormalize(Y, Q, sigma);
+  for (size_t it=0; it<power_iterations; ++it) {
+    centered_prod(X, mean, Q, Z, true, n_threads);
+    orthonormalize(Z, P, sigma);
+    centered_prod(X, mean, P, Y, false, n_threads);
+    orthonormalize(Y, Q, sigma);
+  }
+
+  // (X-mu)^T (X-mu) ~= Z Z^T, with Z = (X-mu)^T Q, whose left singular
+  // vectors are the principal components
+  centered_prod(X, mean, Q, Z, true, n_threads);
+  blitz::Array<double,2> U(D, l);
+  bob::math::svd_(Z, U, sigma, safe_svd);
+
+  /**
+   * sets the linear machine with the results:
+   */
+  machine.setInputSubtraction(mean);
+  machine.setInputDivision(1.0);
+  machine.setBiases(0.0);
+  blitz::Range up_to_rank(0, rank-1);
+  machine.setWeights(U(a,up_to_rank));
+  eigen_values = (blitz::pow2(sigma)/(N-1))(up_to_rank);
+}
+
 void bob::trainer::PCATrainer::train(bob::machine::LinearMachine& machine,
   blitz::Array<double,1>& eigen_values, const blitz::Array<double,2>& X) const
 {
@@ -179,8 +305,10 @@ void bob::trainer::PCATrainer::train(bob::machine::LinearMachine& machine,
     throw std::runtime_error(m.str());
   }
 
-  if (m_use_svd) pca_via_svd(machine, eigen_values, X, rank, m_safe_svd);
-  else pca_via_covmat(machine, eigen_values, X, rank);
+  if (m_rank > 0) pca_via_randomized(machine, eigen_values, X, rank,
+      m_oversampling, m_power_iterations, *m_rng, m_safe_svd, m_n_threads);
+  else if (m_use_svd) pca_via_svd(machine, eigen_values, X, rank, m_safe_svd);
+  else pca_via_covmat(machine, eigen_values, X, rank, m_n_threads);
 }
 
 void bob::trainer::PCATrainer::train(bob::machine::LinearMachine& machine,
@@ -190,7 +318,52 @@ void bob::trainer::PCATrainer::train(bob::machine::LinearMachine& machine,
   train(machine, throw_away_eigen_values, X);
 }
 
+void bob::trainer::PCATrainer::train(bob::machine::LinearMachine& machine,
+  blitz::Array<double,1>& eigen_values,
+  bob::trainer::SampleReader& reader) const
+{
+  const size_t D = reader.getNFeatures();
+  if (machine.inputSize() != D) {
+    boost::format m("Number of features at input data set (%d columns) does not match machine input size (%d)");
+    m % D % machine.inputSize();
+    throw std::runtime_error(m.str());
+  }
+
+  // accumulates the mean and the scatter matrix, one block at a time
+  bob::math::ScatterAccumulator acc(D, m_n_threads);
+  bob::trainer::accumulateScatter(reader, acc);
+  const size_t N = acc.getNSamples();
+  if (N < 2) {
+    boost::format m("The input data set contains %d samples, whereas at least two are required to estimate a covariance matrix");
+    m % N;
+    throw std::runtime_error(m.str());
+  }
+
+  const int rank = output_size(N, D);
+  if (machine.outputSize() != (size_t)rank) {
+    boost::format m("Number of outputs of the given machine (%d) does not match the maximum covariance rank, i.e., min(#samples-1,#features) = min(%d, %d) = %d");
+    m % machine.outputSize() % (N-1) % D % rank;
+    throw std::runtime_error(m.str());
+  }
+  if (eigen_values.extent(0) != rank) {
+    boost::format m("Number of eigenvalues on the given 1D array (%d) does not match the maximum covariance rank, i.e., min(#samples-1,#features) = min(%d,%d) = %d");
+    m % eigen_values.extent(0) % (N-1) % D % rank;
+    throw std::runtime_error(m.str());
+  }
+
+  blitz::Array<double,2> Sigma(acc.getScatter().copy());
+  Sigma /= (N-1); //unbiased variance estimator
+  pca_from_covmat(machine, eigen_values, acc.getMean(), Sigma, rank);
+}
+
 size_t bob::trainer::PCATrainer::output_size
 (const blitz::Array<double,2>& X) const{
-  return (size_t)std::min(X.extent(0)-1,X.extent(1));
+  const size_t rank = (size_t)std::min(X.extent(0)-1,X.extent(1));
+  return m_rank > 0 ? std::min(rank, m_rank) : rank;
+}
+
+size_t bob::trainer::PCATrainer::output_size
+(const size_t n_samples, const size_t n_features) const{
+  const size_t rank = std::min(n_samples-1, n_features);
+  return m_rank > 0 ? std::min(rank, m_rank) : rank;
 }
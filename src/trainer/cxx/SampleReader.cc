@@ -0,0 +1,125 @@
+/**
+ * @file trainer/cxx/SampleReader.cc
+ * @date Sun Oct 18 17:48:20 2026 +0200
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/trainer/SampleReader.h>
+#include <bob/core/assert.h>
+#include <bob/core/check.h>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+bob::trainer::SampleReader::SampleReader(const size_t n_features,
+    const size_t block_size):
+  m_n_features(n_features), m_block_size(block_size)
+{
+  if (m_block_size == 0)
+    throw std::runtime_error("SampleReader: the block size should be strictly positive");
+}
+
+bob::trainer::SampleReader::~SampleReader()
+{
+}
+
+/**
+ * Returns the dimensionality of the rows of a dataset
+ */
+static size_t hdf5_n_features(bob::io::HDF5File& file,
+  const std::string& path)
+{
+  const bob::io::HDF5Descriptor& d = file.describe(path)[0];
+  if (d.type.shape().n() != 1) {
+    boost::format m("dataset '%s' of file '%s' does not contain a list of 1D samples");
+    m % path % file.filename();
+    throw std::runtime_error(m.str());
+  }
+  return d.type.shape()[0];
+}
+
+bob::trainer::HDF5SampleReader::HDF5SampleReader(bob::io::HDF5File& file,
+    const std::string& path, const size_t block_size):
+  SampleReader(hdf5_n_features(file, path), block_size),
+  m_file(file), m_path(path), m_n_samples(file.describe(path)[0].size),
+  m_next(0)
+{
+}
+
+bob::trainer::HDF5SampleReader::~HDF5SampleReader()
+{
+}
+
+void bob::trainer::HDF5SampleReader::reset()
+{
+  m_next = 0;
+}
+
+size_t bob::trainer::HDF5SampleReader::read(blitz::Array<double,2>& block)
+{
+  bob::core::array::assertSameDimensionLength(block.extent(1),
+    getNFeatures());
+  const int n = std::min(m_n_samples - m_next,
+    static_cast<size_t>(block.extent(0)));
+  if (n == 0) return 0;
+
+  // Reads all the rows with a single hyperslab selection
+  blitz::Array<double,2> rows = block(blitz::Range(0, n-1),
+    blitz::Range::all());
+  if (bob::core::array::isCZeroBaseContiguous(rows))
+    m_file.readArrayBlock(m_path, m_next, rows);
+  else {
+    blitz::Array<double,2> tmp(n, getNFeatures());
+    m_file.readArrayBlock(m_path, m_next, tmp);
+    rows = tmp;
+  }
+  m_next += n;
+  return n;
+}
+
+bob::trainer::CallbackSampleReader::CallbackSampleReader(
+    const size_t n_features, const read_callback& read,
+    const reset_callback& reset, const size_t block_size):
+  SampleReader(n_features, block_size), m_read(read), m_reset(reset)
+{
+}
+
+bob::trainer::CallbackSampleReader::~CallbackSampleReader()
+{
+}
+
+void bob::trainer::CallbackSampleReader::reset()
+{
+  m_reset();
+}
+
+size_t bob::trainer::CallbackSampleReader::read(
+  blitz::Array<double,2>& block)
+{
+  const size_t n = m_read(block);
+  if (n > static_cast<size_t>(block.extent(0))) {
+    boost::format m("CallbackSampleReader: the read function returned %u samples, whereas the block can only hold %d");
+    m % n % block.extent(0);
+    throw std::runtime_error(m.str());
+  }
+  return n;
+}
+
+void bob::trainer::accumulateScatter(bob::trainer::SampleReader& reader,
+  bob::math::ScatterAccumulator& accumulator)
+{
+  bob::core::array::assertSameDimensionLength(reader.getNFeatures(),
+    accumulator.getNFeatures());
+
+  blitz::Array<double,2> block(reader.getBlockSize(), reader.getNFeatures());
+  blitz::Range a = blitz::Range::all();
+  reader.reset();
+  size_t n;
+  while ((n = reader.read(block)) > 0) {
+    if (n == static_cast<size_t>(block.extent(0)))
+      accumulator.accumulate(block);
+    else
+      accumulator.accumulate(block(blitz::Range(0, n-1), a));
+  }
+}
@@ -14,11 +14,13 @@
 #include <boost/make_shared.hpp>
 
 
-bob::trainer::WCCNTrainer::WCCNTrainer()
+bob::trainer::WCCNTrainer::WCCNTrainer():
+  m_n_threads(1)
 {
 }
 
-bob::trainer::WCCNTrainer::WCCNTrainer(const bob::trainer::WCCNTrainer& other)
+bob::trainer::WCCNTrainer::WCCNTrainer(const bob::trainer::WCCNTrainer& other):
+  m_n_threads(other.m_n_threads)
 {
 }
 
@@ -27,6 +29,7 @@ bob::trainer::WCCNTrainer::~WCCNTrainer() {}
 bob::trainer::WCCNTrainer& bob::trainer::WCCNTrainer::operator=
 (const bob::trainer::WCCNTrainer& other)
 {
+  m_n_threads = other.m_n_threads;
   return *this;
 }
 
@@ -92,7 +95,7 @@ void bob::trainer::WCCNTrainer::train(bob::machine::LinearMachine& machine,
   blitz::Array<double,1> mean(n_features);
   blitz::Array<double,2> buf1(n_features, n_features); // Sw
   blitz::Array<double,2> buf2(n_features, n_features); // Sb
-  bob::math::scatters(data, buf1, buf2, mean); // buf1 = Sw; buf2 = Sb
+  bob::math::scatters(data, buf1, buf2, mean, m_n_threads); // buf1 = Sw; buf2 = Sb
 
   // 2. Computes the inverse of (1/N * Sw), Sw is the within-class covariance matrix
   buf1 /= n_classes;
@@ -13,11 +13,13 @@
 #include <bob/math/lu.h>
 #include <bob/math/stats.h>
 
-bob::trainer::WhiteningTrainer::WhiteningTrainer()
+bob::trainer::WhiteningTrainer::WhiteningTrainer():
+  m_n_threads(1)
 {
 }
 
-bob::trainer::WhiteningTrainer::WhiteningTrainer(const bob::trainer::WhiteningTrainer& other)
+bob::trainer::WhiteningTrainer::WhiteningTrainer(const bob::trainer::WhiteningTrainer& other):
+  m_n_threads(other.m_n_threads)
 {
 }
 
@@ -26,6 +28,7 @@ bob::trainer::WhiteningTrainer::~WhiteningTrainer() {}
 bob::trainer::WhiteningTrainer& bob::trainer::WhiteningTrainer::operator=
 (const bob::trainer::WhiteningTrainer& other)
 {
+  m_n_threads = other.m_n_threads;
   return *this;
 }
 
@@ -48,6 +51,30 @@ bool bob::trainer::WhiteningTrainer::is_similar_to
   return true;
 }
 
+/**
+ * Sets up the machine from the mean and the covariance matrix of the data
+ */
+static void whitening_from_covmat(bob::machine::LinearMachine& machine,
+  const blitz::Array<double,1>& mean, const blitz::Array<double,2>& cov)
+{
+  const int n_features = mean.extent(0);
+
+  // 2. Computes the inverse of the covariance matrix
+  blitz::Array<double,2> icov(n_features,n_features);
+  bob::math::inv(cov, icov);
+
+  // 3. Computes the Cholesky decomposition of the inverse covariance matrix 
+  blitz::Array<double,2> whiten(n_features,n_features);
+  bob::math::chol(icov, whiten);
+
+  // 4. Updates the linear machine
+  machine.setInputSubtraction(mean);
+  machine.setInputDivision(1.);
+  machine.setWeights(whiten);
+  machine.setBiases(0);
+  machine.setActivation(boost::make_shared<bob::machine::IdentityActivation>());
+}
+
 void bob::trainer::WhiteningTrainer::train(bob::machine::LinearMachine& machine, 
   const blitz::Array<double,2>& ar)
 {
@@ -73,21 +100,45 @@ void bob::trainer::WhiteningTrainer::train(bob::machine::LinearMachine& machine,
   // 1. Computes the mean vector and the covariance matrix of the training set
   blitz::Array<double,1> mean(n_features);
   blitz::Array<double,2> cov(n_features,n_features);
-  bob::math::scatter(ar, cov, mean);
+  bob::math::scatter(ar, cov, mean, m_n_threads);
   cov /= (double)(n_samples-1);
 
-  // 2. Computes the inverse of the covariance matrix
-  blitz::Array<double,2> icov(n_features,n_features);
-  bob::math::inv(cov, icov);
+  whitening_from_covmat(machine, mean, cov);
+}
 
-  // 3. Computes the Cholesky decomposition of the inverse covariance matrix 
-  blitz::Array<double,2> whiten(n_features,n_features);
-  bob::math::chol(icov, whiten);
+void bob::trainer::WhiteningTrainer::train(bob::machine::LinearMachine& machine,
+  bob::trainer::SampleReader& reader)
+{
+  // training data dimensions
+  const size_t n_features = reader.getNFeatures();
+  // machine dimensions
+  const size_t n_inputs = machine.inputSize();
+  const size_t n_outputs = machine.outputSize();
 
-  // 4. Updates the linear machine
-  machine.setInputSubtraction(mean);
-  machine.setInputDivision(1.);
-  machine.setWeights(whiten);
-  machine.setBiases(0);
-  machine.setActivation(boost::make_shared<bob::machine::IdentityActivation>());
+  // Checks that the dimensions are matching
+  if (n_inputs != n_features) {
+    boost::format m("machine input size (%u) does not match the number of features of the reader (%u)");
+    m % n_inputs % n_features;
+    throw std::runtime_error(m.str());
+  }
+  if (n_outputs != n_features) {
+    boost::format m("machine output size (%u) does not match the number of features of the reader (%u)");
+    m % n_outputs % n_features;
+    throw std::runtime_error(m.str());
+  }
+
+  // 1. Accumulates the mean vector and the covariance matrix of the training
+  // set, one block at a time
+  bob::math::ScatterAccumulator acc(n_features, m_n_threads);
+  bob::trainer::accumulateScatter(reader, acc);
+  const size_t n_samples = acc.getNSamples();
+  if (n_samples < 2) {
+    boost::format m("the reader provides %u samples, whereas at least two are required to estimate a covariance matrix");
+    m % n_samples;
+    throw std::runtime_error(m.str());
+  }
+  blitz::Array<double,2> cov(acc.getScatter().copy());
+  cov /= (double)(n_samples-1);
+
+  whitening_from_covmat(machine, acc.getMean(), cov);
 }
@@ -0,0 +1,46 @@
+/**
+ * @file trainer/cxx/benchmark/kmeans.cc
+ * @date Sun Oct 18 19:34:02 2026 +0200
+ *
+ * @brief Benchmark of the k-means training
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/core/array_random.h>
+#include <bob/core/benchmark.h>
+#include <bob/machine/KMeansMachine.h>
+#include <bob/trainer/KMeansTrainer.h>
+
+#include <boost/format.hpp>
+#include <boost/random.hpp>
+#include <boost/shared_ptr.hpp>
+
+void benchmark_kmeans(bob::core::BenchmarkSuite& suite, boost::mt19937& rng,
+  const int C, const int D, const int N, const int n_iterations)
+{
+  blitz::Array<double,2> X(N,D);
+  bob::core::array::randn(rng, X);
+
+  bob::machine::KMeansMachine machine(C, D);
+  bob::trainer::KMeansTrainer trainer(-1., n_iterations, false);
+  const std::string size = (boost::format("C=%d,D=%d,N=%d,it=%d") % C % D % N % n_iterations).str();
+  while (suite.iterate("KMeansTrainer::train", size)) {
+    // the same initialization is used for each run
+    trainer.setRng(boost::shared_ptr<boost::mt19937>(new boost::mt19937(0)));
+    trainer.train(machine, X);
+  }
+}
+
+/*************** KMeans benchmarks *****************/
+int main(int argc, char** argv)
+{
+  bob::core::BenchmarkSuite suite("trainer", argc, argv);
+  boost::mt19937 rng(0);
+
+  benchmark_kmeans(suite, rng, 64, 60, 10000, 5);
+  benchmark_kmeans(suite, rng, 256, 60, 10000, 5);
+
+  suite.report();
+  return 0;
+}
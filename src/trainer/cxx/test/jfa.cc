@@ -0,0 +1,156 @@
+/**
+ * @file trainer/cxx/test/jfa.cc
+ * @date Mon Oct 19 14:37:52 2026 +0200
+ *
+ * @brief Checks that the (deprecated) per-person and per-session updates of
+ * the latent variables match the batched ones
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Trainer-jfa Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/random.hpp>
+#include <blitz/array.h>
+#include <cmath>
+#include <vector>
+
+#include <bob/core/array_copy.h>
+#include <bob/core/array_random.h>
+#include <bob/trainer/JFATrainer.h>
+
+/**
+ * A random factor analysis model, 5 clients with 1 to 3 sessions each and
+ * random starting values of the latent variables
+ */
+struct T {
+  enum { C = 3, D = 2, Ru = 2, Rv = 3, N = 5 };
+  boost::mt19937 rng;
+  boost::shared_ptr<bob::machine::GMMMachine> ubm;
+  bob::machine::FABase m;
+  std::vector<std::vector<boost::shared_ptr<bob::machine::GMMStats> > > stats;
+  std::vector<blitz::Array<double,2> > x;
+  std::vector<blitz::Array<double,1> > y, z;
+
+  T(): rng(0), ubm(boost::make_shared<bob::machine::GMMMachine>(C, D)),
+    m(ubm, Ru, Rv)
+  {
+    blitz::Array<double,1> mean(C*D), variance(C*D), d(C*D);
+    bob::core::array::randn(rng, mean);
+    bob::core::array::randn(rng, variance);
+    variance = 0.5 + blitz::abs(variance);
+    ubm->setMeanSupervector(mean);
+    ubm->setVarianceSupervector(variance);
+
+    blitz::Array<double,2> U(C*D, Ru), V(C*D, Rv);
+    bob::core::array::randn(rng, U);
+    bob::core::array::randn(rng, V);
+    bob::core::array::randn(rng, d);
+    m.setU(U);
+    m.setV(V);
+    m.setD(d);
+
+    boost::uniform_real<> n(0., 10.);
+    for (int i = 0; i < N; ++i) {
+      std::vector<boost::shared_ptr<bob::machine::GMMStats> > client;
+      for (int h = 0; h < 1 + i % 3; ++h) {
+        boost::shared_ptr<bob::machine::GMMStats> s =
+          boost::make_shared<bob::machine::GMMStats>(C, D);
+        for (int c = 0; c < C; ++c) s->n(c) = n(rng);
+        bob::core::array::randn(rng, s->sumPx);
+        s->T = 1 + h;
+        client.push_back(s);
+      }
+      stats.push_back(client);
+
+      x.push_back(blitz::Array<double,2>(Ru, client.size()));
+      bob::core::array::randn(rng, x.back());
+      y.push_back(blitz::Array<double,1>(Rv));
+      bob::core::array::randn(rng, y.back());
+      z.push_back(blitz::Array<double,1>(C*D));
+      bob::core::array::randn(rng, z.back());
+    }
+  }
+
+  /**
+   * Initializes a trainer with copies of the starting values (the blitz++
+   * arrays would otherwise be shared between the trainers)
+   */
+  void init(bob::trainer::FABaseTrainer& t) {
+    t.initUbmNidSumStatistics(m, stats);
+    t.initializeXYZ(stats);
+    std::vector<blitz::Array<double,2> > x_copy;
+    std::vector<blitz::Array<double,1> > y_copy, z_copy;
+    for (size_t i = 0; i < x.size(); ++i) {
+      x_copy.push_back(bob::core::array::ccopy(x[i]));
+      y_copy.push_back(bob::core::array::ccopy(y[i]));
+      z_copy.push_back(bob::core::array::ccopy(z[i]));
+    }
+    t.setX(x_copy);
+    t.setY(y_copy);
+    t.setZ(z_copy);
+  }
+};
+
+/**
+ * Checks that the relative differences between the latent variables are
+ * below eps
+ */
+template <int R>
+static void check_close(const std::vector<blitz::Array<double,R> >& a,
+  const std::vector<blitz::Array<double,R> >& b, double eps)
+{
+  BOOST_REQUIRE_EQUAL(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    BOOST_REQUIRE_EQUAL(a[i].size(), b[i].size());
+    typename blitz::Array<double,R>::const_iterator ia = a[i].begin(),
+      ib = b[i].begin();
+    for ( ; ia != a[i].end(); ++ia, ++ib)
+      BOOST_CHECK_SMALL(*ia - *ib, eps * (1.0 + std::fabs(*ib)));
+  }
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_per_item_updates )
+{
+  bob::trainer::FABaseTrainer batched, per_item;
+  init(batched);
+  init(per_item);
+
+  batched.updateY(m, stats);
+  per_item.computeVtSigmaInv(m);
+  per_item.computeVProd(m);
+  for (size_t id = 0; id < stats.size(); ++id) {
+    per_item.computeIdPlusVProd_i(id);
+    per_item.computeFn_y_i(m, stats[id], id);
+    per_item.updateY_i(id);
+  }
+  check_close(per_item.getY(), batched.getY(), 1e-10);
+
+  batched.updateX(m, stats);
+  per_item.computeUtSigmaInv(m);
+  per_item.computeUProd(m);
+  for (size_t id = 0; id < stats.size(); ++id)
+    for (size_t h = 0; h < stats[id].size(); ++h) {
+      per_item.computeIdPlusUProd_ih(stats[id][h]);
+      per_item.computeFn_x_ih(m, stats[id][h], id);
+      per_item.updateX_ih(id, h);
+    }
+  check_close(per_item.getX(), batched.getX(), 1e-10);
+
+  batched.updateZ(m, stats);
+  per_item.computeDtSigmaInv(m);
+  per_item.computeDProd(m);
+  for (size_t id = 0; id < stats.size(); ++id) {
+    per_item.computeIdPlusDProd_i(id);
+    per_item.computeFn_z_i(m, stats[id], id);
+    per_item.updateZ_i(id);
+  }
+  check_close(per_item.getZ(), batched.getZ(), 1e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
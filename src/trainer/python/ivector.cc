@@ -108,5 +108,7 @@ void bind_trainer_ivector()
     .add_property("acc_fnormij_wij", make_function(&bob::trainer::IVectorTrainer::getAccFnormijWij, return_value_policy<copy_const_reference>()), &py_set_AccFnormijWij, "Accumulator updated during the E-step")
     .add_property("acc_nij", make_function(&bob::trainer::IVectorTrainer::getAccNij, return_value_policy<copy_const_reference>()), &py_set_AccNij, "Accumulator updated during the E-step")
     .add_property("acc_snormij", make_function(&bob::trainer::IVectorTrainer::getAccSnormij, return_value_policy<copy_const_reference>()), &py_set_AccSnormij, "Accumulator updated during the E-step")
+    .add_property("n_threads", &bob::trainer::IVectorTrainer::getNThreads, &bob::trainer::IVectorTrainer::setNThreads, "Number of threads used during the E-step (0 means all hardware threads)")
+    .add_property("batch_size", &bob::trainer::IVectorTrainer::getBatchSize, &bob::trainer::IVectorTrainer::setBatchSize, "Number of utterances processed at once during the E-step")
   ;
 }
@@ -14,6 +14,7 @@
 
 #include <bob/python/ndarray.h>
 #include <bob/trainer/FisherLDATrainer.h>
+#include <bob/trainer/SampleReader.h>
 
 using namespace boost::python;
 
@@ -56,6 +57,23 @@ static size_t output_size(bob::trainer::FisherLDATrainer& t, object data) {
   return t.output_size(vdata);
 }
 
+static tuple lda_train_hdf5(bob::trainer::FisherLDATrainer& t,
+  bob::io::HDF5File& file, object paths, size_t block_size)
+{
+  stl_input_iterator<std::string> pbegin(paths), pend;
+  std::vector<boost::shared_ptr<bob::trainer::SampleReader> > readers;
+  for (; pbegin != pend; ++pbegin)
+    readers.push_back(boost::shared_ptr<bob::trainer::SampleReader>(
+      new bob::trainer::HDF5SampleReader(file, *pbegin, block_size)));
+  if (readers.size() < 2)
+    throw std::runtime_error("for LDA you should provide at least 2 datasets");
+  int osize = t.output_size(readers);
+  blitz::Array<double,1> eig_val(osize);
+  bob::machine::LinearMachine m(readers[0]->getNFeatures(), osize);
+  t.train(m, eig_val, readers);
+  return make_tuple(m, eig_val);
+}
+
 static char CLASS_DOC[] = \
   "Trains a :py:class:`bob.machine.LinearMachine` to perform Fisher's Linear Discriminant Analysis (LDA).\n" \
   "\n" \
@@ -152,6 +170,23 @@ void bind_trainer_lda()
         "   We set at most :py:meth:`bob.trainer.FisherLDATrainer.output_size` eigen-values and vectors on the passed machine. You can compress the machine output further using :py:meth:`bob.machine.LinearMachine.resize` if necessary.\n" \
         )
 
+    .def("train_hdf5", &lda_train_hdf5, (arg("self"), arg("file"), arg("paths"), arg("block_size")=4096),
+        "Creates a LinearMachine that performs Fisher/LDA discrimination, reading the samples of each class from a 2D dataset of an HDF5 file, block by block.\n" \
+        "\n" \
+        "Only one block of samples is held in memory at any time, which allows training on data sets that do not fit in memory. This method returns a tuple containing the resulting linear machine and the eigen values in a 1D array, as :py:meth:`bob.trainer.FisherLDATrainer.train` does.\n" \
+        "\n" \
+        "Keyword parameters:\n" \
+        "\n" \
+        "file\n" \
+        "  An instance of :py:class:`bob.io.HDF5File` containing the data\n" \
+        "\n" \
+        "paths\n" \
+        "  The paths to the datasets, one per class. Each dataset must contain one 1D array of 64-bit floats per sample.\n" \
+        "\n" \
+        "block_size\n" \
+        "  The number of samples read at once\n" \
+        )
+
     .def("output_size", &output_size, (arg("self"), arg("X")),
        "Returns the expected size of the output (or the number of eigen-values returned) given the data.\n" \
        "\n" \
@@ -164,6 +199,9 @@ void bind_trainer_lda()
     .add_property("strip_to_rank", &bob::trainer::FisherLDATrainer::getStripToRank, &bob::trainer::FisherLDATrainer::setStripToRank,
         "Specifies how to calculate the final size of the to-be-trained :py:class:`bob.machine.LinearMachine`. The default setting (``True``), makes the trainer return only the K-1 eigen-values/vectors limiting the output to the rank of :math:`S_w^{-1} S_b`. If you set this value to ``False``, the it returns all eigen-values/vectors of :math:`S_w^{-1} Sb`, including the ones that are supposed to be zero.")
 
+    .add_property("n_threads", &bob::trainer::FisherLDATrainer::getNThreads, &bob::trainer::FisherLDATrainer::setNThreads,
+        "Number of threads used to compute the scatter matrices (0 means all hardware threads)")
+
   ;
 
 }
@@ -14,6 +14,7 @@
 
 #include <bob/python/ndarray.h>
 #include <bob/trainer/PCATrainer.h>
+#include <bob/trainer/SampleReader.h>
 
 using namespace boost::python;
 
@@ -38,6 +39,22 @@ static object pca_train2(bob::trainer::PCATrainer& t,
   return object(eig_val);
 }
 
+static tuple pca_train_hdf5(bob::trainer::PCATrainer& t,
+    bob::io::HDF5File& file, const std::string& path, size_t block_size) {
+
+  bob::trainer::HDF5SampleReader reader(file, path, block_size);
+  const int rank = t.output_size(reader.getNSamples(), reader.getNFeatures());
+  bob::machine::LinearMachine m(reader.getNFeatures(), rank);
+  blitz::Array<double,1> eig_val(rank);
+  t.train(m, eig_val, reader);
+  return make_tuple(m, object(eig_val));
+}
+
+static size_t pca_output_size(const bob::trainer::PCATrainer& t,
+    bob::python::const_ndarray data) {
+  return t.output_size(data.bz<double,2>());
+}
+
 static const char CLASS_DOC[] = \
   "Sets a linear machine to perform the Principal Component Analysis (a.k.a. Karhunen-Loève Transform) on a given dataset using either Singular Value Decomposition (SVD, *the default*) or the Covariance Matrix Method.\n" \
   "\n" \
@@ -158,7 +175,26 @@ void bind_trainer_pca() {
         "  The input data matrix :math:`X`, of 64-bit floating point numbers organized in such a way that every row corresponds to a new observation of the phenomena (i.e., a new sample) and every column corresponds to a different feature.\n"
         )
 
-    .def("output_size", &bob::trainer::PCATrainer::output_size, (arg("self"), arg("X")), 
+    .def("train_hdf5", &pca_train_hdf5, (arg("self"), arg("file"), arg("path"), arg("block_size")=4096),
+        "Trains a LinearMachine to perform the KLT, reading the training samples from a 2D dataset of an HDF5 file, block by block.\n" \
+        "\n" \
+        "Only one block of samples is held in memory at any time, which allows training on data sets that do not fit in memory. The mean and the covariance matrix are accumulated incrementally, and the principal components are always extracted with the Covariance method, whatever the setting of ``use_svd``.\n" \
+        "\n" \
+        "This method returns a tuple containing the resulting linear machine and the eigen values in a 1D array.\n" \
+        "\n" \
+        "Keyword parameters:\n" \
+        "\n" \
+        "file\n" \
+        "  An instance of :py:class:`bob.io.HDF5File` containing the data\n" \
+        "\n" \
+        "path\n" \
+        "  The path to the dataset, which must contain one 1D array of 64-bit floats per sample (e.g. a 2D array written with ``set()``, or samples appended one by one)\n" \
+        "\n" \
+        "block_size\n" \
+        "  The number of samples read at once\n"
+        )
+
+    .def("output_size", &pca_output_size, (arg("self"), arg("X")), 
         "Calculates the maximum possible rank for the covariance matrix of X, given X\n"\
         "\n" \
         "Returns the maximum number of non-zero eigen values that can be generated by this trainer, given some data. This number (K) depends on the size of X and is calculated as follows :math:`K=\\min{(S-1,F)}`, with :math:`S` being the number of rows in ``data`` (samples) and :math:`F` the number of columns (or features).\n" \
@@ -173,6 +209,26 @@ void bind_trainer_pca() {
     .add_property("safe_svd", &bob::trainer::PCATrainer::getSafeSVD,
         &bob::trainer::PCATrainer::setSafeSVD,
         "If the use_svd flag is enabled, this flag will indicates which LAPACK svd function to use (dgesvd if set to true, dgesdd otherwise).")
+
+    .add_property("n_threads", &bob::trainer::PCATrainer::getNThreads,
+        &bob::trainer::PCATrainer::setNThreads,
+        "Number of threads used to compute the covariance matrix, when the use_svd flag is disabled (0 means all hardware threads)")
+
+    .add_property("rank", &bob::trainer::PCATrainer::getRank,
+        &bob::trainer::PCATrainer::setRank,
+        "Number of principal components to compute (0, the default, means all of them). If non-zero, :py:meth:`bob.trainer.PCATrainer.train` computes a truncated decomposition with a randomized range finder, which is much faster than the SVD or the Covariance method when only a few components out of many are required.")
+
+    .add_property("oversampling", &bob::trainer::PCATrainer::getOversampling,
+        &bob::trainer::PCATrainer::setOversampling,
+        "Number of additional random directions used by the randomized range finder (only used if ``rank`` is non-zero)")
+
+    .add_property("power_iterations", &bob::trainer::PCATrainer::getPowerIterations,
+        &bob::trainer::PCATrainer::setPowerIterations,
+        "Number of power iterations of the randomized range finder (only used if ``rank`` is non-zero). More iterations improve the accuracy when the spectrum of the data decays slowly.")
+
+    .add_property("rng", &bob::trainer::PCATrainer::getRng,
+        &bob::trainer::PCATrainer::setRng,
+        "The Mersenne Twister mt19937 random generator used by the randomized range finder.")
     ;
 
 }
@@ -88,5 +88,6 @@ void bind_trainer_wccn()
     .def("is_similar_to", &bob::trainer::WCCNTrainer::is_similar_to, (arg("self"), arg("other"), arg("r_epsilon")=1e-5, arg("a_epsilon")=1e-8), "Compares this WCCNTrainer with the 'other' one to be approximately the same.")
     .def("train", &py_train1, (arg("self"), arg("machine"), arg("data")), "Trains the LinearMachine to perform the WCCN, given a training set.")
     .def("train", &py_train2, (arg("self"), arg("data")), "Allocates, trains and returns a LinearMachine to perform the WCCN, given a training set.")
+    .add_property("n_threads", &bob::trainer::WCCNTrainer::getNThreads, &bob::trainer::WCCNTrainer::setNThreads, "Number of threads used to compute the scatter matrices (0 means all hardware threads)")
   ;
 }
@@ -9,6 +9,7 @@
 #include <boost/python.hpp>
 #include <bob/python/ndarray.h>
 #include <bob/trainer/WhiteningTrainer.h>
+#include <bob/trainer/SampleReader.h>
 #include <bob/machine/LinearMachine.h>
 #include <boost/shared_ptr.hpp>
 
@@ -67,6 +68,16 @@ object py_train2(bob::trainer::WhiteningTrainer& t,
   return object(m);
 }
 
+object py_train_hdf5(bob::trainer::WhiteningTrainer& t,
+  bob::io::HDF5File& file, const std::string& path, size_t block_size)
+{
+  bob::trainer::HDF5SampleReader reader(file, path, block_size);
+  const int n_features = reader.getNFeatures();
+  bob::machine::LinearMachine m(n_features,n_features);
+  t.train(m, reader);
+  return object(m);
+}
+
 
 void bind_trainer_whitening() 
 {
@@ -77,5 +88,7 @@ void bind_trainer_whitening()
     .def("is_similar_to", &bob::trainer::WhiteningTrainer::is_similar_to, (arg("self"), arg("other"), arg("r_epsilon")=1e-5, arg("a_epsilon")=1e-8), "Compares this WhiteningTrainer with the 'other' one to be approximately the same.")
     .def("train", &py_train1, (arg("self"), arg("machine"), arg("data")), "Trains the LinearMachine to perform the Whitening, given a training set.")
     .def("train", &py_train2, (arg("self"), arg("data")), "Allocates, trains and returns a LinearMachine to perform the Whitening, given a training set.")
+    .def("train_hdf5", &py_train_hdf5, (arg("self"), arg("file"), arg("path"), arg("block_size")=4096), "Allocates, trains and returns a LinearMachine to perform the Whitening, reading the training set from a 2D dataset of an HDF5 file (an instance of :py:class:`bob.io.HDF5File`), block_size samples at a time.")
+    .add_property("n_threads", &bob::trainer::WhiteningTrainer::getNThreads, &bob::trainer::WhiteningTrainer::setNThreads, "Number of threads used to compute the covariance matrix (0 means all hardware threads)")
   ;
 }
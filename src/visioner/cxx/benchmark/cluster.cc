@@ -0,0 +1,65 @@
+/**
+ * @file visioner/cxx/benchmark/cluster.cc
+ * @date Sun Oct 18 21:12:37 2026 +0200
+ *
+ * @brief Benchmark of the clustering (non-maximum suppression) of the raw
+ * detections of a 640x480 image scanned with a 24x24 model
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/core/benchmark.h>
+#include <bob/visioner/cv/cv_detector.h>
+
+#include <boost/format.hpp>
+#include <boost/random.hpp>
+#include <vector>
+
+/**
+ * Generates the sub-windows of a pyramid scan (a fraction <density> of them
+ * are kept as detections, with random scores)
+ */
+void scan_detections(boost::mt19937& rng, double density,
+  std::vector<bob::visioner::detection_t>& detections)
+{
+  const double rows = 480., cols = 640., model = 24., ds = 2.;
+  boost::uniform_01<> die;
+
+  detections.clear();
+  for (double scale = 1.; model / scale < rows; scale *= 0.95) {
+    const double size = model / scale, step = ds / scale;
+    for (double y = 0.; y + size <= rows; y += step)
+      for (double x = 0.; x + size <= cols; x += step)
+        if (die(rng) < density)
+          detections.push_back(bob::visioner::make_detection(die(rng),
+            QRectF(x, y, size, size), 0));
+  }
+}
+
+void benchmark_cluster(bob::core::BenchmarkSuite& suite, boost::mt19937& rng,
+  double density, double threshold)
+{
+  std::vector<bob::visioner::detection_t> raw, detections;
+  scan_detections(rng, density, raw);
+
+  const std::string size = (boost::format("n=%d,thres=%g") % raw.size() % threshold).str();
+  while (suite.iterate("CVDetector::cluster", size)) {
+    detections = raw;
+    bob::visioner::CVDetector::cluster(detections, threshold, 1);
+  }
+}
+
+/*************** Detection clustering benchmarks *****************/
+int main(int argc, char** argv)
+{
+  bob::core::BenchmarkSuite suite("visioner", argc, argv);
+  boost::mt19937 rng(0);
+
+  benchmark_cluster(suite, rng, 0.01, 0.05);
+  benchmark_cluster(suite, rng, 0.125, 0.05);
+  benchmark_cluster(suite, rng, 0.125, 0.3);
+  benchmark_cluster(suite, rng, 0.125, 0.7);
+
+  suite.report();
+  return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file visioner/cxx/benchmark/scan.cc
+ * @date Sun Oct 18 20:01:45 2026 +0200
+ *
+ * @brief Benchmark of the face detection: pyramid construction and
+ * scanning of a 640x480 image. The path to the detection model is given as
+ * the first (non-option) argument.
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob/core/benchmark.h>
+#include <bob/visioner/cv/cv_detector.h>
+
+#include <boost/random.hpp>
+#include <iostream>
+#include <vector>
+
+/*************** Face detection benchmarks *****************/
+int main(int argc, char** argv)
+{
+  bob::core::BenchmarkSuite suite("visioner", argc, argv);
+  if (suite.getArguments().empty()) {
+    std::cerr << "usage: " << argv[0] << " [options] <model>" << std::endl;
+    std::cerr << "no detection model given: skipping the benchmark" << std::endl;
+    return 0;
+  }
+
+  const uint64_t rows = 480, cols = 640;
+  std::vector<uint8_t> image(rows * cols);
+  boost::mt19937 rng(0);
+  boost::uniform_int<> dist(0, 255);
+  for (size_t i=0; i<image.size(); ++i) image[i] = dist(rng);
+
+  bob::visioner::CVDetector detector(suite.getArguments()[0], 0.0, 0, 2,
+    0.05, bob::visioner::CVDetector::Scanning);
+  std::vector<bob::visioner::detection_t> detections;
+
+  while (suite.iterate("CVDetector::load", "640x480"))
+    detector.load(&image[0], rows, cols);
+
+  detector.load(&image[0], rows, cols);
+  while (suite.iterate("CVDetector::scan", "640x480"))
+    detector.scan(detections);
+
+  suite.report();
+  return 0;
+}
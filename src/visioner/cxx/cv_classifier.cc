@@ -10,11 +10,15 @@
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
 
+#include <boost/bind.hpp>
+#include <boost/lambda/lambda.hpp>
+
 #include "bob/core/logging.h"
 
 #include "bob/visioner/cv/cv_classifier.h"
 #include "bob/visioner/model/mdecoder.h"
 #include "bob/visioner/util/timer.h"
+#include "bob/visioner/util/threads.h"
 #include "bob/visioner/model/taggers/tagger_object.h"
 
 namespace bob { namespace visioner {
@@ -82,6 +86,14 @@ namespace bob { namespace visioner {
       m_model->n_outputs() == param().m_labels.size();
   }
 
+  // Clone the classifier with its own copy of the model
+  boost::shared_ptr<CVClassifier> CVClassifier::clone() const
+  {
+    boost::shared_ptr<CVClassifier> classifier(new CVClassifier(*this));
+    classifier->m_model = m_model->clone();
+    return classifier;
+  }
+
   // Predict the object label of the keypoints in the <reg> region.
   bool CVClassifier::classify(const CVDetector& detector, const QRectF& reg, uint64_t& dt_label) const
   {
@@ -124,12 +136,73 @@ namespace bob { namespace visioner {
     return ilabel >= 0;
   }
 
+  // Ground truth and predicted labels of an object
+  typedef std::pair<uint64_t, uint64_t> hit_t;
+
+  // Serialize the progress messages of the worker threads
+  static boost::mutex evaluate_mutex;
+
+  // Classify the objects of the <i>-th image with the <ith> worker detector and classifier
+  static void th_evaluate(uint64_t ith, uint64_t i,
+      const std::vector<std::string>& ifiles, const std::vector<std::string>& gfiles,
+      const std::vector<boost::shared_ptr<CVDetector> >& detectors,
+      const std::vector<boost::shared_ptr<CVClassifier> >& classifiers,
+      const ObjectTagger* obj_tagger, std::vector<std::vector<hit_t> >& ihits)
+  {
+    CVDetector& detector = *detectors[ith];
+    const CVClassifier& classifier = *classifiers[ith];
+
+    const std::string& ifile = ifiles[i];
+    const std::string& gfile = gfiles[i];
+
+    // Load the image and the ground truth
+    if (detector.load(ifile, gfile) == false)
+    {
+      boost::mutex::scoped_lock lock(evaluate_mutex);
+      bob::core::warn << "Failed to load image <" << ifile << "> or ground truth <" << gfile << ">!" << std::endl;
+      return;
+    }
+
+    // Classify sub-windows (on the detections that did not fail)
+    Timer timer;				
+
+    std::vector<detection_t> detections;
+    detector.scan(detections);
+
+    Object object;
+    for (std::vector<detection_t>::const_iterator it = detections.begin(); it != detections.end(); ++ it)
+      if (detector.match(*it, object) == true)
+      {
+        const int gt_label = obj_tagger->find(object);
+        if (gt_label < 0)
+        {
+          continue;
+        }
+
+        uint64_t dt_label = 0;
+        if (classifier.classify(detector, object.bbx(), dt_label) == false)
+        {
+          boost::mutex::scoped_lock lock(evaluate_mutex);
+          bob::core::warn << "Failed to classify a sub-window for the <" << ifile << "> image!" << std::endl;
+          continue;
+        }
+
+        ihits[i].push_back(hit_t(gt_label, dt_label));
+      }
+
+    // Debug
+    boost::mutex::scoped_lock lock(evaluate_mutex);
+    bob::core::info
+      << "Image [" << (i + 1) << "/" << ifiles.size() 
+      << "]: classified in " << timer.elapsed() << "s." << std::endl;
+  }
+
   // Compute the confusion matrix considering the 
   //      ground truth and the predicted labels.
   void CVClassifier::evaluate(
       const std::vector<std::string>& ifiles, const std::vector<std::string>& gfiles,
       CVDetector& detector, 
-      Matrix<uint64_t>& hits_mat, std::vector<uint64_t>& hits_cnt) const
+      Matrix<uint64_t>& hits_mat, std::vector<uint64_t>& hits_cnt, size_t threads) const
   {
     hits_mat.resize(n_classes(), n_classes());
     hits_mat.fill(0);
@@ -145,50 +218,31 @@ namespace bob { namespace visioner {
       return;
     }
 
-    // Process each image ...        
-    for (uint64_t i = 0; i < ifiles.size(); i ++)
+    // Process each image (in parallel, each worker with its own copy of the models) ...
+    std::vector<boost::shared_ptr<CVDetector> > detectors(std::max(threads, (size_t)1));
+    std::vector<boost::shared_ptr<CVClassifier> > classifiers(detectors.size());
+    for (uint64_t ith = 0; ith < detectors.size(); ith ++)
     {
-      const std::string& ifile = ifiles[i];
-      const std::string& gfile = gfiles[i];
+      detectors[ith] = detector.clone();
+      classifiers[ith] = clone();
+    }
 
-      // Load the image and the ground truth
-      if (detector.load(ifile, gfile) == false)
+    std::vector<std::vector<hit_t> > ihits(ifiles.size());
+    thread_queue(
+        boost::bind(&th_evaluate, boost::lambda::_1, boost::lambda::_2,
+          boost::cref(ifiles), boost::cref(gfiles), boost::cref(detectors),
+          boost::cref(classifiers), obj_tagger, boost::ref(ihits)),
+        ifiles.size(), threads);
+
+    // ... and accumulate the confusion matrix
+    for (uint64_t i = 0; i < ifiles.size(); i ++)
+    {
+      const std::vector<hit_t>& hits = ihits[i];
+      for (uint64_t k = 0; k < hits.size(); k ++)
       {
-        bob::core::warn << "Failed to load image <" << ifile << "> or ground truth <" << gfile << ">!" << std::endl;
-        continue;
+        hits_mat(hits[k].first, hits[k].second) ++;
+        hits_cnt[hits[k].first] ++;
       }
-
-      // Classify sub-windows (on the detections that did not fail)
-      Timer timer;				
-
-      std::vector<detection_t> detections;
-      detector.scan(detections);
-
-      Object object;
-      for (std::vector<detection_t>::const_iterator it = detections.begin(); it != detections.end(); ++ it)
-        if (detector.match(*it, object) == true)
-        {
-          const int gt_label = obj_tagger->find(object);
-          if (gt_label < 0)
-          {
-            continue;
-          }
-
-          uint64_t dt_label = 0;
-          if (classify(detector, object.bbx(), dt_label) == false)
-          {
-            bob::core::warn << "Failed to classify a sub-window for the <" << ifile << "> image!" << std::endl;
-            continue;
-          }
-
-          hits_mat(gt_label, dt_label) ++;
-          hits_cnt[gt_label] ++;
-        }
-
-      // Debug
-      bob::core::info
-        << "Image [" << (i + 1) << "/" << ifiles.size() 
-        << "]: classified in " << timer.elapsed() << "s." << std::endl;
     }
   }
 
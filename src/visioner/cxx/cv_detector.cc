@@ -10,6 +10,11 @@
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
 
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <boost/bind.hpp>
 #include <boost/lambda/lambda.hpp>
 #include <boost/lambda/bind.hpp>
 #include <boost/format.hpp>
@@ -19,6 +24,7 @@
 #include "bob/visioner/cv/cv_detector.h"
 #include "bob/visioner/model/mdecoder.h"
 #include "bob/visioner/util/timer.h"
+#include "bob/visioner/util/threads.h"
 
 namespace bob { namespace visioner {
 
@@ -28,7 +34,11 @@ namespace bob { namespace visioner {
     m_cluster(0.05),
     m_threshold(0.0),
     m_type(GroundTruth),
-    m_levels(0)
+    m_track_period(10),
+    m_track_margin(0.25),
+    m_track_scales(2),
+    m_levels(0),
+    m_track_frame(0)
   {
   }
 
@@ -131,7 +141,11 @@ namespace bob { namespace visioner {
     m_ds(scale_variation),
     m_cluster(clustering),
     m_threshold(threshold),
-    m_type(detection_method) {
+    m_type(detection_method),
+    m_track_period(10),
+    m_track_margin(0.25),
+    m_track_scales(2),
+    m_track_frame(0) {
 
       // Load the model
       if (Model::load(model, m_model) == false) {
@@ -177,6 +191,16 @@ namespace bob { namespace visioner {
     }
   }
 
+  // Clone the detector with its own copy of the model and an empty image pyramid
+  boost::shared_ptr<CVDetector> CVDetector::clone() const
+  {
+    boost::shared_ptr<CVDetector> detector(new CVDetector(*this));
+    detector->m_model = m_model->clone();
+    detector->m_ipyramid = ipyramid_t(m_ipyramid.param());
+    detector->m_stats = stats_t();
+    return detector;
+  }
+
   // Load an image (build the image pyramid)
   bool CVDetector::load(const std::string& ifile, const std::string& gfile)
   {
@@ -257,18 +281,112 @@ namespace bob { namespace visioner {
         for (int x = ip.m_scan_min_x; x < ip.m_scan_max_x; x += ip.m_scan_dx)
           for (int y = ip.m_scan_min_y; y < ip.m_scan_max_y; y += ip.m_scan_dy)
           {
-            // Concentrate computation on the most promising detections
-            double score = 0.0;
-            for (uint64_t l = 0; l <= m_levels && score >= 0.0; l ++)
-            {
-              const uint64_t lbegin = m_lmodel_begins[o][l];
-              const uint64_t lend = m_lmodel_ends[o][l];
-              score += m_model->score(o, lbegin, lend, x, y);
+            const double score = this->score(o, x, y);
 
-              // Update statistics
-              m_stats.m_evals += lend - lbegin;
+            // Threshold detection and map it to the original image size
+            if (score >= m_threshold)
+            {
+              detections.push_back(make_detection(
+                    score, 
+                    m_ipyramid.map(subwindow_t(x, y, is)), 
+                    o));
             }
 
+            // Update statistics
+            m_stats.m_sws ++;
+          }
+      }
+    }
+
+    // Update statistics
+    m_stats.m_gts += n_objects();
+    m_stats.m_timing += timer.elapsed();
+
+    // OK, cluster detections
+    cluster(detections, m_cluster, n_outputs());
+    return true;
+  }
+
+  // Score the sub-window at (x, y) of the current (preprocessed) scale
+  double CVDetector::score(uint64_t o, int x, int y) const
+  {
+    // Concentrate computation on the most promising detections
+    double score = 0.0;
+    for (uint64_t l = 0; l <= m_levels && score >= 0.0; l ++)
+    {
+      const uint64_t lbegin = m_lmodel_begins[o][l];
+      const uint64_t lend = m_lmodel_ends[o][l];
+      score += m_model->score(o, lbegin, lend, x, y);
+
+      // Update statistics
+      m_stats.m_evals += lend - lbegin;
+    }
+
+    return score;
+  }
+
+  // Scan the sub-windows around the <seeds> detections
+  void CVDetector::scan(const std::vector<detection_t>& seeds, std::vector<detection_t>& detections) const
+  {
+    detections.clear();
+
+    Timer timer;
+    std::vector<unsigned char> mask;
+    for (uint64_t is = 0; is < m_ipyramid.size(); is ++)
+    {
+      const ipscale_t& ip = m_ipyramid[is];
+      const int nx = (ip.m_scan_max_x - ip.m_scan_min_x + ip.m_scan_dx - 1) / ip.m_scan_dx;
+      const int ny = (ip.m_scan_max_y - ip.m_scan_min_y + ip.m_scan_dy - 1) / ip.m_scan_dy;
+      if (nx <= 0 || ny <= 0)
+      {
+        continue;
+      }
+
+      // Mark the sub-windows (on the scanning grid) centered nearby the seeds at similar scales
+      mask.assign(nx * ny, 0);
+      bool marked = false;
+      for (std::vector<detection_t>::const_iterator it = seeds.begin(); it != seeds.end(); ++ it)
+      {
+        const QRectF& reg = it->second.first;
+        const subwindow_t sw = m_ipyramid.map(reg, param());
+        if (std::abs((int)is - (int)sw.m_s) > (int)m_track_scales)
+        {
+          continue;
+        }
+
+        const double x = ip.m_scale * reg.center().x() - 0.5 * param().m_cols;
+        const double y = ip.m_scale * reg.center().y() - 0.5 * param().m_rows;
+        const double dx = ip.m_scale * m_track_margin * reg.width();
+        const double dy = ip.m_scale * m_track_margin * reg.height();
+
+        const int ix0 = range((int)std::ceil((x - dx - ip.m_scan_min_x) / ip.m_scan_dx), 0, nx);
+        const int ix1 = range((int)std::floor((x + dx - ip.m_scan_min_x) / ip.m_scan_dx) + 1, 0, nx);
+        const int iy0 = range((int)std::ceil((y - dy - ip.m_scan_min_y) / ip.m_scan_dy), 0, ny);
+        const int iy1 = range((int)std::floor((y + dy - ip.m_scan_min_y) / ip.m_scan_dy) + 1, 0, ny);
+        for (int ix = ix0; ix < ix1; ix ++)
+          for (int iy = iy0; iy < iy1; iy ++)
+          {
+            mask[ix * ny + iy] = 1;
+            marked = true;
+          }
+      }
+
+      if (marked == false)
+      {
+        continue;
+      }
+
+      // Scan the marked sub-windows
+      m_model->preprocess(ip);
+      for (uint64_t o = 0; o < n_outputs(); o ++)
+      {
+        for (int ix = 0; ix < nx; ix ++)
+          for (int iy = 0; iy < ny; iy ++) if (mask[ix * ny + iy] != 0)
+          {
+            const int x = ip.m_scan_min_x + ix * ip.m_scan_dx;
+            const int y = ip.m_scan_min_y + iy * ip.m_scan_dy;
+            const double score = this->score(o, x, y);
+
             // Threshold detection and map it to the original image size
             if (score >= m_threshold)
             {
@@ -290,7 +408,50 @@ namespace bob { namespace visioner {
 
     // OK, cluster detections
     cluster(detections, m_cluster, n_outputs());
-    return true;
+  }
+
+  // Detect objects in the next frame of a video
+  bool CVDetector::track(const uint8_t* image, uint64_t rows, uint64_t cols,
+      std::vector<detection_t>& detections)
+  {
+    Timer timer;
+    detections.clear();
+
+    const bool dense = 
+      m_track_period <= 1 || m_track_frame % m_track_period == 0 ||
+      m_type == GroundTruth;
+    m_track_frame ++;
+
+    bool ok = load(image, rows, cols);
+    if (ok == true)
+    {
+      if (dense == true)
+      {
+        ok = scan(detections);
+      }
+      else if (valid_model() == true)
+      {
+        scan(m_track_detections, detections);
+      }
+      else
+      {
+        ok = false;
+      }
+    }
+
+    m_track_detections = detections;
+
+    // Update statistics
+    m_stats.m_frames ++;
+    m_stats.m_frame_timing = timer.elapsed();
+    return ok;
+  }
+
+  // Restart the tracking
+  void CVDetector::reset_tracking()
+  {
+    m_track_frame = 0;
+    m_track_detections.clear();
   }
 
   // Match detections with ground truth locations
@@ -373,175 +534,399 @@ namespace bob { namespace visioner {
         detections.end());
   }
 
-  void CVDetector::cluster(std::vector<detection_t>& detections, double thres, uint64_t n_outputs)
+  // Uniform grid over the boxes of similar areas (the cell is as large as the largest box):
+  //	each cell stores the indices of the boxes intersecting it (in increasing order).
+  struct nms_grid_t
   {
-    if (thres >= 1.0)
+    double              m_x0, m_y0, m_cell;
+    int                 m_gw, m_gh;
+    std::vector<uint64_t>  m_cbegins;     // [begin, end) range in <m_cells> for each cell
+    std::vector<uint64_t>  m_cells;
+
+    // Cells covered by a box
+    void cells(const QRectF& reg, int& x0, int& x1, int& y0, int& y1) const
     {
-      // Clustering deactivated!
+      x0 = range((int)((reg.left() - m_x0) / m_cell), 0, m_gw - 1);
+      x1 = range((int)((reg.right() - m_x0) / m_cell), 0, m_gw - 1);
+      y0 = range((int)((reg.top() - m_y0) / m_cell), 0, m_gh - 1);
+      y1 = range((int)((reg.bottom() - m_y0) / m_cell), 0, m_gh - 1);
+    }
+
+    // Index the <boxes> of the given <ids>
+    void build(const std::vector<const QRectF*>& boxes, const std::vector<uint64_t>& ids)
+    {
+      double x1 = -std::numeric_limits<double>::max(), y1 = x1, size = 1.0;
+      m_x0 = m_y0 = std::numeric_limits<double>::max();
+      for (uint64_t k = 0; k < ids.size(); k ++)
+      {
+        const QRectF& reg = *boxes[ids[k]];
+        m_x0 = std::min(m_x0, reg.left()), x1 = std::max(x1, reg.right());
+        m_y0 = std::min(m_y0, reg.top()), y1 = std::max(y1, reg.bottom());
+        size = std::max(size, std::max(reg.width(), reg.height()));
+      }
+
+      // NB: at most ~#boxes cells
+      m_cell = std::max(size, std::sqrt((x1 - m_x0) * (y1 - m_y0) / ids.size()));
+      m_gw = (int)((x1 - m_x0) / m_cell) + 1;
+      m_gh = (int)((y1 - m_y0) / m_cell) + 1;
+
+      int cx0, cx1, cy0, cy1;
+      m_cbegins.assign(m_gw * m_gh + 1, 0);
+      for (uint64_t k = 0; k < ids.size(); k ++)
+      {
+        cells(*boxes[ids[k]], cx0, cx1, cy0, cy1);
+        for (int y = cy0; y <= cy1; y ++)
+          for (int x = cx0; x <= cx1; x ++)
+          {
+            m_cbegins[y * m_gw + x + 1] ++;
+          }
+      }
+      for (uint64_t c = 0; c + 1 < m_cbegins.size(); c ++)
+      {
+        m_cbegins[c + 1] += m_cbegins[c];
+      }
+
+      std::vector<uint64_t> cfills(m_cbegins.begin(), m_cbegins.end() - 1);
+      m_cells.resize(m_cbegins.back());
+      for (uint64_t k = 0; k < ids.size(); k ++)
+      {
+        cells(*boxes[ids[k]], cx0, cx1, cy0, cy1);
+        for (int y = cy0; y <= cy1; y ++)
+          for (int x = cx0; x <= cx1; x ++)
+          {
+            m_cells[cfills[y * m_gw + x] ++] = ids[k];
+          }
+      }
+    }
+  };
+
+  // Greedy non-maximum suppression of the detections <indices> (sorted by decreasing score):
+  //	keep a detection if it does not overlap any kept detection by <thres> or more.
+  // NB: For a positive threshold, two boxes overlap only if they intersect and if the ratio
+  //	of their areas is at least <thres>. The boxes are therefore indexed by octaves of
+  //	their area, each octave with a uniform grid, and only the boxes in the cells covered
+  //	by a kept detection (for the octaves of compatible areas) need to be checked.
+  static void nms(const std::vector<detection_t>& detections, const std::vector<uint64_t>& indices,
+      double thres, std::vector<uint64_t>& kept)
+  {
+    const uint64_t n = indices.size();
+    std::vector<unsigned char> removed(n, 0);
+
+    // Few detections (or every detection overlaps): compare all pairs
+    if (thres <= 0.0 || n < 64)
+    {
+      for (uint64_t i = 0; i < n; i ++) if (removed[i] == 0)
+      {
+        const QRectF& ref = detections[indices[i]].second.first;
+        kept.push_back(indices[i]);
+        for (uint64_t j = i + 1; j < n; j ++)
+        {
+          if (removed[j] == 0 && overlap(ref, detections[indices[j]].second.first) >= thres)
+          {
+            removed[j] = 1;
+          }
+        }
+      }
       return;
     }
 
-    sort_desc(detections);
+    // Index the boxes by octave of their area
+    std::vector<const QRectF*> boxes(n);
+    std::vector<int> octaves(n);
+    int min_octave = std::numeric_limits<int>::max(), max_octave = std::numeric_limits<int>::min();
+    for (uint64_t i = 0; i < n; i ++)
+    {
+      boxes[i] = &detections[indices[i]].second.first;
+      octaves[i] = (int)std::floor(std::log(std::max(area(*boxes[i]), 1.0)) / std::log(2.0));
+      min_octave = std::min(min_octave, octaves[i]);
+      max_octave = std::max(max_octave, octaves[i]);
+    }
 
-    // Check if the detection ...
-    std::vector<detection_t> result;
-    for (uint64_t o = 0; o < n_outputs; o ++)
+    std::vector<std::vector<uint64_t> > ids(max_octave - min_octave + 1);
+    for (uint64_t i = 0; i < n; i ++)
+    {
+      ids[octaves[i] - min_octave].push_back(i);
+    }
+
+    std::vector<nms_grid_t> grids(ids.size());
+    for (uint64_t o = 0; o < ids.size(); o ++)
     {
-      for (uint64_t iref = 0; iref < detections.size(); iref ++)
+      if (ids[o].empty() == false)
       {
-        const detection_t& ref = detections[iref];
-        if (    ref.second.first.left() > -0.5 && // ... is still valid!
-            ref.second.second == (int)o)
+        grids[o].build(boxes, ids[o]);
+      }
+    }
+
+    // Greedy suppression
+    const int doctave = (int)std::ceil(-std::log(thres) / std::log(2.0)) + 1;
+    std::vector<uint64_t> visited(n, n);
+    for (uint64_t i = 0; i < n; i ++) if (removed[i] == 0)
+    {
+      const QRectF& ref = *boxes[i];
+      kept.push_back(indices[i]);
+
+      const int obegin = std::max(octaves[i] - doctave, min_octave) - min_octave;
+      const int oend = std::min(octaves[i] + doctave, max_octave) - min_octave;
+      for (int o = obegin; o <= oend; o ++)
+      {
+        const nms_grid_t& grid = grids[o];
+        if (ids[o].empty() == true)
         {
-          result.push_back(ref);
+          continue;
+        }
 
-          // Then, remove the overlapping detections
-          for (uint64_t icrt = iref + 1; icrt < detections.size(); icrt ++)
+        int cx0, cx1, cy0, cy1;
+        grid.cells(ref, cx0, cx1, cy0, cy1);
+        for (int y = cy0; y <= cy1; y ++)
+          for (int x = cx0; x <= cx1; x ++)
           {
-            detection_t& crt = detections[icrt];
-            if (	crt.second.first.left() > -0.5 &&
-                crt.second.second == (int)o &&
-                overlap(ref.second.first, crt.second.first) >= thres)
+            const uint64_t c = y * grid.m_gw + x;
+            for (uint64_t k = grid.m_cbegins[c]; k < grid.m_cbegins[c + 1]; k ++)
             {
-              crt.second.first.setLeft(-1.0);
+              const uint64_t j = grid.m_cells[k];
+              if (j > i && removed[j] == 0 && visited[j] != i)
+              {
+                visited[j] = i;
+                if (overlap(ref, *boxes[j]) >= thres)
+                {
+                  removed[j] = 1;
+                }
+              }
             }
           }
+      }
+    }
+  }
+
+  void CVDetector::cluster(std::vector<detection_t>& detections, double thres, uint64_t n_outputs)
+  {
+    if (thres >= 1.0)
+    {
+      // Clustering deactivated!
+      return;
+    }
+
+    sort_desc(detections);
+
+    // Suppress the overlapping detections of each output independently
+    std::vector<uint64_t> indices, kept;
+    for (uint64_t o = 0; o < n_outputs; o ++)
+    {
+      indices.clear();
+      for (uint64_t id = 0; id < detections.size(); id ++)
+      {
+        if (detections[id].second.second == (int)o)
+        {
+          indices.push_back(id);
         }
       }
+
+      nms(detections, indices, thres, kept);
+    }
+
+    std::vector<detection_t> result(kept.size());
+    for (uint64_t i = 0; i < kept.size(); i ++)
+    {
+      result[i] = detections[kept[i]];
     }
 
     detections.swap(result);
   }
 
-  // Compute the ROC - the number of true positives and false alarms
-  //	for the <min_score + t * delta_score, t < n_thress> threshold values.
+  // Compute the ROC - the changes of the number of true positives and false alarms
+  //	for the (increasing) <thress> threshold values (the counts are their cumulated sums).
   void CVDetector::roc(
       const Matrix<int>& labels, const std::vector<detection_t>& detections,
-      double min_score, uint64_t n_thress, double delta_score,
-      std::vector<uint64_t>& n_tps, std::vector<uint64_t>& n_fas)
+      const std::vector<double>& thress,
+      std::vector<int64_t>& d_tps, std::vector<int64_t>& d_fas)
   {
-    if (	detections.empty() ||
+    if (	detections.empty() || thress.empty() ||
         labels.rows() != detections.size())
     {
       return;
     }
 
-    // Compute the FAs and TPs for various threshold values
-    double thres = min_score;
-    for (uint64_t t = 0, id = 0; t < n_thress; t ++, thres += delta_score)
+    // Count the false alarms and the true detections of the detections [id, end)
+    //	in a single pass over the labels: a detection is a false alarm if it does
+    //	not match any ground truth and a ground truth is detected until the threshold
+    //	passes its last (highest scored) matching detection.
+    const uint64_t n_detections = detections.size();
+    std::vector<int64_t> tps(n_detections + 1, 0), fas(n_detections + 1, 0);
+    for (uint64_t ig = 0; ig < labels.cols(); ig ++)
     {
-      // Find the first detection with the score just above this threshold
-      for ( ; id < detections.size() &&
-          detections[id].first <= thres; id ++)
+      for (uint64_t cid = n_detections; cid > 0; cid --)
       {
-      }
-
-      // Update the number of false alarms and true detections
-      //	for the thresholded detections
-      uint64_t tps = 0, fas = 0;
-
-      for (uint64_t cid = id; cid < labels.rows(); cid ++)
-      {
-        fas ++;
-        for (uint64_t ig = 0; ig < labels.cols(); ig ++)
+        if (labels(cid - 1, ig))
         {
-          if (labels(cid, ig))
-          {
-            fas --;
-            break;
-          }
+          tps[cid - 1] ++;
+          break;
         }
       }
-
+    }
+    for (uint64_t cid = n_detections; cid > 0; cid --)
+    {
+      fas[cid - 1] = fas[cid] + 1;
       for (uint64_t ig = 0; ig < labels.cols(); ig ++)
       {
-        for (uint64_t cid = id; cid < labels.rows(); cid ++)
+        if (labels(cid - 1, ig))
         {
-          if (labels(cid, ig))
-          {
-            tps ++;
-            break;
-          }
+          fas[cid - 1] --;
+          break;
         }
       }
+      tps[cid - 1] += tps[cid];
+    }
+
+    // Sweep the (sorted) detections: the ones with the same score are removed
+    //	together at the first threshold value not below it
+    d_tps[0] += tps[0];
+    d_fas[0] += fas[0];
+    for (uint64_t id = 0, next; id < n_detections; id = next)
+    {
+      for (next = id + 1; next < n_detections && 
+          detections[next].first == detections[id].first; next ++)
+      {
+      }
 
-      n_fas[t] += fas;
-      n_tps[t] += tps;
+      const uint64_t t = std::lower_bound(thress.begin(), thress.end(), 
+          detections[id].first) - thress.begin();
+      if (t < thress.size())
+      {
+        d_tps[t] += tps[next] - tps[id];
+        d_fas[t] += fas[next] - fas[id];
+      }
     }
   }
 
-  // Compute the ROC - the number of true positives and false alarms
-  void CVDetector::evaluate(const std::vector<std::string>& ifiles, 
-      const std::vector<std::string>& gfiles, std::vector<double>& fas, 
-      std::vector<double>& tars) {
+  // Serialize the progress messages of the worker threads
+  static boost::mutex evaluate_mutex;
 
-    // 1st pass: process each image to assess the minimum/maximum score ...
-    double min_score = std::numeric_limits<double>::max();
-    double max_score = -std::numeric_limits<double>::max();
+  // Scan the <i>-th image with the <ith> worker detector and label its detections
+  static void th_evaluate(uint64_t ith, uint64_t i,
+      const std::vector<std::string>& ifiles, const std::vector<std::string>& gfiles,
+      const std::vector<boost::shared_ptr<CVDetector> >& detectors,
+      std::vector<std::vector<detection_t> >& idetections,
+      std::vector<Matrix<int> >& ilabels)
+  {
+    CVDetector& detector = *detectors[ith];
 
-    std::vector<std::vector<detection_t> > idetections;
-    std::vector<Matrix<int> > ilabels;
+    const std::string& ifile = ifiles[i];
+    const std::string& gfile = gfiles[i];
 
-    std::vector<detection_t> detections;
+    // Load the image and the ground truth
+    if (detector.load(ifile, gfile) == false) {
+      boost::mutex::scoped_lock lock(evaluate_mutex);
+      bob::core::warn << "Failed to load image <" << ifile << "> or ground truth <" << gfile << ">!" << std::endl;
+      return;
+    }
 
-    for (uint64_t i = 0; i < ifiles.size(); i ++) {
+    // Scan the image ...
+    Timer timer;
 
-      const std::string& ifile = ifiles[i];
-      const std::string& gfile = gfiles[i];
+    std::vector<detection_t>& detections = idetections[i];
+    detector.scan(detections);
+    CVDetector::sort_asc(detections);
 
-      // Load the image and the ground truth
-      if (load(ifile, gfile) == false) {
-        bob::core::warn << "Failed to load image <" << ifile << "> or ground truth <" << gfile << ">!" << std::endl;
-        continue;
+    // Save labels
+    detector.label(detections, ilabels[i]); 
+
+    // Debug
+    boost::mutex::scoped_lock lock(evaluate_mutex);
+    bob::core::info << "Image [" << (i + 1) << "/" << ifiles.size() 
+      << "]: produced " << detections.size() << " detections / "
+      << detector.n_objects() << " GTs in " << timer.elapsed() << "s." << std::endl;
+  }
+
+  // Choose the threshold values of the ROC: either <n_thress> values evenly spaced
+  //	between the minimum and the maximum score, or (if 0) all the distinct scores
+  void CVDetector::roc_thresholds(
+      const std::vector<std::vector<detection_t> >& idetections,
+      uint64_t n_thress, std::vector<double>& thress) {
+
+    thress.clear();
+    if (n_thress > 0) {
+      double min_score = std::numeric_limits<double>::max();
+      double max_score = -std::numeric_limits<double>::max();
+
+      for (uint64_t i = 0; i < idetections.size(); i ++) {
+        const std::vector<detection_t>& detections = idetections[i];
+        if (detections.empty() == false) {
+          min_score = std::min(min_score, detections.begin()->first);
+          max_score = std::max(max_score, detections.rbegin()->first);
+        }
       }
 
-      // Scan the image ...
-      Timer timer;
+      const double delta_score = inverse(n_thress - 1) * (max_score - min_score);
 
-      scan(detections);
+      bob::core::info << "min_score = " << min_score << ", max_score = " 
+        << max_score << ", delta_score = " << delta_score << std::endl;
 
-      // Update the score extremes
-      sort_asc(detections);
-      if (detections.empty() == false) {
-        min_score = std::min(min_score, detections.begin()->first);
-        max_score = std::max(max_score, detections.rbegin()->first);
+      double thres = min_score;
+      for (uint64_t t = 0; t < n_thress; t ++, thres += delta_score) {
+        thress.push_back(thres);
       }
+    }
+    else {
+      for (uint64_t i = 0; i < idetections.size(); i ++) {
+        const std::vector<detection_t>& detections = idetections[i];
+        for (uint64_t id = 0; id < detections.size(); id ++) {
+          thress.push_back(detections[id].first);
+        }
+      }
+      unique(thress);
+      thress.insert(thress.begin(), -std::numeric_limits<double>::max());
 
-      // Save detections and labels
-      Matrix<int> labels;
-      label(detections, labels); 
+      bob::core::info << "ROC sampled at " << thress.size() << " threshold values" << std::endl;
+    }
+  }
 
-      idetections.push_back(detections);		
-      ilabels.push_back(labels);                
+  // Compute the ROC - the number of true positives and false alarms
+  void CVDetector::evaluate(const std::vector<std::string>& ifiles, 
+      const std::vector<std::string>& gfiles, std::vector<double>& fas, 
+      std::vector<double>& tars, size_t threads, uint64_t n_thress) {
 
-      // Debug
-      bob::core::info << "Image [" << (i + 1) << "/" << ifiles.size() 
-        << "]: produced " << detections.size() << " detections / "
-        << n_objects() << " GTs in " << timer.elapsed() << "s." << std::endl;
+    // 1st pass: process each image (in parallel, each worker with its own
+    // copy of the model) to collect the labeled detections ...
+    std::vector<boost::shared_ptr<CVDetector> > detectors(std::max(threads, (size_t)1));
+    for (uint64_t ith = 0; ith < detectors.size(); ith ++) {
+      detectors[ith] = clone();
     }
 
-    const uint64_t n_thress = 256;
-    const double delta_score = inverse(n_thress - 1) * (max_score - min_score);
+    std::vector<std::vector<detection_t> > idetections(ifiles.size());
+    std::vector<Matrix<int> > ilabels(ifiles.size());
+
+    thread_queue(
+        boost::bind(&th_evaluate, boost::lambda::_1, boost::lambda::_2,
+          boost::cref(ifiles), boost::cref(gfiles), boost::cref(detectors),
+          boost::ref(idetections), boost::ref(ilabels)),
+        ifiles.size(), threads);
 
-    bob::core::info << "min_score = " << min_score << ", max_score = " 
-      << max_score << ", delta_score = " << delta_score << std::endl;
+    for (uint64_t ith = 0; ith < detectors.size(); ith ++) {
+      m_stats.add(detectors[ith]->stats());
+    }
+
+    // ... and choose the threshold values
+    std::vector<double> thress;
+    roc_thresholds(idetections, n_thress, thress);
 
-    std::vector<uint64_t> n_tps(n_thress, 0);	// #true positives
-    std::vector<uint64_t> n_fas(n_thress, 0);	// #false alarms			
+    std::vector<int64_t> d_tps(thress.size(), 0);	// #true positives (changes)
+    std::vector<int64_t> d_fas(thress.size(), 0);	// #false alarms (changes)
 
     // 2nd pass: use the detections and the ground truth locations to compute
     // the ROC curve ...
     for (uint64_t i = 0; i < ifiles.size(); i ++) {
       const std::vector<detection_t>& detections = idetections[i];
       const Matrix<int>& labels = ilabels[i];
-      roc(labels, detections, min_score, n_thress, delta_score, n_tps, n_fas);
+      roc(labels, detections, thress, d_tps, d_fas);
     }
 
     // Build the ROC curve		
-    fas.resize(n_thress), tars.resize(n_thress);
-    for (uint64_t t = 0; t < n_thress; t ++) {
-      fas[t] = n_fas[t];
-      tars[t] = inverse(stats().m_gts) * n_tps[t];
+    fas.resize(thress.size()), tars.resize(thress.size());
+    for (int64_t t = 0, n_tps = 0, n_fas = 0; t < (int64_t)thress.size(); t ++) {
+      n_tps += d_tps[t];
+      n_fas += d_fas[t];
+      fas[t] = n_fas;
+      tars[t] = inverse(stats().m_gts) * n_tps;
     }
     roc_order(fas, tars);
     roc_trim(fas, tars);    
@@ -556,6 +941,10 @@ namespace bob { namespace visioner {
       << m_sws << " SWs with " << (inverse(m_sws) * m_evals) 
       << " LUT evaluations done in " << (inverse(m_sws) * m_timing) 
       << " seconds on average." << std::endl;
+    if (m_frames > 0) {
+      bob::core::info << "Tracked " << m_frames << " video frames, the last one in "
+        << m_frame_timing << " seconds." << std::endl;
+    }
   }
 
   // Save the model back to file
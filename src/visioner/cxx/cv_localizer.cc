@@ -10,6 +10,8 @@
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
 
+#include <boost/bind.hpp>
+#include <boost/lambda/lambda.hpp>
 #include <boost/format.hpp>
 
 #include "bob/core/logging.h"
@@ -17,11 +19,13 @@
 #include "bob/visioner/cv/cv_localizer.h"
 #include "bob/visioner/model/mdecoder.h"
 #include "bob/visioner/util/timer.h"
+#include "bob/visioner/util/threads.h"
 
 namespace bob { namespace visioner {
 
   CVLocalizer::CVLocalizer()
-    :	m_type(MultipleShots_Median)
+    :	m_type(MultipleShots_Median),
+    m_threads(0)
   {
   }
 
@@ -96,7 +100,7 @@ namespace bob { namespace visioner {
   }
 
   CVLocalizer::CVLocalizer(const std::string& model, Type method):
-    m_type(method) {
+    m_type(method), m_threads(0) {
 
     // Load the localization model
     if (Model::load(model, m_model) == false) {
@@ -122,8 +126,139 @@ namespace bob { namespace visioner {
       m_model->n_outputs() == 2 * param().m_labels.size();
   }
 
+  // Clone the localizer with its own copy of the model
+  boost::shared_ptr<CVLocalizer> CVLocalizer::clone() const
+  {
+    boost::shared_ptr<CVLocalizer> localizer(new CVLocalizer(*this));
+    localizer->m_model = m_model->clone();
+    return localizer;
+  }
+
   // Predict the location of the keypoints in the <reg> region.
   bool CVLocalizer::locate(const CVDetector& detector, const QRectF& reg, std::vector<QPointF>& dt_points) const
+  {
+    std::vector<detection_t> detections(1, make_detection(0.0, reg, 0));
+    std::vector<std::vector<QPointF> > points;
+    if (locate(detector, detections, points) == 0)
+    {
+      return false;
+    }
+
+    // OK
+    dt_points.insert(dt_points.end(), points[0].begin(), points[0].end());
+    return true;
+  }
+
+  // Predict the location of the keypoints for all the <detections> at once
+  uint64_t CVLocalizer::locate(const CVDetector& detector, 
+      const std::vector<detection_t>& detections, 
+      std::vector<std::vector<QPointF> >& dt_points) const
+  {
+    dt_points.clear();
+    dt_points.resize(detections.size());
+
+    // Collect the sub-windows to evaluate for all regions, grouped by scale, so that
+    //	each scale is preprocessed once for all the detections in the image
+    std::vector<std::vector<sw_task_t> > stasks(detector.ipyramid().size());
+    std::vector<bool> valid(detections.size(), false);
+    for (uint64_t r = 0; r < detections.size(); r ++)
+    {
+      valid[r] = neighbours(detector, r, detections[r].second.first, stasks);
+    }
+
+    // Split the sub-windows of each scale in (at most) one chunk per worker
+    const uint64_t n_workers = std::max(m_threads, (size_t)1);
+
+    std::vector<sw_task_t> tasks;
+    std::vector<std::pair<uint64_t, uint64_t> > chunks;
+    for (uint64_t s = 0; s < stasks.size(); s ++)
+    {
+      const std::vector<sw_task_t>& sws = stasks[s];
+      if (sws.empty() == true)
+      {
+        continue;
+      }
+
+      std::vector<uint64_t> th_begins, th_ends;
+      thread_split(sws.size(), th_begins, th_ends, std::min(n_workers, (uint64_t)sws.size()));
+      for (uint64_t k = 0; k < th_begins.size(); k ++) if (th_begins[k] < th_ends[k])
+      {
+        chunks.push_back(std::make_pair(tasks.size() + th_begins[k], tasks.size() + th_ends[k]));
+      }
+
+      tasks.insert(tasks.end(), sws.begin(), sws.end());
+    }
+
+    // Each worker uses its own copy of the model (<m_model> is left untouched,
+    //	so that concurrent calls do not preprocess the same model)
+    std::vector<boost::shared_ptr<Model> > wmodels(n_workers);
+    for (uint64_t ith = 0; ith < n_workers; ith ++)
+    {
+      wmodels[ith] = m_model->clone();
+    }
+
+    // Predict the keypoints on each sub-window (not projected)
+    std::vector<const ipscale_t*> wscales(n_workers, (const ipscale_t*)0);
+    std::vector<QPointF> preds(tasks.size() * n_points());
+    thread_queue(
+        boost::bind(&CVLocalizer::locate_chunk, this, 
+          boost::lambda::_1, boost::lambda::_2,
+          boost::cref(detector), boost::cref(tasks), boost::cref(chunks), 
+          boost::cref(wmodels), boost::ref(wscales), boost::ref(preds)),
+        chunks.size(), m_threads);
+
+    // Gather the predictions of each region (in the order of the sub-windows) ...
+    std::vector<std::vector<std::vector<QPointF> > > rpreds(detections.size(), 
+        std::vector<std::vector<QPointF> >(n_points()));
+    for (uint64_t t = 0; t < tasks.size(); t ++)
+    {
+      std::vector<std::vector<QPointF> >& rpred = rpreds[tasks[t].first];
+      for (uint64_t i = 0; i < n_points(); i ++)
+      {
+        rpred[i].push_back(preds[t * n_points() + i]);
+      }
+    }
+
+    // ... and process them: average or median (if required)
+    uint64_t n_located = 0;
+    for (uint64_t r = 0; r < detections.size(); r ++)
+    {
+      if (valid[r] == false)
+      {
+        continue;
+      }
+
+      const std::vector<std::vector<QPointF> >& rpred = rpreds[r];
+      std::vector<QPointF>& pred = dt_points[r];
+      switch (m_type)
+      {
+        case SingleShot:
+          for (uint64_t i = 0; i < n_points(); i ++)
+          {
+            pred.push_back(rpred[i][0]);
+          }
+          break;
+
+        case MultipleShots_Average:
+          avg(rpred, pred);
+          break;
+
+        case MultipleShots_Median:
+        default:
+          med(rpred, pred);
+          break;
+      }
+
+      n_located ++;
+    }
+
+    // OK
+    return n_located;
+  }
+
+  // Collect the sub-windows to evaluate for the <r>-th region <reg>
+  bool CVLocalizer::neighbours(const CVDetector& detector, uint64_t r, const QRectF& reg,
+      std::vector<std::vector<sw_task_t> >& stasks) const
   {
     // Check the sub-window
     const subwindow_t sw = detector.ipyramid().map(reg, param());
@@ -132,83 +267,67 @@ namespace bob { namespace visioner {
       return false;
     }
 
-    // Collect predictions (not projected)
-    std::vector<std::vector<QPointF> > preds(n_points());
+    // Collect predictions from the neighbourhood (if required)
+    std::vector<std::vector<subwindow_t> > ssws;
     switch (m_type)
     {
       case SingleShot:
-        locate(detector, sw, 0, 0, 0, 0, 0, preds);
+        ssws = detector.ipyramid().neighbours(sw, 0, 0, 0, 0, 0, param());
         break;
 
       case MultipleShots_Average:
       case MultipleShots_Median:			
       default:
-        locate(detector, sw, 
+        ssws = detector.ipyramid().neighbours(sw, 
             1, 4, std::max((int)1, (int)(0.5 + 0.02 * param().m_cols)), 
-            4, std::max((int)1, (int)(0.5 + 0.02 * param().m_rows)), preds);
+            4, std::max((int)1, (int)(0.5 + 0.02 * param().m_rows)), param());
         break;
     }
 
-    // Process the predictions: average or median (if required)
-    std::vector<QPointF> pred;                
-    switch (m_type)
+    for (uint64_t ss = 0; ss < ssws.size(); ss ++)
     {
-      case SingleShot:
-        for (uint64_t i = 0; i < n_points(); i ++)
-        {
-          pred.push_back(preds[i][0]);
-        }
-        break;
-
-      case MultipleShots_Average:
-        avg(preds, pred);
-        break;
-
-      case MultipleShots_Median:
-      default:
-        med(preds, pred);
-        break;
+      const std::vector<subwindow_t>& sws = ssws[ss];
+      for (uint64_t s = 0; s < sws.size(); s ++)
+      {
+        stasks[sws[s].m_s].push_back(std::make_pair(r, sws[s]));
+      }
     }
 
-    // OK
-    dt_points.insert(dt_points.end(), pred.begin(), pred.end());
     return true;
   }
 
-  // Collect predictions from the neighbourhood of <seed_sw>
-  void CVLocalizer::locate(
-      const CVDetector& detector, const subwindow_t& seed_sw, 
-      int n_ds, int n_dx, int dx, int n_dy, int dy, std::vector<std::vector<QPointF> >& preds) const
-  {       
-    std::vector<std::vector<subwindow_t> > ssws = detector.ipyramid().neighbours(
-        seed_sw, n_ds, n_dx, dx, n_dy, dy, param());
+  // Predict the keypoints for the <chunk>-th range of sub-windows
+  void CVLocalizer::locate_chunk(uint64_t ith, uint64_t chunk, const CVDetector& detector,
+      const std::vector<sw_task_t>& tasks,
+      const std::vector<std::pair<uint64_t, uint64_t> >& chunks,
+      const std::vector<boost::shared_ptr<Model> >& wmodels,
+      std::vector<const ipscale_t*>& wscales,
+      std::vector<QPointF>& preds) const
+  {
+    const uint64_t begin = chunks[chunk].first, end = chunks[chunk].second;
+    Model& model = *wmodels[ith];
 
-    // Process each scale ...
-    for (uint64_t ss = 0; ss < ssws.size(); ss ++)
+    // Preprocess the scale (if not already done by this worker)
+    const ipscale_t& ip = detector.ipyramid()[tasks[begin].second.m_s];
+    if (wscales[ith] != &ip)
     {
-      const std::vector<subwindow_t>& sws = ssws[ss];
-      if (sws.empty() == true)
-      {
-        continue;
-      }
+      model.preprocess(ip);
+      wscales[ith] = &ip;
+    }
 
-      const ipscale_t& ip = detector.ipyramid()[sws[0].m_s];                                                
-      m_model->preprocess(ip);
+    // Process each sub-window at this scale ...
+    const double inv_scale = ip.m_inv_scale;                          
+    for (uint64_t t = begin; t < end; t ++)
+    {
+      const subwindow_t& sw = tasks[t].second;
 
-      // Process each sub-window at this scale ...
-      const double inv_scale = ip.m_inv_scale;                          
-      for (uint64_t s = 0; s < sws.size(); s ++)
+      for (uint64_t i = 0; i < n_points(); i ++)
       {
-        const subwindow_t& sw = sws[s];
+        const double x = model.score(2 * i + 0, sw.m_x, sw.m_y) * param().m_cols;
+        const double y = model.score(2 * i + 1, sw.m_x, sw.m_y) * param().m_rows;
 
-        for (uint64_t i = 0; i < n_points(); i ++)
-        {
-          const double x = m_model->score(2 * i + 0, sw.m_x, sw.m_y) * param().m_cols;
-          const double y = m_model->score(2 * i + 1, sw.m_x, sw.m_y) * param().m_rows;
-
-          preds[i].push_back(QPointF(inv_scale * (sw.m_x + x), 
-                inv_scale * (sw.m_y + y)));
-        }
+        preds[t * n_points() + i] = QPointF(inv_scale * (sw.m_x + x), 
+            inv_scale * (sw.m_y + y));
       }
     }
   }
@@ -251,53 +370,106 @@ namespace bob { namespace visioner {
     pt = QPointF(xs[xs.size() / 2], ys[ys.size() / 2]);
   }
 
-  // Compute the normalized distances [0.0 - 1.0] between
-  //	each ground truth keypoints and its predicted points.
-  void CVLocalizer::evaluate(  
+  // Ground truth object and its predicted keypoints
+  typedef std::pair<Object, std::vector<QPointF> > localization_t;
+
+  // Serialize the progress messages of the worker threads
+  static boost::mutex evaluate_mutex;
+
+  // Locate the keypoints on the <i>-th image with the <ith> worker detector and localizer
+  static void th_evaluate(uint64_t ith, uint64_t i,
       const std::vector<std::string>& ifiles, const std::vector<std::string>& gfiles,
-      CVDetector& detector,
-      std::vector<Histogram>& histos, Histogram& histo) const
+      const std::vector<boost::shared_ptr<CVDetector> >& detectors,
+      const std::vector<boost::shared_ptr<CVLocalizer> >& localizers,
+      std::vector<std::vector<localization_t> >& ilocalizations)
   {
-    histo = Histogram(100, 0.0, 1.0);
-    histos = std::vector<Histogram>(n_points(), histo);                
+    CVDetector& detector = *detectors[ith];
+    const CVLocalizer& localizer = *localizers[ith];
 
-    // Process each image ...
-    for (uint64_t i = 0; i < ifiles.size(); i ++)
+    const std::string& ifile = ifiles[i];
+    const std::string& gfile = gfiles[i];
+
+    // Load the image and the ground truth
+    if (detector.load(ifile, gfile) == false)
     {
-      const std::string& ifile = ifiles[i];
-      const std::string& gfile = gfiles[i];
+      boost::mutex::scoped_lock lock(evaluate_mutex);
+      bob::core::warn << "Failed to load image <" << ifile << "> or ground truth <" << gfile << ">!" << std::endl;
+      return;
+    }
 
-      // Load the image and the ground truth
-      if (detector.load(ifile, gfile) == false)
+    // Locate keypoints (on the detections that did not fail)
+    Timer timer;				
+
+    std::vector<detection_t> detections;
+    detector.scan(detections);
+
+    std::vector<detection_t> mdetections;
+    std::vector<Object> objects;
+    Object object;
+    for (std::vector<detection_t>::const_iterator it = detections.begin(); it != detections.end(); ++ it)
+      if (detector.match(*it, object) == true)
+      {
+        mdetections.push_back(*it);
+        objects.push_back(object);
+      }
+
+    std::vector<std::vector<QPointF> > dt_points;
+    localizer.locate(detector, mdetections, dt_points);
+    for (uint64_t k = 0; k < mdetections.size(); k ++)
+    {
+      if (dt_points[k].empty() == true)
       {
-        bob::core::warn << "Failed to load image <" << ifile << "> or ground truth <" << gfile << ">!" << std::endl;
+        boost::mutex::scoped_lock lock(evaluate_mutex);
+        bob::core::warn << "Failed to localize the keypoints for the <" << ifile << "> image!" << std::endl;
         continue;
       }
 
-      // Locate keypoints (on the detections that did not fail)
-      Timer timer;				
+      ilocalizations[i].push_back(std::make_pair(objects[k], dt_points[k]));
+    }
 
-      std::vector<detection_t> detections;
-      detector.scan(detections);
+    boost::mutex::scoped_lock lock(evaluate_mutex);
+    bob::core::info
+      << "Image [" << (i + 1) << "/" << ifiles.size() 
+      << "]: localized in " << timer.elapsed() << "s." << std::endl;
+  }
 
-      Object object;
-      for (std::vector<detection_t>::const_iterator it = detections.begin(); it != detections.end(); ++ it)
-        if (detector.match(*it, object) == true)
-        {
-          std::vector<QPointF> dt_points;
-          if (locate(detector, it->second.first, dt_points) == false)
-          {
-            bob::core::warn << "Failed to localize the keypoints for the <" << ifile << "> image!" << std::endl;
-            continue;
-          }
+  // Compute the normalized distances [0.0 - 1.0] between
+  //	each ground truth keypoints and its predicted points.
+  void CVLocalizer::evaluate(  
+      const std::vector<std::string>& ifiles, const std::vector<std::string>& gfiles,
+      CVDetector& detector,
+      std::vector<Histogram>& histos, Histogram& histo, size_t threads) const
+  {
+    histo = Histogram(100, 0.0, 1.0);
+    histos = std::vector<Histogram>(n_points(), histo);                
 
-          evaluate(object, dt_points, histos, histo);
-        }
+    // Process each image (in parallel, each worker with its own copy of the models
+    //  and localizing the keypoints in its own thread) ...
+    std::vector<boost::shared_ptr<CVDetector> > detectors(std::max(threads, (size_t)1));
+    std::vector<boost::shared_ptr<CVLocalizer> > localizers(detectors.size());
+    for (uint64_t ith = 0; ith < detectors.size(); ith ++)
+    {
+      detectors[ith] = detector.clone();
+      localizers[ith] = clone();
+      localizers[ith]->m_threads = 0;
+    }
 
-      bob::core::info
-        << "Image [" << (i + 1) << "/" << ifiles.size() 
-        << "]: localized in " << timer.elapsed() << "s." << std::endl;
-    }                
+    std::vector<std::vector<localization_t> > ilocalizations(ifiles.size());
+    thread_queue(
+        boost::bind(&th_evaluate, boost::lambda::_1, boost::lambda::_2,
+          boost::cref(ifiles), boost::cref(gfiles), boost::cref(detectors),
+          boost::cref(localizers), boost::ref(ilocalizations)),
+        ifiles.size(), threads);
+
+    // ... and accumulate the errors in the order of the images
+    for (uint64_t i = 0; i < ifiles.size(); i ++)
+    {
+      const std::vector<localization_t>& localizations = ilocalizations[i];
+      for (uint64_t k = 0; k < localizations.size(); k ++)
+      {
+        evaluate(localizations[k].first, localizations[k].second, histos, histo);
+      }
+    }
   }
 
   // Compute the normalized distances [0.0 - 1.0] between
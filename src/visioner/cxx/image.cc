@@ -10,6 +10,9 @@
  * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "bob/visioner/vision/image.h"
 #include "bob/visioner/util/util.h"
 
@@ -28,15 +31,143 @@ namespace bob { namespace visioner {
       load(qimage, grays);
   }
 
+  // Size of the image scaled to a specific <scale> of a <rows> x <cols> image
+  //  (same rounding and aspect ratio policy as QImage::scaled with Qt::KeepAspectRatio)
+  void scaled_size(uint64_t rows, uint64_t cols, double scale,
+      uint64_t& new_rows, uint64_t& new_cols)
+  {
+    scale = range(scale, 0.01, 1.00);
+    const int64_t w = (int64_t)(0.5 + scale * cols);
+    const int64_t h = (int64_t)(0.5 + scale * rows);
+
+    new_rows = h, new_cols = w;
+    if (rows > 0 && cols > 0)
+    {
+      const int64_t rw = h * (int64_t)cols / (int64_t)rows;
+      if (rw <= w)
+      {
+        new_cols = rw;
+      }
+      else
+      {
+        new_rows = w * (int64_t)rows / (int64_t)cols;
+      }
+    }
+
+    new_rows = std::max(new_rows, (uint64_t)1);
+    new_cols = std::max(new_cols, (uint64_t)1);
+  }
+
+  // Area-averaging coefficients to resample <n_src> samples to <n_dst> (<= <n_src>) samples:
+  //  the output sample <o> is the weighted sum of the <n_src> input samples starting at <begins[o]>
+  //  with the weights <weights[o * stride ...]>.
+  static uint64_t area_coeffs(uint64_t n_src, uint64_t n_dst,
+      std::vector<uint64_t>& begins, std::vector<uint64_t>& counts, std::vector<float>& weights)
+  {
+    const double ratio = (double)n_src / (double)n_dst;
+    const double inv_ratio = 1.0 / ratio;
+    const uint64_t stride = (uint64_t)std::ceil(ratio) + 1;
+
+    begins.resize(n_dst);
+    counts.resize(n_dst);
+    weights.assign(n_dst * stride, 0.0f);
+
+    for (uint64_t o = 0; o < n_dst; o ++)
+    {
+      const double lo = o * ratio, hi = std::min((o + 1) * ratio, (double)n_src);
+      const uint64_t ibegin = (uint64_t)lo;
+      const uint64_t iend = std::min((uint64_t)std::ceil(hi), n_src);
+
+      begins[o] = ibegin;
+      counts[o] = iend - ibegin;
+      for (uint64_t i = ibegin; i < iend; i ++)
+      {
+        const double overlap = std::min((double)(i + 1), hi) - std::max((double)i, lo);
+        weights[o * stride + i - ibegin] = (float)(overlap * inv_ratio);
+      }
+    }
+
+    return stride;
+  }
+
+  // Resample the <src> image to <rows> x <cols> (at most the size of <src>) by area averaging
+  void resample(const Matrix<uint8_t>& src, uint64_t rows, uint64_t cols,
+      Matrix<uint8_t>& dst, Matrix<float>& buffer)
+  {
+    const uint64_t src_rows = src.rows(), src_cols = src.cols();
+
+    rows = std::min(std::max(rows, (uint64_t)1), src_rows);
+    cols = std::min(std::max(cols, (uint64_t)1), src_cols);
+    dst.resize(rows, cols);
+
+    if (rows == src_rows && cols == src_cols)
+    {
+      std::copy(src.begin(), src.end(), dst.begin());
+      return;
+    }
+
+    std::vector<uint64_t> xbegins, xcounts, ybegins, ycounts;
+    std::vector<float> xweights, yweights;
+    const uint64_t xstride = area_coeffs(src_cols, cols, xbegins, xcounts, xweights);
+    const uint64_t ystride = area_coeffs(src_rows, rows, ybegins, ycounts, yweights);
+
+    // Horizontal pass: each source row is reduced to <cols> samples ...
+    buffer.resize(src_rows, cols);
+    for (uint64_t y = 0; y < src_rows; y ++)
+    {
+      const uint8_t* srow = src[y];
+      float* brow = buffer[y];
+      for (uint64_t x = 0; x < cols; x ++)
+      {
+        const uint8_t* sp = srow + xbegins[x];
+        const float* wp = &xweights[x * xstride];
+        float sum = 0.0f;
+        for (uint64_t k = 0; k < xcounts[x]; k ++)
+        {
+          sum += wp[k] * sp[k];
+        }
+        brow[x] = sum;
+      }
+    }
+
+    // ... and the vertical pass accumulates the reduced rows
+    std::vector<float> acc(cols);
+    for (uint64_t y = 0; y < rows; y ++)
+    {
+      std::fill(acc.begin(), acc.end(), 0.0f);
+      const float* wp = &yweights[y * ystride];
+      for (uint64_t k = 0; k < ycounts[y]; k ++)
+      {
+        const float w = wp[k];
+        const float* brow = buffer[ybegins[y] + k];
+        for (uint64_t x = 0; x < cols; x ++)
+        {
+          acc[x] += w * brow[x];
+        }
+      }
+
+      uint8_t* drow = dst[y];
+      for (uint64_t x = 0; x < cols; x ++)
+      {
+        drow[x] = (uint8_t)range((int)(0.5f + acc[x]), 0, 255);
+      }
+    }
+  }
+
   // Scale the image to a specific <scale> of the <src> source image
   bool scale(const Matrix<uint8_t>& src, double scale, Matrix<uint8_t>& dst)
   {
-    scale = range(scale, 0.01, 1.00);
-    const int new_w = (int)(0.5 + scale * src.cols());
-    const int new_h = (int)(0.5 + scale * src.rows());
+    if (src.empty())
+    {
+      return false;
+    }
+
+    uint64_t new_rows, new_cols;
+    scaled_size(src.rows(), src.cols(), scale, new_rows, new_cols);
 
-    QImage qimage = convert(src);
-    return load(qimage.scaled(new_w, new_h, Qt::KeepAspectRatio, Qt::SmoothTransformation), dst);
+    Matrix<float> buffer;
+    resample(src, new_rows, new_cols, dst, buffer);
+    return true;
   }
 
   // Convert from <Matrix<uint8_t>> to <QImage>
@@ -66,6 +66,13 @@ namespace bob { namespace visioner {
     return std::max((uint64_t)1, (uint64_t)(0.5 + scale * dy0));
   }
 
+  // Check if a scaled image of the given size has no sub-window to scan
+  static bool scan_empty(uint64_t rows, uint64_t cols, const param_t& param)
+  {
+    return  param.min_col(rows, cols) >= param.max_col(rows, cols) ||
+      param.min_row(rows, cols) >= param.max_row(rows, cols);
+  }
+
   // Update the internals of a scaled image
   static void update_ipscale(ipscale_t& ipscale, const param_t& param)
   {
@@ -82,17 +89,23 @@ namespace bob { namespace visioner {
     ipscale.m_scan_o_h = (uint64_t)(0.5 + inverse(ipscale.m_scale) * param.m_rows);
   }
 
+  // Scale the ground truth of an image
+  static void scale_objects(const std::vector<Object>& src, double sfactor, std::vector<Object>& dst)
+  {
+    dst = src;
+    for (std::vector<Object>::iterator it = dst.begin(); it != dst.end(); ++ it)
+    {
+      it->scale(sfactor);
+    }
+  }
+
   // Scale an image and its ground truth
   void ipscale_t::scale(double sfactor, ipscale_t& dst) const
   {
     dst.m_scale = range(sfactor, 0.0, 1.0);
     dst.m_inv_scale = inverse(dst.m_scale);		
 
-    dst.m_objects = m_objects;
-    for (std::vector<Object>::iterator it = dst.m_objects.begin(); it != dst.m_objects.end(); ++ it)
-    {
-      it->scale(dst.m_scale);
-    }
+    scale_objects(m_objects, dst.m_scale, dst.m_objects);
 
     visioner::scale(m_image, dst.m_scale, dst.m_image);
   }
@@ -109,49 +122,83 @@ namespace bob { namespace visioner {
     m_param = param;
   }
 
+  // Build the scaled versions of the original image (already stored at the top of the pyramid)
+  void ipyramid_t::build(const std::vector<double>& scales)
+  {
+    ipscale_t& top = m_ipscales[0];
+    top.m_scale = 1.0;
+    top.m_inv_scale = 1.0;
+    update_ipscale(top, m_param);
+
+    const uint64_t rows = top.rows(), cols = top.cols();
+
+    // Stop at the first scale without any sub-window to scan
+    //  (NB: the levels are kept allocated to be reused when loading images of the same size)
+    uint64_t n_scales = 1;
+    for ( ; n_scales < scales.size(); n_scales ++)
+    {
+      uint64_t new_rows, new_cols;
+      scaled_size(rows, cols, scales[n_scales], new_rows, new_cols);
+      if (scan_empty(new_rows, new_cols, m_param) == true)
+      {
+        break;
+      }
+    }
+    m_ipscales.resize(n_scales);
+
+    // Each level is resampled from the coarsest level at least twice its size
+    //  (or from the original image), which bounds the area of the resampled footprints
+    //  while keeping the anti-aliasing of a direct resampling.
+    uint64_t s = 0;
+    for (uint64_t i = 1; i < n_scales; i ++)
+    {
+      while (s + 1 < i && m_ipscales[s + 1].m_scale >= 2.0 * scales[i])
+      {
+        s ++;
+      }
+
+      ipscale_t& dst = m_ipscales[i];
+      dst.m_scale = range(scales[i], 0.0, 1.0);
+      dst.m_inv_scale = inverse(dst.m_scale);
+
+      scale_objects(top.m_objects, dst.m_scale, dst.m_objects);
+
+      uint64_t new_rows, new_cols;
+      scaled_size(rows, cols, scales[i], new_rows, new_cols);
+      resample(m_ipscales[s].m_image, new_rows, new_cols, dst.m_image, m_buffer);
+
+      update_ipscale(dst, m_param);
+    }
+  }
+
   // Loads scaled versions of an image and its ground truth
   bool ipyramid_t::load(const std::string& ifile, const std::string& gfile)
   {
-    Matrix<uint8_t> tmp_image;
-    visioner::load(ifile, tmp_image);
+    m_ipscales.resize(std::max(m_ipscales.size(), (size_t)1));
+
+    // Load the ground truth and the image to the top of the pyramid
+    ipscale_t& top = m_ipscales[0];
+    visioner::load(ifile, top.m_image);
 
     // Compute the scalling factors
-    const std::vector<double> scales = scan_scales(m_param.m_rows, m_param.m_cols, tmp_image.rows(), tmp_image.cols(), m_param.m_ds);
+    const std::vector<double> scales = scan_scales(m_param.m_rows, m_param.m_cols, top.rows(), top.cols(), m_param.m_ds);
     if (scales.empty()) {
       boost::format m("The number of scales for image file '%s' is empty. Relevant parameters are model shape: %d x %d; image shape: %d x %d, sliding windows: %d");
       m % ifile % m_param.m_rows % m_param.m_cols;
-      m % tmp_image.rows() % tmp_image.cols() % m_param.m_ds;
+      m % top.rows() % top.cols() % m_param.m_ds;
+      m_ipscales.clear();
       throw std::runtime_error(m.str());
     }
 
-    m_ipscales.resize(scales.size());
-
-    // Load the ground truth and the image to the top of the pyramid
-    m_ipscales[0].m_scale = 1.0;
-    m_ipscales[0].m_inv_scale = 1.0;
-    if (visioner::Object::load(gfile, m_ipscales[0].m_objects) == false) {
+    if (visioner::Object::load(gfile, top.m_objects) == false) {
       boost::format m("The ground-thruth file '%s' could not be loaded");
       m % gfile;
+      m_ipscales.clear();
       throw std::runtime_error(m.str());
     }
-    m_ipscales[0].m_image = tmp_image;
-    update_ipscale(m_ipscales[0], m_param);
 
     // Build the scaled versions of the original image
-    const ipscale_t& src = m_ipscales[0];
-    for (uint64_t i = 1; i < scales.size(); i ++)
-    {
-      ipscale_t& dst = m_ipscales[i];
-      src.scale(scales[i], dst);
-      update_ipscale(dst, m_param);
-
-      if (	dst.m_scan_min_x >= dst.m_scan_max_x ||
-          dst.m_scan_min_y >= dst.m_scan_max_y)
-      {
-        m_ipscales.erase(m_ipscales.begin() + i, m_ipscales.end());
-        break;
-      }
-    }
+    build(scales);
 
     // OK
     return true;
@@ -160,34 +207,19 @@ namespace bob { namespace visioner {
   // Loads scaled versions of an image and its ground truth
   bool ipyramid_t::load(const ipscale_t& ipscale)
   {
-    m_ipscales.clear();
-
     // Compute the scalling factors
     const std::vector<double> scales = scan_scales(m_param.m_rows, m_param.m_cols, ipscale.rows(), ipscale.cols(), m_param.m_ds);
-
-    if (scales.empty()) return false;
-
-    m_ipscales.resize(scales.size());
+    if (scales.empty()) {
+      m_ipscales.clear();
+      return false;
+    }
 
     // Load the ground truth and the image
+    m_ipscales.resize(std::max(m_ipscales.size(), (size_t)1));
     m_ipscales[0] = ipscale;
-    m_ipscales[0].m_scale = 1.0;
-    m_ipscales[0].m_inv_scale = 1.0;
-    update_ipscale(m_ipscales[0], m_param);
 
     // Build the scaled versions of the original image
-    const ipscale_t& src = m_ipscales[0];
-    for (uint64_t i = 1; i < scales.size(); i ++) {
-      ipscale_t& dst = m_ipscales[i];
-      src.scale(scales[i], dst);
-      update_ipscale(dst, m_param);
-
-      if (dst.m_scan_min_x >= dst.m_scan_max_x ||
-          dst.m_scan_min_y >= dst.m_scan_max_y) {
-        m_ipscales.erase(m_ipscales.begin() + i, m_ipscales.end());
-        break;
-      }
-    }
+    build(scales);
 
     // OK
     return true;
@@ -196,36 +228,22 @@ namespace bob { namespace visioner {
   // Loads scaled versions of an image without its ground-thruth
   bool ipyramid_t::load(const uint8_t* image, uint64_t rows, uint64_t cols)
   {
-    //AA: no simple way not to have a copy here...
-    Matrix<uint8_t> tmp_image(rows, cols, image);
-
     // Compute the scalling factors
-    const std::vector<double> scales = scan_scales(m_param.m_rows, m_param.m_cols, tmp_image.rows(), tmp_image.cols(), m_param.m_ds);
-    if (scales.empty()) return false;
-
-    m_ipscales.resize(scales.size());
+    const std::vector<double> scales = scan_scales(m_param.m_rows, m_param.m_cols, rows, cols, m_param.m_ds);
+    if (scales.empty()) {
+      m_ipscales.clear();
+      return false;
+    }
 
-    // Load the ground truth and the image
-    m_ipscales[0].m_scale = 1.0;
-    m_ipscales[0].m_inv_scale = 1.0;
-    m_ipscales[0].m_image = tmp_image;
-    update_ipscale(m_ipscales[0], m_param);
+    // Load the image (copied in place to reuse the buffer of the previous image)
+    m_ipscales.resize(std::max(m_ipscales.size(), (size_t)1));
+    ipscale_t& top = m_ipscales[0];
+    top.m_image.resize(rows, cols);
+    std::copy(image, image + rows * cols, top.m_image.begin());
+    top.m_objects.clear();
 
     // Build the scaled versions of the original image
-    const ipscale_t& src = m_ipscales[0];
-    for (uint64_t i = 1; i < scales.size(); i ++)
-    {
-      ipscale_t& dst = m_ipscales[i];
-      src.scale(scales[i], dst);
-      update_ipscale(dst, m_param);
-
-      if (	dst.m_scan_min_x >= dst.m_scan_max_x ||
-          dst.m_scan_min_y >= dst.m_scan_max_y)
-      {
-        m_ipscales.erase(m_ipscales.begin() + i, m_ipscales.end());
-        break;
-      }
-    }
+    build(scales);
 
     // OK
     return true;
@@ -38,7 +38,7 @@ namespace bob { namespace visioner {
 
   // Constructor
   LUTProblem::LUTProblem(
-      const DataSet& data, const param_t& param, size_t threads)
+      const DataSet& data, const param_t& param, size_t threads, bool compact)
     : m_data(data), 
     m_param(param),
 
@@ -50,9 +50,11 @@ namespace bob { namespace visioner {
     m_mluts(n_outputs()),
     m_luts(n_outputs(), LUT(0, n_entries())),
 
-    m_sscores(n_samples(), n_outputs(), 0.0),
-    m_wscores(n_samples(), n_outputs()),
-    m_cscores(n_samples(), n_outputs()),
+    m_compact(compact),
+    m_sscores(compact ? 0 : n_samples(), n_outputs(), 0.0),
+    m_wscores(compact ? 0 : n_samples(), n_outputs()),
+    m_fsscores(compact ? n_samples() : 0, n_outputs(), 0.0f),
+    m_fwscores(compact ? n_samples() : 0, n_outputs()),
 
     m_umasks(n_features(), n_entries(), 0.0),
 
@@ -97,11 +99,7 @@ namespace bob { namespace visioner {
   void LUTProblem::update_scores_mt(const std::vector<LUT>& luts,
       const std::pair<uint64_t,uint64_t>& range) {
     for (uint64_t s = range.first; s < range.second; ++s) {
-      for (uint64_t o = 0; o < n_outputs(); ++o) {
-        const LUT& lut = luts[o];                        
-        const uint16_t u = fvalue(lut.feature(), s);
-        m_sscores(s, o) += lut[u];
-      }
+      add_scores(luts, s);
     }
   }
 
@@ -116,32 +114,17 @@ namespace bob { namespace visioner {
     }
   }
 
-  void LUTProblem::update_cscores_mt(const double* x,
-      const std::pair<uint64_t,uint64_t>& range) {
-    for (uint64_t s = range.first; s < range.second; ++s) {
-      for (uint64_t o = 0; o < n_outputs(); ++o) {
-        m_cscores(s, o) = m_sscores(s, o) + x[o] * m_wscores(s, o);
-      }
-    }
-  }
-
-  void LUTProblem::update_cscores(const double* x) {
-    if (!m_threads) {
-      update_cscores_mt(x, std::make_pair<uint64_t,uint64_t>(0, n_samples()));
-    }
-    else {
-      thread_loop(boost::bind(&LUTProblem::update_cscores_mt,
-            this, boost::cref(x), boost::lambda::_1),
-          n_samples(), m_threads);
-    }
-  }
-
   void LUTProblem::line_search_mt(const std::pair<uint64_t,uint64_t>& range) {
     for (uint64_t s = range.first; s < range.second; ++s) {
       for (uint64_t o = 0; o < n_outputs(); ++o) {
         const LUT& lut = m_luts[o];
         const uint64_t u = fvalue(lut.feature(), s);
-        m_wscores(s, o) = lut[u];
+        if (m_compact == true) {
+          m_fwscores(s, o) = lut[u];
+        }
+        else {
+          m_wscores(s, o) = lut[u];
+        }
       }
     }
   }
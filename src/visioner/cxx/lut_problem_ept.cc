@@ -21,25 +21,35 @@ namespace bob { namespace visioner {
 
   // Constructor
   LUTProblemEPT::LUTProblemEPT(const DataSet& data, const param_t& param,
-      size_t threads)
-    : LUTProblem(data, param, threads), m_values(n_samples())
+      size_t threads, bool compact)
+    : LUTProblem(data, param, threads, compact), m_values(n_samples())
   {
   }
 
   // Update loss values and derivatives
   void LUTProblemEPT::update_loss_deriv()
   {
-    update_loss_deriv(m_sscores);
+    update_loss_deriv(0);
   }
   void LUTProblemEPT::update_loss()
   {
-    update_loss(m_sscores);
+    update_loss(0);
   }
 
-  void LUTProblemEPT::update_loss_deriv_mt(const Matrix<double>& scores,
+  // Update predictions and then loss values and derivatives
+  void LUTProblemEPT::update_scores_loss_deriv(const std::vector<LUT>& luts)
+  {
+    update_loss_deriv(&luts);
+  }
+
+  void LUTProblemEPT::update_loss_deriv_mt(const std::vector<LUT>* luts,
       const std::pair<uint64_t,uint64_t>& range) {
+    std::vector<double> buffer(n_outputs());
     for (uint64_t s = range.first; s < range.second; ++s) {
-      m_loss.eval(target(s), scores[s], n_outputs(), m_values[s], m_grad[s]);
+      if (luts) {
+        add_scores(*luts, s);
+      }
+      m_loss.eval(target(s), sscores(s, &buffer[0]), n_outputs(), m_values[s], m_grad[s]);
 
       // Adjust with costs
       const double _cost = cost(s);
@@ -51,39 +61,43 @@ namespace bob { namespace visioner {
     }
   }
 
-  // Update loss values and derivatives (for some particular scores)
-  void LUTProblemEPT::update_loss_deriv(const Matrix<double>& scores)
+  // Update loss values and derivatives (after adding <luts> to the scores)
+  void LUTProblemEPT::update_loss_deriv(const std::vector<LUT>* luts)
   {
     // Allocate buffers (if not already done)
     m_grad.resize(n_samples(), n_outputs());
 
     // Compute the loss value + gradient
     if (!m_threads) {
-      update_loss_deriv_mt(scores,
+      update_loss_deriv_mt(luts,
           std::make_pair<uint64_t,uint64_t>(0, n_samples()));
     }
     else {
       thread_loop(boost::bind(&LUTProblemEPT::update_loss_deriv_mt,
-            this, boost::cref(scores), boost::lambda::_1),
+            this, luts, boost::lambda::_1),
           n_samples(), m_threads);
     }
   }
 
-  void LUTProblemEPT::update_loss_mt(const Matrix<double>& scores,
+  void LUTProblemEPT::update_loss_mt(const std::vector<LUT>* luts,
       const std::pair<uint64_t,uint64_t>& range) {
+    std::vector<double> buffer(n_outputs());
     for (uint64_t s = range.first; s < range.second; ++s) {
-      m_loss.eval(target(s), scores[s], n_outputs(), m_values[s]);
+      if (luts) {
+        add_scores(*luts, s);
+      }
+      m_loss.eval(target(s), sscores(s, &buffer[0]), n_outputs(), m_values[s]);
       m_values[s] *= cost(s); // Adjust with costs
     }
   }
 
-  void LUTProblemEPT::update_loss(const Matrix<double>& scores) {
+  void LUTProblemEPT::update_loss(const std::vector<LUT>* luts) {
     if (!m_threads) {
-      update_loss_mt(scores, std::make_pair<uint64_t,uint64_t>(0, n_samples()));
+      update_loss_mt(luts, std::make_pair<uint64_t,uint64_t>(0, n_samples()));
     }
     else {
       thread_loop(boost::bind(&LUTProblemEPT::update_loss_mt,
-            this, boost::cref(scores), boost::lambda::_1),
+            this, luts, boost::lambda::_1),
           n_samples(), m_threads);
     }
   }
@@ -96,37 +110,86 @@ namespace bob { namespace visioner {
   }
   double LUTProblemEPT::error() const
   {
+    std::vector<double> buffer(n_outputs());
     double sum = 0.0;
     for (uint64_t s = 0; s < n_samples(); s ++)
     {
-      sum += m_loss.error(target(s), m_sscores[s], n_outputs()) * cost(s);
+      sum += m_loss.error(target(s), sscores(s, &buffer[0]), n_outputs()) * cost(s);
     }
 
     return  sum *
       inverse(n_samples()) * inverse(n_outputs());
   }
 
+  void LUTProblemEPT::lsearch_t::add(const lsearch_t& other)
+  {
+    m_value += other.m_value;
+    m_value_sq += other.m_value_sq;
+    for (uint64_t o = 0; o < m_grad.size(); o ++)
+    {
+      m_grad[o] += other.m_grad[o];
+      m_grad_value[o] += other.m_grad_value[o];
+    }
+  }
+
+  // Compute the current (strong + x * weak) scores, the loss values and 
+  //      gradients for a range of samples and accumulate them
+  void LUTProblemEPT::linesearch_mt(const double* x,
+      const std::pair<uint64_t,uint64_t>& range, lsearch_t& sums) const {
+    sums = lsearch_t(n_outputs());
+
+    std::vector<double> buffer(n_outputs()), wscores(n_outputs());
+    std::vector<double> cscores(n_outputs()), grad(n_outputs());
+    for (uint64_t s = range.first; s < range.second; ++s) {
+      const double* _sscores = sscores(s, &buffer[0]);
+      for (uint64_t o = 0; o < n_outputs(); ++o) {
+        wscores[o] = wscore(s, o);
+        cscores[o] = _sscores[o] + x[o] * wscores[o];
+      }
+
+      double value;
+      m_loss.eval(target(s), &cscores[0], n_outputs(), value, &grad[0]);
+
+      // Adjust with costs
+      const double _cost = cost(s);
+      value *= _cost;
+
+      sums.m_value += value;
+      sums.m_value_sq += value * value;
+      for (uint64_t o = 0; o < n_outputs(); ++o) {
+        const double dw = grad[o] * _cost * wscores[o];
+        sums.m_grad[o] += dw;
+        sums.m_grad_value[o] += dw * value;
+      }
+    }
+  }
+
   // Compute the gradient <g> and the function value in the <x> point
   //      (used during linesearch)
   double LUTProblemEPT::linesearch(const double* x, double* g)
   {
-    update_cscores(x);
-    update_loss_deriv(m_cscores);
-
-    // Compute the loss value
-    const double fx = std::accumulate(m_values.begin(), m_values.end(), 0.0);
-
-    // Compute the gradients
-    std::fill(g, g + n_outputs(), 0.0);
-    for (uint64_t s = 0; s < n_samples(); s ++)
-    {
-      for (uint64_t o = 0; o < n_outputs(); o ++)
-      {
-        g[o] += m_grad(s, o) * m_wscores(s, o);
+    // A single pass over the samples: the current scores are not buffered
+    lsearch_t sums(n_outputs());
+    if (!m_threads) {
+      linesearch_mt(x, std::make_pair<uint64_t,uint64_t>(0, n_samples()), sums);
+    }
+    else {
+      std::vector<lsearch_t> th_sums;
+      thread_loop(boost::bind(&LUTProblemEPT::linesearch_mt,
+            this, x, boost::lambda::_1, boost::lambda::_2),
+          n_samples(), th_sums, m_threads);
+      for (uint64_t i = 0; i < th_sums.size(); i ++) {
+        sums.add(th_sums[i]);
       }
     }
 
-    return fx;
+    return linesearch(sums, g);
+  }
+
+  double LUTProblemEPT::linesearch(const lsearch_t& sums, double* g) const
+  {
+    std::copy(sums.m_grad.begin(), sums.m_grad.end(), g);
+    return sums.m_value;
   }
 
   // Select the optimal feature
@@ -19,11 +19,11 @@ namespace bob { namespace visioner {
 
   // Constructor
   LUTProblemVAR::LUTProblemVAR(const DataSet& data, 
-      const param_t& param, double lambda, size_t threads)
-    : LUTProblemEPT(data, param, threads), m_lambda(lambda) {                
+      const param_t& param, double lambda, size_t threads, bool compact)
+    : LUTProblemEPT(data, param, threads, compact), m_lambda(lambda) {                
   }
 
-  void LUTProblemVAR::update_loss_deriv_mt(const Matrix<double>& scores,
+  void LUTProblemVAR::update_loss_deriv_mt(
       double scale1, double scale2, double ept_sum,
       const std::pair<uint64_t,uint64_t>& range) {
     for (uint64_t s = range.first; s < range.second; ++s) {
@@ -35,10 +35,10 @@ namespace bob { namespace visioner {
     }
   }
 
-  void LUTProblemVAR::update_loss_deriv(const Matrix<double>& scores) {
+  void LUTProblemVAR::update_loss_deriv(const std::vector<LUT>* luts) {
 
     // Compute the expectation loss values and derivatives
-    LUTProblemEPT::update_loss_deriv(scores);
+    LUTProblemEPT::update_loss_deriv(luts);
 
     const double scale1 = m_lambda * n_samples();
     const double scale2 = 1.0 - m_lambda;                                
@@ -51,12 +51,12 @@ namespace bob { namespace visioner {
 
     // Compute the variational loss gradients (replace the expectation values)
     if (!m_threads) {
-      update_loss_deriv_mt(scores, scale1, scale2, ept_sum,
+      update_loss_deriv_mt(scale1, scale2, ept_sum,
           std::make_pair<uint64_t,uint64_t>(0, n_samples()));
     }
     else {
       thread_loop(boost::bind(&LUTProblemVAR::update_loss_deriv_mt,
-            this, boost::cref(scores), scale1, scale2, ept_sum,
+            this, scale1, scale2, ept_sum,
             boost::lambda::_1), n_samples(), m_threads);
     }
 
@@ -64,10 +64,10 @@ namespace bob { namespace visioner {
     std::fill(m_values.begin(), m_values.end(), var_sum * inverse(n_samples()));                
   }
 
-  void LUTProblemVAR::update_loss(const Matrix<double>& scores) {
+  void LUTProblemVAR::update_loss(const std::vector<LUT>* luts) {
 
     // Compute the expectation loss values
-    LUTProblemEPT::update_loss(scores);
+    LUTProblemEPT::update_loss(luts);
 
     const double scale1 = m_lambda * n_samples();
     const double scale2 = 1.0 - m_lambda;                                
@@ -82,4 +82,19 @@ namespace bob { namespace visioner {
     std::fill(m_values.begin(), m_values.end(), var_sum * inverse(n_samples()));
   }
 
+  // Compute the gradient <g> and the function value from the linesearch sums:
+  //      the variational loss gradient of the sample <s> is
+  //      2 * d_s * (scale1 * v_s + scale2 * sum(v)) (see ::update_loss_deriv()).
+  double LUTProblemVAR::linesearch(const lsearch_t& sums, double* g) const {
+
+    const double scale1 = m_lambda * n_samples();
+    const double scale2 = 1.0 - m_lambda;                                
+
+    for (uint64_t o = 0; o < n_outputs(); ++o) {
+      g[o] = 2.0 * (scale1 * sums.m_grad_value[o] + scale2 * sums.m_value * sums.m_grad[o]);
+    }
+
+    return scale1 * sums.m_value_sq + scale2 * sums.m_value * sums.m_value;
+  }
+
 }}
@@ -11,11 +11,17 @@
  */
 
 #include <fstream>
+#include <sstream>
+#include <cstring>
+#include <stdexcept>
+#include <boost/format.hpp>
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 #include "bob/core/logging.h"
 
@@ -37,6 +43,161 @@ inline static bool is_dot_vbin(const std::string& filename) {
     boost::filesystem::extension(filename) == ".vbgz";
 }
 
+inline static bool is_dot_vflat(const std::string& filename) {
+  return boost::filesystem::extension(filename) == ".vflat";
+}
+
+/**
+ * Layout of the flat binary model files (all sections are 8-byte aligned and
+ * stored with the native byte order):
+ *
+ *   header
+ *   param_t                  (binary archive, <param_size> bytes)
+ *   LUT ranges per output    (uint64_t x (n_outputs + 1))
+ *   LUT features             (uint64_t x n_luts)
+ *   LUT entries              (double x n_luts x n_fvalues)
+ *   feature descriptors      (model specific, <features_size> bytes)
+ */
+struct flat_header_t {
+  char m_magic[8];
+  uint32_t m_version;
+  uint32_t m_byte_order;
+  uint64_t m_param_size;
+  uint64_t m_n_outputs;
+  uint64_t m_n_fvalues;
+  uint64_t m_n_luts;
+  uint64_t m_features_size;
+};
+
+static const char FLAT_MAGIC[8] = { 'V', 'I', 'S', 'I', 'O', 'N', 'E', 'R' };
+static const uint32_t FLAT_VERSION = 1;
+static const uint32_t FLAT_BYTE_ORDER = 0x01020304;
+
+inline static uint64_t flat_align(uint64_t size) {
+  return (size + 7) & ~(uint64_t)7;
+}
+
+static void flat_write(std::ostream& os, const void* data, uint64_t size) {
+  static const char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+  if (size > 0) os.write((const char*)data, size);
+  os.write(padding, flat_align(size) - size);
+}
+
+/**
+ * A memory-mapped flat model file
+ */
+struct flat_model_t {
+
+  bool map(const std::string& path) {
+    try {
+      boost::interprocess::file_mapping file(path.c_str(), boost::interprocess::read_only);
+      m_region.reset(new boost::interprocess::mapped_region(file, boost::interprocess::read_only));
+    }
+    catch (boost::interprocess::interprocess_exception&) {
+      bob::core::error << "Failed to map the model file <" << path << ">!" << std::endl;
+      return false;
+    }
+
+    const unsigned char* data = (const unsigned char*)m_region->get_address();
+    const uint64_t size = m_region->get_size();
+    if (size < sizeof(flat_header_t)) {
+      bob::core::error << "The model file <" << path << "> is truncated!" << std::endl;
+      return false;
+    }
+
+    std::memcpy(&m_header, data, sizeof(flat_header_t));
+    if (std::memcmp(m_header.m_magic, FLAT_MAGIC, sizeof(FLAT_MAGIC)) != 0) {
+      bob::core::error << "The file <" << path << "> is not a flat model!" << std::endl;
+      return false;
+    }
+    if (m_header.m_byte_order != FLAT_BYTE_ORDER) {
+      bob::core::error << "The model file <" << path << "> was saved with a different byte order!" << std::endl;
+      return false;
+    }
+    if (m_header.m_version != FLAT_VERSION) {
+      bob::core::error << "The model file <" << path << "> uses the unsupported version "
+        << m_header.m_version << " of the flat format (expected " << FLAT_VERSION << ")!" << std::endl;
+      return false;
+    }
+
+    // Locate the sections
+    uint64_t offset = flat_align(sizeof(flat_header_t));
+    const uint64_t param_offset = offset;
+    offset += flat_align(m_header.m_param_size);
+    const uint64_t begins_offset = offset;
+    offset += (m_header.m_n_outputs + 1) * sizeof(uint64_t);
+    const uint64_t features_offset = offset;
+    offset += m_header.m_n_luts * sizeof(uint64_t);
+    const uint64_t entries_offset = offset;
+    offset += m_header.m_n_luts * m_header.m_n_fvalues * sizeof(double);
+    const uint64_t descriptors_offset = offset;
+    offset += m_header.m_features_size;
+    if (offset > size) {
+      bob::core::error << "The model file <" << path << "> is truncated!" << std::endl;
+      return false;
+    }
+
+    m_begins = (const uint64_t*)(data + begins_offset);
+    m_features = (const uint64_t*)(data + features_offset);
+    m_entries = (const double*)(data + entries_offset);
+    m_descriptors = data + descriptors_offset;
+    if (m_begins[0] != 0 || m_begins[m_header.m_n_outputs] != m_header.m_n_luts) {
+      boost::format m("the LUT ranges of the model file '%s' are corrupted");
+      m % path;
+      throw std::runtime_error(m.str());
+    }
+    for (uint64_t o = 0; o < m_header.m_n_outputs; o ++) {
+      if (m_begins[o] > m_begins[o + 1]) {
+        boost::format m("the LUT ranges of the model file '%s' are not sorted");
+        m % path;
+        throw std::runtime_error(m.str());
+      }
+    }
+
+    // Decode the parameters
+    try {
+      std::istringstream is(std::string((const char*)data + param_offset, m_header.m_param_size));
+      boost::archive::binary_iarchive ia(is);
+      ia >> m_param;
+    }
+    catch (std::exception&) {
+      bob::core::error << "Failed to decode the parameters of the model file <" << path << ">!" << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  bob::visioner::LUTTable table() const {
+    return bob::visioner::LUTTable(m_region, m_header.m_n_outputs, m_header.m_n_fvalues,
+        m_begins, m_features, m_entries);
+  }
+
+  // Check the LUTs against the feature descriptors loaded by <model>
+  void check(const bob::visioner::Model& model, const std::string& path) const {
+    if (m_header.m_n_luts > 0 && m_header.m_n_fvalues < model.n_fvalues()) {
+      boost::format m("the LUTs of the model file '%s' have %d entries instead of %d");
+      m % path % m_header.m_n_fvalues % model.n_fvalues();
+      throw std::runtime_error(m.str());
+    }
+    for (uint64_t r = 0; r < m_header.m_n_luts; r ++) {
+      if (m_features[r] >= model.n_features()) {
+        boost::format m("the LUT %d of the model file '%s' uses the feature %d out of %d");
+        m % r % path % m_features[r] % model.n_features();
+        throw std::runtime_error(m.str());
+      }
+    }
+  }
+
+  boost::shared_ptr<boost::interprocess::mapped_region> m_region;
+  flat_header_t m_header;
+  bob::visioner::param_t m_param;
+  const uint64_t* m_begins;
+  const uint64_t* m_features;
+  const double* m_entries;
+  const unsigned char* m_descriptors;
+};
+
 namespace bob { namespace visioner {
 
   // Constructor
@@ -51,10 +212,11 @@ namespace bob { namespace visioner {
   {
     m_param = param;
     m_mluts.resize(make_tagger(param)->n_outputs());
-    for (uint64_t o = 0; o < n_outputs(); o ++)                        
+    for (uint64_t o = 0; o < m_mluts.size(); o ++)                        
     {
       m_mluts[o].clear();
     }
+    m_table = LUTTable(m_mluts);
   }
 
   // Reset to new std::vector<LUT> (lut.size() == model.n_outputs()!)
@@ -65,16 +227,51 @@ namespace bob { namespace visioner {
       return false;
     }
 
-    for (uint64_t o = 0; o < n_outputs(); o ++)                        
-    {
-      m_mluts[o] = mluts[o];
-    }
+    m_mluts = mluts;
+    m_table = LUTTable(m_mluts);
     return true;
   }
 
   // Save/load to/from file
   bool Model::save(const std::string& path) const
   {
+    if (is_dot_vflat(path)) { //the flat binary format
+      std::ofstream ofs(path.c_str(), std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+      if (ofs.good() == false)
+      {
+        bob::core::error << "Failed to save the model!" << std::endl;
+        return false;
+      }
+
+      std::ostringstream param;
+      {
+        boost::archive::binary_oarchive oa(param);
+        oa << m_param;
+      }
+      std::vector<unsigned char> descriptors;
+      save(descriptors);
+
+      flat_header_t header;
+      std::memset(&header, 0, sizeof(header));
+      std::memcpy(header.m_magic, FLAT_MAGIC, sizeof(FLAT_MAGIC));
+      header.m_version = FLAT_VERSION;
+      header.m_byte_order = FLAT_BYTE_ORDER;
+      header.m_param_size = param.str().size();
+      header.m_n_outputs = m_table.n_outputs();
+      header.m_n_fvalues = m_table.n_fvalues();
+      header.m_n_luts = m_table.n_luts();
+      header.m_features_size = descriptors.size();
+
+      flat_write(ofs, &header, sizeof(header));
+      flat_write(ofs, param.str().data(), header.m_param_size);
+      flat_write(ofs, m_table.begins(), (header.m_n_outputs + 1) * sizeof(uint64_t));
+      flat_write(ofs, m_table.features(), header.m_n_luts * sizeof(uint64_t));
+      flat_write(ofs, m_table.entries(), header.m_n_luts * header.m_n_fvalues * sizeof(double));
+      flat_write(ofs, descriptors.empty() ? 0 : &descriptors[0], descriptors.size());
+
+      return ofs.good();
+    }
+
     std::ios_base::openmode mode = std::ios_base::out | std::ios_base::trunc;
     if (is_dot_gz(path) || is_dot_vbin(path)) mode |= std::ios_base::binary;
     std::ofstream file(path.c_str(), mode);
@@ -92,13 +289,13 @@ namespace bob { namespace visioner {
     if (is_dot_vbin(path)) { //a binary file from visioner
       boost::archive::binary_oarchive oa(ofs);
       oa << m_param;
-      oa << m_mluts;  
+      oa << luts();  
       save(oa);
     }
     else {
       boost::archive::text_oarchive oa(ofs);
       oa << m_param;
-      oa << m_mluts;  
+      oa << luts();  
       save(oa);
     }
 
@@ -108,6 +305,24 @@ namespace bob { namespace visioner {
 
   bool Model::load(const std::string& path)
   {
+    if (is_dot_vflat(path)) { //the flat binary format, memory-mapped
+      flat_model_t flat;
+      if (flat.map(path) == false)
+      {
+        return false;
+      }
+
+      m_param = flat.m_param;
+      m_table = flat.table();
+      m_table.get(m_mluts);
+      if (load(flat.m_descriptors, flat.m_header.m_features_size) == false)
+      {
+        return false;
+      }
+      flat.check(*this, path);
+      return true;
+    }
+
     //AA: adds gzip decompression if necessary (depends on path)
     std::ios_base::openmode mode = std::ios_base::in;
     if (is_dot_gz(path) || is_dot_vbin(path)) mode |= std::ios_base::binary;
@@ -136,11 +351,30 @@ namespace bob { namespace visioner {
       load(ia);
     }
 
+    m_table = LUTTable(m_mluts);
     return ifs.good();
   }
 
   bool Model::load(const std::string& path, boost::shared_ptr<Model>& model)
   {
+    if (is_dot_vflat(path)) { //the flat binary format, memory-mapped
+      flat_model_t flat;
+      if (flat.map(path) == false)
+      {
+        return false;
+      }
+
+      model = make_model(flat.m_param);
+      model->m_table = flat.table();
+      model->m_table.get(model->m_mluts);
+      if (model->load(flat.m_descriptors, flat.m_header.m_features_size) == false)
+      {
+        return false;
+      }
+      flat.check(*model, path);
+      return true;
+    }
+
     //AA: adds gzip decompression if necessary (depends on path)
     std::ios_base::openmode mode = std::ios_base::in;
     if (is_dot_gz(path) || is_dot_vbin(path)) mode |= std::ios_base::binary;
@@ -182,12 +416,15 @@ namespace bob { namespace visioner {
   }        
   double Model::score(uint64_t o, uint64_t rbegin, uint64_t rend, int x, int y) const
   {                
+    const uint64_t n_fvalues = m_table.n_fvalues();
+    const uint64_t* features = m_table.features() + m_table.begin(o);
+    const double* entries = m_table.entries() + m_table.begin(o) * n_fvalues;
+
     double sum = 0.0;
     for (uint64_t r = rbegin; r < rend; r ++)
     {
-      const LUT& lut = m_mluts[o][r];
-      const uint64_t fv = get(lut.feature(), x, y);
-      sum += lut[fv];
+      const uint64_t fv = get(features[r], x, y);
+      sum += entries[r * n_fvalues + fv];
     }
     return sum;
   }
@@ -196,14 +433,7 @@ namespace bob { namespace visioner {
   std::vector<uint64_t> Model::features() const
   {
     std::vector<uint64_t> result;
-    for (uint64_t o = 0; o < n_outputs(); o ++)
-    {
-      for (uint64_t r = 0; r < n_luts(o); r ++)
-      {
-        const LUT& lut = m_mluts[o][r];
-        result.push_back(lut.feature());
-      }
-    }
+    result.insert(result.end(), m_table.features(), m_table.features() + m_table.n_luts());
 
     unique(result);
 
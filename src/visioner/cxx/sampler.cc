@@ -40,7 +40,8 @@ std::vector<T> stat_cumulate(const std::vector<std::vector<T> >& stats,
 namespace bob { namespace visioner {
 
   // Constructor
-  Sampler::Sampler(const param_t& param, SamplerType type, size_t max_threads) :
+  Sampler::Sampler(const param_t& param, SamplerType type, size_t max_threads,
+      bool compact) :
     m_param(param),
     m_type(type),
     m_tagger(make_tagger(m_param)),
@@ -48,6 +49,7 @@ namespace bob { namespace visioner {
     m_n_outputs(m_tagger->n_outputs()),
     m_n_samples(0),
     m_n_types(m_tagger->n_types()),
+    m_compact(compact),
     m_tcounts(m_tagger->n_types(), 0),
     m_sprobs(m_tagger->n_types(), 0.0),
     m_rgens(max_threads?max_threads:1,boost::mt19937(param.m_seed)) {
@@ -66,63 +68,155 @@ namespace bob { namespace visioner {
           throw std::runtime_error(m.str());
         }
 
-        this->load(ifiles, gfiles);
+        this->load(ifiles, gfiles, max_threads);
       }
 
     }
 
-  // Reset to a set of listfiles
-  void Sampler::load(const std::vector<std::string>& ifiles,
-      const std::vector<std::string>& gfiles) {
+  // Serialize the warnings of the loading threads
+  static boost::mutex load_mutex;
 
-    ipyramid_t ipyramid(m_param);
+  // Crop a scaled image to the sub-windows at [min_x, max_x] x [min_y, max_y]
+  //  (on the scanning grid), translating the scanning ranges and the ground truth
+  static void crop(const ipscale_t& src, int min_x, int max_x, int min_y, int max_y,
+      const param_t& param, ipscale_t& dst)
+  {
+    const uint64_t rows = max_y - min_y + param.m_rows;
+    const uint64_t cols = max_x - min_x + param.m_cols;
 
-    std::vector<double> targets(n_outputs());
-    uint64_t type;
+    dst.m_image.resize(rows, cols);
+    for (uint64_t y = 0; y < rows; y ++)
+    {
+      const uint8_t* src_row = src.m_image[min_y + y] + min_x;
+      std::copy(src_row, src_row + cols, dst.m_image[y]);
+    }
 
-    // Process each image in the list
-    for (uint64_t i = 0; i < ifiles.size(); ++i) {
+    dst.m_objects = src.m_objects;
+    for (std::vector<Object>::iterator it = dst.m_objects.begin(); it != dst.m_objects.end(); ++ it)
+    {
+      it->translate(-min_x, -min_y);
+    }
+
+    dst.m_scale = src.m_scale;
+    dst.m_inv_scale = src.m_inv_scale;
+    dst.m_scan_dx = src.m_scan_dx;
+    dst.m_scan_dy = src.m_scan_dy;
+    dst.m_scan_min_x = 0;
+    dst.m_scan_max_x = max_x - min_x + 1;
+    dst.m_scan_min_y = 0;
+    dst.m_scan_max_y = max_y - min_y + 1;
+    dst.m_scan_w = src.m_scan_w;
+    dst.m_scan_h = src.m_scan_h;
+    dst.m_scan_o_w = src.m_scan_o_w;
+    dst.m_scan_o_h = src.m_scan_o_h;
+  }
 
-      TDEBUG1("[" << type2str() << " sampler] loading image "
-        << (i + 1) << " of " << ifiles.size() << "...");
+  // Loading thread
+  void Sampler::th_load(uint64_t ith, uint64_t i,
+      const std::vector<std::string>& ifiles,
+      const std::vector<std::string>& gfiles,
+      std::vector<ipyramid_t>& ipyramids,
+      std::vector<iscales_t>& iscales) const {
+
+    TDEBUG1("[" << type2str() << " sampler] loading image "
+      << (i + 1) << " of " << ifiles.size() << "...");
+
+    // Load the scaled images ...
+    ipyramid_t& ipyramid = ipyramids[ith];
+    if (ipyramid.load(ifiles[i], gfiles[i]) == false) {
+      boost::mutex::scoped_lock lock(load_mutex);
+      bob::core::warn << "failed to load the image in file '"
+        << ifiles[i] << "'" << std::endl;
+      return;
+    }
 
-      // Load the scaled images ...
-      if (ipyramid.load(ifiles[i], gfiles[i]) == false) {
-        bob::core::warn << "failed to load the image in file '"
-          << ifiles[i] << "'" << std::endl;
-        continue;
-      }
+    iscales_t& result = iscales[i];
+    result.m_tcounts.resize(n_types(), 0);
+
+    std::vector<double> targets(n_outputs());
+    uint64_t type;
 
-      // Build the samples using sliding-windows
-      for (uint64_t is = 0; is < ipyramid.size(); ++is) {
+    // Build the samples using sliding-windows
+    for (uint64_t is = 0; is < ipyramid.size(); ++is) {
 
-        const ipscale_t& ip = ipyramid[is];
+      const ipscale_t& ip = ipyramid[is];
 
-        uint64_t new_n_samples = 0, old_n_samples = n_samples();
-        for (int y = ip.m_scan_min_y; y < ip.m_scan_max_y; y += ip.m_scan_dy)
-          for (int x = ip.m_scan_min_x; x < ip.m_scan_max_x; x += ip.m_scan_dx)
+      uint64_t new_n_samples = 0;
+      int min_x = ip.m_scan_max_x, max_x = ip.m_scan_min_x;
+      int min_y = ip.m_scan_max_y, max_y = ip.m_scan_min_y;
+      for (int y = ip.m_scan_min_y; y < ip.m_scan_max_y; y += ip.m_scan_dy)
+        for (int x = ip.m_scan_min_x; x < ip.m_scan_max_x; x += ip.m_scan_dx)
+        {
+          if (m_tagger->check(ip, x, y, targets, type) == true)
           {
-            if (m_tagger->check(ip, x, y, targets, type) == true)
-            {
-              m_tcounts[type] ++;
-              new_n_samples ++;
-            }
+            result.m_tcounts[type] ++;
+            new_n_samples ++;
+
+            min_x = std::min(min_x, x), max_x = std::max(max_x, x);
+            min_y = std::min(min_y, y), max_y = std::max(max_y, y);
           }
+        }
 
-        // Make sure to store only images with at least one sample
-        if (new_n_samples > 0) {
-          m_ipscales.push_back(ip);
-          m_ipsbegins.push_back(old_n_samples);
-          m_ipsends.push_back(old_n_samples + new_n_samples);
-          m_n_samples += new_n_samples;
+      // Make sure to store only images with at least one sample
+      if (new_n_samples > 0) {
+        result.m_ipscales.push_back(ipscale_t());
+        if (m_compact == true) {
+          crop(ip, min_x, max_x, min_y, max_y, m_param, result.m_ipscales.back());
         }
+        else {
+          result.m_ipscales.back() = ip;
+        }
+        result.m_n_samples.push_back(new_n_samples);
+      }
 
-        // Backgroung image - there is no point in keeping in memory too many scales!
-        // if (ip.m_objects.empty() == true)
-        // {
-        //         is += 2;//ipyramid.size() / 8;
-        // }
+      // Backgroung image - there is no point in keeping in memory too many scales!
+      // if (ip.m_objects.empty() == true)
+      // {
+      //         is += 2;//ipyramid.size() / 8;
+      // }
+    }
+  }
+
+  // Reset to a set of listfiles
+  void Sampler::load(const std::vector<std::string>& ifiles,
+      const std::vector<std::string>& gfiles, size_t threads) {
+
+    // Load and scan each image in the list (in parallel) ...
+    std::vector<ipyramid_t> ipyramids(std::max(threads, (size_t)1), ipyramid_t(m_param));
+    std::vector<iscales_t> iscales(ifiles.size());
+
+    thread_queue(
+        boost::bind(&Sampler::th_load, this, boost::lambda::_1, boost::lambda::_2,
+          boost::cref(ifiles), boost::cref(gfiles),
+          boost::ref(ipyramids), boost::ref(iscales)),
+        ifiles.size(), threads);
+
+    // ... and store the scaled images with samples in the order of the list
+    uint64_t n_new_scales = 0;
+    for (uint64_t i = 0; i < iscales.size(); ++i) {
+      n_new_scales += iscales[i].m_ipscales.size();
+    }
+    m_ipscales.reserve(m_ipscales.size() + n_new_scales);
+    m_ipsbegins.reserve(m_ipsbegins.size() + n_new_scales);
+    m_ipsends.reserve(m_ipsends.size() + n_new_scales);
+
+    for (uint64_t i = 0; i < iscales.size(); ++i) {
+
+      iscales_t& result = iscales[i];
+      for (uint64_t is = 0; is < result.m_ipscales.size(); ++is) {
+        m_ipscales.push_back(ipscale_t());
+        std::swap(m_ipscales.back(), result.m_ipscales[is]);
+        m_ipsbegins.push_back(m_n_samples);
+        m_ipsends.push_back(m_n_samples + result.m_n_samples[is]);
+        m_n_samples += result.m_n_samples[is];
+      }
+
+      for (uint64_t iti = 0; iti < result.m_tcounts.size(); iti ++) {
+        m_tcounts[iti] += result.m_tcounts[iti];
       }
+
+      // Release the memory as soon as possible
+      std::vector<ipscale_t>().swap(result.m_ipscales);
     }
 
 #   ifdef BOB_DEBUG
@@ -131,13 +131,13 @@ namespace bob { namespace visioner {
       switch (make_optimization(m_param))
       {
         case Expectation:
-          t_lp.reset(new LUTProblemEPT(t_data, m_param, threads));
-          v_lp.reset(new LUTProblemEPT(v_data, m_param, threads));
+          t_lp.reset(new LUTProblemEPT(t_data, m_param, threads, m_compact));
+          v_lp.reset(new LUTProblemEPT(v_data, m_param, threads, m_compact));
           break;
 
         case Variational:
-          t_lp.reset(new LUTProblemVAR(t_data, m_param, lambda, threads));
-          v_lp.reset(new LUTProblemVAR(v_data, m_param, lambda, threads));
+          t_lp.reset(new LUTProblemVAR(t_data, m_param, lambda, threads, m_compact));
+          v_lp.reset(new LUTProblemVAR(v_data, m_param, lambda, threads, m_compact));
           break;
       }
 
@@ -163,11 +163,11 @@ namespace bob { namespace visioner {
     Timer timer;
 
     // Train the models in boosting rounds ...
+    t_lp->update_loss_deriv();
     for (uint64_t nc = 0; nc < m_param.m_rounds; nc ++)
     {
       // Train weak learners ...
       timer.restart();
-      t_lp->update_loss_deriv();
       t_lp->select();
 #     ifdef BOB_DEBUG
       const double time_select = timer.elapsed();
@@ -187,8 +187,8 @@ namespace bob { namespace visioner {
         "<<round " + boost::lexical_cast<std::string>(nc + 1) + "/" +
         boost::lexical_cast<std::string>(m_param.m_rounds) + ">>";
 
-      t_lp->update_scores(t_lp->luts());
-      t_lp->update_loss();
+      // (the loss derivatives are those of the next round)
+      t_lp->update_scores_loss_deriv(t_lp->luts());
 
       v_lp->update_scores(t_lp->luts());
       //v_lp->update_loss();
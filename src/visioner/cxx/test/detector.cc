@@ -0,0 +1,211 @@
+/**
+ * @file visioner/cxx/test/detector.cc
+ * @date Sun Oct 18 22:31:08 2026 +0200
+ *
+ * @brief Compares the processing of the detections of the CVDetector with
+ * straightforward implementations
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE visioner-CVDetector Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/random.hpp>
+#include <limits>
+#include <vector>
+
+#include <bob/visioner/cv/cv_detector.h>
+#include <bob/visioner/vision/vision.h>
+
+namespace bob { namespace visioner {
+
+  /**
+   * Gives access to the computation of the ROC
+   */
+  class TestCVDetector {
+    public:
+      static void roc(const Matrix<int>& labels,
+        const std::vector<detection_t>& detections,
+        const std::vector<double>& thress,
+        std::vector<int64_t>& d_tps, std::vector<int64_t>& d_fas)
+      {
+        CVDetector::roc(labels, detections, thress, d_tps, d_fas);
+      }
+
+      static void roc_thresholds(
+        const std::vector<std::vector<detection_t> >& idetections,
+        uint64_t n_thress, std::vector<double>& thress)
+      {
+        CVDetector::roc_thresholds(idetections, n_thress, thress);
+      }
+  };
+
+}}
+
+struct T {
+  boost::mt19937 rng;
+
+  T(): rng(0) {}
+};
+
+/**
+ * Draws <n> detections of <n_outputs> labels. The boxes are taken from a
+ * coarse set of positions and sizes, and the scores from a few values, so
+ * that identical boxes and tied scores are frequent.
+ */
+static std::vector<bob::visioner::detection_t> random_detections(
+  boost::mt19937& rng, uint64_t n, int n_outputs)
+{
+  static const double sizes[] = { 6., 8., 11., 12., 16., 23., 24., 32., 47. };
+  boost::uniform_int<> position(0, 60), size(0, 8), score(0, 9),
+    label(0, n_outputs - 1);
+  std::vector<bob::visioner::detection_t> detections;
+  for (uint64_t i = 0; i < n; ++i) {
+    const double w = sizes[size(rng)], h = sizes[size(rng)];
+    detections.push_back(bob::visioner::make_detection(0.1 * score(rng),
+      QRectF(3. * position(rng), 2. * position(rng), w, h), label(rng)));
+  }
+  return detections;
+}
+
+/**
+ * Greedy non-maximum suppression comparing all pairs of detections of the
+ * same label
+ */
+static void cluster_reference(std::vector<bob::visioner::detection_t>& detections,
+  double thres, uint64_t n_outputs)
+{
+  bob::visioner::CVDetector::sort_desc(detections);
+
+  std::vector<bob::visioner::detection_t> result;
+  std::vector<bool> removed(detections.size(), false);
+  for (uint64_t o = 0; o < n_outputs; ++o)
+    for (uint64_t i = 0; i < detections.size(); ++i) {
+      if (removed[i] || detections[i].second.second != (int)o) continue;
+      result.push_back(detections[i]);
+      for (uint64_t j = i + 1; j < detections.size(); ++j)
+        if (!removed[j] && detections[j].second.second == (int)o &&
+            bob::visioner::overlap(detections[i].second.first,
+              detections[j].second.first) >= thres)
+          removed[j] = true;
+    }
+
+  detections.swap(result);
+}
+
+/**
+ * Counts the true positives and the false alarms of the detections scored
+ * above each threshold value, one threshold after the other
+ */
+static void roc_reference(const bob::visioner::Matrix<int>& labels,
+  const std::vector<bob::visioner::detection_t>& detections,
+  const std::vector<double>& thress,
+  std::vector<int64_t>& n_tps, std::vector<int64_t>& n_fas)
+{
+  if (detections.empty() || labels.rows() != detections.size()) return;
+
+  for (uint64_t t = 0, id = 0; t < thress.size(); ++t) {
+    for ( ; id < detections.size() && detections[id].first <= thress[t]; ++id) {}
+
+    for (uint64_t cid = id; cid < labels.rows(); ++cid) {
+      bool matched = false;
+      for (uint64_t ig = 0; ig < labels.cols(); ++ig)
+        matched = matched || labels(cid, ig) != 0;
+      if (!matched) ++n_fas[t];
+    }
+    for (uint64_t ig = 0; ig < labels.cols(); ++ig)
+      for (uint64_t cid = id; cid < labels.rows(); ++cid)
+        if (labels(cid, ig) != 0) {
+          ++n_tps[t];
+          break;
+        }
+  }
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_cluster )
+{
+  // NB: at least 64 detections per output use the grid
+  const uint64_t sizes[] = { 10, 64, 300, 2000 };
+  const int outputs[] = { 1, 3 };
+  const double thresholds[] = { 0.0, 0.01, 0.05, 0.2, 0.3, 0.5, 0.8, 0.99 };
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    for (size_t o = 0; o < sizeof(outputs) / sizeof(outputs[0]); ++o) {
+      const std::vector<bob::visioner::detection_t> raw =
+        random_detections(rng, sizes[s], outputs[o]);
+      for (size_t t = 0; t < sizeof(thresholds) / sizeof(thresholds[0]); ++t) {
+        std::vector<bob::visioner::detection_t> detections = raw, expected = raw;
+        bob::visioner::CVDetector::cluster(detections, thresholds[t], outputs[o]);
+        cluster_reference(expected, thresholds[t], outputs[o]);
+        BOOST_REQUIRE_EQUAL(detections.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+          BOOST_CHECK(detections[i] == expected[i]);
+      }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_cluster_disabled )
+{
+  const std::vector<bob::visioner::detection_t> raw =
+    random_detections(rng, 100, 2);
+  std::vector<bob::visioner::detection_t> detections = raw;
+  bob::visioner::CVDetector::cluster(detections, 1.0, 2);
+  BOOST_CHECK(detections == raw);
+}
+
+BOOST_AUTO_TEST_CASE( test_roc )
+{
+  // NB: the scores take a few values, so that many detections are tied
+  boost::uniform_int<> n_detections(0, 40), n_gts(0, 3), score(0, 19),
+    label(0, 6);
+  const uint64_t n_thress[] = { 0, 1, 2, 7, 256 };
+  for (int trial = 0; trial < 50; ++trial) {
+    const uint64_t n_images = 1 + trial % 5;
+    std::vector<std::vector<bob::visioner::detection_t> > idetections(n_images);
+    std::vector<bob::visioner::Matrix<int> > ilabels(n_images);
+    for (uint64_t i = 0; i < n_images; ++i) {
+      const uint64_t n = n_detections(rng);
+      for (uint64_t id = 0; id < n; ++id)
+        idetections[i].push_back(bob::visioner::make_detection(
+          0.25 * score(rng) - 2.0, QRectF(), 0));
+      bob::visioner::CVDetector::sort_asc(idetections[i]);
+
+      ilabels[i] = bob::visioner::Matrix<int>(n, n_gts(rng), 0);
+      for (uint64_t k = 0; k < ilabels[i].size(); ++k)
+        ilabels[i](k) = label(rng) == 0;
+    }
+
+    for (size_t k = 0; k < sizeof(n_thress) / sizeof(n_thress[0]); ++k) {
+      std::vector<double> thress;
+      bob::visioner::TestCVDetector::roc_thresholds(idetections, n_thress[k],
+        thress);
+      BOOST_REQUIRE(!thress.empty());
+      if (n_thress[k] > 0) BOOST_CHECK_EQUAL(thress.size(), n_thress[k]);
+      else BOOST_CHECK_EQUAL(thress[0], -std::numeric_limits<double>::max());
+      for (size_t t = 1; t < thress.size(); ++t)
+        BOOST_CHECK(n_thress[k] > 0 ? thress[t] >= thress[t-1] :
+          thress[t] > thress[t-1]);
+
+      std::vector<int64_t> d_tps(thress.size(), 0), d_fas(thress.size(), 0);
+      std::vector<int64_t> n_tps(thress.size(), 0), n_fas(thress.size(), 0);
+      for (uint64_t i = 0; i < n_images; ++i) {
+        bob::visioner::TestCVDetector::roc(ilabels[i], idetections[i], thress,
+          d_tps, d_fas);
+        roc_reference(ilabels[i], idetections[i], thress, n_tps, n_fas);
+      }
+
+      int64_t tps = 0, fas = 0;
+      for (size_t t = 0; t < thress.size(); ++t) {
+        tps += d_tps[t];
+        fas += d_fas[t];
+        BOOST_CHECK_EQUAL(tps, n_tps[t]);
+        BOOST_CHECK_EQUAL(fas, n_fas[t]);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,197 @@
+/**
+ * @file visioner/cxx/test/evaluate.cc
+ * @date Mon Oct 19 00:17:52 2026 +0200
+ *
+ * @brief Checks that the evaluation of the detector, of the keypoint
+ * localizer and of the classifier does not depend on the number of threads
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE visioner-Evaluate Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <boost/random.hpp>
+#include <string>
+#include <vector>
+
+#include "bob/core/logging.h"
+#include <bob/visioner/cv/cv_detector.h>
+#include <bob/visioner/cv/cv_localizer.h>
+#include <bob/visioner/cv/cv_classifier.h>
+#include <bob/visioner/model/mdecoder.h>
+#include <bob/visioner/vision/image.h>
+
+/**
+ * A few images (random pixels) with annotated faces and cars, saved to
+ * temporary files with models of random LUTs
+ */
+struct T {
+  boost::mt19937 rng;
+  std::vector<std::string> ifiles, gfiles, mfiles;
+
+  T(): rng(0) {
+    boost::uniform_int<> pixel(0, 255);
+    const struct { int x, y, w, h; const char* type; } objects[] = {
+      { 10, 12, 40, 48, "face" }, { 60, 30, 30, 36, "face" },
+      { 30, 50, 25, 30, "car" }, { 70, 5, 35, 42, "face" },
+      { 5, 40, 20, 24, "car" } };
+    for (size_t i = 0; i < 4; ++i) {
+      bob::visioner::Matrix<uint8_t> image(100, 120);
+      for (uint64_t k = 0; k < image.size(); ++k) image(k) = pixel(rng);
+
+      // NB: the last image is a background image
+      std::vector<bob::visioner::Object> gts;
+      for (size_t k = i; k < i + 2 && i < 3; ++k) {
+        bob::visioner::Object object(objects[k].type, "frontal", "0",
+          objects[k].x, objects[k].y, objects[k].w, objects[k].h);
+        object.add(bob::visioner::Keypoint("leye",
+          objects[k].x + 0.3 * objects[k].w, objects[k].y + 0.4 * objects[k].h));
+        object.add(bob::visioner::Keypoint("reye",
+          objects[k].x + 0.7 * objects[k].w, objects[k].y + 0.4 * objects[k].h));
+        gts.push_back(object);
+      }
+
+      ifiles.push_back(bob::core::tmpfile(".png"));
+      gfiles.push_back(bob::core::tmpfile(".gt"));
+      BOOST_REQUIRE(bob::visioner::convert(image).save(ifiles.back().c_str()));
+      BOOST_REQUIRE(bob::visioner::Object::save(gfiles.back(), gts));
+    }
+  }
+
+  ~T() {
+    for (size_t i = 0; i < ifiles.size(); ++i) {
+      boost::filesystem::remove(ifiles[i]);
+      boost::filesystem::remove(gfiles[i]);
+    }
+    for (size_t i = 0; i < mfiles.size(); ++i) boost::filesystem::remove(mfiles[i]);
+  }
+
+  /**
+   * Saves a MB-LBP model of 20 random LUTs per output for the given labels
+   * and sub-window labelling
+   */
+  std::string model(const char* label1, const char* label2,
+    const std::string& tagger)
+  {
+    bob::visioner::param_t param(24, 20);
+    param.m_labels.push_back(label1);
+    if (label2) param.m_labels.push_back(label2);
+    param.m_feature = "lbp";
+    param.m_tagger = tagger;
+
+    const boost::shared_ptr<bob::visioner::Model> model =
+      bob::visioner::make_model(param);
+    boost::uniform_int<uint64_t> feature(0, model->n_features() - 1);
+    boost::uniform_real<> entry(-1., 1.);
+    std::vector<std::vector<bob::visioner::LUT> > mluts(model->n_outputs());
+    for (uint64_t o = 0; o < mluts.size(); ++o)
+      for (uint64_t r = 0; r < 20; ++r) {
+        bob::visioner::LUT lut(feature(rng), model->n_fvalues());
+        for (uint64_t fv = 0; fv < lut.n_fvalues(); ++fv) lut[fv] = entry(rng);
+        mluts[o].push_back(lut);
+      }
+    BOOST_REQUIRE(model->set(mluts));
+
+    mfiles.push_back(bob::core::tmpfile(".vbin"));
+    BOOST_REQUIRE(model->save(mfiles.back()));
+    return mfiles.back();
+  }
+};
+
+/**
+ * Checks that two histograms have the same bins
+ */
+static void check_equal(const bob::visioner::Histogram& h1,
+  const bob::visioner::Histogram& h2)
+{
+  BOOST_CHECK_EQUAL(h1.n_bins(), h2.n_bins());
+  BOOST_CHECK(h1.bins() == h2.bins());
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_detector )
+{
+  const std::string mfile = model("face", "car", "object_type");
+  const uint64_t n_thress[] = { 0, 16 };
+  for (size_t k = 0; k < sizeof(n_thress) / sizeof(n_thress[0]); ++k) {
+    bob::visioner::CVDetector reference(mfile, 0.0, 0, 2, 0.05,
+      bob::visioner::CVDetector::Scanning);
+    std::vector<double> ref_fas, ref_tars;
+    reference.evaluate(ifiles, gfiles, ref_fas, ref_tars, 0, n_thress[k]);
+    BOOST_REQUIRE(!ref_fas.empty());
+
+    for (size_t threads = 1; threads < 5; threads += 3) {
+      bob::visioner::CVDetector detector(mfile, 0.0, 0, 2, 0.05,
+        bob::visioner::CVDetector::Scanning);
+      std::vector<double> fas, tars;
+      detector.evaluate(ifiles, gfiles, fas, tars, threads, n_thress[k]);
+      BOOST_CHECK(fas == ref_fas);
+      BOOST_CHECK(tars == ref_tars);
+      BOOST_CHECK_EQUAL(detector.stats().m_gts, reference.stats().m_gts);
+      BOOST_CHECK_EQUAL(detector.stats().m_sws, reference.stats().m_sws);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_localizer )
+{
+  bob::visioner::CVDetector detector(model("face", 0, "object_type"));
+  const std::string mfile = model("leye", "reye", "keypoint");
+  const bob::visioner::CVLocalizer::Type methods[] = {
+    bob::visioner::CVLocalizer::SingleShot,
+    bob::visioner::CVLocalizer::MultipleShots_Average,
+    bob::visioner::CVLocalizer::MultipleShots_Median };
+  for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); ++m) {
+    bob::visioner::CVLocalizer localizer(mfile, methods[m]);
+    std::vector<bob::visioner::Histogram> ref_histos;
+    bob::visioner::Histogram ref_histo;
+    localizer.evaluate(ifiles, gfiles, detector, ref_histos, ref_histo, 0);
+    BOOST_REQUIRE_EQUAL(ref_histos.size(), 2u);
+
+    for (size_t threads = 1; threads < 5; threads += 3) {
+      std::vector<bob::visioner::Histogram> histos;
+      bob::visioner::Histogram histo;
+      localizer.evaluate(ifiles, gfiles, detector, histos, histo, threads);
+      check_equal(histo, ref_histo);
+      BOOST_REQUIRE_EQUAL(histos.size(), ref_histos.size());
+      for (size_t k = 0; k < histos.size(); ++k) check_equal(histos[k], ref_histos[k]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_classifier )
+{
+  bob::visioner::CVDetector detector(model("face", "car", "object_type"));
+  const std::string mfile = model("face", "car", "object_type");
+
+  // NB: the classification model can only be set from the command line
+  bob::visioner::CVClassifier classifier;
+  boost::program_options::options_description po_desc;
+  classifier.add_options(po_desc);
+  const char* argv[] = { "test", "--classify_model", mfile.c_str() };
+  boost::program_options::variables_map po_vm;
+  boost::program_options::store(
+    boost::program_options::parse_command_line(3, argv, po_desc), po_vm);
+  boost::program_options::notify(po_vm);
+  BOOST_REQUIRE(classifier.decode(po_desc, po_vm));
+
+  bob::visioner::Matrix<uint64_t> ref_hits_mat;
+  std::vector<uint64_t> ref_hits_cnt;
+  classifier.evaluate(ifiles, gfiles, detector, ref_hits_mat, ref_hits_cnt, 0);
+  BOOST_REQUIRE_EQUAL(ref_hits_cnt.size(), 2u);
+
+  for (size_t threads = 1; threads < 5; threads += 3) {
+    bob::visioner::Matrix<uint64_t> hits_mat;
+    std::vector<uint64_t> hits_cnt;
+    classifier.evaluate(ifiles, gfiles, detector, hits_mat, hits_cnt, threads);
+    BOOST_CHECK(hits_mat == ref_hits_mat);
+    BOOST_CHECK(hits_cnt == ref_hits_cnt);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
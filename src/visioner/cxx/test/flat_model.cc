@@ -0,0 +1,227 @@
+/**
+ * @file visioner/cxx/test/flat_model.cc
+ * @date Mon Oct 19 11:26:08 2026 +0200
+ *
+ * @brief Saves models to the flat format and checks that the memory-mapped
+ * models score like the in-memory ones, and that invalid files are rejected
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE visioner-FlatModel Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/random.hpp>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bob/core/logging.h"
+#include <bob/visioner/model/ipyramid.h>
+#include <bob/visioner/model/mdecoder.h>
+
+/**
+ * Model parameters (two outputs), a random image scanned at several scales
+ * and the temporary model files
+ */
+struct T {
+  bob::visioner::param_t param;
+  std::vector<uint8_t> image;
+  boost::mt19937 rng;
+  std::vector<std::string> mfiles;
+
+  T(): param(24, 20), image(61 * 53), rng(0) {
+    param.m_labels.push_back("face");
+    param.m_labels.push_back("car");
+    param.m_tagger = "object_type";
+    boost::uniform_int<> pixel(0, 255);
+    for (size_t i=0; i<image.size(); ++i) image[i] = pixel(rng);
+  }
+
+  ~T() {
+    for (size_t i = 0; i < mfiles.size(); ++i) boost::filesystem::remove(mfiles[i]);
+  }
+
+  /**
+   * Makes a model of the given feature type with 30 random LUTs per output
+   */
+  boost::shared_ptr<bob::visioner::Model> model(const std::string& feature) {
+    param.m_feature = feature;
+    const boost::shared_ptr<bob::visioner::Model> model =
+      bob::visioner::make_model(param);
+    boost::uniform_int<uint64_t> f(0, model->n_features() - 1);
+    boost::uniform_real<> entry(-1., 1.);
+    std::vector<std::vector<bob::visioner::LUT> > mluts(model->n_outputs());
+    for (uint64_t o = 0; o < mluts.size(); ++o)
+      for (uint64_t r = 0; r < 30; ++r) {
+        bob::visioner::LUT lut(f(rng), model->n_fvalues());
+        for (uint64_t fv = 0; fv < lut.n_fvalues(); ++fv) lut[fv] = entry(rng);
+        mluts[o].push_back(lut);
+      }
+    BOOST_REQUIRE(model->set(mluts));
+    return model;
+  }
+
+  /**
+   * Returns a new temporary model file
+   */
+  std::string tmpfile(const std::string& extension = ".vflat") {
+    mfiles.push_back(bob::core::tmpfile(extension));
+    return mfiles.back();
+  }
+};
+
+/**
+ * Reads and writes the raw bytes of a model file
+ */
+static std::vector<char> read_bytes(const std::string& path)
+{
+  std::ifstream ifs(path.c_str(), std::ios_base::in | std::ios_base::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(ifs),
+    std::istreambuf_iterator<char>());
+}
+
+static void write_bytes(const std::string& path, const std::vector<char>& data)
+{
+  std::ofstream ofs(path.c_str(), std::ios_base::out | std::ios_base::trunc |
+    std::ios_base::binary);
+  ofs.write(&data[0], data.size());
+  BOOST_REQUIRE(ofs.good());
+}
+
+/**
+ * Checks that both models have the same LUTs and the same scores at every
+ * position of every scale of the image pyramid
+ */
+static void check_equal(T& t, bob::visioner::Model& model,
+  bob::visioner::Model& loaded)
+{
+  BOOST_REQUIRE_EQUAL(loaded.n_outputs(), model.n_outputs());
+  BOOST_CHECK_EQUAL(loaded.n_features(), model.n_features());
+  BOOST_CHECK_EQUAL(loaded.n_fvalues(), model.n_fvalues());
+  for (uint64_t o = 0; o < model.n_outputs(); ++o) {
+    BOOST_REQUIRE_EQUAL(loaded.n_luts(o), model.n_luts(o));
+    for (uint64_t r = 0; r < model.n_luts(o); ++r) {
+      const bob::visioner::LUT& lut = model.luts()[o][r];
+      const bob::visioner::LUT& lut2 = loaded.luts()[o][r];
+      BOOST_CHECK_EQUAL(lut2.feature(), lut.feature());
+      BOOST_CHECK(std::vector<double>(lut2.begin(), lut2.end()) ==
+        std::vector<double>(lut.begin(), lut.end()));
+      BOOST_CHECK_EQUAL(loaded.describe(lut.feature()), model.describe(lut.feature()));
+    }
+  }
+
+  bob::visioner::ipyramid_t pyramid(t.param);
+  BOOST_REQUIRE(pyramid.load(&t.image[0], 61, 53));
+  BOOST_REQUIRE(pyramid.size() > 2);
+  for (uint64_t s = 0; s < pyramid.size(); ++s) {
+    const bob::visioner::ipscale_t& ip = pyramid[s];
+    model.preprocess(ip);
+    loaded.preprocess(ip);
+    for (int y = ip.m_scan_min_y; y < ip.m_scan_max_y; y += ip.m_scan_dy)
+      for (int x = ip.m_scan_min_x; x < ip.m_scan_max_x; x += ip.m_scan_dx)
+        for (uint64_t o = 0; o < model.n_outputs(); ++o) {
+          BOOST_CHECK_EQUAL(loaded.score(o, x, y), model.score(o, x, y));
+          BOOST_CHECK_EQUAL(loaded.score(o, 5, 17, x, y), model.score(o, 5, 17, x, y));
+        }
+  }
+}
+
+/**
+ * Saves the model to a flat file and loads it back both ways
+ */
+static void check_round_trip(T& t, const std::string& feature)
+{
+  const boost::shared_ptr<bob::visioner::Model> model = t.model(feature);
+  const std::string path = t.tmpfile();
+  BOOST_REQUIRE(model->save(path));
+
+  boost::shared_ptr<bob::visioner::Model> loaded;
+  BOOST_REQUIRE(bob::visioner::Model::load(path, loaded));
+  check_equal(t, *model, *loaded);
+
+  const boost::shared_ptr<bob::visioner::Model> reloaded =
+    bob::visioner::make_model(t.param);
+  BOOST_REQUIRE(reloaded->load(path));
+  check_equal(t, *model, *reloaded);
+
+  // The flat file saved again from the mapped model is the same
+  const std::string path2 = t.tmpfile();
+  BOOST_REQUIRE(loaded->save(path2));
+  BOOST_CHECK(read_bytes(path2) == read_bytes(path));
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_mblbp )
+{
+  check_round_trip(*this, "lbp");
+}
+
+BOOST_AUTO_TEST_CASE( test_model_pool )
+{
+  check_round_trip(*this, "elbp");
+}
+
+BOOST_AUTO_TEST_CASE( test_rejected )
+{
+  const std::string path = tmpfile();
+  BOOST_REQUIRE(model("lbp")->save(path));
+  const std::vector<char> data = read_bytes(path);
+  BOOST_REQUIRE(data.size() > 56);
+
+  // NB: header = magic[8], version (uint32), byte order (uint32), then the
+  // parameter size and the number of outputs (uint64)
+  uint64_t param_size, n_outputs;
+  std::memcpy(&param_size, &data[16], sizeof(uint64_t));
+  std::memcpy(&n_outputs, &data[24], sizeof(uint64_t));
+  BOOST_REQUIRE_EQUAL(n_outputs, (uint64_t)2);
+  const size_t begins = 56 + ((param_size + 7) & ~(uint64_t)7);
+  const size_t features = begins + (n_outputs + 1) * sizeof(uint64_t);
+
+  boost::shared_ptr<bob::visioner::Model> loaded;
+  const std::string bad = tmpfile();
+
+  // Magic, version and byte order
+  const size_t offsets[] = { 0, 8, 12 };
+  for (size_t k = 0; k < sizeof(offsets) / sizeof(offsets[0]); ++k) {
+    std::vector<char> bad_data = data;
+    bad_data[offsets[k]] ^= 0x7f;
+    write_bytes(bad, bad_data);
+    BOOST_CHECK(!bob::visioner::Model::load(bad, loaded));
+    BOOST_CHECK(!bob::visioner::make_model(param)->load(bad));
+  }
+
+  // Truncated
+  write_bytes(bad, std::vector<char>(data.begin(), data.begin() + features));
+  BOOST_CHECK(!bob::visioner::Model::load(bad, loaded));
+
+  // Decreasing LUT ranges
+  {
+    std::vector<char> bad_data = data;
+    const uint64_t begin = 61;
+    std::memcpy(&bad_data[begins + sizeof(uint64_t)], &begin, sizeof(uint64_t));
+    write_bytes(bad, bad_data);
+    BOOST_CHECK_THROW(bob::visioner::Model::load(bad, loaded), std::runtime_error);
+  }
+
+  // Feature out of range
+  {
+    std::vector<char> bad_data = data;
+    const uint64_t feature = bob::visioner::make_model(param)->n_features();
+    std::memcpy(&bad_data[features + 3 * sizeof(uint64_t)], &feature, sizeof(uint64_t));
+    write_bytes(bad, bad_data);
+    BOOST_CHECK_THROW(bob::visioner::Model::load(bad, loaded), std::runtime_error);
+    BOOST_CHECK_THROW(bob::visioner::make_model(param)->load(bad), std::runtime_error);
+  }
+
+  // The original file is still fine
+  BOOST_CHECK(bob::visioner::Model::load(path, loaded));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,142 @@
+/**
+ * @file visioner/cxx/test/image.cc
+ * @date Sun Oct 18 23:24:47 2026 +0200
+ *
+ * @brief Checks the native scaling of grayscale images: the scaled sizes
+ * against the ones of QImage::scaled and the area averaging on small images
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE visioner-Image Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/random.hpp>
+#include <vector>
+
+#include <bob/visioner/vision/image.h>
+#include <bob/visioner/util/util.h>
+
+struct T {
+  boost::mt19937 rng;
+  std::vector<double> scales;
+
+  T(): rng(0) {
+    // NB: the scales of a pyramid with the default step, and a few others
+    for (double scale = 1.0; scale > 0.05; scale /= 1.1) scales.push_back(scale);
+    const double others[] = { 0.5, 0.25, 0.333, 0.999, 0.001, 2.0 };
+    scales.insert(scales.end(), others, others + sizeof(others) / sizeof(others[0]));
+  }
+};
+
+/**
+ * Draws a <rows> x <cols> image with random pixels
+ */
+static bob::visioner::Matrix<uint8_t> random_image(boost::mt19937& rng,
+  uint64_t rows, uint64_t cols)
+{
+  boost::uniform_int<> pixel(0, 255);
+  bob::visioner::Matrix<uint8_t> image(rows, cols);
+  for (uint64_t i = 0; i < image.size(); ++i) image(i) = pixel(rng);
+  return image;
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_scaled_size_fixed )
+{
+  const struct { uint64_t rows, cols; double scale; uint64_t new_rows, new_cols; }
+    cases[] = {
+      { 480, 640, 0.5, 240, 320 }, { 576, 720, 0.5, 288, 360 },
+      { 61, 53, 0.7, 43, 37 }, { 7, 3, 0.5, 4, 1 }, { 1, 1, 0.5, 1, 1 } };
+  for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); ++k) {
+    uint64_t new_rows, new_cols;
+    bob::visioner::scaled_size(cases[k].rows, cases[k].cols, cases[k].scale,
+      new_rows, new_cols);
+    BOOST_CHECK_EQUAL(new_rows, cases[k].new_rows);
+    BOOST_CHECK_EQUAL(new_cols, cases[k].new_cols);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_scaled_size_qimage )
+{
+  // The sizes must be the ones previously given by scaling through QImage
+  const uint64_t sizes[] = { 1, 2, 3, 5, 19, 24, 53, 61, 120, 240, 333, 480, 640 };
+  const size_t n_sizes = sizeof(sizes) / sizeof(sizes[0]);
+  for (size_t r = 0; r < n_sizes; ++r)
+    for (size_t c = 0; c < n_sizes; ++c)
+      for (size_t s = 0; s < scales.size(); ++s) {
+        const uint64_t rows = sizes[r], cols = sizes[c];
+        const double scale = bob::visioner::range(scales[s], 0.01, 1.00);
+        const int new_w = (int)(0.5 + scale * cols);
+        const int new_h = (int)(0.5 + scale * rows);
+        const QImage qimage = QImage(cols, rows, QImage::Format_RGB32).scaled(
+          new_w, new_h, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        if (qimage.isNull()) continue; // empty sizes are clamped to 1 now
+
+        uint64_t new_rows, new_cols;
+        bob::visioner::scaled_size(rows, cols, scales[s], new_rows, new_cols);
+        BOOST_CHECK_EQUAL(new_rows, (uint64_t)qimage.height());
+        BOOST_CHECK_EQUAL(new_cols, (uint64_t)qimage.width());
+      }
+}
+
+BOOST_AUTO_TEST_CASE( test_resample_constant )
+{
+  bob::visioner::Matrix<float> buffer;
+  const uint8_t values[] = { 0, 1, 127, 254, 255 };
+  const uint64_t sizes[][2] = { {1, 1}, {1, 7}, {5, 1}, {9, 13}, {24, 20},
+    {61, 53} };
+  for (size_t v = 0; v < sizeof(values) / sizeof(values[0]); ++v)
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k) {
+      const bob::visioner::Matrix<uint8_t> src(sizes[k][0], sizes[k][1], values[v]);
+      for (uint64_t rows = 1; rows <= src.rows(); ++rows)
+        for (uint64_t cols = 1; cols <= src.cols(); ++cols) {
+          bob::visioner::Matrix<uint8_t> dst;
+          bob::visioner::resample(src, rows, cols, dst, buffer);
+          BOOST_REQUIRE_EQUAL(dst.rows(), rows);
+          BOOST_REQUIRE_EQUAL(dst.cols(), cols);
+          BOOST_CHECK(dst == bob::visioner::Matrix<uint8_t>(rows, cols, values[v]));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_resample_halve )
+{
+  bob::visioner::Matrix<float> buffer;
+  const uint64_t sizes[][2] = { {2, 2}, {2, 8}, {6, 2}, {24, 20}, {60, 52} };
+  for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k) {
+    const bob::visioner::Matrix<uint8_t> src =
+      random_image(rng, sizes[k][0], sizes[k][1]);
+    bob::visioner::Matrix<uint8_t> dst;
+    bob::visioner::resample(src, src.rows() / 2, src.cols() / 2, dst, buffer);
+    BOOST_REQUIRE_EQUAL(dst.rows(), src.rows() / 2);
+    BOOST_REQUIRE_EQUAL(dst.cols(), src.cols() / 2);
+
+    // Each pixel is the rounded mean of its 2x2 block
+    for (uint64_t y = 0; y < dst.rows(); ++y)
+      for (uint64_t x = 0; x < dst.cols(); ++x) {
+        const int sum = src(2 * y, 2 * x) + src(2 * y, 2 * x + 1) +
+          src(2 * y + 1, 2 * x) + src(2 * y + 1, 2 * x + 1);
+        BOOST_CHECK_EQUAL((int)dst(y, x), (sum + 2) / 4);
+      }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_resample_identity )
+{
+  bob::visioner::Matrix<float> buffer;
+  const bob::visioner::Matrix<uint8_t> src = random_image(rng, 13, 9);
+  bob::visioner::Matrix<uint8_t> dst, scaled;
+  bob::visioner::resample(src, 13, 9, dst, buffer);
+  BOOST_CHECK(dst == src);
+
+  // Larger sizes are clamped to the size of the source image
+  bob::visioner::resample(src, 100, 100, dst, buffer);
+  BOOST_CHECK(dst == src);
+  BOOST_CHECK(bob::visioner::scale(src, 1.0, scaled));
+  BOOST_CHECK(scaled == src);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,246 @@
+/**
+ * @file visioner/cxx/test/lut_problem.cc
+ * @date Sun Oct 18 22:58:14 2026 +0200
+ *
+ * @brief Compares the single pass line-search and score updates of the EPT
+ * and VAR boosting problems with the two pass computation
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE visioner-LUTProblem Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/random.hpp>
+#include <cmath>
+#include <vector>
+
+#include <bob/visioner/model/trainers/lutproblems/lut_problem_ept.h>
+#include <bob/visioner/model/trainers/lutproblems/lut_problem_var.h>
+
+/**
+ * Exposes the buffers of a LUT problem, and computes the line-search loss
+ * and gradient as they were computed before the single pass: the candidate
+ * scores of all samples first, then the loss values and derivatives.
+ */
+template <typename TProblem>
+class Probe: public TProblem
+{
+  public:
+    Probe(const bob::visioner::DataSet& data,
+        const bob::visioner::param_t& param, size_t threads, bool compact)
+      : TProblem(data, param, threads, compact), m_lambda(-1.0) {}
+
+    Probe(const bob::visioner::DataSet& data,
+        const bob::visioner::param_t& param, double lambda, size_t threads,
+        bool compact)
+      : TProblem(data, param, lambda, threads, compact), m_lambda(lambda) {}
+
+    const std::vector<double>& values() const { return this->m_values; }
+    const bob::visioner::Matrix<double>& grad() const { return this->m_grad; }
+
+    // Sets the weak learner and buffers its scores
+    void set_luts(const std::vector<bob::visioner::LUT>& luts)
+    {
+      this->m_luts = luts;
+      for (uint64_t s = 0; s < this->n_samples(); ++s)
+        for (uint64_t o = 0; o < this->n_outputs(); ++o) {
+          const bob::visioner::LUT& lut = this->m_luts[o];
+          const double score = lut[this->fvalue(lut.feature(), s)];
+          if (this->compact()) this->m_fwscores(s, o) = score;
+          else this->m_wscores(s, o) = score;
+        }
+    }
+
+    double reference(const double* x, double* g) const
+    {
+      const uint64_t n_samples = this->n_samples(), n_outputs = this->n_outputs();
+
+      bob::visioner::Matrix<double> cscores(n_samples, n_outputs);
+      std::vector<double> buffer(n_outputs);
+      for (uint64_t s = 0; s < n_samples; ++s) {
+        const double* sscores = this->sscores(s, &buffer[0]);
+        for (uint64_t o = 0; o < n_outputs; ++o)
+          cscores(s, o) = sscores[o] + x[o] * this->wscore(s, o);
+      }
+
+      std::vector<double> values(n_samples);
+      bob::visioner::Matrix<double> grad(n_samples, n_outputs);
+      for (uint64_t s = 0; s < n_samples; ++s) {
+        this->m_loss.eval(this->target(s), cscores[s], n_outputs, values[s],
+          grad[s]);
+        values[s] *= this->cost(s);
+        for (uint64_t o = 0; o < n_outputs; ++o) grad(s, o) *= this->cost(s);
+      }
+
+      double fx = 0.0;
+      if (m_lambda < 0.0) {
+        for (uint64_t s = 0; s < n_samples; ++s) fx += values[s];
+      }
+      else {
+        const double scale1 = m_lambda * n_samples, scale2 = 1.0 - m_lambda;
+        double sum = 0.0, sum_sq = 0.0;
+        for (uint64_t s = 0; s < n_samples; ++s) {
+          sum += values[s];
+          sum_sq += values[s] * values[s];
+        }
+        for (uint64_t s = 0; s < n_samples; ++s)
+          for (uint64_t o = 0; o < n_outputs; ++o)
+            grad(s, o) = 2.0 * grad(s, o) * (scale1 * values[s] + scale2 * sum);
+        fx = scale1 * sum_sq + scale2 * sum * sum;
+      }
+
+      std::fill(g, g + n_outputs, 0.0);
+      for (uint64_t s = 0; s < n_samples; ++s)
+        for (uint64_t o = 0; o < n_outputs; ++o)
+          g[o] += grad(s, o) * this->wscore(s, o);
+      return fx;
+    }
+
+  private:
+    double m_lambda;
+};
+
+typedef Probe<bob::visioner::LUTProblemEPT> ProbeEPT;
+typedef Probe<bob::visioner::LUTProblemVAR> ProbeVAR;
+
+/**
+ * A small data set with two outputs and costs
+ */
+struct T {
+  bob::visioner::DataSet data;
+  bob::visioner::param_t param;
+  std::vector<std::vector<double> > xs;
+
+  T(): data(2, 500, 12, 16) {
+    boost::mt19937 rng(0);
+    boost::uniform_int<> sign(0, 1), fvalue(0, 15);
+    boost::uniform_real<> cost(0.5, 2.0);
+    for (uint64_t s = 0; s < data.n_samples(); ++s) {
+      for (uint64_t o = 0; o < data.n_outputs(); ++o)
+        data.target(s, o) = sign(rng) ? 1.0 : -1.0;
+      for (uint64_t f = 0; f < data.n_features(); ++f)
+        data.value(f, s) = fvalue(rng);
+      data.cost(s) = cost(rng);
+    }
+
+    const double x[][2] = { {0., 0.}, {0.3, 0.3}, {-0.7, 1.5}, {2., 0.1} };
+    for (size_t k = 0; k < sizeof(x) / sizeof(x[0]); ++k)
+      xs.push_back(std::vector<double>(x[k], x[k] + 2));
+  }
+};
+
+/**
+ * Checks that the relative difference between a and b is below eps
+ */
+static void check_close(double a, double b, double eps)
+{
+  BOOST_CHECK_SMALL(a - b, eps * (1.0 + std::fabs(b)));
+}
+
+/**
+ * Runs two boosting rounds (the second one with non-zero strong learner's
+ * scores) and compares the line-search with the two pass computation, then
+ * the compact problem with the double one on the same weak learners
+ */
+template <typename TProbe>
+static void check_linesearch(TProbe& probe, TProbe& compact_probe,
+  const std::vector<std::vector<double> >& xs)
+{
+  // NB: the VAR problem hides some overloads of the public interface
+  bob::visioner::LUTProblem& problem = probe;
+  bob::visioner::LUTProblem& compact = compact_probe;
+  const uint64_t n_outputs = problem.n_outputs();
+  std::vector<double> g(n_outputs), g_ref(n_outputs), g_compact(n_outputs);
+
+  problem.update_loss_deriv();
+  compact.update_loss_deriv();
+  for (int round = 0; round < 2; ++round) {
+    problem.select();
+    probe.set_luts(problem.luts());
+    compact_probe.set_luts(problem.luts());
+
+    for (size_t k = 0; k < xs.size(); ++k) {
+      const double fx = problem.linesearch(&xs[k][0], &g[0]);
+      const double fx_ref = probe.reference(&xs[k][0], &g_ref[0]);
+      const double fx_compact = compact.linesearch(&xs[k][0], &g_compact[0]);
+      check_close(fx, fx_ref, 1e-10);
+      check_close(fx_compact, fx, 1e-4);
+      for (uint64_t o = 0; o < n_outputs; ++o) {
+        check_close(g[o], g_ref[o], 1e-10);
+        check_close(g_compact[o], g[o], 1e-4);
+      }
+    }
+
+    std::vector<bob::visioner::LUT> luts = problem.luts();
+    for (uint64_t o = 0; o < n_outputs; ++o) luts[o].scale(0.5);
+    problem.update_scores_loss_deriv(luts);
+    compact.update_scores_loss_deriv(luts);
+    check_close(compact.value(), problem.value(), 1e-4);
+  }
+}
+
+/**
+ * Checks that updating the scores and then the loss values and derivatives
+ * in a single pass gives the same results as doing it in two passes
+ */
+template <typename TProbe>
+static void check_update(TProbe& fused_probe, TProbe& separate_probe)
+{
+  bob::visioner::LUTProblem& fused = fused_probe;
+  bob::visioner::LUTProblem& separate = separate_probe;
+  fused.update_loss_deriv();
+  fused.select();
+  std::vector<bob::visioner::LUT> luts = fused.luts();
+  for (uint64_t o = 0; o < luts.size(); ++o) luts[o].scale(0.25);
+
+  fused.update_scores_loss_deriv(luts);
+  separate.update_scores(luts);
+  separate.update_loss_deriv();
+
+  BOOST_CHECK_EQUAL(fused.value(), separate.value());
+  BOOST_CHECK(fused_probe.values() == separate_probe.values());
+  BOOST_CHECK(fused_probe.grad() == separate_probe.grad());
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_ept_linesearch )
+{
+  for (size_t threads = 0; threads < 4; threads += 3) {
+    ProbeEPT problem(data, param, threads, false);
+    ProbeEPT compact(data, param, threads, true);
+    check_linesearch(problem, compact, xs);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_var_linesearch )
+{
+  for (size_t threads = 0; threads < 4; threads += 3) {
+    ProbeVAR problem(data, param, 0.1, threads, false);
+    ProbeVAR compact(data, param, 0.1, threads, true);
+    check_linesearch(problem, compact, xs);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_ept_update )
+{
+  for (size_t threads = 0; threads < 4; threads += 3) {
+    ProbeEPT fused(data, param, threads, false), separate(data, param, threads, false);
+    check_update(fused, separate);
+    ProbeEPT cfused(data, param, threads, true), cseparate(data, param, threads, true);
+    check_update(cfused, cseparate);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_var_update )
+{
+  for (size_t threads = 0; threads < 4; threads += 3) {
+    ProbeVAR fused(data, param, 0.1, threads, false);
+    ProbeVAR separate(data, param, 0.1, threads, false);
+    check_update(fused, separate);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,132 @@
+/**
+ * @file visioner/cxx/test/mblbp.cc
+ * @date Sun Oct 18 22:04:31 2026 +0200
+ *
+ * @brief Compares the compiled scoring of the LUTs of the MB-LBP and MB-MCT
+ * models with the feature by feature (get()-based) scoring
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE visioner-MBLBP Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/random.hpp>
+#include <vector>
+
+#include <bob/visioner/model/ipyramid.h>
+#include <bob/visioner/model/models/mblbp_model.h>
+
+/**
+ * Model parameters (two outputs) and a random image scanned at several
+ * scales
+ */
+struct T {
+  bob::visioner::param_t param;
+  std::vector<uint8_t> image;
+  boost::mt19937 rng;
+
+  T(): param(24, 20), image(61 * 53), rng(0) {
+    param.m_labels.push_back("face");
+    param.m_labels.push_back("eye");
+    boost::uniform_int<> pixel(0, 255);
+    for (size_t i=0; i<image.size(); ++i) image[i] = pixel(rng);
+  }
+};
+
+/**
+ * Draws <n> LUTs per output with random features and entries
+ */
+static std::vector<std::vector<bob::visioner::LUT> > random_luts(
+  boost::mt19937& rng, const bob::visioner::Model& model, uint64_t n)
+{
+  boost::uniform_int<uint64_t> feature(0, model.n_features() - 1);
+  boost::uniform_real<> entry(-1., 1.);
+  std::vector<std::vector<bob::visioner::LUT> > mluts(model.n_outputs());
+  for (uint64_t o = 0; o < mluts.size(); ++o)
+    for (uint64_t r = 0; r < n; ++r) {
+      bob::visioner::LUT lut(feature(rng), model.n_fvalues());
+      for (uint64_t fv = 0; fv < lut.n_fvalues(); ++fv) lut[fv] = entry(rng);
+      mluts[o].push_back(lut);
+    }
+  return mluts;
+}
+
+/**
+ * Sums the entries of the LUTs [rbegin, rend) of the output <o>, indexed by
+ * the feature values returned by Model::get()
+ */
+static double get_score(const bob::visioner::Model& model, uint64_t o,
+  uint64_t rbegin, uint64_t rend, int x, int y)
+{
+  const std::vector<bob::visioner::LUT>& luts = model.luts()[o];
+  double sum = 0.0;
+  for (uint64_t r = rbegin; r < rend; ++r)
+    sum += luts[r][model.get(luts[r].feature(), x, y)];
+  return sum;
+}
+
+/**
+ * Checks the compiled scores at every position of every scale of the image
+ * pyramid, for the whole LUT range of each output and for sub-ranges (the
+ * levels of a cascade). The LUTs are replaced after the preprocessing of
+ * the second scale, which should switch to the get()-based scoring.
+ */
+template <typename TModel>
+static void check_scores(T& t)
+{
+  TModel mb_model(t.param);
+  bob::visioner::Model& model = mb_model;
+  BOOST_REQUIRE(model.set(random_luts(t.rng, model, 40)));
+
+  bob::visioner::ipyramid_t pyramid(t.param);
+  BOOST_REQUIRE(pyramid.load(&t.image[0], 61, 53));
+  BOOST_REQUIRE(pyramid.size() > 2);
+
+  const uint64_t ranges[][2] = { {0, 40}, {0, 1}, {3, 17}, {17, 40}, {5, 5} };
+  for (uint64_t s = 0; s < pyramid.size(); ++s) {
+    const bob::visioner::ipscale_t& ip = pyramid[s];
+    model.preprocess(ip);
+    if (s == 1) BOOST_REQUIRE(model.set(random_luts(t.rng, model, 40)));
+
+    for (int y = ip.m_scan_min_y; y < ip.m_scan_max_y; y += ip.m_scan_dy)
+      for (int x = ip.m_scan_min_x; x < ip.m_scan_max_x; x += ip.m_scan_dx)
+        for (uint64_t o = 0; o < model.n_outputs(); ++o) {
+          BOOST_CHECK_EQUAL(model.score(o, x, y),
+            get_score(model, o, 0, model.n_luts(o), x, y));
+          for (size_t k = 0; k < sizeof(ranges) / sizeof(ranges[0]); ++k)
+            BOOST_CHECK_EQUAL(model.score(o, ranges[k][0], ranges[k][1], x, y),
+              get_score(model, o, ranges[k][0], ranges[k][1], x, y));
+        }
+  }
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_mblbp_score )
+{
+  check_scores<bob::visioner::MBLBPModel>(*this);
+}
+
+BOOST_AUTO_TEST_CASE( test_mbmlbp_score )
+{
+  check_scores<bob::visioner::MBmLBPModel>(*this);
+}
+
+BOOST_AUTO_TEST_CASE( test_mbtlbp_score )
+{
+  check_scores<bob::visioner::MBtLBPModel>(*this);
+}
+
+BOOST_AUTO_TEST_CASE( test_mbdlbp_score )
+{
+  check_scores<bob::visioner::MBdLBPModel>(*this);
+}
+
+BOOST_AUTO_TEST_CASE( test_mbmct_score )
+{
+  check_scores<bob::visioner::MBMCTModel>(*this);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,126 @@
+/**
+ * @file visioner/cxx/test/sampler.cc
+ * @date Sun Oct 18 23:51:36 2026 +0200
+ *
+ * @brief Checks that the samples loaded by the Sampler do not depend on the
+ * compact storage of the scaled images nor on the number of loading threads
+ *
+ * Copyright (C) 2011-2013 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE visioner-Sampler Tests
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/random.hpp>
+#include <string>
+#include <vector>
+
+#include "bob/core/logging.h"
+#include <bob/visioner/model/sampler.h>
+#include <bob/visioner/model/mdecoder.h>
+#include <bob/visioner/vision/image.h>
+#include <bob/visioner/vision/object.h>
+
+/**
+ * A small list of images (random pixels) with faces, an object of an
+ * unknown type and a background image, saved to temporary files
+ */
+struct T {
+  bob::visioner::param_t param;
+  std::vector<std::string> ifiles, gfiles;
+
+  T(): param(12, 10) {
+    param.m_labels.push_back("face");
+    param.m_feature = "lbp";
+
+    boost::mt19937 rng(0);
+    std::vector<bob::visioner::Object> objects;
+    objects.push_back(bob::visioner::Object("face", "frontal", "0", 30, 20, 30, 36));
+    add(rng, 96, 80, objects);
+
+    objects.clear();
+    objects.push_back(bob::visioner::Object("face", "frontal", "0", 5, 5, 20, 24));
+    objects.push_back(bob::visioner::Object("face", "frontal", "0", 40, 50, 25, 30));
+    objects.push_back(bob::visioner::Object("car", "frontal", "0", 10, 60, 20, 24));
+    add(rng, 90, 70, objects);
+
+    objects.clear();
+    add(rng, 60, 50, objects);
+  }
+
+  ~T() {
+    for (size_t i = 0; i < ifiles.size(); ++i) {
+      boost::filesystem::remove(ifiles[i]);
+      boost::filesystem::remove(gfiles[i]);
+    }
+  }
+
+  void add(boost::mt19937& rng, uint64_t rows, uint64_t cols,
+    const std::vector<bob::visioner::Object>& objects)
+  {
+    boost::uniform_int<> pixel(0, 255);
+    bob::visioner::Matrix<uint8_t> image(rows, cols);
+    for (uint64_t i = 0; i < image.size(); ++i) image(i) = pixel(rng);
+
+    ifiles.push_back(bob::core::tmpfile(".png"));
+    gfiles.push_back(bob::core::tmpfile(".gt"));
+    BOOST_REQUIRE(bob::visioner::convert(image).save(ifiles.back().c_str()));
+    BOOST_REQUIRE(bob::visioner::Object::save(gfiles.back(), objects));
+  }
+};
+
+/**
+ * Maps every third sample of the sampler to a dataset
+ */
+static void map_samples(const bob::visioner::Sampler& sampler,
+  const bob::visioner::Model& model, size_t threads,
+  bob::visioner::DataSet& data)
+{
+  std::vector<uint64_t> samples;
+  for (uint64_t s = 0; s < sampler.n_samples(); s += 3) samples.push_back(s);
+  sampler.map(samples, model, data, threads);
+}
+
+BOOST_FIXTURE_TEST_SUITE( test_setup, T )
+
+BOOST_AUTO_TEST_CASE( test_load )
+{
+  const boost::shared_ptr<bob::visioner::Model> model =
+    bob::visioner::make_model(param);
+
+  bob::visioner::Sampler reference(param, bob::visioner::Sampler::TrainSampler, 3);
+  reference.load(ifiles, gfiles, 0);
+  BOOST_REQUIRE(reference.n_samples() > 0);
+  BOOST_REQUIRE_EQUAL(reference.tcounts().size(), 2u);
+  BOOST_REQUIRE(reference.tcounts()[0] > 0 && reference.tcounts()[1] > 0);
+
+  bob::visioner::DataSet ref_data;
+  map_samples(reference, *model, 0, ref_data);
+
+  for (int compact = 0; compact < 2; ++compact)
+    for (size_t threads = 0; threads < 4; threads += 3) {
+      bob::visioner::Sampler sampler(param,
+        bob::visioner::Sampler::TrainSampler, 3, compact != 0);
+      sampler.load(ifiles, gfiles, threads);
+
+      BOOST_CHECK_EQUAL(sampler.n_images(), reference.n_images());
+      BOOST_CHECK_EQUAL(sampler.n_samples(), reference.n_samples());
+      BOOST_CHECK(sampler.tcounts() == reference.tcounts());
+      if (compact) {
+        for (uint64_t i = 0; i < sampler.n_images(); ++i)
+          BOOST_CHECK(sampler.images()[i].m_image.size() <=
+            reference.images()[i].m_image.size());
+      }
+
+      bob::visioner::DataSet data;
+      map_samples(sampler, *model, threads, data);
+      BOOST_REQUIRE_EQUAL(data.n_samples(), ref_data.n_samples());
+      BOOST_CHECK(data.targets() == ref_data.targets());
+      BOOST_CHECK(data.values() == ref_data.values());
+      BOOST_CHECK(data.costs() == ref_data.costs());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
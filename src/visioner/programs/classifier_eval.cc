@@ -26,7 +26,9 @@ int main(int argc, char *argv[]) {
     ("help,h", "help message");
   po_desc.add_options()
     ("data", boost::program_options::value<std::string>(), 
-     "test datasets");
+     "test datasets")
+    ("threads", boost::program_options::value<size_t>()->default_value(boost::thread::hardware_concurrency()),
+     "number of threads to process the images (0 to use the current thread)");
   detector.add_options(po_desc);
   classifier.add_options(po_desc);
 
@@ -48,6 +50,7 @@ int main(int argc, char *argv[]) {
   }
 
   const std::string cmd_data = po_vm["data"].as<std::string>();
+  const size_t cmd_threads = po_vm["threads"].as<size_t>();
 
   // Load the test datasets
   std::vector<std::string> ifiles, gfiles;
@@ -61,7 +64,7 @@ int main(int argc, char *argv[]) {
   bob::visioner::Matrix<uint64_t> hits_mat;
   std::vector<uint64_t> hits_cnt;
 
-  classifier.evaluate(ifiles, gfiles, detector, hits_mat, hits_cnt);
+  classifier.evaluate(ifiles, gfiles, detector, hits_mat, hits_cnt, cmd_threads);
 
   // Display the confusion matrix
   const uint64_t n_classes = classifier.n_classes();
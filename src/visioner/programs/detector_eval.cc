@@ -26,7 +26,11 @@ int main(int argc, char *argv[]) {
     ("data", boost::program_options::value<std::string>(),
      "test datasets")
     ("roc", boost::program_options::value<std::string>(),
-     "file to save the ROC points");
+     "file to save the ROC points")
+    ("roc_points", boost::program_options::value<uint64_t>()->default_value(256),
+     "number of threshold values to sample the ROC (0 for the full curve: every distinct detection score)")
+    ("threads", boost::program_options::value<size_t>()->default_value(boost::thread::hardware_concurrency()),
+     "number of threads to process the images (0 to use the current thread)");
   detector.add_options(po_desc);
 
   boost::program_options::variables_map po_vm;
@@ -47,6 +51,8 @@ int main(int argc, char *argv[]) {
   }
 
   const std::string cmd_data = po_vm["data"].as<std::string>();
+  const size_t cmd_threads = po_vm["threads"].as<size_t>();
+  const uint64_t cmd_roc_points = po_vm["roc_points"].as<uint64_t>();
   const std::string cmd_roc = po_vm.count("roc") ? po_vm["roc"].as<std::string>() : "";
 
   // Load the test datasets
@@ -60,7 +66,7 @@ int main(int argc, char *argv[]) {
 
   // Build the ROC curve
   std::vector<double> fas, tars;
-  detector.evaluate(ifiles, gfiles, fas, tars);
+  detector.evaluate(ifiles, gfiles, fas, tars, cmd_threads, cmd_roc_points);
 
   // ... and save it to file: TAR + FA
   if (bob::visioner::save_roc(fas, tars, cmd_roc) == false)
@@ -34,7 +34,9 @@ int main(int argc, char *argv[]) {
     ("data", boost::program_options::value<std::string>(), 
      "test datasets")
     ("results", boost::program_options::value<std::string>()->default_value("./"),
-     "directory to save images to");	
+     "directory to save images to")
+    ("threads", boost::program_options::value<size_t>()->default_value(boost::thread::hardware_concurrency()),
+     "number of threads to localize the keypoints (0 to use the current thread)");	
   detector.add_options(po_desc);
   localizer.add_options(po_desc);
 
@@ -57,6 +59,7 @@ int main(int argc, char *argv[]) {
 
   const std::string cmd_data = po_vm["data"].as<std::string>();
   const std::string cmd_results = po_vm["results"].as<std::string>();
+  localizer.m_threads = po_vm["threads"].as<size_t>();
 
   // Load the test datasets
   std::vector<std::string> ifiles, gfiles;
@@ -93,21 +96,25 @@ int main(int argc, char *argv[]) {
     QImage qimage = bob::visioner::draw_gt(detector.ipscale());
     bob::visioner::draw_detections(qimage, detections, detector.param(), labels);
 
-    // Localize keypoints
+    // Localize keypoints (for all the matched detections at once)
     bob::visioner::Object object;
-    std::vector<QPointF> dt_points;
+    std::vector<bob::visioner::detection_t> mdetections;
     for (std::vector<bob::visioner::detection_t>::const_iterator it = detections.begin(); it != detections.end(); ++ it)
       if (detector.match(*it, object) == true)
       {
-        if (localizer.locate(detector, it->second.first, dt_points) == false)
-        {
-          bob::core::warn << "Failed to localize the keypoints for the <" << ifile << "> image!" << std::endl;
-          continue;
-        }          
-
-        bob::visioner::draw_points(qimage, dt_points);
+        mdetections.push_back(*it);
       }
 
+    std::vector<std::vector<QPointF> > dt_points;
+    if (localizer.locate(detector, mdetections, dt_points) < mdetections.size())
+    {
+      bob::core::warn << "Failed to localize the keypoints for the <" << ifile << "> image!" << std::endl;
+    }
+    for (std::size_t k = 0; k < dt_points.size(); k ++)
+    {
+      bob::visioner::draw_points(qimage, dt_points[k]);
+    }
+
     qimage.save((cmd_results + "/" + bob::visioner::basename(ifiles[i]) + ".loc.png").c_str());
 
     bob::core::info 
@@ -28,7 +28,9 @@ int main(int argc, char *argv[]) {
     ("data", boost::program_options::value<std::string>(), 
      "test datasets")
     ("loc", boost::program_options::value<std::string>(), 
-     "base filename to save the localization results");	
+     "base filename to save the localization results")
+    ("threads", boost::program_options::value<size_t>()->default_value(boost::thread::hardware_concurrency()),
+     "number of threads to process the images (0 to use the current thread)");	
   detector.add_options(po_desc);
   localizer.add_options(po_desc);
 
@@ -51,6 +53,7 @@ int main(int argc, char *argv[]) {
   }
 
   const std::string cmd_data = po_vm["data"].as<std::string>();
+  const size_t cmd_threads = po_vm["threads"].as<size_t>();
   const std::string cmd_loc = po_vm["loc"].as<std::string>();
 
   // Load the test datasets
@@ -65,7 +68,7 @@ int main(int argc, char *argv[]) {
   bob::visioner::Histogram histo;	
   std::vector<bob::visioner::Histogram> histos;
 
-  localizer.evaluate(ifiles, gfiles, detector, histos, histo);
+  localizer.evaluate(ifiles, gfiles, detector, histos, histo, cmd_threads);
 
   // Save the histograms and the cumulated histograms
   histo.norm();
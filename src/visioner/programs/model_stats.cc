@@ -13,6 +13,7 @@
 #include "bob/core/logging.h"
 
 #include "bob/visioner/model/mdecoder.h"
+#include "bob/visioner/util/timer.h"
 
 int main(int argc, char *argv[]) {
 
@@ -20,7 +21,9 @@ int main(int argc, char *argv[]) {
   boost::program_options::options_description po_desc("", 160);
   po_desc.add_options()
     ("input", boost::program_options::value<std::string>(), 
-     "input model file");	
+     "input model file")
+    ("output", boost::program_options::value<std::string>(), 
+     "convert the model to this file (e.g. '.vflat' for the memory-mapped flat binary format)");	
 
   boost::program_options::variables_map po_vm;
   boost::program_options::store(
@@ -40,6 +43,7 @@ int main(int argc, char *argv[]) {
   const std::string cmd_input = po_vm["input"].as<std::string>();
 
   // Load the model
+  bob::visioner::Timer timer;
   boost::shared_ptr<bob::visioner::Model> model;
   if (bob::visioner::Model::load(cmd_input, model) == false)
   {
@@ -47,6 +51,20 @@ int main(int argc, char *argv[]) {
       << "Failed to load the model <" << cmd_input << ">!" << std::endl;
     exit(EXIT_FAILURE);
   }
+  bob::core::info
+    << "Loaded the model <" << cmd_input << "> in " << timer.elapsed() << "s." << std::endl;
+
+  // Convert the model
+  if (po_vm.count("output"))
+  {
+    const std::string cmd_output = po_vm["output"].as<std::string>();
+    if (model->save(cmd_output) == false)
+    {
+      bob::core::error 
+        << "Failed to save the model <" << cmd_output << ">!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
 
   // Display statistics
   bob::core::info
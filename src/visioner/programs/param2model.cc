@@ -27,7 +27,7 @@ int main(int argc, char *argv[]) {
   param.add_options(po_desc);
   po_desc.add_options()
     ("model", boost::program_options::value<std::string>(),
-     "model");
+     "model (the format is chosen by extension: '.vbin' or '.vbgz' binary archive, '.vflat' flat binary, otherwise text archive)");
 
   boost::program_options::variables_map po_vm;
   boost::program_options::store(
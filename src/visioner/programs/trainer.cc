@@ -19,7 +19,7 @@
 #include "bob/visioner/model/sampler.h"
 
 // Train the <model>
-static bool train(bob::visioner::Model& model) {
+static bool train(bob::visioner::Model& model, bool compact) {
   bob::visioner::Timer timer;
 
   const bob::visioner::param_t param = model.param();
@@ -34,7 +34,9 @@ static bool train(bob::visioner::Model& model) {
   for (uint64_t p = 0; p <= param.m_projections; p ++, model.project())
   {
     timer.restart();
-    if (bob::visioner::make_trainer(param)->train(t_sampler, v_sampler, model,
+    const boost::shared_ptr<bob::visioner::Trainer> trainer = bob::visioner::make_trainer(param);
+    trainer->setCompact(compact);
+    if (trainer->train(t_sampler, v_sampler, model,
           boost::thread::hardware_concurrency()) == false)
     {
       bob::core::error << "Failed to train the model!" << std::endl;
@@ -57,7 +59,9 @@ int main(int argc, char *argv[]) {
     ("help,h", "help message");
   po_desc.add_options()
     ("model", boost::program_options::value<std::string>(),
-     "model");
+     "model")
+    ("compact", 
+     "keep the training scores in single precision (less memory and bandwidth)");
   param.add_options(po_desc);
 
   boost::program_options::variables_map po_vm;
@@ -81,7 +85,7 @@ int main(int argc, char *argv[]) {
   // Train the model	
   bob::visioner::Timer timer;
   boost::shared_ptr<bob::visioner::Model> model = make_model(param);
-  if (train(*model) == false)
+  if (train(*model, po_vm.count("compact") > 0) == false)
   {
     bob::core::error << "Failed to train the model!" << std::endl;
     exit(EXIT_FAILURE);
@@ -62,6 +62,33 @@ static boost::python::object detect(bob::visioner::CVDetector& det,
   return boost::python::tuple(tmp);
 }
 
+static boost::python::object track(bob::visioner::CVDetector& det,
+    bob::python::const_ndarray image) {
+  
+  blitz::Array<uint8_t,2> bzimage = image.bz<uint8_t,2>();
+  std::vector<bob::visioner::detection_t> detections;
+  det.track(bzimage.data(), bzimage.rows(), bzimage.cols(), detections);
+  
+  if (detections.size() == 0) {
+    return boost::python::object();
+  }
+
+  det.sort_desc(detections);
+
+  // Returns a tuple containing all detections, with descending scores
+  boost::python::list tmp;
+  qreal x, y, width, height;
+  for (size_t i=0; i<detections.size(); ++i) {
+    detections[i].second.first.getRect(&x, &y, &width, &height);
+    tmp.append(boost::python::make_tuple(x, y, width, height, detections[i].first));
+  }
+  return boost::python::tuple(tmp);
+}
+
+static double frame_timing(const bob::visioner::CVDetector& det) {
+  return det.stats().m_frame_timing;
+}
+
 static boost::python::object locate(bob::visioner::CVLocalizer& loc,
     bob::visioner::CVDetector& det, bob::python::const_ndarray image) {
 
@@ -100,13 +127,49 @@ static boost::python::object locate(bob::visioner::CVLocalizer& loc,
   return boost::python::make_tuple(bbox, boost::python::tuple(tmp));
 }
 
+static boost::python::object locate_all(bob::visioner::CVLocalizer& loc,
+    bob::visioner::CVDetector& det, bob::python::const_ndarray image) {
+
+  blitz::Array<uint8_t,2> bzimage = image.bz<uint8_t,2>();
+  det.load(bzimage.data(), bzimage.rows(), bzimage.cols());
+  std::vector<bob::visioner::detection_t> detections;
+  det.scan(detections);
+
+  det.sort_desc(detections);
+
+  // Locate keypoints for all detections at once (sharing the image pyramid):
+  // there is no ground truth to match the detections with in a raw image
+  std::vector<std::vector<QPointF> > dt_points;
+  loc.locate(det, detections, dt_points);
+
+  // Returns a tuple of 2-tuples, one for each localized detection:
+  // [0] => The region bounding box as x, y, width, height
+  // [1] => A tuple containing all points detected
+  boost::python::list tmp;
+  qreal x, y, width, height;
+  for (size_t k=0; k<detections.size(); ++k) {
+    if (dt_points[k].empty()) continue;
+
+    detections[k].second.first.getRect(&x, &y, &width, &height);
+    boost::python::tuple bbox = boost::python::make_tuple(x, y, width, height);
+
+    boost::python::list points;
+    for (size_t i=0; i<dt_points[k].size(); ++i) {
+      points.append(boost::python::make_tuple(dt_points[k][i].x(), dt_points[k][i].y()));
+    }
+    tmp.append(boost::python::make_tuple(bbox, boost::python::tuple(points)));
+  }
+
+  return boost::python::tuple(tmp);
+}
+
 void bind_visioner_localize() {
   boost::python::enum_<bob::visioner::CVDetector::Type>("DetectionMethod")
     .value("Scanning", bob::visioner::CVDetector::Scanning)
     .value("GroundTruth", bob::visioner::CVDetector::GroundTruth)
     ;
 
-  boost::python::class_<bob::visioner::CVDetector>("CVDetector", "Object detector that processes a pyramid of images", boost::python::init<const std::string&, double, uint64_t, uint64_t, double, bob::visioner::CVDetector::Type>((boost::python::arg("model"), boost::python::arg("threshold")=0.0, boost::python::arg("scanning_levels")=0, boost::python::arg("scale_variation")=2, boost::python::arg("clustering")=0.05, boost::python::arg("method")=bob::visioner::CVDetector::GroundTruth), "Basic constructor with the following parameters:\n\nmodel\n  file containing the model to be loaded; **note**: Serialization will use a native text format by default. Files that have their names suffixed with '.gz' will be automatically decompressed. If the filename ends in '.vbin' or '.vbgz' the format used will be the native binary format.\n\nthreshold\n  object classification threshold\n\nscanning_levels\n  scanning levels (the more, the faster)\n\nscale_variation\n  scale variation in pixels\n\nclustering\n  overlapping threshold for clustering detections\n\nmethod\n  Scanning or GroundTruth"))
+  boost::python::class_<bob::visioner::CVDetector>("CVDetector", "Object detector that processes a pyramid of images", boost::python::init<const std::string&, double, uint64_t, uint64_t, double, bob::visioner::CVDetector::Type>((boost::python::arg("model"), boost::python::arg("threshold")=0.0, boost::python::arg("scanning_levels")=0, boost::python::arg("scale_variation")=2, boost::python::arg("clustering")=0.05, boost::python::arg("method")=bob::visioner::CVDetector::GroundTruth), "Basic constructor with the following parameters:\n\nmodel\n  file containing the model to be loaded; **note**: Serialization will use a native text format by default. Files that have their names suffixed with '.gz' will be automatically decompressed. If the filename ends in '.vbin' or '.vbgz' the format used will be the native binary format. If the filename ends in '.vflat' the flat binary format is used, which is memory-mapped on loading.\n\nthreshold\n  object classification threshold\n\nscanning_levels\n  scanning levels (the more, the faster)\n\nscale_variation\n  scale variation in pixels\n\nclustering\n  overlapping threshold for clustering detections\n\nmethod\n  Scanning or GroundTruth"))
     .def_readwrite("threshold", &bob::visioner::CVDetector::m_threshold, "Object classification threshold")
     .add_property("scanning_levels", &bob::visioner::CVDetector::get_scan_levels, &bob::visioner::CVDetector::set_scan_levels, "Levels (the more, the faster)")
     .def_readwrite("scale_variation", &bob::visioner::CVDetector::m_ds, "Scale variation in pixels")
@@ -114,7 +177,13 @@ void bind_visioner_localize() {
     .def_readwrite("method", &bob::visioner::CVDetector::m_type, "Scanning or GroundTruth (default)")
     .def("detect", &detect, (boost::python::arg("self"), boost::python::arg("image")), "Detects faces in the input (gray-scaled) image according to the current settings. The input image format should be a 2D array of dtype=uint8.")
     .def("detect_max", &detect_max, (boost::python::arg("self"), boost::python::arg("image")), "Detects the most probable face in the input (gray-scaled) image according to the current settings")
-    .def("save", &bob::visioner::CVDetector::save, (boost::python::arg("self"), boost::python::arg("filename")), "Saves the model and parameters to a given file.\n\n**Note**: Serialization will use a native text format by default. Files that have their name suffixed with '.gz' will be automatically decompressed. If the filename ends in '.vbin' or '.vbgz' the format used will be the native binary format.")
+    .def_readwrite("tracking_period", &bob::visioner::CVDetector::m_track_period, "Video: number of frames between two dense scans (0 or 1 scans every frame densely)")
+    .def_readwrite("tracking_margin", &bob::visioner::CVDetector::m_track_margin, "Video: search margin around the previous detections, relative to their size")
+    .def_readwrite("tracking_scales", &bob::visioner::CVDetector::m_track_scales, "Video: number of scales searched around the previous detections")
+    .add_property("frame_timing", &frame_timing, "Video: time (in seconds) spent on the last frame processed with track()")
+    .def("track", &track, (boost::python::arg("self"), boost::python::arg("image")), "Detects faces in the next frame of a video: the frame is scanned densely every 'tracking_period' frames and only around the previous detections otherwise (using 'tracking_margin' and 'tracking_scales'). Returns the same as detect(). The input image format should be a 2D array of dtype=uint8.")
+    .def("reset_tracking", &bob::visioner::CVDetector::reset_tracking, (boost::python::arg("self")), "Forgets the previous detections, so that the next frame given to track() is scanned densely (e.g. on a new video or a shot change)")
+    .def("save", &bob::visioner::CVDetector::save, (boost::python::arg("self"), boost::python::arg("filename")), "Saves the model and parameters to a given file.\n\n**Note**: Serialization will use a native text format by default. Files that have their name suffixed with '.gz' will be automatically decompressed. If the filename ends in '.vbin' or '.vbgz' the format used will be the native binary format. If the filename ends in '.vflat' the flat binary format is used, which is memory-mapped on loading.")
     ;
 
   boost::python::enum_<bob::visioner::CVLocalizer::Type>("LocalizationMethod")
@@ -125,7 +194,9 @@ void bind_visioner_localize() {
 
   boost::python::class_<bob::visioner::CVLocalizer>("CVLocalizer", "Keypoint localizer to be applied in tandem with ground-truth or detections from CVDetector", boost::python::init<const std::string&, bob::visioner::CVLocalizer::Type>((boost::python::arg("model"), boost::python::arg("method")=bob::visioner::CVLocalizer::MultipleShots_Median), "Basic constructor taking a model file and the localization method to use"))
       .def_readwrite("method", &bob::visioner::CVLocalizer::m_type, "SingleShot, MultipleShots_Average or MultipleShots_Median (default)")
+      .def_readwrite("threads", &bob::visioner::CVLocalizer::m_threads, "Number of threads used to evaluate the sub-windows around each face location (0, the default, uses the current thread). The result does not depend on this number.")
       .def("locate", &locate, (boost::python::arg("self"), boost::python::arg("detector"), boost::python::arg("image")), "Runs the keypoint localization on the first (highest scored) face location determined by the detector. The input image format should be a 2D array of dtype=uint8.")
-    .def("save", &bob::visioner::CVLocalizer::save, (boost::python::arg("self"), boost::python::arg("filename")), "Saves the model and parameters to a given file.\n\n**Note**: Serialization will use a native text format by default. Files that have their name suffixed with '.gz' will be automatically decompressed. If the filename ends in '.vbin' or '.vbgz' the format used will be the native binary format.")
+      .def("locate_all", &locate_all, (boost::python::arg("self"), boost::python::arg("detector"), boost::python::arg("image")), "Runs the keypoint localization on all the face locations determined by the detector at once, sharing its image pyramid. Returns a tuple containing a (bounding box, points) 2-tuple for each localized face, with descending detection scores. The input image format should be a 2D array of dtype=uint8.")
+    .def("save", &bob::visioner::CVLocalizer::save, (boost::python::arg("self"), boost::python::arg("filename")), "Saves the model and parameters to a given file.\n\n**Note**: Serialization will use a native text format by default. Files that have their name suffixed with '.gz' will be automatically decompressed. If the filename ends in '.vbin' or '.vbgz' the format used will be the native binary format. If the filename ends in '.vflat' the flat binary format is used, which is memory-mapped on loading.")
     ;
 }
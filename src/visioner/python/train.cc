@@ -42,14 +42,16 @@ inline static bool is_dot_vbin(const std::string& filename) {
 
 static bool train_model(bob::visioner::Model& model, 
     const bob::visioner::Sampler& training, 
-    const bob::visioner::Sampler& validation, size_t threads) {
+    const bob::visioner::Sampler& validation, size_t threads, bool compact) {
 
   const bob::visioner::param_t param = model.param();
 
   // Train the model using coarse-to-fine feature projection
   for (uint64_t p = 0; p <= param.m_projections;
       ++p, model.project()) {
-    if (bob::visioner::make_trainer(param)->train(training, validation, model, threads) == false) return false;
+    const boost::shared_ptr<bob::visioner::Trainer> trainer = bob::visioner::make_trainer(param);
+    trainer->setCompact(compact);
+    if (trainer->train(training, validation, model, threads) == false) return false;
   }
 
   // OK
@@ -58,6 +60,14 @@ static bool train_model(bob::visioner::Model& model,
 
 static boost::shared_ptr<bob::visioner::Model> model_from_path(const std::string& path) {
 
+  if (boost::filesystem::extension(path) == ".vflat") { //the flat binary format
+    boost::shared_ptr<bob::visioner::Model> model;
+    if (bob::visioner::Model::load(path, model) == false) {
+      PYTHON_ERROR(IOError, "failed to load model parameters from file '%s'", path.c_str());
+    }
+    return bob::visioner::make_model(model->param());
+  }
+
   std::ios_base::openmode mode = std::ios_base::in;
   if (is_dot_gz(path) || is_dot_vbin(path)) mode |= std::ios_base::binary;
   std::ifstream file(path.c_str(), mode);
@@ -127,12 +137,12 @@ static boost::python::tuple available_sharings() {
 }
 
 static void sampler_load(bob::visioner::Sampler& s, boost::python::object images,
-    boost::python::object gts) {
+    boost::python::object gts, size_t threads=0) {
   boost::python::stl_input_iterator<const char*> ibegin(images), iend;
   std::vector<std::string> i(ibegin, iend);
     boost::python::stl_input_iterator<const char*> gbegin(gts), gend;
   std::vector<std::string> g(gbegin, gend);
-  s.load(i, g);
+  s.load(i, g, threads);
 }
 
 static boost::shared_ptr<bob::visioner::Sampler> 
@@ -149,7 +159,7 @@ sampler_from_files_2(const bob::visioner::param_t& param,
     bob::visioner::Sampler::SamplerType type, boost::python::object images,
     boost::python::object gts, size_t max_threads) {
   boost::shared_ptr<bob::visioner::Sampler> retval(new bob::visioner::Sampler(param, type, max_threads));
-  sampler_load(*retval, images, gts);
+  sampler_load(*retval, images, gts, max_threads);
   return retval;
 }
 
@@ -197,13 +207,14 @@ void bind_visioner_train() {
 
   boost::python::class_<bob::visioner::Sampler>("Sampler", "Object used for sampling uniformly, such that the same number of samples are obtained for distinct target values.", boost::python::init<bob::visioner::param_t, bob::visioner::Sampler::SamplerType, boost::python::optional<size_t> >((boost::python::arg("param"), boost::python::arg("type"), boost::python::arg("max_threads")=0), "Default constructor with parameters and the type of sampler this sampler will be. Set the maximum number of threads to zero if you want the job to be executed in the current thread, or to 1 or more if you would like to have more threads spawn. At this point, this parameter will only create as many random number generators as you specify (with a minimum of 1, if you set 0 there)."))
     .def("__init__", make_constructor(&sampler_from_files, boost::python::default_call_policies(), (boost::python::arg("param"), boost::python::arg("type"), boost::python::arg("images"), boost::python::arg("ground_thruth"))), "Constructs a new (single-threaded) sampler with parameters, a type and a list of images and (associated) ground-thruth information. Note that if you specify the list of images and ground-thruth inside the parameters object, that list will be read, but discarded in favor of the discrete list provided with the two input parameters.")
-    .def("__init__", make_constructor(&sampler_from_files_2, boost::python::default_call_policies(), (boost::python::arg("param"), boost::python::arg("type"), boost::python::arg("images"), boost::python::arg("ground_thruth"), boost::python::arg("max_threads"))), "Constructs a new (multi-threaded) sampler with parameters, a type and a list of images and (associated) ground-thruth information. Note that if you specify the list of images and ground-thruth inside the parameters object, that list will be read, but discarded in favor of the discrete list provided with the two input parameters.")
+    .def("__init__", make_constructor(&sampler_from_files_2, boost::python::default_call_policies(), (boost::python::arg("param"), boost::python::arg("type"), boost::python::arg("images"), boost::python::arg("ground_thruth"), boost::python::arg("max_threads"))), "Constructs a new (multi-threaded) sampler with parameters, a type and a list of images and (associated) ground-thruth information, which are loaded using max_threads threads. Note that if you specify the list of images and ground-thruth inside the parameters object, that list will be read, but discarded in favor of the discrete list provided with the two input parameters.")
     .add_property("num_of_images", &bob::visioner::Sampler::n_images)
     .add_property("num_of_samples", &bob::visioner::Sampler::n_samples)
     .add_property("num_of_outputs", &bob::visioner::Sampler::n_outputs)
     .add_property("num_of_types", &bob::visioner::Sampler::n_types)
     .add_property("type", &bob::visioner::Sampler::getType, "This sampler's type")
-    .def("load", &sampler_load, (boost::python::arg("self"), boost::python::arg("images"), boost::python::arg("ground_thruth")), "Resets the current contents of this sampler to use the image and (matching) ground-thruth files given. This method input lists or python iterables with the absolute or relative path of images and ground-thruth files you need to load.")
+    .add_property("compact", &bob::visioner::Sampler::getCompact, &bob::visioner::Sampler::setCompact, "If set, only the part of each scaled image covered by its samples is kept in memory for the images loaded afterwards (the samples are the same, but the memory usage is lower)")
+    .def("load", &sampler_load, (boost::python::arg("self"), boost::python::arg("images"), boost::python::arg("ground_thruth"), boost::python::arg("threads")=0), "Resets the current contents of this sampler to use the image and (matching) ground-thruth files given. This method input lists or python iterables with the absolute or relative path of images and ground-thruth files you need to load. The images are loaded by the given number of threads (0 to use the current thread), the result does not depend on this number.")
     ;
 
   boost::python::class_<bob::visioner::Model, boost::shared_ptr<bob::visioner::Model>, boost::noncopyable>("Model", "Multivariate model as a linear combination of LUTs. NB: The ::preprocess() must be called before ::get() and ::score() functions.", boost::python::no_init)
@@ -219,7 +230,7 @@ void bind_visioner_train() {
     .add_property("num_of_outputs", &bob::visioner::Model::n_outputs)
     .def("num_of_luts", &bob::visioner::Model::n_luts, (boost::python::arg("self"), boost::python::arg("o")), "Number of LUTs")
     .def("describe", &bob::visioner::Model::describe, (boost::python::arg("self"), boost::python::arg("feature")), "Describes a feature")
-    .def("train", &train_model, (boost::python::arg("self"), boost::python::arg("training_sampler"), boost::python::arg("validation_sampler"), boost::python::arg("threads")), "Trains the boosted classifier using training and validation samplers with the specified number of threads (0 to run in the current thread and 1 or more to spawn new worker threads).")
+    .def("train", &train_model, (boost::python::arg("self"), boost::python::arg("training_sampler"), boost::python::arg("validation_sampler"), boost::python::arg("threads"), boost::python::arg("compact")=false), "Trains the boosted classifier using training and validation samplers with the specified number of threads (0 to run in the current thread and 1 or more to spawn new worker threads). If compact is set, the per-sample scores are kept in single precision during training, which reduces the memory usage and traffic.")
     ;
 
   boost::python::scope().attr("LOSSES") = available_losses();